@@ -19,10 +19,15 @@
 #include <cassert>
 #include <limits>
 #include "AIPlayer.h"
-#include "FrameManager.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
+// Class static members.
+std::atomic<uint64_t> AIPlayer::m_TotalSearchedNodes (0);
+
 ///
 /// \brief Default constructor.
 ///
@@ -39,9 +44,12 @@ AIPlayer::AIPlayer (IPlayer::PlayerSide side,
     IPlayer (side),
     m_BestMove (),
     m_BestScore (std::numeric_limits<int32_t>::min ()),
+    m_CurrentTime (0),
     m_FallingPairAtPosition (false),
     m_HaveFinalMove (false),
     m_PairToCheck (CheckingCurrentFallingPair),
+    m_PositionResult (),
+    m_SearchedNodes (0),
     m_TimeDeviation (timeDeviation),
     m_TimeOfNextMove (0),
     m_TimeToWaitForNextMove (timeToWaitForNextMove),
@@ -49,13 +57,17 @@ AIPlayer::AIPlayer (IPlayer::PlayerSide side,
 {
     assert ( 0 <= m_TimeDeviation &&
             "The time deviation must be greater than 0!" );
+    // Keep room for as many groups and step chains as the grid can hold.
+    m_PositionResult.groups.reserve (Grid::k_GridWidth * Grid::k_GridHeight);
+    m_PositionResult.stepChains.reserve (Grid::k_GridWidth *
+                                         Grid::k_GridHeight);
 }
 
 ///
 /// \brief Tells if the AI player can move.
 ///
-/// Checks if the current time is past the time of the next move,
-/// letting the player move.
+/// Checks if the player's current time is past the time of the next
+/// move, letting the player move.
 ///
 /// \return \a true if the player can make the next move,
 ///         \a false otherwise.
@@ -63,7 +75,7 @@ AIPlayer::AIPlayer (IPlayer::PlayerSide side,
 bool
 AIPlayer::canMove (void) const
 {
-    return FrameManager::getCurrentTime () > m_TimeOfNextMove;
+    return m_CurrentTime > m_TimeOfNextMove;
 }
 
 ///
@@ -146,10 +158,11 @@ AIPlayer::checkAllPositionsOf (State &state, const GridStatus &gridState,
         for ( state.currentX = 0 ; state.currentX < state.endX ; ++state.currentX )
         {
             state.gridState = gridState;
-            GridStatus::PositionResult result;
             state.gridState.checkPositions (state.move.main,
-                                            state.move.satellite, result);
-            state.score = parentScore + computeScore (result);
+                                            state.move.satellite,
+                                            m_PositionResult);
+            ++m_SearchedNodes;
+            state.score = parentScore + computeScore (m_PositionResult);
             if ( state.score > getBestScore () )
             {
                 // Take into account that satellite and main are
@@ -334,10 +347,10 @@ AIPlayer::checkNextPositionOf (State &state, const GridStatus &gridState,
         }
     }
     state.gridState = gridState;
-    GridStatus::PositionResult result;
     state.gridState.checkPositions (state.move.main, state.move.satellite,
-                                    result);
-    state.score = parentScore + computeScore (result);
+                                    m_PositionResult);
+    ++m_SearchedNodes;
+    state.score = parentScore + computeScore (m_PositionResult);
 }
 
 ///
@@ -346,6 +359,7 @@ AIPlayer::checkNextPositionOf (State &state, const GridStatus &gridState,
 void
 AIPlayer::computeNextMove (void)
 {
+    AMOEBAX_TRACE_ZONE ("AIPlayer::computeNextMove");
     switch ( getWhichPairToCheck () )
     {
         case CheckingCurrentFallingPair:
@@ -364,6 +378,23 @@ AIPlayer::computeNextMove (void)
             setPairToCheck (CheckingCurrentFallingPair);
             break;
     }
+    // Adding once per move keeps the players of different threads
+    // from fighting over the counter at each position.
+    m_TotalSearchedNodes.fetch_add (m_SearchedNodes,
+                                    std::memory_order_relaxed);
+    m_SearchedNodes = 0;
+}
+
+///
+/// \brief Gets the positions the computer players have checked.
+///
+/// \return The number of positions all the computer players checked
+///         for their moves since the program started.
+///
+uint64_t
+AIPlayer::getSearchedNodes (void)
+{
+    return m_TotalSearchedNodes.load (std::memory_order_relaxed);
 }
 
 ///
@@ -419,7 +450,7 @@ AIPlayer::hasPairAtFinalPosition (void) const
 ///
 void
 AIPlayer::initializeState (State &state, const GridStatus &gridState,
-                           int32_t parentScore) const
+                           int32_t parentScore)
 {
     state.move.rotation = RotationLeft;
     state.move.main.x = 0;
@@ -428,10 +459,9 @@ AIPlayer::initializeState (State &state, const GridStatus &gridState,
     state.endX = Grid::k_GridWidth - 1;
 
     state.gridState = gridState;
-    GridStatus::PositionResult result;
     state.gridState.checkPositions (state.move.main, state.move.satellite,
-                                    result);
-    state.score = parentScore + computeScore (result);
+                                    m_PositionResult);
+    state.score = parentScore + computeScore (m_PositionResult);
 }
 
 ///
@@ -637,6 +667,8 @@ void
 AIPlayer::update (uint32_t elapsedTime)
 {
     IPlayer::update (elapsedTime);
+    Profiler::Timer timer (Profiler::PhaseAI);
+    m_CurrentTime += elapsedTime;
     if ( isWaitingNextPair () )
     {
         checkIfPairIsAvailable ();
@@ -665,9 +697,9 @@ AIPlayer::update (uint32_t elapsedTime)
 void
 AIPlayer::updateTimeOfNextMove (void)
 {
-    m_TimeOfNextMove = FrameManager::getCurrentTime () +
+    m_TimeOfNextMove = m_CurrentTime +
                        m_TimeToWaitForNextMove -
-                       ((rand () % (m_TimeDeviation << 1)) -
+                       ((Random::get () % (m_TimeDeviation << 1)) -
                        m_TimeDeviation);
 }
 
@@ -19,6 +19,7 @@
 #if !defined (AMOEBAX_AI_PLAYER_H)
 #define AMOEBAX_AI_PLAYER_H
 
+#include <atomic>
 #include "IPlayer.h"
 #include "Grid.h"
 #include "GridStatus.h"
@@ -36,6 +37,7 @@ namespace Amoebax
                                uint32_t timeToWaitForNextMove,
                                uint32_t timeDeviation);
 
+            static uint64_t getSearchedNodes (void);
             virtual void joyMotion (uint8_t joystick, uint8_t axis,
                                     int16_t value);
             virtual void joyDown (uint8_t joystick, SDL_GameControllerButton button);
@@ -166,7 +168,7 @@ namespace Amoebax
             bool hasFinalMove (void) const;
             bool hasPairAtFinalPosition (void) const;
             void initializeState (State &state, const GridStatus &gridState,
-                                  int32_t parentScore = 0) const;
+                                  int32_t parentScore = 0);
             bool isWaitingNextPair (void) const;
             void moveLeft (void);
             void movePairToPosition (void);
@@ -184,6 +186,8 @@ namespace Amoebax
             Move m_BestMove;
             /// The score of the best movement.
             int32_t m_BestScore;
+            /// The sum of all elapsed times the player received, in ms.
+            uint32_t m_CurrentTime;
             /// The falling pair is at the computed position.
             bool m_FallingPairAtPosition;
             /// The player has chosen its final movement.
@@ -192,12 +196,19 @@ namespace Amoebax
             State m_PairState[3];
             /// Tells which pair are we checking right now for its best move.
             Checking m_PairToCheck;
+            /// The result of the last checked position, reused to keep
+            /// its vectors' memory between positions.
+            GridStatus::PositionResult m_PositionResult;
+            /// The positions checked since the last computeNextMove().
+            uint32_t m_SearchedNodes;
             /// The max. number of milliseconds to add/subtract to the average.
             uint32_t m_TimeDeviation;
             /// The time we can make the next movement.
             uint32_t m_TimeOfNextMove;
             /// The average time the player waits between moves, in ms.
             uint32_t m_TimeToWaitForNextMove;
+            /// The positions all computer players have checked.
+            static std::atomic<uint64_t> m_TotalSearchedNodes;
             /// Tells if we are waiting for the next grid's falling pair.
             bool m_WaitingNextPair;
     };
@@ -21,7 +21,9 @@
 #include "AIPlayerFactory.h"
 #include "AnticipatoryAIPlayer.h"
 #include "DumbAIPlayer.h"
+#include "Random.h"
 #include "SimpleAIPlayer.h"
+#include "WinRates.h"
 
 using namespace Amoebax;
 
@@ -140,6 +142,26 @@ AIPlayerFactory::getRandomBackgroundFileName (void)
 }
 
 
+///
+/// \brief Gets the probability that a level wins against another.
+///
+/// The probabilities come from the table in WinRates.h, that is
+/// computed by playing simulated matches between all levels. See the
+/// win_rates build target.
+///
+/// \param leftLevel The level of the left AI player.
+/// \param rightLevel The level of the right AI player.
+/// \return The probability, between 0.0f and 1.0f, that the left player
+///         wins the match.
+///
+float
+AIPlayerFactory::getWinProbability (uint8_t leftLevel, uint8_t rightLevel)
+{
+    assert ( leftLevel < k_MaxPlayerLevel && rightLevel < k_MaxPlayerLevel &&
+             "AI player level not valid!" );
+    return k_WinRate[leftLevel][rightLevel] / 1000.0f;
+}
+
 ///
 /// \brief Gets the winner of an hypotetical match between to AI players.
 ///
@@ -150,199 +172,8 @@ AIPlayerFactory::getRandomBackgroundFileName (void)
 IPlayer::PlayerSide
 AIPlayerFactory::getWinner (uint8_t leftLevel, uint8_t rightLevel)
 {
-    uint8_t probabilityLeftPlayerWins = 0;
-
-    // If both players have the same level, then both have the same
-    // probability to win.
-    if ( leftLevel == rightLevel )
-    {
-        probabilityLeftPlayerWins = 50;
-    }
-    else
-    {
-        switch (leftLevel)
-        {
-            case 0:
-                switch (rightLevel)
-                {
-                    case 1:
-                        probabilityLeftPlayerWins = 15;
-                        break;
-
-                    case 2:
-                        probabilityLeftPlayerWins = 12;
-                        break;
-
-                    case 3:
-                        probabilityLeftPlayerWins = 9;
-                        break;
-
-                    case 4:
-                        probabilityLeftPlayerWins = 6;
-                        break;
-
-                    case 5:
-                        probabilityLeftPlayerWins = 3;
-                        break;
-
-                    default:
-                        probabilityLeftPlayerWins = 50;
-                        break;
-                }
-                break;
-
-            case 1:
-                switch (rightLevel)
-                {
-                    case 0:
-                        probabilityLeftPlayerWins = 85;
-                        break;
-
-                    case 2:
-                        probabilityLeftPlayerWins = 32;
-                        break;
-
-                    case 3:
-                        probabilityLeftPlayerWins = 29;
-                        break;
-
-                    case 4:
-                        probabilityLeftPlayerWins = 25;
-                        break;
-
-                    case 5:
-                        probabilityLeftPlayerWins = 20;
-                        break;
-
-                    default:
-                        probabilityLeftPlayerWins = 14;
-                        break;
-                }
-                break;
-
-            case 2:
-                switch (rightLevel)
-                {
-                    case 0:
-                        probabilityLeftPlayerWins = 88;
-                        break;
-
-                    case 1:
-                        probabilityLeftPlayerWins = 68;
-                        break;
-
-                    case 3:
-                        probabilityLeftPlayerWins = 34;
-                        break;
-
-                    case 4:
-                        probabilityLeftPlayerWins = 29;
-                        break;
-
-                    case 5:
-                        probabilityLeftPlayerWins = 23;
-                        break;
-
-                    default:
-                        probabilityLeftPlayerWins = 50;
-                        break;
-                }
-                break;
-
-            case 3:
-                switch (rightLevel)
-                {
-                    case 0:
-                        probabilityLeftPlayerWins = 91;
-                        break;
-
-                    case 1:
-                        probabilityLeftPlayerWins = 71;
-                        break;
-
-                    case 2:
-                        probabilityLeftPlayerWins = 66;
-                        break;
-
-                    case 4:
-                        probabilityLeftPlayerWins = 31;
-                        break;
-
-                    case 5:
-                        probabilityLeftPlayerWins = 26;
-                        break;
-
-                    default:
-                        probabilityLeftPlayerWins = 50;
-                        break;
-                }
-                break;
-
-            case 4:
-                switch (rightLevel)
-                {
-                    case 0:
-                        probabilityLeftPlayerWins = 94;
-                        break;
-
-                    case 1:
-                        probabilityLeftPlayerWins = 75;
-                        break;
-
-                    case 2:
-                        probabilityLeftPlayerWins = 71;
-                        break;
-
-                    case 3:
-                        probabilityLeftPlayerWins = 69;
-                        break;
-
-                    case 5:
-                        probabilityLeftPlayerWins = 35;
-                        break;
-
-                    default:
-                        probabilityLeftPlayerWins = 50;
-                        break;
-                }
-                break;
-
-            case 5:
-                switch (rightLevel)
-                {
-                    case 0:
-                        probabilityLeftPlayerWins = 97;
-                        break;
-
-                    case 1:
-                        probabilityLeftPlayerWins = 80;
-                        break;
-
-                    case 2:
-                        probabilityLeftPlayerWins = 77;
-                        break;
-
-                    case 3:
-                        probabilityLeftPlayerWins = 74;
-                        break;
-
-                    case 4:
-                        probabilityLeftPlayerWins = 65;
-                        break;
-
-                    default:
-                        probabilityLeftPlayerWins = 50;
-                        break;
-                }
-                break;
-
-            default:
-                probabilityLeftPlayerWins = 50;
-                break;
-        }
-    }
-
-
-    return ((rand () % 100) < probabilityLeftPlayerWins) ? IPlayer::LeftSide :
-                                                           IPlayer::RightSide;
+    assert ( leftLevel < k_MaxPlayerLevel && rightLevel < k_MaxPlayerLevel &&
+             "AI player level not valid!" );
+    return (Random::get () % 1000) < k_WinRate[leftLevel][rightLevel] ?
+        IPlayer::LeftSide : IPlayer::RightSide;
 }
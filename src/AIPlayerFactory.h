@@ -40,6 +40,8 @@ namespace Amoebax
             static std::string getBackgroundFileName (uint8_t level);
             static std::string getPlayerName (uint8_t level);
             static std::string getRandomBackgroundFileName ();
+            static float getWinProbability (uint8_t leftLevel,
+                                            uint8_t rightLevel);
             static IPlayer::PlayerSide getWinner (uint8_t leftLevel,
                                                   uint8_t rightLevel);
 
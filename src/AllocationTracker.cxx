@@ -0,0 +1,327 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "AllocationTracker.h"
+
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+#include <algorithm>
+#include <iostream>
+#include <new>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#if defined (__GLIBC__)
+#include <cxxabi.h>
+#include <execinfo.h>
+#endif // __GLIBC__
+
+using namespace Amoebax;
+
+// Class static members.  All of them are initialized before any
+// constructor runs, since operator new can be called from them.
+std::atomic<uint64_t> AllocationTracker::m_AllocatedBytes (0);
+std::atomic<uint64_t> AllocationTracker::m_Allocations (0);
+AllocationTracker::CallSite AllocationTracker::m_CallSites[AllocationTracker::k_NumCallSites];
+std::mutex AllocationTracker::m_CallSitesMutex;
+uint64_t AllocationTracker::m_DroppedSamples = 0;
+thread_local bool AllocationTracker::m_Sampling = false;
+thread_local uint32_t AllocationTracker::m_ThreadAllocations = 0;
+
+// The definitions of the class' constants, for when they are used by reference.
+const unsigned int AllocationTracker::k_CallStackDepth;
+const unsigned int AllocationTracker::k_NumCallSites;
+const unsigned int AllocationTracker::k_ReportedCallSites;
+const uint32_t AllocationTracker::k_SampleInterval;
+
+///
+/// \struct ReportWriter.
+/// \brief Writes the allocations' report when the program exits.
+///
+static struct ReportWriter
+{
+    ~ReportWriter (void)
+    {
+        AllocationTracker::writeReport (std::cerr);
+    }
+} g_ReportWriter;
+
+///
+/// \brief Allocates memory, counting the allocation.
+///
+/// \param size The bytes to allocate.
+/// \return The allocated memory.
+/// \throw std::bad_alloc if there is no memory left and no new handler.
+///
+static void *
+allocate (size_t size)
+{
+    AllocationTracker::addAllocation (size);
+    for ( ; ; )
+    {
+        void *memory = malloc (0 == size ? 1 : size);
+        if ( 0 != memory )
+        {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler ();
+        if ( 0 == handler )
+        {
+            throw std::bad_alloc ();
+        }
+        handler ();
+    }
+}
+
+///
+/// \brief Allocates memory, counting the allocation, without throwing.
+///
+/// \param size The bytes to allocate.
+/// \return The allocated memory, or 0 if there is no memory left.
+///
+static void *
+allocateNoThrow (size_t size)
+{
+    try
+    {
+        return allocate (size);
+    }
+    catch (std::bad_alloc &)
+    {
+        return 0;
+    }
+}
+
+///
+/// \brief Gets a function's name from a backtrace symbol.
+///
+/// \param symbol The symbol, as given by backtrace_symbols().
+/// \return The demangled function's name, or \p symbol if it has none.
+///
+static std::string
+getFunctionName (const char *symbol)
+{
+    std::string name (symbol);
+#if defined (__GLIBC__)
+    // The symbol looks like "file(mangled+offset) [address]".
+    const std::string::size_type start = name.find ('(');
+    const std::string::size_type end = name.find ('+', start);
+    if ( std::string::npos != start && std::string::npos != end &&
+         start + 1 < end )
+    {
+        int status = 0;
+        char *demangledName =
+            abi::__cxa_demangle (name.substr (start + 1, end - start - 1).c_str (),
+                                 0, 0, &status);
+        if ( 0 == status )
+        {
+            name = demangledName;
+        }
+        free (demangledName);
+    }
+#endif // __GLIBC__
+    return name;
+}
+
+void *
+operator new (size_t size)
+{
+    return allocate (size);
+}
+
+void *
+operator new[] (size_t size)
+{
+    return allocate (size);
+}
+
+void *
+operator new (size_t size, const std::nothrow_t &) noexcept
+{
+    return allocateNoThrow (size);
+}
+
+void *
+operator new[] (size_t size, const std::nothrow_t &) noexcept
+{
+    return allocateNoThrow (size);
+}
+
+void
+operator delete (void *memory) noexcept
+{
+    free (memory);
+}
+
+void
+operator delete[] (void *memory) noexcept
+{
+    free (memory);
+}
+
+void
+operator delete (void *memory, const std::nothrow_t &) noexcept
+{
+    free (memory);
+}
+
+void
+operator delete[] (void *memory, const std::nothrow_t &) noexcept
+{
+    free (memory);
+}
+
+///
+/// \brief Counts an allocation and samples its call stack now and then.
+///
+/// \param size The bytes allocated.
+///
+void
+AllocationTracker::addAllocation (size_t size)
+{
+    m_Allocations.fetch_add (1, std::memory_order_relaxed);
+    m_AllocatedBytes.fetch_add (size, std::memory_order_relaxed);
+    // Sampling can allocate the first time, so don't sample that.
+    if ( 0 == ++m_ThreadAllocations % k_SampleInterval && !m_Sampling )
+    {
+        m_Sampling = true;
+        sampleCallSite ();
+        m_Sampling = false;
+    }
+}
+
+///
+/// \brief Tells if a call site was sampled more often than another.
+///
+/// \param first The first call site to compare.
+/// \param second The second call site to compare.
+/// \return \a true if \p first has more samples than \p second.
+///
+bool
+AllocationTracker::hasMoreSamples (const CallSite *first,
+                                   const CallSite *second)
+{
+    return first->samples > second->samples;
+}
+
+///
+/// \brief Adds the current call stack to the sampled call sites.
+///
+void
+AllocationTracker::sampleCallSite (void)
+{
+#if defined (__GLIBC__)
+    void *callStack[k_CallStackDepth];
+    const int depth = backtrace (callStack, k_CallStackDepth);
+    size_t hash = depth;
+    for ( int frame = 0 ; frame < depth ; ++frame )
+    {
+        hash = hash * 31 + reinterpret_cast<size_t>(callStack[frame]);
+    }
+
+    std::lock_guard<std::mutex> lock (m_CallSitesMutex);
+    for ( unsigned int probe = 0 ; probe < k_NumCallSites ; ++probe )
+    {
+        CallSite &callSite = m_CallSites[(hash + probe) % k_NumCallSites];
+        if ( 0 == callSite.samples )
+        {
+            std::copy (callStack, callStack + depth, callSite.callStack);
+            callSite.depth = depth;
+        }
+        if ( callSite.depth == depth &&
+             std::equal (callStack, callStack + depth, callSite.callStack) )
+        {
+            ++callSite.samples;
+            return;
+        }
+    }
+    ++m_DroppedSamples;
+#endif // __GLIBC__
+}
+
+///
+/// \brief Writes the number of allocations and the most sampled call sites.
+///
+/// The functions of the tracker and operator new are left out of the
+/// call stacks.
+///
+/// \param stream The stream to write the report to.
+///
+void
+AllocationTracker::writeReport (std::ostream &stream)
+{
+    // The report's own allocations must not change it.
+    m_Sampling = true;
+    stream << getAllocations () << " allocations of " <<
+        getAllocatedBytes () << " bytes." << std::endl;
+
+    std::vector<CallSite *> callSites;
+    uint64_t samples = 0;
+    {
+        std::lock_guard<std::mutex> lock (m_CallSitesMutex);
+        for ( unsigned int callSite = 0 ; callSite < k_NumCallSites ; ++callSite )
+        {
+            if ( 0 < m_CallSites[callSite].samples )
+            {
+                callSites.push_back (&m_CallSites[callSite]);
+                samples += m_CallSites[callSite].samples;
+            }
+        }
+        samples += m_DroppedSamples;
+    }
+    if ( callSites.empty () )
+    {
+        return;
+    }
+    std::sort (callSites.begin (), callSites.end (), hasMoreSamples);
+    if ( callSites.size () > k_ReportedCallSites )
+    {
+        callSites.resize (k_ReportedCallSites);
+    }
+
+    stream << "The most sampled call stacks, out of " << samples <<
+        " allocations sampled one every " << k_SampleInterval << ":" <<
+        std::endl;
+#if defined (__GLIBC__)
+    for ( std::vector<CallSite *>::const_iterator callSite = callSites.begin () ;
+          callSite != callSites.end () ; ++callSite )
+    {
+        stream << (*callSite)->samples << " samples:" << std::endl;
+        char **symbols = backtrace_symbols ((*callSite)->callStack,
+                                            (*callSite)->depth);
+        if ( 0 == symbols )
+        {
+            continue;
+        }
+        bool inTracker = true;
+        for ( int frame = 0 ; frame < (*callSite)->depth ; ++frame )
+        {
+            const std::string function (getFunctionName (symbols[frame]));
+            inTracker = inTracker &&
+                (std::string::npos != function.find ("AllocationTracker") ||
+                 std::string::npos != function.find ("allocate") ||
+                 std::string::npos != function.find ("operator new"));
+            if ( !inTracker )
+            {
+                stream << "    " << function << std::endl;
+            }
+        }
+        free (symbols);
+    }
+#endif // __GLIBC__
+}
+#endif // AMOEBAX_ALLOCATION_TRACKING
@@ -0,0 +1,142 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_ALLOCATION_TRACKER_H)
+#define AMOEBAX_ALLOCATION_TRACKER_H
+
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+#include <atomic>
+#include <iosfwd>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Amoebax
+{
+    ///
+    /// \class AllocationTracker.
+    /// \brief Counts the heap allocations made with operator new.
+    ///
+    /// The global operator new is replaced to count the allocations of
+    /// all threads, which the profiler splits by frame.  Every
+    /// k_SampleInterval allocations of a thread, the allocation's call
+    /// stack is sampled, and the most sampled call stacks are written to
+    /// the standard error when the program exits.  Call stacks are only
+    /// sampled with the GNU C library, and their functions' names are
+    /// only known when the executable exports its symbols.
+    ///
+    /// The tracker is only compiled in with the ALLOCATION_TRACKING
+    /// CMake option.
+    ///
+    class AllocationTracker
+    {
+        public:
+            /// The number of functions kept of each call stack.
+            static const unsigned int k_CallStackDepth = 12;
+            /// The number of different call stacks that can be sampled.
+            static const unsigned int k_NumCallSites = 1024;
+            /// The number of call stacks written to the report.
+            static const unsigned int k_ReportedCallSites = 10;
+            /// The allocations of a thread between two samples.
+            static const uint32_t k_SampleInterval = 64;
+
+            static void addAllocation (size_t size);
+            static uint64_t getAllocatedBytes (void);
+            static uint64_t getAllocations (void);
+            static void writeReport (std::ostream &stream);
+
+        private:
+            // This class it not instanciable.
+            ///
+            /// \brief Default constructor.
+            ///
+            AllocationTracker (void);
+            ///
+            /// \brief Copy constructor.
+            ///
+            /// \note This constructor is left unimplemented because we
+            /// don't want copies of AllocationTracker. Don't use it.
+            ///
+            AllocationTracker (const AllocationTracker &);
+            ///
+            /// \brief Assigment operator.
+            ///
+            /// \note This operator is left unimplemented because we
+            /// don't want copies of AllocationTracker. Don't use it.
+            ///
+            AllocationTracker &operator= (const AllocationTracker &);
+
+            ///
+            /// \struct CallSite.
+            /// \brief A call stack that made sampled allocations.
+            ///
+            struct CallSite
+            {
+                /// The return addresses, from the innermost function.
+                void *callStack[k_CallStackDepth];
+                /// The number of addresses in callStack.
+                int depth;
+                /// The number of allocations sampled from the call stack.
+                uint64_t samples;
+            };
+
+            static bool hasMoreSamples (const CallSite *first,
+                                        const CallSite *second);
+            static void sampleCallSite (void);
+
+            /// The bytes allocated since the program started.
+            static std::atomic<uint64_t> m_AllocatedBytes;
+            /// The allocations since the program started.
+            static std::atomic<uint64_t> m_Allocations;
+            /// The sampled call stacks, at their hash's position.
+            static CallSite m_CallSites[k_NumCallSites];
+            /// Guards m_CallSites and m_DroppedSamples.
+            static std::mutex m_CallSitesMutex;
+            /// The samples dropped because m_CallSites was full.
+            static uint64_t m_DroppedSamples;
+            /// Tells if the current thread is sampling a call stack.
+            static thread_local bool m_Sampling;
+            /// The allocations of the current thread.
+            static thread_local uint32_t m_ThreadAllocations;
+    };
+
+    ///
+    /// \brief Gets the bytes allocated so far.
+    ///
+    /// \return The bytes all threads allocated since the program started.
+    ///
+    inline uint64_t
+    AllocationTracker::getAllocatedBytes (void)
+    {
+        return m_AllocatedBytes.load (std::memory_order_relaxed);
+    }
+
+    ///
+    /// \brief Gets the number of allocations made so far.
+    ///
+    /// \return The allocations of all threads since the program started.
+    ///
+    inline uint64_t
+    AllocationTracker::getAllocations (void)
+    {
+        return m_Allocations.load (std::memory_order_relaxed);
+    }
+}
+#endif // AMOEBAX_ALLOCATION_TRACKING
+
+#endif // !AMOEBAX_ALLOCATION_TRACKER_H
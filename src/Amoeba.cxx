@@ -16,10 +16,39 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
+#include <stdlib.h>
 #include "Amoeba.h"
 
 using namespace Amoebax;
 
+// The definitions of the class' constants, for when they are used by reference.
+const uint16_t Amoeba::k_MaxInterpolation;
+
+///
+/// \brief Interpolates a coordinate between two ticks.
+///
+/// \param previous The coordinate at the previous tick.
+/// \param current The coordinate at the current tick.
+/// \param interpolation How far to go from \p previous to \p current,
+///                      from 0 to Amoeba::k_MaxInterpolation.
+/// \param maxDistance The maximum distance to interpolate.
+/// \return The interpolated coordinate, or \p current if it is farther
+///         than \p maxDistance from \p previous, because then the amoeba
+///         didn't move but was placed somewhere else.
+///
+static uint16_t
+interpolate (uint16_t previous, uint16_t current, uint16_t interpolation,
+             uint16_t maxDistance)
+{
+    const int32_t distance = static_cast<int16_t> (current - previous);
+    if ( abs (distance) > maxDistance )
+    {
+        return current;
+    }
+    return static_cast<uint16_t> (previous + distance * interpolation /
+                                             Amoeba::k_MaxInterpolation);
+}
+
 ///
 /// \brief Constructor.
 ///
@@ -28,6 +57,8 @@ using namespace Amoebax;
 Amoeba::Amoeba (Colour colour):
     m_Colour (colour),
     m_Dying (false),
+    m_PreviousX (0),
+    m_PreviousY (0),
     m_State (StateNone),
     m_Visible (true),
     m_X (0),
@@ -41,3 +72,61 @@ Amoeba::Amoeba (Colour colour):
 Amoeba::~Amoeba (void)
 {
 }
+
+///
+/// \brief Gets the letter that stands for the amoeba in text.
+///
+/// \return The upper case initial of the amoeba's colour, or `x' for
+///         ghost amoebas.
+///
+char
+Amoeba::getLetter (void) const
+{
+    switch ( getColour () )
+    {
+        case ColourRed:
+            return 'R';
+        case ColourBlue:
+            return 'B';
+        case ColourGreen:
+            return 'G';
+        case ColourOrange:
+            return 'O';
+        case ColourPurple:
+            return 'P';
+        case ColourGhost:
+            return 'x';
+        default:
+            return '?';
+    }
+}
+
+///
+/// \brief Gets the amoeba's X position between two logic ticks.
+///
+/// \param interpolation How far to go from the position at the previous
+///                      tick to the current position, from 0 to
+///                      k_MaxInterpolation.
+/// \param maxDistance The maximum distance the amoeba can move in a tick.
+/// \return The interpolated X position.
+///
+uint16_t
+Amoeba::getX (uint16_t interpolation, uint16_t maxDistance) const
+{
+    return interpolate (m_PreviousX, m_X, interpolation, maxDistance);
+}
+
+///
+/// \brief Gets the amoeba's Y position between two logic ticks.
+///
+/// \param interpolation How far to go from the position at the previous
+///                      tick to the current position, from 0 to
+///                      k_MaxInterpolation.
+/// \param maxDistance The maximum distance the amoeba can move in a tick.
+/// \return The interpolated Y position.
+///
+uint16_t
+Amoeba::getY (uint16_t interpolation, uint16_t maxDistance) const
+{
+    return interpolate (m_PreviousY, m_Y, interpolation, maxDistance);
+}
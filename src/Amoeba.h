@@ -89,15 +89,22 @@ namespace Amoebax
                 StateTopRightBottomLeft = 15
             };
 
+            /// The interpolation that gives the current position.
+            static const uint16_t k_MaxInterpolation = 256;
+
             explicit Amoeba (Colour colour);
             ~Amoeba (void);
 
             Colour getColour (void) const;
+            char getLetter (void) const;
             State getState (void) const;
             uint16_t getX (void) const;
+            uint16_t getX (uint16_t interpolation, uint16_t maxDistance) const;
             uint16_t getY (void) const;
+            uint16_t getY (uint16_t interpolation, uint16_t maxDistance) const;
             bool isDying (void) const;
             bool isVisible (void) const;
+            void keepPosition (void);
             void setDying (bool dying);
             void setState (State state);
             void setVisible (bool visible);
@@ -109,6 +116,10 @@ namespace Amoebax
             Colour m_Colour;
             /// Tells if the amoeba is dying.
             bool m_Dying;
+            /// Amoeba's X position at the previous logic tick.
+            uint16_t m_PreviousX;
+            /// Amoeba's Y position at the previous logic tick.
+            uint16_t m_PreviousY;
             /// Amoeba's state or neighbourhood state.
             State m_State;
             /// Tells if the amoeba should be visible.
@@ -185,6 +196,19 @@ namespace Amoebax
         return m_Visible;
     }
 
+    ///
+    /// \brief Remembers the current position as the previous tick's.
+    ///
+    /// The grids call this before each logic tick, so the amoebas can be
+    /// drawn between the position before and after the tick.
+    ///
+    inline void
+    Amoeba::keepPosition (void)
+    {
+        m_PreviousX = m_X;
+        m_PreviousY = m_Y;
+    }
+
     ///
     /// \brief Sets the amoeba to a dying state.
     ///
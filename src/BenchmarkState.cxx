@@ -0,0 +1,320 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+#if !defined (IS_WIN32_HOST)
+#include <sys/resource.h>
+#endif // !IS_WIN32_HOST
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <SDL.h>
+#include "AIPlayerFactory.h"
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+#include "AllocationTracker.h"
+#endif // AMOEBAX_ALLOCATION_TRACKING
+#include "BenchmarkState.h"
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+#include "FlightRecorder.h"
+#endif // AMOEBAX_ALLOCATION_TRACKING
+#include "Options.h"
+#include "System.h"
+
+using namespace Amoebax;
+
+///
+/// \brief Gets the most memory the process has had resident.
+///
+/// \return The peak resident set size in kilobytes, or 0 if the system
+///         doesn't tell.
+///
+static long
+getPeakResidentSize (void)
+{
+#if defined (IS_WIN32_HOST)
+    return 0;
+#else // !IS_WIN32_HOST
+    struct rusage usage;
+    if ( 0 != getrusage (RUSAGE_SELF, &usage) )
+    {
+        return 0;
+    }
+#if defined (IS_OSX_HOST)
+    // Mac OS X tells the size in bytes.
+    return usage.ru_maxrss / 1024;
+#else // !IS_OSX_HOST
+    return usage.ru_maxrss;
+#endif // IS_OSX_HOST
+#endif // IS_WIN32_HOST
+}
+
+///
+/// \brief Constructor.
+///
+/// \param frames The number of frames to play before writing the results.
+/// \param seed The seed the random generators were initialized with.
+///             It is only written with the results.
+///
+BenchmarkState::BenchmarkState (uint32_t frames, uint32_t seed):
+    IState (),
+    IMatchObserver (),
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+    m_AllocatingFrames (0),
+    m_Allocations (0),
+#endif // AMOEBAX_ALLOCATION_TRACKING
+    m_Frames (frames),
+    m_FrameTimes (),
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+    m_LastAllocations (0),
+    m_LastDumps (0),
+#endif // AMOEBAX_ALLOCATION_TRACKING
+    m_LastCounter (0),
+    m_Match (nullptr),
+    m_MatchOver (false),
+    m_MatchStarted (false),
+    m_MatchResults (),
+    m_PhaseTimes (),
+    m_Seed (seed)
+{
+    m_FrameTimes.reserve (frames);
+    createMatch ();
+}
+
+void
+BenchmarkState::activate (void)
+{
+    // The phases' times are needed even without the graph.
+    Profiler::setAlwaysEnabled (true);
+    m_Match->activate ();
+}
+
+///
+/// \brief Creates a match between two different computer levels.
+///
+/// The levels and the background are chosen the same way the demo
+/// does.
+///
+void
+BenchmarkState::createMatch (void)
+{
+    uint8_t leftPlayerLevel = rand () % AIPlayerFactory::k_MaxPlayerLevel;
+    uint8_t rightPlayerLevel = rand () % AIPlayerFactory::k_MaxPlayerLevel;
+    while ( leftPlayerLevel == rightPlayerLevel )
+    {
+        rightPlayerLevel = rand () % AIPlayerFactory::k_MaxPlayerLevel;
+    }
+
+    m_Match.reset (
+            new TwoPlayersState (AIPlayerFactory::create (leftPlayerLevel,
+                                                          IPlayer::LeftSide),
+                                 AIPlayerFactory::create (rightPlayerLevel,
+                                                          IPlayer::RightSide),
+                                 AIPlayerFactory::getRandomBackgroundFileName (),
+                                 0, 0, this));
+    m_MatchOver = false;
+}
+
+void
+BenchmarkState::endOfMatch (IPlayer::PlayerSide winner,
+                            uint32_t leftPlayerScore,
+                            uint32_t rightPlayerScore)
+{
+    m_MatchResults.push_back (
+            std::string (IPlayer::LeftSide == winner ? "left" : "right") +
+            " wins " + std::to_string (leftPlayerScore) + " to " +
+            std::to_string (rightPlayerScore));
+    // The match is still being updated, so it is replaced later.
+    m_MatchOver = true;
+}
+
+void
+BenchmarkState::joyMotion (uint8_t joystick, uint8_t axis, int16_t value)
+{
+}
+
+void
+BenchmarkState::joyDown (uint8_t joystick, SDL_GameControllerButton button)
+{
+}
+
+void
+BenchmarkState::joyUp (uint8_t joystick, SDL_GameControllerButton button)
+{
+}
+
+void
+BenchmarkState::keyDown (uint32_t key)
+{
+}
+
+void
+BenchmarkState::keyUp (uint32_t key)
+{
+}
+
+///
+/// \brief Keeps how long the previous frame took.
+///
+/// The first update has no previous frame to keep.  When built with the
+/// ALLOCATION_TRACKING CMake option, it also counts the allocations of
+/// the previous frame if it was steady: not the first of its match,
+/// which loads and draws the match, nor a frame the flight recorder
+/// dumped, which writes the stall log.
+///
+void
+BenchmarkState::recordFrame (void)
+{
+    const uint64_t counter = SDL_GetPerformanceCounter ();
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+    const uint64_t allocations = AllocationTracker::getAllocations ();
+    const uint32_t dumps = FlightRecorder::getNumberOfDumps ();
+    if ( 0 != m_LastCounter && !m_MatchStarted && dumps == m_LastDumps &&
+         allocations > m_LastAllocations )
+    {
+        ++m_AllocatingFrames;
+        m_Allocations += allocations - m_LastAllocations;
+    }
+    m_LastAllocations = allocations;
+    m_LastDumps = dumps;
+#endif // AMOEBAX_ALLOCATION_TRACKING
+    if ( 0 != m_LastCounter )
+    {
+        m_FrameTimes.push_back (
+                static_cast<uint32_t>(1000000.0 * (counter - m_LastCounter) /
+                                      SDL_GetPerformanceFrequency ()));
+        for ( unsigned int phase = 0 ; phase < Profiler::k_NumPhases ; ++phase )
+        {
+            m_PhaseTimes[phase] +=
+                Profiler::getPhaseTime (static_cast<Profiler::Phase>(phase));
+        }
+    }
+    m_LastCounter = counter;
+}
+
+void
+BenchmarkState::redrawBackground (SDL_Rect *region, SDL_Surface *screen)
+{
+    m_Match->redrawBackground (region, screen);
+}
+
+void
+BenchmarkState::render (SDL_Surface *screen)
+{
+    m_Match->render (screen);
+}
+
+void
+BenchmarkState::update (uint32_t elapsedTime)
+{
+    if ( m_FrameTimes.size () >= m_Frames )
+    {
+        return;
+    }
+
+    const bool firstFrame = 0 == m_LastCounter;
+    recordFrame ();
+    if ( m_FrameTimes.size () >= m_Frames )
+    {
+        writeResults (std::cout);
+        System::getInstance ().removeActiveState (false);
+        return;
+    }
+
+    m_MatchStarted = firstFrame || m_MatchOver;
+    if ( m_MatchOver )
+    {
+        createMatch ();
+        m_Match->activate ();
+    }
+    m_Match->update (elapsedTime);
+}
+
+void
+BenchmarkState::videoModeChanged (void)
+{
+    m_Match->videoModeChanged ();
+}
+
+void
+BenchmarkState::writeBoards (std::ostream &stream)
+{
+    m_Match->writeBoards (stream);
+}
+
+///
+/// \brief Writes the frame time percentiles and the phases' averages.
+///
+/// \param stream The stream to write the results to.
+///
+void
+BenchmarkState::writeResults (std::ostream &stream) const
+{
+    using namespace std;
+    static const char *phaseNames[Profiler::k_NumPhases] =
+    {
+        "events", "update", "grid", "ai", "background", "render", "present"
+    };
+
+    vector<uint32_t> sorted (m_FrameTimes);
+    sort (sorted.begin (), sorted.end ());
+
+    stream << "frames:     " << sorted.size () << " at ";
+    stream << Options::getInstance ().getScreenWidth () << "x";
+    stream << Options::getInstance ().getScreenHeight () << ", seed ";
+    stream << m_Seed << endl;
+    for ( vector<string>::const_iterator result = m_MatchResults.begin () ;
+          result != m_MatchResults.end () ; ++result )
+    {
+        stream << "match:      " << *result << endl;
+    }
+
+    stream << fixed << setprecision (2);
+    stream << "p50:        " << sorted[sorted.size () / 2] / 1000.0f;
+    stream << " ms" << endl;
+    stream << "p90:        " << sorted[sorted.size () * 9 / 10] / 1000.0f;
+    stream << " ms" << endl;
+    stream << "p99:        " << sorted[sorted.size () * 99 / 100] / 1000.0f;
+    stream << " ms" << endl;
+    stream << "max:        " << sorted.back () / 1000.0f << " ms" << endl;
+    stream << "mean:       ";
+    stream << accumulate (sorted.begin (), sorted.end (), 0.0) /
+              sorted.size () / 1000.0 << " ms" << endl;
+
+    for ( unsigned int phase = 0 ; phase < Profiler::k_NumPhases ; ++phase )
+    {
+        stream << left << setw (12) << (string (phaseNames[phase]) + ":");
+        stream << right << m_PhaseTimes[phase] / 1000.0 / sorted.size ();
+        stream << " ms" << endl;
+    }
+
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+    stream << "allocations: " << m_Allocations << " in " <<
+        m_AllocatingFrames << " steady frames" << endl;
+#endif // AMOEBAX_ALLOCATION_TRACKING
+
+    const long peakResidentSize = getPeakResidentSize ();
+    stream << "peak rss:   ";
+    if ( 0 < peakResidentSize )
+    {
+        stream << peakResidentSize / 1024.0 << " MiB" << endl;
+    }
+    else
+    {
+        stream << "unknown" << endl;
+    }
+}
@@ -0,0 +1,105 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+#if !defined (AMOEBAX_BENCHMARK_STATE_H)
+#define AMOEBAX_BENCHMARK_STATE_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "IMatchObserver.h"
+#include "IState.h"
+#include "Profiler.h"
+#include "TwoPlayersState.h"
+
+namespace Amoebax
+{
+    ///
+    /// \class BenchmarkState
+    /// \brief Plays matches between two computer players for some frames.
+    ///
+    /// Like the demo, it shows matches between two computer players, but
+    /// starts a new match when one ends and ignores the players' inputs.
+    /// Once it has played the number of frames it was asked for, it
+    /// writes how long the frames took and removes itself.
+    ///
+    /// The frame time is the time between two updates, so it includes
+    /// everything the system does in a frame.  With the frame manager's
+    /// fixed step, the frames don't wait for each other, and a seeded
+    /// benchmark plays the same matches every time.
+    ///
+    class BenchmarkState: public IState, public IMatchObserver
+    {
+        public:
+            BenchmarkState (uint32_t frames, uint32_t seed);
+
+            virtual void activate (void);
+            virtual void endOfMatch (IPlayer::PlayerSide winner,
+                                     uint32_t leftPlayerScore,
+                                     uint32_t rightPlayerScore);
+            virtual void joyMotion (uint8_t joystick, uint8_t axis,
+                                    int16_t value);
+            virtual void joyDown (uint8_t joystick, SDL_GameControllerButton button);
+            virtual void joyUp (uint8_t joystick, SDL_GameControllerButton button);
+            virtual void keyDown (uint32_t key);
+            virtual void keyUp (uint32_t key);
+            virtual void redrawBackground (SDL_Rect *region, SDL_Surface *screen);
+            virtual void render (SDL_Surface *screen);
+            virtual void update (uint32_t elapsedTime);
+            virtual void videoModeChanged (void);
+            virtual void writeBoards (std::ostream &stream);
+
+        private:
+            void createMatch (void);
+            void recordFrame (void);
+            void writeResults (std::ostream &stream) const;
+
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+            /// The steady frames that allocated.
+            uint32_t m_AllocatingFrames;
+            /// The allocations of the steady frames.
+            uint64_t m_Allocations;
+#endif // AMOEBAX_ALLOCATION_TRACKING
+            /// The number of frames to play.
+            uint32_t m_Frames;
+            /// The time each played frame took, in microseconds.
+            std::vector<uint32_t> m_FrameTimes;
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+            /// The allocations made until the last update.
+            uint64_t m_LastAllocations;
+            /// The flight recorder's dumps until the last update.
+            uint32_t m_LastDumps;
+#endif // AMOEBAX_ALLOCATION_TRACKING
+            /// The performance counter at the last update, or 0.
+            uint64_t m_LastCounter;
+            /// The match being played.
+            std::unique_ptr<TwoPlayersState> m_Match;
+            /// Tells if the match being played is over.
+            bool m_MatchOver;
+            /// Tells if the frame being played is the first of its match.
+            bool m_MatchStarted;
+            /// The winner and the scores of each match played to the end.
+            std::vector<std::string> m_MatchResults;
+            /// The time each phase took in all the played frames, in microseconds.
+            uint64_t m_PhaseTimes[Profiler::k_NumPhases];
+            /// The seed the random generators were initialized with.
+            uint32_t m_Seed;
+    };
+}
+
+#endif // !AMOEBAX_BENCHMARK_STATE_H
@@ -0,0 +1,856 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <algorithm>
+#include <SDL.h>
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#if defined (__GNUC__)
+#include <immintrin.h>
+/// Tells that the AVX2 blitters are compiled in.
+#define AMOEBAX_BLITTER_AVX2
+#endif // __GNUC__
+#endif // __SSE2__
+#include "Blitter.h"
+
+using namespace Amoebax;
+
+/// The alpha value of opaque pixels and of the fully opaque blits.
+static const uint32_t k_Opaque = 255;
+/// The bits of the alpha channel in the premultiplied pixels.
+static const uint32_t k_PremultipliedAlphaMask = 0xff000000;
+
+/// A blitter that blends premultiplied pixels.
+typedef void (*BlendFunction) (const uint32_t *, int, uint32_t *, int,
+                               int, int, uint8_t);
+/// A blitter that copies the pixels that are not the color key.
+typedef void (*ColorKeyFunction) (const uint32_t *, int, uint32_t *, int,
+                                  int, int, uint32_t, uint32_t);
+/// A blitter that multiplies the pixels' channels by a constant alpha.
+typedef void (*FadeFunction) (const uint32_t *, int, uint32_t *, int,
+                              int, int, uint8_t, uint32_t);
+
+///
+/// \struct Blitters
+/// \brief The blitters selected for the current CPU.
+///
+struct Blitters
+{
+    /// The premultiplied alpha blender.
+    BlendFunction blend;
+    /// The color key copier.
+    ColorKeyFunction copyColorKey;
+    /// The fader.
+    FadeFunction fade;
+    /// The instruction set the blitters use.
+    Blitter::InstructionSet instructionSet;
+};
+
+///
+/// \brief Gets the row of a surface.
+///
+/// \param pixels The surface's pixels.
+/// \param pitch The length of a row in bytes.
+/// \param y The row to get.
+/// \return The first pixel of the row \p y.
+///
+static inline const uint32_t *
+getRow (const uint32_t *pixels, int pitch, int y)
+{
+    return reinterpret_cast<const uint32_t *>(
+            reinterpret_cast<const uint8_t *>(pixels) + y * pitch);
+}
+
+///
+/// \brief Gets the row of a surface.
+///
+/// \param pixels The surface's pixels.
+/// \param pitch The length of a row in bytes.
+/// \param y The row to get.
+/// \return The first pixel of the row \p y.
+///
+static inline uint32_t *
+getRow (uint32_t *pixels, int pitch, int y)
+{
+    return reinterpret_cast<uint32_t *>(
+            reinterpret_cast<uint8_t *>(pixels) + y * pitch);
+}
+
+///
+/// \brief Divides a product of two channels by 255, rounding.
+///
+/// \param value The value to divide, up to 255 * 255.
+/// \return \p value / 255, rounded to the nearest integer.
+///
+static inline uint32_t
+divideBy255 (uint32_t value)
+{
+    value += 128;
+    return (value + (value >> 8)) >> 8;
+}
+
+///
+/// \brief Blends a premultiplied pixel over another pixel.
+///
+/// \param source The premultiplied pixel, with alpha in its top byte.
+/// \param destination The pixel to blend \p source over.
+/// \param alpha The alpha to multiply \p source with.
+/// \return The blended pixel.
+///
+static inline uint32_t
+blendPixel (uint32_t source, uint32_t destination, uint32_t alpha)
+{
+    uint32_t sourceChannels[4];
+    for ( int channel = 0 ; channel < 4 ; ++channel )
+    {
+        sourceChannels[channel] = (source >> (channel * 8)) & 0xff;
+        if ( k_Opaque != alpha )
+        {
+            sourceChannels[channel] =
+                divideBy255 (sourceChannels[channel] * alpha);
+        }
+    }
+    const uint32_t inverseAlpha = k_Opaque - sourceChannels[3];
+
+    uint32_t blended = 0;
+    for ( int channel = 0 ; channel < 4 ; ++channel )
+    {
+        uint32_t destinationChannel = (destination >> (channel * 8)) & 0xff;
+        uint32_t color = sourceChannels[channel] +
+                         divideBy255 (destinationChannel * inverseAlpha);
+        blended |= std::min (color, k_Opaque) << (channel * 8);
+    }
+    return blended;
+}
+
+///
+/// \brief Blends premultiplied pixels one at a time.
+///
+static void
+blendScalar (const uint32_t *source, int sourcePitch,
+             uint32_t *destination, int destinationPitch,
+             int width, int height, uint8_t alpha)
+{
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        const uint32_t *sourceRow = getRow (source, sourcePitch, y);
+        uint32_t *destinationRow = getRow (destination, destinationPitch, y);
+        for ( int x = 0 ; x < width ; ++x )
+        {
+            destinationRow[x] =
+                blendPixel (sourceRow[x], destinationRow[x], alpha);
+        }
+    }
+}
+
+///
+/// \brief Copies the pixels that are not the color key one at a time.
+///
+static void
+copyColorKeyScalar (const uint32_t *source, int sourcePitch,
+                    uint32_t *destination, int destinationPitch,
+                    int width, int height, uint32_t colorKey,
+                    uint32_t keyMask)
+{
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        const uint32_t *sourceRow = getRow (source, sourcePitch, y);
+        uint32_t *destinationRow = getRow (destination, destinationPitch, y);
+        for ( int x = 0 ; x < width ; ++x )
+        {
+            if ( colorKey != (sourceRow[x] & keyMask) )
+            {
+                destinationRow[x] = sourceRow[x];
+            }
+        }
+    }
+}
+
+///
+/// \brief Multiplies a pixel's channels by an alpha.
+///
+/// \param source The pixel to multiply.
+/// \param alpha The alpha to multiply the channels with.
+/// \param colorMask The bits of the channels to multiply.  The other
+///                  bits are kept as is.
+/// \return The multiplied pixel.
+///
+static inline uint32_t
+fadePixel (uint32_t source, uint32_t alpha, uint32_t colorMask)
+{
+    uint32_t faded = 0;
+    for ( int shift = 0 ; shift < 32 ; shift += 8 )
+    {
+        faded |= divideBy255 (((source >> shift) & 0xff) * alpha) << shift;
+    }
+    return (faded & colorMask) | (source & ~colorMask);
+}
+
+///
+/// \brief Multiplies the pixels' channels by an alpha one at a time.
+///
+static void
+fadeScalar (const uint32_t *source, int sourcePitch,
+            uint32_t *destination, int destinationPitch,
+            int width, int height, uint8_t alpha, uint32_t colorMask)
+{
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        const uint32_t *sourceRow = getRow (source, sourcePitch, y);
+        uint32_t *destinationRow = getRow (destination, destinationPitch, y);
+        for ( int x = 0 ; x < width ; ++x )
+        {
+            destinationRow[x] = fadePixel (sourceRow[x], alpha, colorMask);
+        }
+    }
+}
+
+#if defined (__SSE2__)
+///
+/// \brief Divides each 16-bit lane of a product of channels by 255.
+///
+/// \param value The products to divide, up to 255 * 255.
+/// \return The rounded quotients.
+///
+static inline __m128i
+divideBy255SSE2 (__m128i value)
+{
+    value = _mm_add_epi16 (value, _mm_set1_epi16 (128));
+    return _mm_srli_epi16 (_mm_add_epi16 (value, _mm_srli_epi16 (value, 8)),
+                           8);
+}
+
+///
+/// \brief Blends two premultiplied pixels expanded to 16-bit lanes.
+///
+/// \param source The two premultiplied pixels.
+/// \param destination The two pixels to blend \p source over.
+/// \param alpha The alpha to multiply \p source with, in every lane.
+/// \param scale Tells whether \p source must be multiplied by \p alpha.
+/// \return The two blended pixels, in 16-bit lanes.
+///
+static inline __m128i
+blendPixelsSSE2 (__m128i source, __m128i destination, __m128i alpha,
+                 bool scale)
+{
+    if ( scale )
+    {
+        source = divideBy255SSE2 (_mm_mullo_epi16 (source, alpha));
+    }
+    __m128i inverseAlpha =
+        _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (source,
+                                                  _MM_SHUFFLE (3, 3, 3, 3)),
+                             _MM_SHUFFLE (3, 3, 3, 3));
+    inverseAlpha = _mm_sub_epi16 (_mm_set1_epi16 (k_Opaque), inverseAlpha);
+    return _mm_add_epi16 (source,
+                          divideBy255SSE2 (_mm_mullo_epi16 (destination,
+                                                            inverseAlpha)));
+}
+
+///
+/// \brief Blends premultiplied pixels four at a time.
+///
+static void
+blendSSE2 (const uint32_t *source, int sourcePitch,
+           uint32_t *destination, int destinationPitch,
+           int width, int height, uint8_t alpha)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i alphaMask =
+        _mm_set1_epi32 (static_cast<int>(k_PremultipliedAlphaMask));
+    const __m128i alphaFactor = _mm_set1_epi16 (alpha);
+    const bool scale = k_Opaque != alpha;
+
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        const uint32_t *sourceRow = getRow (source, sourcePitch, y);
+        uint32_t *destinationRow = getRow (destination, destinationPitch, y);
+        int x = 0;
+        for ( ; x + 4 <= width ; x += 4 )
+        {
+            __m128i sourcePixels =
+                _mm_loadu_si128 (reinterpret_cast<const __m128i *>(sourceRow + x));
+            // Skip the fully transparent pixels and just copy the opaque.
+            if ( 0xffff == _mm_movemask_epi8 (_mm_cmpeq_epi32 (sourcePixels,
+                                                               zero)) )
+            {
+                continue;
+            }
+            __m128i *destinationPixels =
+                reinterpret_cast<__m128i *>(destinationRow + x);
+            if ( !scale &&
+                 0xffff == _mm_movemask_epi8 (
+                    _mm_cmpeq_epi32 (_mm_and_si128 (sourcePixels, alphaMask),
+                                     alphaMask)) )
+            {
+                _mm_storeu_si128 (destinationPixels, sourcePixels);
+                continue;
+            }
+
+            __m128i destinationPacked = _mm_loadu_si128 (destinationPixels);
+            __m128i low =
+                blendPixelsSSE2 (_mm_unpacklo_epi8 (sourcePixels, zero),
+                                 _mm_unpacklo_epi8 (destinationPacked, zero),
+                                 alphaFactor, scale);
+            __m128i high =
+                blendPixelsSSE2 (_mm_unpackhi_epi8 (sourcePixels, zero),
+                                 _mm_unpackhi_epi8 (destinationPacked, zero),
+                                 alphaFactor, scale);
+            _mm_storeu_si128 (destinationPixels, _mm_packus_epi16 (low, high));
+        }
+        for ( ; x < width ; ++x )
+        {
+            destinationRow[x] =
+                blendPixel (sourceRow[x], destinationRow[x], alpha);
+        }
+    }
+}
+
+///
+/// \brief Copies the pixels that are not the color key four at a time.
+///
+static void
+copyColorKeySSE2 (const uint32_t *source, int sourcePitch,
+                  uint32_t *destination, int destinationPitch,
+                  int width, int height, uint32_t colorKey,
+                  uint32_t keyMask)
+{
+    const __m128i key = _mm_set1_epi32 (static_cast<int>(colorKey));
+    const __m128i mask = _mm_set1_epi32 (static_cast<int>(keyMask));
+
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        const uint32_t *sourceRow = getRow (source, sourcePitch, y);
+        uint32_t *destinationRow = getRow (destination, destinationPitch, y);
+        int x = 0;
+        for ( ; x + 4 <= width ; x += 4 )
+        {
+            __m128i sourcePixels =
+                _mm_loadu_si128 (reinterpret_cast<const __m128i *>(sourceRow + x));
+            __m128i transparent =
+                _mm_cmpeq_epi32 (_mm_and_si128 (sourcePixels, mask), key);
+            int transparentMask = _mm_movemask_epi8 (transparent);
+            if ( 0xffff == transparentMask )
+            {
+                continue;
+            }
+            __m128i *destinationPixels =
+                reinterpret_cast<__m128i *>(destinationRow + x);
+            if ( 0 != transparentMask )
+            {
+                sourcePixels =
+                    _mm_or_si128 (_mm_and_si128 (transparent,
+                                                 _mm_loadu_si128 (destinationPixels)),
+                                  _mm_andnot_si128 (transparent, sourcePixels));
+            }
+            _mm_storeu_si128 (destinationPixels, sourcePixels);
+        }
+        for ( ; x < width ; ++x )
+        {
+            if ( colorKey != (sourceRow[x] & keyMask) )
+            {
+                destinationRow[x] = sourceRow[x];
+            }
+        }
+    }
+}
+
+///
+/// \brief Multiplies the pixels' channels by an alpha four at a time.
+///
+static void
+fadeSSE2 (const uint32_t *source, int sourcePitch,
+          uint32_t *destination, int destinationPitch,
+          int width, int height, uint8_t alpha, uint32_t colorMask)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i alphaFactor = _mm_set1_epi16 (alpha);
+    const __m128i mask = _mm_set1_epi32 (static_cast<int>(colorMask));
+
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        const uint32_t *sourceRow = getRow (source, sourcePitch, y);
+        uint32_t *destinationRow = getRow (destination, destinationPitch, y);
+        int x = 0;
+        for ( ; x + 4 <= width ; x += 4 )
+        {
+            __m128i sourcePixels =
+                _mm_loadu_si128 (reinterpret_cast<const __m128i *>(sourceRow + x));
+            __m128i low =
+                divideBy255SSE2 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (sourcePixels,
+                                                                     zero),
+                                                  alphaFactor));
+            __m128i high =
+                divideBy255SSE2 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (sourcePixels,
+                                                                     zero),
+                                                  alphaFactor));
+            __m128i faded =
+                _mm_or_si128 (_mm_and_si128 (mask, _mm_packus_epi16 (low, high)),
+                              _mm_andnot_si128 (mask, sourcePixels));
+            _mm_storeu_si128 (reinterpret_cast<__m128i *>(destinationRow + x),
+                              faded);
+        }
+        for ( ; x < width ; ++x )
+        {
+            destinationRow[x] = fadePixel (sourceRow[x], alpha, colorMask);
+        }
+    }
+}
+#endif // __SSE2__
+
+#if defined (AMOEBAX_BLITTER_AVX2)
+///
+/// \brief Divides each 16-bit lane of a product of channels by 255.
+///
+/// \param value The products to divide, up to 255 * 255.
+/// \return The rounded quotients.
+///
+__attribute__ ((target ("avx2"))) static inline __m256i
+divideBy255AVX2 (__m256i value)
+{
+    value = _mm256_add_epi16 (value, _mm256_set1_epi16 (128));
+    return _mm256_srli_epi16 (_mm256_add_epi16 (value,
+                                                 _mm256_srli_epi16 (value, 8)),
+                              8);
+}
+
+///
+/// \brief Blends four premultiplied pixels expanded to 16-bit lanes.
+///
+/// \param source The four premultiplied pixels.
+/// \param destination The four pixels to blend \p source over.
+/// \param alpha The alpha to multiply \p source with, in every lane.
+/// \param scale Tells whether \p source must be multiplied by \p alpha.
+/// \return The four blended pixels, in 16-bit lanes.
+///
+__attribute__ ((target ("avx2"))) static inline __m256i
+blendPixelsAVX2 (__m256i source, __m256i destination, __m256i alpha,
+                 bool scale)
+{
+    if ( scale )
+    {
+        source = divideBy255AVX2 (_mm256_mullo_epi16 (source, alpha));
+    }
+    __m256i inverseAlpha =
+        _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (source,
+                                                        _MM_SHUFFLE (3, 3, 3, 3)),
+                                _MM_SHUFFLE (3, 3, 3, 3));
+    inverseAlpha = _mm256_sub_epi16 (_mm256_set1_epi16 (k_Opaque),
+                                     inverseAlpha);
+    return _mm256_add_epi16 (source,
+                             divideBy255AVX2 (_mm256_mullo_epi16 (destination,
+                                                                  inverseAlpha)));
+}
+
+///
+/// \brief Blends premultiplied pixels eight at a time.
+///
+__attribute__ ((target ("avx2"))) static void
+blendAVX2 (const uint32_t *source, int sourcePitch,
+           uint32_t *destination, int destinationPitch,
+           int width, int height, uint8_t alpha)
+{
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256i alphaMask =
+        _mm256_set1_epi32 (static_cast<int>(k_PremultipliedAlphaMask));
+    const __m256i alphaFactor = _mm256_set1_epi16 (alpha);
+    const bool scale = k_Opaque != alpha;
+
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        const uint32_t *sourceRow = getRow (source, sourcePitch, y);
+        uint32_t *destinationRow = getRow (destination, destinationPitch, y);
+        int x = 0;
+        for ( ; x + 8 <= width ; x += 8 )
+        {
+            __m256i sourcePixels =
+                _mm256_loadu_si256 (reinterpret_cast<const __m256i *>(sourceRow + x));
+            // Skip the fully transparent pixels and just copy the opaque.
+            if ( -1 == _mm256_movemask_epi8 (_mm256_cmpeq_epi32 (sourcePixels,
+                                                                 zero)) )
+            {
+                continue;
+            }
+            __m256i *destinationPixels =
+                reinterpret_cast<__m256i *>(destinationRow + x);
+            if ( !scale &&
+                 -1 == _mm256_movemask_epi8 (
+                    _mm256_cmpeq_epi32 (_mm256_and_si256 (sourcePixels,
+                                                          alphaMask),
+                                        alphaMask)) )
+            {
+                _mm256_storeu_si256 (destinationPixels, sourcePixels);
+                continue;
+            }
+
+            __m256i destinationPacked = _mm256_loadu_si256 (destinationPixels);
+            __m256i low =
+                blendPixelsAVX2 (_mm256_unpacklo_epi8 (sourcePixels, zero),
+                                 _mm256_unpacklo_epi8 (destinationPacked, zero),
+                                 alphaFactor, scale);
+            __m256i high =
+                blendPixelsAVX2 (_mm256_unpackhi_epi8 (sourcePixels, zero),
+                                 _mm256_unpackhi_epi8 (destinationPacked, zero),
+                                 alphaFactor, scale);
+            _mm256_storeu_si256 (destinationPixels,
+                                 _mm256_packus_epi16 (low, high));
+        }
+        for ( ; x < width ; ++x )
+        {
+            destinationRow[x] =
+                blendPixel (sourceRow[x], destinationRow[x], alpha);
+        }
+    }
+}
+
+///
+/// \brief Copies the pixels that are not the color key eight at a time.
+///
+__attribute__ ((target ("avx2"))) static void
+copyColorKeyAVX2 (const uint32_t *source, int sourcePitch,
+                  uint32_t *destination, int destinationPitch,
+                  int width, int height, uint32_t colorKey,
+                  uint32_t keyMask)
+{
+    const __m256i key = _mm256_set1_epi32 (static_cast<int>(colorKey));
+    const __m256i mask = _mm256_set1_epi32 (static_cast<int>(keyMask));
+
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        const uint32_t *sourceRow = getRow (source, sourcePitch, y);
+        uint32_t *destinationRow = getRow (destination, destinationPitch, y);
+        int x = 0;
+        for ( ; x + 8 <= width ; x += 8 )
+        {
+            __m256i sourcePixels =
+                _mm256_loadu_si256 (reinterpret_cast<const __m256i *>(sourceRow + x));
+            __m256i transparent =
+                _mm256_cmpeq_epi32 (_mm256_and_si256 (sourcePixels, mask), key);
+            int transparentMask = _mm256_movemask_epi8 (transparent);
+            if ( -1 == transparentMask )
+            {
+                continue;
+            }
+            __m256i *destinationPixels =
+                reinterpret_cast<__m256i *>(destinationRow + x);
+            if ( 0 != transparentMask )
+            {
+                sourcePixels =
+                    _mm256_blendv_epi8 (sourcePixels,
+                                        _mm256_loadu_si256 (destinationPixels),
+                                        transparent);
+            }
+            _mm256_storeu_si256 (destinationPixels, sourcePixels);
+        }
+        for ( ; x < width ; ++x )
+        {
+            if ( colorKey != (sourceRow[x] & keyMask) )
+            {
+                destinationRow[x] = sourceRow[x];
+            }
+        }
+    }
+}
+
+///
+/// \brief Multiplies the pixels' channels by an alpha eight at a time.
+///
+__attribute__ ((target ("avx2"))) static void
+fadeAVX2 (const uint32_t *source, int sourcePitch,
+          uint32_t *destination, int destinationPitch,
+          int width, int height, uint8_t alpha, uint32_t colorMask)
+{
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256i alphaFactor = _mm256_set1_epi16 (alpha);
+    const __m256i mask = _mm256_set1_epi32 (static_cast<int>(colorMask));
+
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        const uint32_t *sourceRow = getRow (source, sourcePitch, y);
+        uint32_t *destinationRow = getRow (destination, destinationPitch, y);
+        int x = 0;
+        for ( ; x + 8 <= width ; x += 8 )
+        {
+            __m256i sourcePixels =
+                _mm256_loadu_si256 (reinterpret_cast<const __m256i *>(sourceRow + x));
+            __m256i low =
+                divideBy255AVX2 (_mm256_mullo_epi16 (
+                            _mm256_unpacklo_epi8 (sourcePixels, zero),
+                            alphaFactor));
+            __m256i high =
+                divideBy255AVX2 (_mm256_mullo_epi16 (
+                            _mm256_unpackhi_epi8 (sourcePixels, zero),
+                            alphaFactor));
+            __m256i faded =
+                _mm256_blendv_epi8 (sourcePixels,
+                                    _mm256_packus_epi16 (low, high), mask);
+            _mm256_storeu_si256 (reinterpret_cast<__m256i *>(destinationRow + x),
+                                 faded);
+        }
+        for ( ; x < width ; ++x )
+        {
+            destinationRow[x] = fadePixel (sourceRow[x], alpha, colorMask);
+        }
+    }
+}
+#endif // AMOEBAX_BLITTER_AVX2
+
+///
+/// \brief Selects the fastest blitters the CPU can run.
+///
+/// \return The blitters to use.
+///
+static Blitters
+selectBlitters (void)
+{
+    Blitters blitters;
+    blitters.blend = blendScalar;
+    blitters.copyColorKey = copyColorKeyScalar;
+    blitters.fade = fadeScalar;
+    blitters.instructionSet = Blitter::Scalar;
+#if defined (__SSE2__)
+    if ( SDL_HasSSE2 () )
+    {
+        blitters.blend = blendSSE2;
+        blitters.copyColorKey = copyColorKeySSE2;
+        blitters.fade = fadeSSE2;
+        blitters.instructionSet = Blitter::SSE2;
+    }
+#endif // __SSE2__
+#if defined (AMOEBAX_BLITTER_AVX2)
+    if ( SDL_HasAVX2 () )
+    {
+        blitters.blend = blendAVX2;
+        blitters.copyColorKey = copyColorKeyAVX2;
+        blitters.fade = fadeAVX2;
+        blitters.instructionSet = Blitter::AVX2;
+    }
+#endif // AMOEBAX_BLITTER_AVX2
+    return blitters;
+}
+
+///
+/// \brief Gets the blitters for the current CPU.
+///
+/// \return The blitters selected the first time this function is called.
+///
+static const Blitters &
+getBlitters (void)
+{
+    static const Blitters blitters (selectBlitters ());
+    return blitters;
+}
+
+///
+/// \brief Blends premultiplied pixels over pixels of any 32-bit format.
+///
+/// This is the slow path for the destinations whose channels are not in
+/// the same order as the source's.
+///
+static void
+blendConvertScalar (const uint32_t *source, int sourcePitch,
+                    const SDL_PixelFormat *sourceFormat,
+                    uint32_t *destination, int destinationPitch,
+                    const SDL_PixelFormat *destinationFormat,
+                    int width, int height, uint8_t alpha)
+{
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        const uint32_t *sourceRow = getRow (source, sourcePitch, y);
+        uint32_t *destinationRow = getRow (destination, destinationPitch, y);
+        for ( int x = 0 ; x < width ; ++x )
+        {
+            uint8_t sourceChannels[4];
+            SDL_GetRGBA (sourceRow[x], sourceFormat,
+                         &sourceChannels[0], &sourceChannels[1],
+                         &sourceChannels[2], &sourceChannels[3]);
+            uint8_t destinationChannels[4];
+            SDL_GetRGBA (destinationRow[x], destinationFormat,
+                         &destinationChannels[0], &destinationChannels[1],
+                         &destinationChannels[2], &destinationChannels[3]);
+            if ( k_Opaque != alpha )
+            {
+                for ( int channel = 0 ; channel < 4 ; ++channel )
+                {
+                    sourceChannels[channel] = static_cast<uint8_t>(
+                            divideBy255 (sourceChannels[channel] * alpha));
+                }
+            }
+            const uint32_t inverseAlpha = k_Opaque - sourceChannels[3];
+            for ( int channel = 0 ; channel < 4 ; ++channel )
+            {
+                destinationChannels[channel] = static_cast<uint8_t>(
+                        std::min (sourceChannels[channel] +
+                                  divideBy255 (destinationChannels[channel] *
+                                               inverseAlpha), k_Opaque));
+            }
+            destinationRow[x] =
+                SDL_MapRGBA (destinationFormat,
+                             destinationChannels[0], destinationChannels[1],
+                             destinationChannels[2], destinationChannels[3]);
+        }
+    }
+}
+
+///
+/// \brief Blends premultiplied pixels over other pixels.
+///
+/// When both formats have their color channels in the same place, the
+/// source has its alpha in the top byte and the destination has either
+/// alpha or nothing there, the pixels are blended channel by channel
+/// with the fastest blitter.  Otherwise, the pixels are converted one
+/// by one.
+///
+/// \param source The first premultiplied pixel to blend.
+/// \param sourcePitch The length of a source row in bytes.
+/// \param sourceFormat The 32-bit format of the source pixels.
+/// \param destination The first pixel to blend the source over.
+/// \param destinationPitch The length of a destination row in bytes.
+/// \param destinationFormat The 32-bit format of the destination pixels.
+/// \param width The number of pixels to blend in each row.
+/// \param height The number of rows to blend.
+/// \param alpha The alpha to multiply every source pixel with.
+///
+void
+Blitter::blendPremultiplied (const uint32_t *source, int sourcePitch,
+                             const SDL_PixelFormat *sourceFormat,
+                             uint32_t *destination, int destinationPitch,
+                             const SDL_PixelFormat *destinationFormat,
+                             int width, int height, uint8_t alpha)
+{
+    if ( 0 == alpha )
+    {
+        return;
+    }
+
+    if ( k_PremultipliedAlphaMask == sourceFormat->Amask &&
+         sourceFormat->Rmask == destinationFormat->Rmask &&
+         sourceFormat->Gmask == destinationFormat->Gmask &&
+         sourceFormat->Bmask == destinationFormat->Bmask &&
+         (0 == destinationFormat->Amask ||
+          k_PremultipliedAlphaMask == destinationFormat->Amask) )
+    {
+        getBlitters ().blend (source, sourcePitch, destination,
+                              destinationPitch, width, height, alpha);
+    }
+    else
+    {
+        blendConvertScalar (source, sourcePitch, sourceFormat,
+                            destination, destinationPitch, destinationFormat,
+                            width, height, alpha);
+    }
+}
+
+///
+/// \brief Copies the pixels that are not the color key.
+///
+/// \param source The first pixel to copy.
+/// \param sourcePitch The length of a source row in bytes.
+/// \param destination Where to copy the first pixel.
+/// \param destinationPitch The length of a destination row in bytes.
+/// \param width The number of pixels to copy in each row.
+/// \param height The number of rows to copy.
+/// \param colorKey The transparent color.  Only the bits in \p keyMask
+///                 must be set.
+/// \param keyMask The bits of the pixels to compare with \p colorKey.
+///
+void
+Blitter::copyColorKey (const uint32_t *source, int sourcePitch,
+                       uint32_t *destination, int destinationPitch,
+                       int width, int height, uint32_t colorKey,
+                       uint32_t keyMask)
+{
+    getBlitters ().copyColorKey (source, sourcePitch, destination,
+                                 destinationPitch, width, height,
+                                 colorKey, keyMask);
+}
+
+///
+/// \brief Multiplies the pixels' channels by a constant alpha.
+///
+/// This is the same as blending black with 255 - \p alpha over the
+/// pixels, but with a single multiplication per channel.  Unlike the
+/// other blitters, \p source and \p destination can be the same pixels.
+///
+/// \param source The first pixel to multiply.
+/// \param sourcePitch The length of a source row in bytes.
+/// \param destination Where to write the first multiplied pixel.
+/// \param destinationPitch The length of a destination row in bytes.
+/// \param width The number of pixels to multiply in each row.
+/// \param height The number of rows to multiply.
+/// \param alpha The alpha to multiply the channels with.
+/// \param colorMask The bits of the pixels to multiply.  The other bits,
+///                  such as the alpha channel, are copied as is.
+///
+void
+Blitter::fade (const uint32_t *source, int sourcePitch,
+               uint32_t *destination, int destinationPitch,
+               int width, int height, uint8_t alpha, uint32_t colorMask)
+{
+    getBlitters ().fade (source, sourcePitch, destination, destinationPitch,
+                         width, height, alpha, colorMask);
+}
+
+///
+/// \brief Gets the instruction set of the blitters in use.
+///
+/// \return The instruction set selected for the current CPU.
+///
+Blitter::InstructionSet
+Blitter::getInstructionSet (void)
+{
+    return getBlitters ().instructionSet;
+}
+
+///
+/// \brief Multiplies the color channels of some pixels by their alpha.
+///
+/// \param pixels The first pixel to multiply.
+/// \param pitch The length of a row in bytes.
+/// \param width The number of pixels to multiply in each row.
+/// \param height The number of rows to multiply.
+/// \param alphaShift The position of the alpha channel in the pixels.
+///
+void
+Blitter::premultiply (uint32_t *pixels, int pitch, int width, int height,
+                      uint8_t alphaShift)
+{
+    for ( int y = 0 ; y < height ; ++y )
+    {
+        uint32_t *row = getRow (pixels, pitch, y);
+        for ( int x = 0 ; x < width ; ++x )
+        {
+            const uint32_t alpha = (row[x] >> alphaShift) & 0xff;
+            if ( k_Opaque == alpha )
+            {
+                continue;
+            }
+            uint32_t premultiplied = alpha << alphaShift;
+            for ( int shift = 0 ; shift < 32 ; shift += 8 )
+            {
+                if ( shift != alphaShift )
+                {
+                    premultiplied |=
+                        divideBy255 (((row[x] >> shift) & 0xff) * alpha) <<
+                        shift;
+                }
+            }
+            row[x] = premultiplied;
+        }
+    }
+}
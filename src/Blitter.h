@@ -0,0 +1,92 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_BLITTER_H)
+#define AMOEBAX_BLITTER_H
+
+#include <stdint.h>
+
+// Forward declarations.
+struct SDL_PixelFormat;
+
+namespace Amoebax
+{
+    ///
+    /// \class Blitter.
+    /// \brief Copies sprites between 32-bit surfaces with the same layout.
+    ///
+    /// These blitters replace SDL's generic per-pixel paths for the
+    /// formats the sprites are converted to: translucent sprites with
+    /// premultiplied alpha in the top byte and color keyed sprites in
+    /// the screen's format.  They also fade whole screens to black.
+    /// Each blitter has a scalar, an SSE2 and an AVX2 version, and the
+    /// fastest one that the CPU supports is selected the first time a
+    /// blitter is used.
+    ///
+    /// All pitches are in bytes and the source and destination rectangles
+    /// must not overlap.
+    ///
+    class Blitter
+    {
+        public:
+            /// The blitters' instruction sets.
+            enum InstructionSet
+            {
+                /// Plain C++.
+                Scalar,
+                /// SSE2 instructions, four pixels at a time.
+                SSE2,
+                /// AVX2 instructions, eight pixels at a time.
+                AVX2
+            };
+
+            static void blendPremultiplied (const uint32_t *source,
+                                            int sourcePitch,
+                                            const SDL_PixelFormat *sourceFormat,
+                                            uint32_t *destination,
+                                            int destinationPitch,
+                                            const SDL_PixelFormat *destinationFormat,
+                                            int width, int height,
+                                            uint8_t alpha);
+            static void copyColorKey (const uint32_t *source,
+                                      int sourcePitch,
+                                      uint32_t *destination,
+                                      int destinationPitch,
+                                      int width, int height,
+                                      uint32_t colorKey, uint32_t keyMask);
+            static void fade (const uint32_t *source, int sourcePitch,
+                              uint32_t *destination, int destinationPitch,
+                              int width, int height, uint8_t alpha,
+                              uint32_t colorMask);
+            static InstructionSet getInstructionSet (void);
+            static void premultiply (uint32_t *pixels, int pitch,
+                                     int width, int height,
+                                     uint8_t alphaShift);
+
+        private:
+            ///
+            /// \brief Constructor.
+            ///
+            /// \note Declared private because we don't want objects
+            ///       of this class.
+            ///
+            Blitter (void);
+    };
+}
+
+#endif // !AMOEBAX_BLITTER_H
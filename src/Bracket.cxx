@@ -0,0 +1,604 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include "Bracket.h"
+#include "MatchSimulator.h"
+#include "ThreadPool.h"
+
+using namespace Amoebax;
+
+namespace
+{
+    ///
+    /// \class StandingsOrder
+    /// \brief Sorts the entrants' indices from the best to the worst.
+    ///
+    class StandingsOrder
+    {
+        public:
+            ///
+            /// \brief Constructor.
+            ///
+            /// \param entrants The tournament's entrants.
+            /// \param eliminatedRound The round each entrant was
+            ///                        eliminated, or 0 if still alive.
+            ///
+            StandingsOrder (const std::vector<Bracket::Entrant> &entrants,
+                            const std::vector<uint16_t> &eliminatedRound):
+                m_EliminatedRound (eliminatedRound),
+                m_Entrants (entrants)
+            {
+            }
+
+            ///
+            /// \brief Tells if an entrant goes before another.
+            ///
+            /// The entrant that was eliminated later goes first, then
+            /// the one with more wins, the one with more points and,
+            /// finally, the highest seed.
+            ///
+            /// \param first The index of the first entrant to compare.
+            /// \param second The index of the second entrant to compare.
+            /// \return \a true if \p first goes before \p second.
+            ///
+            bool
+            operator() (uint16_t first, uint16_t second) const
+            {
+                uint16_t firstOut = getEliminatedRound (first);
+                uint16_t secondOut = getEliminatedRound (second);
+                if ( firstOut != secondOut )
+                {
+                    return firstOut > secondOut;
+                }
+                if ( m_Entrants[first].wins != m_Entrants[second].wins )
+                {
+                    return m_Entrants[first].wins > m_Entrants[second].wins;
+                }
+                if ( m_Entrants[first].score != m_Entrants[second].score )
+                {
+                    return m_Entrants[first].score > m_Entrants[second].score;
+                }
+                return first < second;
+            }
+
+        private:
+            ///
+            /// \brief Gets the round an entrant was eliminated.
+            ///
+            /// \param entrant The index of the entrant.
+            /// \return The round \p entrant was eliminated or the max.
+            ///         round if \p entrant is still alive.
+            ///
+            uint16_t
+            getEliminatedRound (uint16_t entrant) const
+            {
+                return 0 == m_EliminatedRound[entrant] ?
+                    std::numeric_limits<uint16_t>::max () :
+                    m_EliminatedRound[entrant];
+            }
+
+            /// The round each entrant was eliminated.
+            const std::vector<uint16_t> &m_EliminatedRound;
+            /// The tournament's entrants.
+            const std::vector<Bracket::Entrant> &m_Entrants;
+    };
+
+    ///
+    /// \brief Makes a match that has not been played yet.
+    ///
+    /// \param left The index of the left entrant.
+    /// \param right The index of the right entrant.
+    /// \return The match between \p left and \p right.
+    ///
+    Bracket::Match
+    makeMatch (uint16_t left, uint16_t right)
+    {
+        Bracket::Match match;
+        match.left = left;
+        match.right = right;
+        match.played = false;
+        match.winner = IPlayer::LeftSide;
+        match.leftScore = 0;
+        match.rightScore = 0;
+
+        return match;
+    }
+}
+
+///
+/// \brief Constructor.
+///
+/// Makes the first round.  The entrants' scores and records are reset.
+///
+/// \param format The tournament's format.
+/// \param entrants The tournament's players, from the highest seed to
+///                 the lowest.
+///
+Bracket::Bracket (Format format, const std::vector<Entrant> &entrants):
+    m_EliminatedRound (entrants.size (), 0),
+    m_Entrants (entrants),
+    m_Format (format),
+    m_Opponents (entrants.size ()),
+    m_Over (false),
+    m_Round (),
+    m_RoundNumber (1),
+    m_SwissRounds (0)
+{
+    if ( entrants.size () < k_MinEntrants ||
+         entrants.size () > k_MaxEntrants )
+    {
+        std::ostringstream error;
+        error << "A tournament must have between " << k_MinEntrants
+              << " and " << k_MaxEntrants << " entrants";
+        throw std::runtime_error (error.str ());
+    }
+
+    for ( std::vector<Entrant>::iterator entrant = m_Entrants.begin () ;
+          entrant != m_Entrants.end () ; ++entrant )
+    {
+        entrant->score = 0;
+        entrant->wins = 0;
+        entrant->losses = 0;
+        entrant->byes = 0;
+    }
+    while ( (1U << m_SwissRounds) < m_Entrants.size () )
+    {
+        ++m_SwissRounds;
+    }
+
+    makeRound ();
+}
+
+///
+/// \brief Gets the tournament's entrants.
+///
+/// \return The entrants with their current scores and records.
+///
+const std::vector<Bracket::Entrant> &
+Bracket::getEntrants (void) const
+{
+    return m_Entrants;
+}
+
+///
+/// \brief Gets the tournament's format.
+///
+/// \return The format the tournament is played with.
+///
+Bracket::Format
+Bracket::getFormat (void) const
+{
+    return m_Format;
+}
+
+///
+/// \brief Gets the number of losses that eliminate a player.
+///
+/// \return The number of losses after which the player is out.
+///
+uint16_t
+Bracket::getMaxLosses (void) const
+{
+    switch ( getFormat () )
+    {
+        case SingleElimination:
+            return 1;
+
+        case DoubleElimination:
+            return 2;
+
+        case Swiss:
+        default:
+            return std::numeric_limits<uint16_t>::max ();
+    }
+}
+
+///
+/// \brief Gets the next match of the current round with a human player.
+///
+/// \param match Set to the index of the match in getRound().
+/// \return \a true if there is a match with a human player left to
+///         play in the current round, \a false otherwise.
+///
+bool
+Bracket::getNextHumanMatch (uint16_t &match) const
+{
+    for ( uint16_t current = 0 ; current < m_Round.size () ; ++current )
+    {
+        if ( !m_Round[current].played && !isComputerMatch (m_Round[current]) )
+        {
+            match = current;
+            return true;
+        }
+    }
+    return false;
+}
+
+///
+/// \brief Gets the matches of the current round.
+///
+/// \return The matches of the current round, played or not.
+///
+const std::vector<Bracket::Match> &
+Bracket::getRound (void) const
+{
+    return m_Round;
+}
+
+///
+/// \brief Gets the current round's number.
+///
+/// \return The number of the round being played, starting at 1.
+///
+uint16_t
+Bracket::getRoundNumber (void) const
+{
+    return m_RoundNumber;
+}
+
+///
+/// \brief Gets the current standings.
+///
+/// \return The entrants' indices from the best to the worst.  Once
+///         the tournament is over, the first is the winner.
+///
+std::vector<uint16_t>
+Bracket::getStandings (void) const
+{
+    std::vector<uint16_t> standings (m_Entrants.size ());
+    for ( uint16_t entrant = 0 ; entrant < standings.size () ; ++entrant )
+    {
+        standings[entrant] = entrant;
+    }
+    std::sort (standings.begin (), standings.end (),
+               StandingsOrder (m_Entrants, m_EliminatedRound));
+
+    return standings;
+}
+
+///
+/// \brief Makes an entrant wait for the next round.
+///
+/// \param entrant The index of the entrant without opponent.
+///
+void
+Bracket::giveBye (uint16_t entrant)
+{
+    ++m_Entrants[entrant].byes;
+    if ( Swiss == getFormat () )
+    {
+        ++m_Entrants[entrant].wins;
+    }
+}
+
+///
+/// \brief Tells if an entrant is still in the tournament.
+///
+/// \param entrant The index of the entrant.
+/// \return \a true if \p entrant has not been eliminated.
+///
+bool
+Bracket::isAlive (uint16_t entrant) const
+{
+    return m_Entrants[entrant].losses < getMaxLosses ();
+}
+
+///
+/// \brief Tells if both players of a match are computer players.
+///
+/// \param match The match to check.
+/// \return \a true if \p match is between two computer players.
+///
+bool
+Bracket::isComputerMatch (const Match &match) const
+{
+    return m_Entrants[match.left].isComputerPlayer &&
+           m_Entrants[match.right].isComputerPlayer;
+}
+
+///
+/// \brief Tells if the tournament is over.
+///
+/// \return \a true if there are no more matches to play.
+///
+bool
+Bracket::isOver (void) const
+{
+    return m_Over;
+}
+
+///
+/// \brief Makes a new round of one of the elimination formats.
+///
+void
+Bracket::makeEliminationRound (void)
+{
+    std::vector<uint16_t> undefeated;
+    std::vector<uint16_t> defeated;
+    for ( uint16_t entrant = 0 ; entrant < m_Entrants.size () ; ++entrant )
+    {
+        if ( isAlive (entrant) )
+        {
+            if ( 0 == m_Entrants[entrant].losses )
+            {
+                undefeated.push_back (entrant);
+            }
+            else
+            {
+                defeated.push_back (entrant);
+            }
+        }
+    }
+
+    if ( 1 == undefeated.size () && 1 == defeated.size () )
+    {
+        // The grand final.
+        m_Round.push_back (makeMatch (undefeated[0], defeated[0]));
+    }
+    else if ( 1 < undefeated.size () + defeated.size () )
+    {
+        pairEliminationGroup (undefeated);
+        pairEliminationGroup (defeated);
+    }
+}
+
+///
+/// \brief Makes the next round.
+///
+/// If there are no more matches to play, the tournament is over.
+///
+void
+Bracket::makeRound (void)
+{
+    m_Round.clear ();
+    if ( Swiss == getFormat () )
+    {
+        makeSwissRound ();
+    }
+    else
+    {
+        makeEliminationRound ();
+    }
+    m_Over = m_Round.empty ();
+}
+
+///
+/// \brief Makes a new round of the Swiss format.
+///
+void
+Bracket::makeSwissRound (void)
+{
+    if ( getRoundNumber () > m_SwissRounds )
+    {
+        return;
+    }
+
+    std::vector<uint16_t> ranking (getStandings ());
+    if ( 1 == ranking.size () % 2 )
+    {
+        // The lowest ranked player with the fewest byes gets this one.
+        std::vector<uint16_t>::iterator bye = ranking.end () - 1;
+        for ( std::vector<uint16_t>::iterator entrant = ranking.end () - 1 ;
+              entrant != ranking.begin () ; --entrant )
+        {
+            if ( m_Entrants[*entrant].byes < m_Entrants[*bye].byes )
+            {
+                bye = entrant;
+            }
+        }
+        giveBye (*bye);
+        ranking.erase (bye);
+    }
+
+    std::vector<bool> paired (ranking.size (), false);
+    for ( size_t first = 0 ; first < ranking.size () ; ++first )
+    {
+        if ( paired[first] )
+        {
+            continue;
+        }
+        paired[first] = true;
+
+        // The next unpaired player not yet played against, or just the
+        // next unpaired player when there is none.
+        size_t second = ranking.size ();
+        for ( size_t candidate = first + 1 ; candidate < ranking.size () ;
+              ++candidate )
+        {
+            if ( !paired[candidate] )
+            {
+                if ( ranking.size () == second )
+                {
+                    second = candidate;
+                }
+                if ( 0 == m_Opponents[ranking[first]].count (ranking[candidate]) )
+                {
+                    second = candidate;
+                    break;
+                }
+            }
+        }
+        assert ( second < ranking.size () && "Nobody left to pair with." );
+        paired[second] = true;
+        m_Round.push_back (makeMatch (ranking[first], ranking[second]));
+    }
+}
+
+///
+/// \brief Pairs the players of a group with the same number of losses.
+///
+/// \param group The entrants' indices, from the highest seed to the
+///              lowest.  The player getting a bye, if any, is removed.
+///
+void
+Bracket::pairEliminationGroup (std::vector<uint16_t> &group)
+{
+    if ( 1 == group.size () % 2 )
+    {
+        std::vector<uint16_t>::iterator bye = group.begin ();
+        for ( std::vector<uint16_t>::iterator entrant = group.begin () ;
+              entrant != group.end () ; ++entrant )
+        {
+            if ( m_Entrants[*entrant].byes < m_Entrants[*bye].byes )
+            {
+                bye = entrant;
+            }
+        }
+        giveBye (*bye);
+        group.erase (bye);
+    }
+
+    for ( size_t first = 0 ; first < group.size () / 2 ; ++first )
+    {
+        m_Round.push_back (makeMatch (group[first],
+                                      group[group.size () - 1 - first]));
+    }
+}
+
+///
+/// \brief Plays all the matches between computer players.
+///
+/// The matches of the current round between two computer players are
+/// played at the same time in \p pool.  When they are done, and if the
+/// next round also has matches between computer players, those are
+/// played too, until the tournament is over or there are matches with
+/// human players left to play in the current round.
+///
+/// Each match has its own seed, made from \p seed and the match's
+/// position, so the results are the same regardless of the number of
+/// threads in \p pool.
+///
+/// \param pool The thread pool to play the matches in.
+/// \param seed The seed of the first match of the tournament.
+///
+void
+Bracket::playComputerMatches (ThreadPool &pool, uint32_t seed)
+{
+    while ( !isOver () )
+    {
+        std::vector<Match> results (m_Round);
+        std::vector<uint16_t> played;
+        for ( uint16_t match = 0 ; match < m_Round.size () ; ++match )
+        {
+            if ( !m_Round[match].played && isComputerMatch (m_Round[match]) )
+            {
+                const Entrant &left = m_Entrants[m_Round[match].left];
+                const Entrant &right = m_Entrants[m_Round[match].right];
+                pool.schedule (
+                        std::bind (&Bracket::playMatch,
+                                   left.computerPlayerLevel,
+                                   right.computerPlayerLevel,
+                                   seed + (getRoundNumber () << 8) + match,
+                                   &results[match]));
+                played.push_back (match);
+            }
+        }
+        if ( played.empty () )
+        {
+            break;
+        }
+        pool.wait ();
+
+        // The last result of the round makes the next one.
+        for ( std::vector<uint16_t>::iterator match = played.begin () ;
+              match != played.end () ; ++match )
+        {
+            setResult (*match, results[*match].winner,
+                       results[*match].leftScore, results[*match].rightScore);
+        }
+    }
+}
+
+///
+/// \brief Plays a single match between two computer players.
+///
+/// \param leftLevel The level of the left computer player.
+/// \param rightLevel The level of the right computer player.
+/// \param seed The seed of the match's pseudo-random numbers.
+/// \param match The match to store the winner and scores to.
+///
+void
+Bracket::playMatch (uint8_t leftLevel, uint8_t rightLevel, uint32_t seed,
+                    Match *match)
+{
+    MatchSimulator::Result result =
+        MatchSimulator::play (leftLevel, rightLevel, seed);
+    match->winner = MatchSimulator::adjudicate (result, leftLevel, rightLevel);
+    match->leftScore = result.leftScore;
+    match->rightScore = result.rightScore;
+}
+
+///
+/// \brief Sets the result of a match of the current round.
+///
+/// When all the matches of the round have a result, the next round
+/// is made.
+///
+/// \param match The index of the match in getRound().
+/// \param winner The side of the player that won.
+/// \param leftScore The points the left player made in the match.
+/// \param rightScore The points the right player made in the match.
+///
+void
+Bracket::setResult (uint16_t match, IPlayer::PlayerSide winner,
+                    uint32_t leftScore, uint32_t rightScore)
+{
+    assert ( match < m_Round.size () && "Invalid match index." );
+    assert ( !m_Round[match].played && "The match already has a result." );
+
+    Match &current = m_Round[match];
+    current.played = true;
+    current.winner = winner;
+    current.leftScore = leftScore;
+    current.rightScore = rightScore;
+
+    m_Entrants[current.left].score += leftScore;
+    m_Entrants[current.right].score += rightScore;
+    m_Opponents[current.left].insert (current.right);
+    m_Opponents[current.right].insert (current.left);
+
+    uint16_t winnerIndex = current.left;
+    uint16_t loserIndex = current.right;
+    if ( IPlayer::RightSide == winner )
+    {
+        std::swap (winnerIndex, loserIndex);
+    }
+    ++m_Entrants[winnerIndex].wins;
+    ++m_Entrants[loserIndex].losses;
+    if ( !isAlive (loserIndex) )
+    {
+        m_EliminatedRound[loserIndex] = getRoundNumber ();
+    }
+
+    for ( std::vector<Match>::iterator other = m_Round.begin () ;
+          other != m_Round.end () ; ++other )
+    {
+        if ( !other->played )
+        {
+            return;
+        }
+    }
+    ++m_RoundNumber;
+    makeRound ();
+}
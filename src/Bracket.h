@@ -0,0 +1,166 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_BRACKET_H)
+#define AMOEBAX_BRACKET_H
+
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "IPlayer.h"
+
+namespace Amoebax
+{
+    // Forward declarations.
+    class ThreadPool;
+
+    ///
+    /// \class Bracket.
+    /// \brief Pairs the entrants of a tournament and keeps its results.
+    ///
+    /// The bracket knows nothing about graphics or states.  It only
+    /// tells which matches must be played in the current round, and
+    /// makes the next round once all of them have a result.
+    ///
+    /// The elimination formats are reseeded each round: the players
+    /// with the same number of losses are paired the highest seed (the
+    /// entrant's index) against the lowest one.  When a group has an
+    /// odd number of players, the highest seed that had the fewest byes
+    /// waits for the next round.  In double elimination, the last
+    /// player without losses and the last one with a loss play the
+    /// grand final, that is played twice when the player without losses
+    /// loses the first one.
+    ///
+    /// The Swiss format plays log2(entrants) rounds, rounded up, and
+    /// pairs the players by wins and score avoiding rematches.  The
+    /// bye, if any, counts as a win.
+    ///
+    /// The matches between two computer players can be played all at
+    /// once with playComputerMatches(), so the front end only needs to
+    /// show the matches with a human player.
+    ///
+    class Bracket
+    {
+        public:
+            ///
+            /// \enum Format
+            /// \brief The tournament formats.
+            ///
+            enum Format
+            {
+                /// Players are out after their first loss.
+                SingleElimination,
+                /// Players are out after their second loss.
+                DoubleElimination,
+                /// Nobody is out, the most wins after all rounds wins.
+                Swiss
+            };
+
+            /// The minimum number of entrants.
+            static const uint16_t k_MinEntrants = 8;
+            /// The maximum number of entrants.
+            static const uint16_t k_MaxEntrants = 256;
+
+            ///
+            /// \struct Entrant
+            /// \brief A player of the tournament.
+            ///
+            struct Entrant
+            {
+                /// The player's name.
+                std::string name;
+                /// Tells the computer level, if isComputerPlayer is \a true.
+                uint8_t computerPlayerLevel;
+                /// Tells if the player is computer controlled or not.
+                bool isComputerPlayer;
+                /// The points made in all the matches played.
+                uint32_t score;
+                /// The matches won, plus the byes in the Swiss format.
+                uint16_t wins;
+                /// The matches lost.
+                uint16_t losses;
+                /// The rounds the player had no opponent.
+                uint16_t byes;
+            };
+
+            ///
+            /// \struct Match
+            /// \brief A match of the current round.
+            ///
+            struct Match
+            {
+                /// The index of the left entrant.
+                uint16_t left;
+                /// The index of the right entrant.
+                uint16_t right;
+                /// Tells if the match already has a result.
+                bool played;
+                /// The side of the winner.  Only valid if \a played.
+                IPlayer::PlayerSide winner;
+                /// The points made by the left player in the match.
+                uint32_t leftScore;
+                /// The points made by the right player in the match.
+                uint32_t rightScore;
+            };
+
+            Bracket (Format format, const std::vector<Entrant> &entrants);
+
+            const std::vector<Entrant> &getEntrants (void) const;
+            Format getFormat (void) const;
+            bool getNextHumanMatch (uint16_t &match) const;
+            const std::vector<Match> &getRound (void) const;
+            uint16_t getRoundNumber (void) const;
+            std::vector<uint16_t> getStandings (void) const;
+            bool isComputerMatch (const Match &match) const;
+            bool isOver (void) const;
+            void playComputerMatches (ThreadPool &pool, uint32_t seed);
+            void setResult (uint16_t match, IPlayer::PlayerSide winner,
+                            uint32_t leftScore, uint32_t rightScore);
+
+        private:
+            uint16_t getMaxLosses (void) const;
+            void giveBye (uint16_t entrant);
+            bool isAlive (uint16_t entrant) const;
+            void makeEliminationRound (void);
+            void makeRound (void);
+            void makeSwissRound (void);
+            void pairEliminationGroup (std::vector<uint16_t> &group);
+            static void playMatch (uint8_t leftLevel, uint8_t rightLevel,
+                                   uint32_t seed, Match *match);
+
+            /// The round each entrant was eliminated, or 0 if still alive.
+            std::vector<uint16_t> m_EliminatedRound;
+            /// The tournament's players.
+            std::vector<Entrant> m_Entrants;
+            /// The tournament's format.
+            Format m_Format;
+            /// The opponents each entrant already played against.
+            std::vector<std::set<uint16_t> > m_Opponents;
+            /// Tells if the tournament is over.
+            bool m_Over;
+            /// The matches of the current round.
+            std::vector<Match> m_Round;
+            /// The current round's number, starting at 1.
+            uint16_t m_RoundNumber;
+            /// The number of rounds to play in the Swiss format.
+            uint16_t m_SwissRounds;
+    };
+}
+
+#endif // !AMOEBAX_BRACKET_H
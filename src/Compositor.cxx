@@ -0,0 +1,235 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <algorithm>
+#include <assert.h>
+#include <SDL.h>
+#include "Blitter.h"
+#include "Compositor.h"
+#include "ThreadPool.h"
+
+using namespace Amoebax;
+
+// The definitions of the class' constants, for when they are used by reference.
+const unsigned int Compositor::k_MaxThreads;
+const size_t Compositor::k_ReservedBlits;
+
+///
+/// \brief Gets a pixel of a 32-bit surface.
+///
+/// \param surface The surface to get the pixel of.
+/// \param x The pixel's X coordinate.
+/// \param y The pixel's Y coordinate.
+/// \return The pointer to the pixel at (\p x, \p y).
+///
+static uint32_t *
+getPixels (SDL_Surface *surface, int x, int y)
+{
+    return reinterpret_cast<uint32_t *>(
+            static_cast<uint8_t *>(surface->pixels) + y * surface->pitch) + x;
+}
+
+///
+/// \brief Default constructor.
+///
+Compositor::Compositor (void):
+    m_Blits (),
+    m_Pool (0),
+    m_Screen (0)
+{
+    m_Blits.reserve (k_ReservedBlits);
+}
+
+///
+/// \brief Destructor.
+///
+Compositor::~Compositor (void)
+{
+    delete m_Pool;
+}
+
+///
+/// \brief Starts recording the blits to the screen.
+///
+/// The blits are only recorded when the screen is large enough and
+/// there is more than one CPU core to draw the bands with.
+///
+/// \param screen The screen to record the blits to.
+///
+void
+Compositor::begin (SDL_Surface *screen)
+{
+    assert (m_Blits.empty () && "Tried to begin with pending blits.");
+
+    m_Screen = 0;
+    if ( screen->w * screen->h >= k_MinimumArea &&
+         1 < ThreadPool::getDefaultNumberOfThreads () )
+    {
+        if ( 0 == m_Pool )
+        {
+            m_Pool = new ThreadPool (
+                    std::min (ThreadPool::getDefaultNumberOfThreads (),
+                              k_MaxThreads));
+        }
+        m_Screen = screen;
+    }
+}
+
+///
+/// \brief Draws or records a blit.
+///
+/// The blits to the screen are recorded while recording.  Any other
+/// blit flushes the recorded blits, because it could change a surface
+/// they read from, and is drawn right away.
+///
+/// \param blit The blit to draw.
+/// \param destination The surface to draw \p blit to.
+///
+void
+Compositor::blit (const Blit &blit, SDL_Surface *destination)
+{
+    if ( isRecording () && destination == m_Screen )
+    {
+        m_Blits.push_back (blit);
+    }
+    else
+    {
+        flush ();
+        SDL_LockSurface (destination);
+        draw (blit, destination, blit.destinationRect.y,
+              blit.destinationRect.y + blit.destinationRect.h);
+        SDL_UnlockSurface (destination);
+    }
+}
+
+///
+/// \brief Draws the rows of a blit that are inside a band.
+///
+/// \param blit The blit to draw.
+/// \param destination The surface to draw \p blit to.  Must be locked.
+/// \param firstRow The band's first row.
+/// \param lastRow The row after the band's last row.
+///
+void
+Compositor::draw (const Blit &blit, SDL_Surface *destination,
+                  int firstRow, int lastRow)
+{
+    const int top = std::max (firstRow, blit.destinationRect.y);
+    const int bottom = std::min (lastRow, blit.destinationRect.y +
+                                          blit.destinationRect.h);
+    if ( top >= bottom )
+    {
+        return;
+    }
+
+    const int height = bottom - top;
+    const int width = blit.destinationRect.w;
+    const uint32_t *sourcePixels =
+        getPixels (blit.source, blit.sourceRect.x,
+                   blit.sourceRect.y + top - blit.destinationRect.y);
+    uint32_t *destinationPixels =
+        getPixels (destination, blit.destinationRect.x, top);
+    switch ( blit.type )
+    {
+        case Blit::Copy:
+            for ( int y = 0 ; y < height ; ++y )
+            {
+                std::copy (sourcePixels, sourcePixels + width,
+                           destinationPixels);
+                sourcePixels = reinterpret_cast<const uint32_t *>(
+                        reinterpret_cast<const uint8_t *>(sourcePixels) +
+                        blit.source->pitch);
+                destinationPixels = reinterpret_cast<uint32_t *>(
+                        reinterpret_cast<uint8_t *>(destinationPixels) +
+                        destination->pitch);
+            }
+            break;
+
+        case Blit::CopyColorKey:
+            Blitter::copyColorKey (sourcePixels, blit.source->pitch,
+                                   destinationPixels, destination->pitch,
+                                   width, height, blit.colorKey,
+                                   blit.colorMask);
+            break;
+
+        case Blit::BlendPremultiplied:
+            Blitter::blendPremultiplied (sourcePixels, blit.source->pitch,
+                                         blit.source->format,
+                                         destinationPixels,
+                                         destination->pitch,
+                                         destination->format,
+                                         width, height, blit.alpha);
+            break;
+    }
+}
+
+///
+/// \brief Draws the recorded blits inside a band of the screen.
+///
+/// \param band The band to draw, counting from the top.
+///
+void
+Compositor::drawBand (int band)
+{
+    const int bands = static_cast<int>(m_Pool->getNumberOfThreads ());
+    const int bandHeight = (m_Screen->h + bands - 1) / bands;
+    const int firstRow = band * bandHeight;
+    const int lastRow = std::min (firstRow + bandHeight, m_Screen->h);
+    for ( std::vector<Blit>::const_iterator blit = m_Blits.begin () ;
+          blit != m_Blits.end () ; ++blit )
+    {
+        draw (*blit, m_Screen, firstRow, lastRow);
+    }
+}
+
+///
+/// \brief Draws the recorded blits and stops recording.
+///
+void
+Compositor::end (void)
+{
+    flush ();
+    m_Screen = 0;
+}
+
+///
+/// \brief Draws the recorded blits.
+///
+/// Each thread draws all the blits to its own band of the screen,
+/// and this function waits until all the bands are done.
+///
+void
+Compositor::flush (void)
+{
+    if ( m_Blits.empty () )
+    {
+        return;
+    }
+
+    const int bands = static_cast<int>(m_Pool->getNumberOfThreads ());
+    SDL_LockSurface (m_Screen);
+    for ( int band = 0 ; band < bands ; ++band )
+    {
+        // Unlike std::bind()'s, this task is small enough to be kept
+        // inside the std::function, so scheduling it doesn't allocate.
+        m_Pool->schedule ([this, band] () { drawBand (band); });
+    }
+    m_Pool->wait ();
+    SDL_UnlockSurface (m_Screen);
+    m_Blits.clear ();
+}
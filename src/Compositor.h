@@ -0,0 +1,144 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_COMPOSITOR_H)
+#define AMOEBAX_COMPOSITOR_H
+
+#include <SDL_rect.h>
+#include <stdint.h>
+#include <vector>
+
+// Forward declarations.
+struct SDL_Surface;
+
+namespace Amoebax
+{
+    // Forward declarations.
+    class ThreadPool;
+
+    ///
+    /// \class Compositor.
+    /// \brief Draws the blits to the screen in parallel horizontal bands.
+    ///
+    /// On large screens, the blits to the screen between begin() and
+    /// end() are recorded instead of drawn.  When they are flushed,
+    /// the screen is split in as many horizontal bands as threads and
+    /// each thread replays all the recorded blits clipped to its band.
+    /// The blits are replayed in the same order and every row is drawn
+    /// with the same kernel as the serial path, so the result is the
+    /// same pixel by pixel.
+    ///
+    /// Only the blits that Blitter can draw are recorded.  Anything
+    /// else that reads or writes the screen, or changes or frees a
+    /// surface that was blit, must call flush() first.
+    ///
+    class Compositor
+    {
+        public:
+            ///
+            /// \struct Blit
+            /// \brief A blit already clipped to its destination.
+            ///
+            struct Blit
+            {
+                /// The kinds of blits.
+                enum Type
+                {
+                    /// Copy the pixels as they are.
+                    Copy,
+                    /// Copy the pixels that aren't the color key.
+                    CopyColorKey,
+                    /// Blend premultiplied pixels.
+                    BlendPremultiplied
+                };
+
+                /// The kind of blit.
+                Type type;
+                /// The surface to blit.
+                SDL_Surface *source;
+                /// The part of the source to blit.
+                SDL_Rect sourceRect;
+                /// The part of the destination that is changed.
+                SDL_Rect destinationRect;
+                /// The alpha to blend the source with.
+                uint8_t alpha;
+                /// The color key, with only the color bits.
+                uint32_t colorKey;
+                /// The color bits of the source's pixels.
+                uint32_t colorMask;
+            };
+
+            /// The minimum screen area to draw in bands, in pixels.
+            static const int k_MinimumArea = 1280 * 960;
+            /// The maximum number of threads to draw the bands with.
+            static const unsigned int k_MaxThreads = 4;
+            /// The blits kept room for, more than a match's frame makes.
+            static const size_t k_ReservedBlits = 1024;
+
+            Compositor (void);
+            ~Compositor (void);
+
+            void begin (SDL_Surface *screen);
+            void blit (const Blit &blit, SDL_Surface *destination);
+            void end (void);
+            void flush (void);
+            bool isRecording (void) const;
+
+        private:
+            ///
+            /// \brief Copy constructor.
+            ///
+            /// \note This constructor is left unimplemented because we
+            /// don't want copies of Compositor. Don't use it.
+            ///
+            Compositor (const Compositor &);
+            ///
+            /// \brief Assigment operator.
+            ///
+            /// \note This operator is left unimplemented because we
+            /// don't want copies of Compositor. Don't use it.
+            ///
+            Compositor &operator= (const Compositor &);
+
+            static void draw (const Blit &blit, SDL_Surface *destination,
+                              int firstRow, int lastRow);
+            void drawBand (int band);
+
+            /// The recorded blits, in the order they were made.
+            std::vector<Blit> m_Blits;
+            /// The threads that draw the bands.  Created the first time
+            /// a large screen is drawn.
+            ThreadPool *m_Pool;
+            /// The screen whose blits are recorded, or 0 if not recording.
+            SDL_Surface *m_Screen;
+    };
+
+    ///
+    /// \brief Tells if the blits to the screen are being recorded.
+    ///
+    /// \return \a true if the blits to the screen are drawn in bands
+    ///         when flushed, \a false if they are drawn right away.
+    ///
+    inline bool
+    Compositor::isRecording (void) const
+    {
+        return 0 != m_Screen;
+    }
+}
+
+#endif // !AMOEBAX_COMPOSITOR_H
@@ -22,6 +22,7 @@
 #include "Options.h"
 #include "System.h"
 #include "CongratulationsState.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
@@ -42,6 +43,7 @@ CongratulationsState::CongratulationsState (const std::string &playerName,
     m_PlayerName (playerName),
     m_PlayerScore (playerScore)
 {
+    AMOEBAX_TRACE_ZONE ("CongratulationsState::CongratulationsState");
     loadGraphicResources ();
 }
 
@@ -127,6 +129,7 @@ CongratulationsState::keyUp (uint32_t key)
 void
 CongratulationsState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("CongratulationsState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
     const float originalScale = 1.0f;
 
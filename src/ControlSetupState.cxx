@@ -22,6 +22,7 @@
 #include "File.h"
 #include "Joystick.h"
 #include "System.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
@@ -78,6 +79,7 @@ ControlSetupState::ControlSetupState (Options::PlayerControls &leftControls,
     m_VisibleTime (k_VisibleTime),
     m_WaitingForInput (false)
 {
+    AMOEBAX_TRACE_ZONE ("ControlSetupState::ControlSetupState");
     loadGraphicResources ();
 
     m_KeyControls.push_back (&m_LeftPlayerControls.keyboard.moveRight);
@@ -527,6 +529,7 @@ ControlSetupState::keyUp (uint32_t key)
 void
 ControlSetupState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("ControlSetupState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
     m_Background.reset (Surface::fromFile (
                 File::getGraphicsFilePath ("menuBackground.png")));
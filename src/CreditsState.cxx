@@ -24,6 +24,7 @@
 #include "Options.h"
 #include "OptionsMenuState.h"
 #include "System.h"
+#include "Tracer.h"
 #include "TrainingState.h"
 
 using namespace Amoebax;
@@ -38,9 +39,17 @@ CreditsState::CreditsState (void):
     m_SectionsFont (nullptr),
     m_StateRemoved (false)
 {
+    AMOEBAX_TRACE_ZONE ("CreditsState::CreditsState");
     loadGraphicResources ();
 }
 
+uint32_t
+CreditsState::getIdleTime (void)
+{
+    // The screen only changes with the events.
+    return k_MaxIdleTime;
+}
+
 void
 CreditsState::joyMotion (uint8_t joystick, uint8_t axis, int16_t value)
 {
@@ -74,6 +83,7 @@ CreditsState::keyUp (uint32_t key)
 void
 CreditsState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("CreditsState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
     m_Background.reset (
             Surface::fromFile (File::getGraphicsFilePath ("menuBackground.png")));
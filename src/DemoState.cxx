@@ -16,12 +16,16 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
+#include <algorithm>
 #include "AIPlayerFactory.h"
 #include "DemoState.h"
 #include "System.h"
 
 using namespace Amoebax;
 
+// Static members.
+uint8_t DemoState::m_InitialTimeScale = 1;
+
 ///
 /// \brief Default constructor.
 ///
@@ -46,6 +50,7 @@ DemoState::DemoState (void):
                                                           IPlayer::RightSide),
                                  AIPlayerFactory::getRandomBackgroundFileName (),
                                  0, 0, this));
+    m_Match->setTimeScale (m_InitialTimeScale);
 }
 
 void
@@ -93,7 +98,43 @@ DemoState::joyUp (uint8_t joystick, SDL_GameControllerButton button)
 void
 DemoState::keyDown (uint32_t key)
 {
-    removeState ();
+    uint8_t timeScale = m_Match->getTimeScale ();
+    switch ( key )
+    {
+        // Faster, up to as fast as possible.
+        case SDLK_PLUS:
+        case SDLK_EQUALS:
+        case SDLK_KP_PLUS:
+            if ( TwoPlayersState::k_MaxTimeScale == timeScale )
+            {
+                setTimeScale (TwoPlayersState::k_FastestTimeScale);
+            }
+            else if ( TwoPlayersState::k_FastestTimeScale != timeScale )
+            {
+                // The initial time scale isn't always a power of two.
+                setTimeScale (static_cast<uint8_t>(
+                            std::min<unsigned int> (timeScale * 2,
+                                                    TwoPlayersState::k_MaxTimeScale)));
+            }
+            break;
+
+        // Slower, down to real time.
+        case SDLK_MINUS:
+        case SDLK_KP_MINUS:
+            if ( TwoPlayersState::k_FastestTimeScale == timeScale )
+            {
+                setTimeScale (TwoPlayersState::k_MaxTimeScale);
+            }
+            else if ( 1 < timeScale )
+            {
+                setTimeScale (timeScale / 2);
+            }
+            break;
+
+        default:
+            removeState ();
+            break;
+    }
 }
 
 void
@@ -129,6 +170,18 @@ DemoState::render (SDL_Surface *screen)
     m_Match->render (screen);
 }
 
+///
+/// \brief Sets the time scale used by new demos.
+///
+/// \param timeScale How many times faster than real time the demo's
+///                  match is played.  See TwoPlayersState::setTimeScale().
+///
+void
+DemoState::setInitialTimeScale (uint8_t timeScale)
+{
+    m_InitialTimeScale = timeScale;
+}
+
 ///
 /// \brief Sets the time until the end of the demo.
 ///
@@ -140,14 +193,30 @@ DemoState::setDemoTime (int32_t time)
     m_DemoTime = time;
 }
 
+///
+/// \brief Changes the time scale of the demo's match.
+///
+/// \param timeScale How many times faster than real time the match is
+///                  played.  See TwoPlayersState::setTimeScale().
+///
+void
+DemoState::setTimeScale (uint8_t timeScale)
+{
+    m_Match->setTimeScale (timeScale);
+}
+
 void
 DemoState::update (uint32_t elapsedTime)
 {
     m_Match->update (elapsedTime);
-    setDemoTime (getDemoTime () - elapsedTime);
-    if ( getDemoTime () <= 0 )
+    // A fast forwarded demo lasts until the end of the match.
+    if ( 1 == m_Match->getTimeScale () )
     {
-        removeState ();
+        setDemoTime (getDemoTime () - elapsedTime);
+        if ( getDemoTime () <= 0 )
+        {
+            removeState ();
+        }
     }
 }
 
@@ -156,3 +225,9 @@ DemoState::videoModeChanged (void)
 {
     m_Match->videoModeChanged ();
 }
+
+void
+DemoState::writeBoards (std::ostream &stream)
+{
+    m_Match->writeBoards (stream);
+}
@@ -46,8 +46,10 @@ namespace Amoebax
             virtual void keyUp (uint32_t key);
             virtual void redrawBackground (SDL_Rect *region, SDL_Surface *screen);
             virtual void render (SDL_Surface *screen);
+            static void setInitialTimeScale (uint8_t timeScale);
             virtual void update (uint32_t elapsedTime);
             virtual void videoModeChanged (void);
+            virtual void writeBoards (std::ostream &stream);
 
         private:
             /// The time the demo lasts in ms.
@@ -56,9 +58,12 @@ namespace Amoebax
             int32_t getDemoTime (void) const;
             void removeState (void);
             void setDemoTime (int32_t time);
+            void setTimeScale (uint8_t timeScale);
 
             /// The time the demo has to run.
             int32_t m_DemoTime;
+            /// The time scale of every new demo.
+            static uint8_t m_InitialTimeScale;
             /// The two players mode that will show the match.
             std::unique_ptr<TwoPlayersState> m_Match;
             /// Tells if the state was already removed.
@@ -0,0 +1,140 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <limits>
+#include <SDL.h>
+#include "DirtyRegions.h"
+
+using namespace Amoebax;
+
+/// The extra area, in pixels, a union can have to be worth merging.
+static const uint32_t k_MergeSlack = 32 * 32;
+
+///
+/// \brief Default constructor.
+///
+DirtyRegions::DirtyRegions (void):
+    m_Rects ()
+{
+    m_Rects.reserve (k_MaxRects);
+}
+
+///
+/// \brief Adds a new dirty rectangle.
+///
+/// \param rect The rectangle to add.  Empty rectangles are ignored.
+///
+void
+DirtyRegions::add (const SDL_Rect &rect)
+{
+    if ( 0 >= rect.w || 0 >= rect.h )
+    {
+        return;
+    }
+
+    SDL_Rect united;
+    for ( std::vector<SDL_Rect>::iterator current = m_Rects.begin () ;
+          current != m_Rects.end () ; ++current )
+    {
+        if ( isWorthMerging (*current, rect, united) )
+        {
+            // The union can now be worth merging with others.
+            m_Rects.erase (current);
+            add (united);
+            return;
+        }
+    }
+
+    if ( k_MaxRects == m_Rects.size () )
+    {
+        std::vector<SDL_Rect>::iterator smallest = m_Rects.end ();
+        uint32_t smallestArea = std::numeric_limits<uint32_t>::max ();
+        for ( std::vector<SDL_Rect>::iterator current = m_Rects.begin () ;
+              current != m_Rects.end () ; ++current )
+        {
+            SDL_UnionRect (&(*current), &rect, &united);
+            if ( getArea (united) < smallestArea )
+            {
+                smallest = current;
+                smallestArea = getArea (united);
+            }
+        }
+        SDL_UnionRect (&(*smallest), &rect, &united);
+        m_Rects.erase (smallest);
+        add (united);
+        return;
+    }
+
+    m_Rects.push_back (rect);
+}
+
+///
+/// \brief Removes all the rectangles.
+///
+void
+DirtyRegions::clear (void)
+{
+    m_Rects.clear ();
+}
+
+///
+/// \brief Gets the area to redraw.
+///
+/// \return The sum of the area of all rectangles, in pixels.
+///
+uint32_t
+DirtyRegions::getArea (void) const
+{
+    uint32_t area = 0;
+    for ( std::vector<SDL_Rect>::const_iterator current = m_Rects.begin () ;
+          current != m_Rects.end () ; ++current )
+    {
+        area += getArea (*current);
+    }
+    return area;
+}
+
+///
+/// \brief Gets the area of a rectangle.
+///
+/// \param rect The rectangle to get the area of.
+/// \return The area of \p rect in pixels.
+///
+uint32_t
+DirtyRegions::getArea (const SDL_Rect &rect)
+{
+    return static_cast<uint32_t> (rect.w) * static_cast<uint32_t> (rect.h);
+}
+
+///
+/// \brief Tells if two rectangles should be merged.
+///
+/// \param first The first rectangle.
+/// \param second The second rectangle.
+/// \param united Set to the union of \p first and \p second.
+/// \return \a true if the union of \p first and \p second is not much
+///         larger than both rectangles apart.
+///
+bool
+DirtyRegions::isWorthMerging (const SDL_Rect &first, const SDL_Rect &second,
+                              SDL_Rect &united)
+{
+    SDL_UnionRect (&first, &second, &united);
+    return getArea (united) <= getArea (first) + getArea (second) +
+                               k_MergeSlack;
+}
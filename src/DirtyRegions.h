@@ -0,0 +1,87 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_DIRTY_REGIONS_H)
+#define AMOEBAX_DIRTY_REGIONS_H
+
+#include <SDL_rect.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Amoebax
+{
+    ///
+    /// \class DirtyRegions.
+    /// \brief A bounded list of screen rectangles that need to be redrawn.
+    ///
+    /// Each new rectangle is merged with the rectangles already in the
+    /// list when their union covers about the same area than both of
+    /// them apart, so sprites that overlap or are next to each other
+    /// end up in the same rectangle, but sprites at opposite sides of
+    /// the screen don't make the whole screen dirty.  When the list is
+    /// full, the new rectangle is merged with the one that makes the
+    /// smallest union.
+    ///
+    class DirtyRegions
+    {
+        public:
+            /// The maximum number of rectangles in the list.
+            static const size_t k_MaxRects = 16;
+
+            DirtyRegions (void);
+
+            void add (const SDL_Rect &rect);
+            void clear (void);
+            uint32_t getArea (void) const;
+            const std::vector<SDL_Rect> &getRects (void) const;
+            bool isEmpty (void) const;
+
+        private:
+            static uint32_t getArea (const SDL_Rect &rect);
+            static bool isWorthMerging (const SDL_Rect &first,
+                                        const SDL_Rect &second,
+                                        SDL_Rect &united);
+
+            /// The dirty rectangles.
+            std::vector<SDL_Rect> m_Rects;
+    };
+
+    ///
+    /// \brief Gets the dirty rectangles.
+    ///
+    /// \return The list of rectangles to redraw.
+    ///
+    inline const std::vector<SDL_Rect> &
+    DirtyRegions::getRects (void) const
+    {
+        return m_Rects;
+    }
+
+    ///
+    /// \brief Tells if there is nothing to redraw.
+    ///
+    /// \return \a true if the list has no rectangles.
+    ///
+    inline bool
+    DirtyRegions::isEmpty (void) const
+    {
+        return m_Rects.empty ();
+    }
+}
+
+#endif // !AMOEBAX_DIRTY_REGIONS_H
@@ -21,6 +21,7 @@
 
 #include <functional>
 #include <algorithm>
+#include "Amoeba.h"
 #include "Surface.h"
 
 namespace Amoebax
@@ -38,6 +39,9 @@ namespace Amoebax
         uint8_t amoebasSize;
         /// The SDL surface to draw the amoeba to.
         SDL_Surface *destination;
+        /// How far to draw the amoeba from its previous tick's position
+        /// to its current position.
+        uint16_t interpolation;
         /// The surface to get the amoeba's images to use.
         Surface *source;
 
@@ -48,10 +52,15 @@ namespace Amoebax
         ///                    height of an amoeba must be the same.
         /// \param source The surface to use to draw the amoebas from.
         /// \param destination The SDL surface to use to draw the amoebas to.
+        /// \param interpolation How far to draw the amoebas between their
+        ///                      previous tick's position and their current
+        ///                      position.  See Amoeba::getX().
         DrawAmoeba (uint8_t amoebasSize, Surface *source,
-                    SDL_Surface *destination):
+                    SDL_Surface *destination,
+                    uint16_t interpolation = Amoeba::k_MaxInterpolation):
             amoebasSize (amoebasSize),
             destination (destination),
+            interpolation (interpolation),
             source (source)
         {
         }
@@ -69,9 +78,22 @@ namespace Amoebax
                 source->blit (amoebasSize * amoeba->getState (),
                               amoebasSize * amoeba->getColour (),
                               amoebasSize, amoebasSize,
-                              amoeba->getX (), amoeba->getY (), destination);
+                              amoeba->getX (interpolation, amoebasSize),
+                              amoeba->getY (interpolation, amoebasSize),
+                              destination);
             }
         }
+
+        ///
+        /// \brief Draws a single amoeba.
+        ///
+        /// \param amoeba The amoeba to draw.
+        ///
+        void
+        operator() (const Amoeba &amoeba)
+        {
+            (*this) (&amoeba);
+        }
     };
 }
 
@@ -21,6 +21,7 @@
 
 #include <functional>
 #include <algorithm>
+#include <string>
 #include "ChainLabel.h"
 #include "Font.h"
 #include "Surface.h"
@@ -68,21 +69,35 @@ namespace Amoebax
         {
             if ( chainLabel->isActive () )
             {
-                std::stringstream chainLabelText;
-                chainLabelText << int(chainLabel->getStepChain ()) << " ";
+                // The text is short enough to not need any heap memory.
+                std::string chainLabelText (
+                        std::to_string (int(chainLabel->getStepChain ())));
+                chainLabelText += ' ';
                 uint16_t chainLabelTextWidth =
-                    font->getTextWidth (chainLabelText.str ());
+                    font->getTextWidth (chainLabelText);
                 int16_t x = chainLabel->getX () -
                             (chainLabelTextWidth +
                              chainLabelImage->getWidth ()) / 2;
                 int16_t y = chainLabel->getY ();
-                font->write (chainLabelText.str (),
-                             x, y - font->getHeight () / 2, destination);
+                font->writeCharacters (chainLabelText, x,
+                                       y - font->getHeight () / 2,
+                                       destination);
                 chainLabelImage->blit (x + chainLabelTextWidth,
                                        y - chainLabelImage->getHeight () / 2,
                                        destination);
             }
         }
+
+        ///
+        /// \brief Draws a single chain label.
+        ///
+        /// \param chainLabel The chain label to draw.
+        ///
+        void
+        operator() (const ChainLabel &chainLabel)
+        {
+            (*this) (&chainLabel);
+        }
     };
 }
 
@@ -17,6 +17,7 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
 #include "DumbAIPlayer.h"
+#include "Random.h"
 
 using namespace Amoebax;
 
@@ -38,7 +39,7 @@ DumbAIPlayer::DumbAIPlayer (IPlayer::PlayerSide side):
 int32_t
 DumbAIPlayer::computeScore (const GridStatus::PositionResult &result) const
 {
-    return rand ();
+    return Random::get ();
 }
 
 bool
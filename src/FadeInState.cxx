@@ -16,6 +16,8 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
+#include <algorithm>
+#include "Fader.h"
 #include "FadeInState.h"
 #include "System.h"
 
@@ -30,7 +32,6 @@ using namespace Amoebax;
 FadeInState::FadeInState (IState *nextState, uint32_t fadeTime):
     IState (),
     m_Alpha (0),
-    m_Background (nullptr),
     m_FadeTime (fadeTime),
     m_NextState (nextState)
 {
@@ -39,15 +40,14 @@ FadeInState::FadeInState (IState *nextState, uint32_t fadeTime):
 void
 FadeInState::activate (void)
 {
-    m_Background.reset (Surface::fromScreen ());
+    SDL_Surface *backBuffer = Fader::getInstance ().getBackBuffer ();
     SDL_Rect region;
     region.x = 0;
     region.y = 0;
-    region.w = m_Background->getWidth ();
-    region.h = m_Background->getHeight ();
-    m_NextState->redrawBackground (&region, m_Background->toSDLSurface ());
-    m_NextState->render (m_Background->toSDLSurface ());
-    m_Background->setAlpha (getAlpha ());
+    region.w = backBuffer->w;
+    region.h = backBuffer->h;
+    m_NextState->redrawBackground (&region, backBuffer);
+    m_NextState->render (backBuffer);
 }
 
 ///
@@ -75,13 +75,14 @@ FadeInState::getFadeTime (void) const
 void
 FadeInState::redrawBackground (SDL_Rect *region, SDL_Surface *screen)
 {
-    SDL_FillRect (screen, region, SDL_MapRGB (screen->format, 0, 0, 0));
+    // render() draws the whole screen.
 }
 
 void
 FadeInState::render (SDL_Surface *screen)
 {
-    m_Background->blit (screen);
+    int16_t alpha = std::min<int16_t> (getAlpha (), Surface::k_MaxAlpha);
+    Fader::getInstance ().draw (static_cast<uint8_t>(alpha), screen);
 }
 
 ///
@@ -101,11 +102,7 @@ FadeInState::update (uint32_t elapsedTime)
     setAlpha (getAlpha () +
               static_cast<int16_t>(Surface::k_MaxAlpha *
                     static_cast<float> (elapsedTime) / getFadeTime ()));
-    if ( getAlpha () <= Surface::k_MaxAlpha )
-    {
-        m_Background->setAlpha (getAlpha ());
-    }
-    else
+    if ( getAlpha () > Surface::k_MaxAlpha )
     {
         System::getInstance ().removeActiveState (false);
     }
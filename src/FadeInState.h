@@ -51,8 +51,6 @@ namespace Amoebax
 
             /// The current alpha value.
             int16_t m_Alpha;
-            /// The background image to fade.
-            std::unique_ptr<Surface> m_Background;
             /// The time the fade should take.
             uint32_t m_FadeTime;
             /// The state that will be active next.
@@ -16,6 +16,8 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
+#include <algorithm>
+#include "Fader.h"
 #include "FadeOutState.h"
 #include "System.h"
 
@@ -29,7 +31,6 @@ using namespace Amoebax;
 FadeOutState::FadeOutState (uint32_t fadeTime):
     IState (),
     m_Alpha (255),
-    m_Background (nullptr),
     m_FadeTime (fadeTime)
 {
 }
@@ -37,8 +38,7 @@ FadeOutState::FadeOutState (uint32_t fadeTime):
 void
 FadeOutState::activate (void)
 {
-    m_Background.reset (Surface::fromScreen ());
-    m_Background->setAlpha (getAlpha ());
+    Fader::getInstance ().captureScreen ();
 }
 
 ///
@@ -66,13 +66,14 @@ FadeOutState::getFadeTime (void) const
 void
 FadeOutState::redrawBackground (SDL_Rect *region, SDL_Surface *screen)
 {
-    SDL_FillRect (screen, region, SDL_MapRGB (screen->format, 0, 0, 0));
+    // render() draws the whole screen.
 }
 
 void
 FadeOutState::render (SDL_Surface *screen)
 {
-    m_Background->blit (screen);
+    int16_t alpha = std::max<int16_t> (getAlpha (), 0);
+    Fader::getInstance ().draw (static_cast<uint8_t>(alpha), screen);
 }
 
 ///
@@ -92,11 +93,7 @@ FadeOutState::update (uint32_t elapsedTime)
     setAlpha (getAlpha () -
               static_cast<int16_t>(Surface::k_MaxAlpha *
                     static_cast<float> (elapsedTime) / getFadeTime ()));
-    if ( getAlpha () > 0 )
-    {
-        m_Background->setAlpha (getAlpha ());
-    }
-    else
+    if ( getAlpha () <= 0 )
     {
         System::getInstance ().removeActiveState (false);
     }
@@ -0,0 +1,328 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <algorithm>
+#include <assert.h>
+#include <SDL.h>
+#include <stdexcept>
+#include "Blitter.h"
+#include "Fader.h"
+#include "Surface.h"
+#include "System.h"
+
+using namespace Amoebax;
+
+///
+/// \brief Tells whether Blitter::fade() can fade a surface.
+///
+/// \param surface The surface to fade.
+/// \return \a true if \p surface has 32-bit pixels with a byte for
+///         each channel.
+///
+static bool
+canFade (const SDL_Surface *surface)
+{
+    return 4 == surface->format->BytesPerPixel &&
+           SDL_PIXELFORMAT_ARGB2101010 != surface->format->format;
+}
+
+///
+/// \brief Gets the bits of a surface's pixels that hold the color.
+///
+/// \param surface The surface to get the color bits of.
+/// \return The union of the red, green and blue masks of \p surface.
+///
+static uint32_t
+getColorMask (const SDL_Surface *surface)
+{
+    return surface->format->Rmask | surface->format->Gmask |
+           surface->format->Bmask;
+}
+
+///
+/// \brief Averages two pixels, channel by channel.
+///
+/// \param first The first pixel to average.
+/// \param second The second pixel to average.
+/// \return The average of each channel, rounded down.
+///
+static inline uint32_t
+averagePixels (uint32_t first, uint32_t second)
+{
+    return (first & second) + (((first ^ second) & 0xfefefefe) >> 1);
+}
+
+///
+/// \brief Default constructor.
+///
+Fader::Fader (void):
+    m_BackBuffer (0),
+    m_FadedPixels (),
+    m_ReducedOutdated (true),
+    m_ReducedPixels ()
+{
+}
+
+///
+/// \brief Destructor.
+///
+Fader::~Fader (void)
+{
+    SDL_FreeSurface (m_BackBuffer);
+}
+
+///
+/// \brief Copies the screen to the back buffer.
+///
+void
+Fader::captureScreen (void)
+{
+    SDL_Surface *screen = System::getInstance ().getScreenSDLSurface ();
+    SDL_Surface *backBuffer = getBackBuffer ();
+    System::getInstance ().getCompositor ().flush ();
+
+    const size_t rowLength = screen->w * screen->format->BytesPerPixel;
+    SDL_LockSurface (screen);
+    for ( int y = 0 ; y < screen->h ; ++y )
+    {
+        const uint8_t *screenRow =
+            static_cast<uint8_t *>(screen->pixels) + y * screen->pitch;
+        std::copy (screenRow, screenRow + rowLength,
+                   static_cast<uint8_t *>(backBuffer->pixels) +
+                   y * backBuffer->pitch);
+    }
+    SDL_UnlockSurface (screen);
+}
+
+///
+/// \brief Blends black over a whole surface.
+///
+/// \param surface The surface to dim.
+/// \param alpha The alpha to blend black with.
+///
+void
+Fader::dim (Surface &surface, uint8_t alpha)
+{
+    System::getInstance ().getCompositor ().flush ();
+    SDL_Surface *pixels = surface.toSDLSurface ();
+    if ( canFade (pixels) )
+    {
+        SDL_LockSurface (pixels);
+        Blitter::fade (static_cast<uint32_t *>(pixels->pixels), pixels->pitch,
+                       static_cast<uint32_t *>(pixels->pixels), pixels->pitch,
+                       pixels->w, pixels->h, Surface::k_MaxAlpha - alpha,
+                       getColorMask (pixels));
+        SDL_UnlockSurface (pixels);
+    }
+    else
+    {
+        SDL_Surface *blackBox =
+            SDL_CreateRGBSurfaceWithFormat (0, pixels->w, pixels->h,
+                                            pixels->format->BitsPerPixel,
+                                            pixels->format->format);
+        if ( 0 == blackBox )
+        {
+            throw std::runtime_error (SDL_GetError ());
+        }
+        SDL_FillRect (blackBox, NULL, SDL_MapRGB (blackBox->format, 0, 0, 0));
+        SDL_SetSurfaceAlphaMod (blackBox, alpha);
+        SDL_SetSurfaceBlendMode (blackBox, SDL_BLENDMODE_BLEND);
+        SDL_BlitSurface (blackBox, NULL, pixels, NULL);
+        SDL_FreeSurface (blackBox);
+    }
+}
+
+///
+/// \brief Draws the back buffer faded to black to the whole screen.
+///
+/// \param alpha The alpha of the back buffer over black.
+/// \param screen The screen to draw the back buffer to.
+///
+void
+Fader::draw (uint8_t alpha, SDL_Surface *screen)
+{
+    assert (0 != m_BackBuffer && "Tried to draw a missing back buffer.");
+    // Fading draws the whole screen, over the recorded blits.
+    System::getInstance ().getCompositor ().flush ();
+
+    SDL_Surface *backBuffer = m_BackBuffer;
+    if ( canFade (screen) && backBuffer->w == screen->w &&
+         backBuffer->h == screen->h &&
+         backBuffer->format->format == screen->format->format )
+    {
+        if ( screen->w >= k_ReducedResolutionWidth )
+        {
+            drawReduced (alpha, screen);
+        }
+        else
+        {
+            SDL_LockSurface (screen);
+            Blitter::fade (static_cast<uint32_t *>(backBuffer->pixels),
+                           backBuffer->pitch,
+                           static_cast<uint32_t *>(screen->pixels),
+                           screen->pitch, screen->w, screen->h, alpha,
+                           getColorMask (screen));
+            SDL_UnlockSurface (screen);
+        }
+    }
+    else
+    {
+        SDL_FillRect (screen, NULL, SDL_MapRGB (screen->format, 0, 0, 0));
+        SDL_SetSurfaceAlphaMod (backBuffer, alpha);
+        SDL_SetSurfaceBlendMode (backBuffer, SDL_BLENDMODE_BLEND);
+        SDL_BlitSurface (backBuffer, NULL, screen, NULL);
+        SDL_SetSurfaceAlphaMod (backBuffer, Surface::k_MaxAlpha);
+        SDL_SetSurfaceBlendMode (backBuffer, SDL_BLENDMODE_NONE);
+    }
+
+    SDL_Rect screenRect;
+    screenRect.x = 0;
+    screenRect.y = 0;
+    screenRect.w = screen->w;
+    screenRect.h = screen->h;
+    System::getInstance ().invalidateScreenRegion (&screenRect);
+}
+
+///
+/// \brief Draws the back buffer faded at half resolution.
+///
+/// Each faded pixel is drawn as a square of four pixels on the screen.
+///
+/// \param alpha The alpha of the back buffer over black.
+/// \param screen The screen to draw the back buffer to.
+///
+void
+Fader::drawReduced (uint8_t alpha, SDL_Surface *screen)
+{
+    if ( m_ReducedOutdated )
+    {
+        reduceBackBuffer ();
+    }
+
+    const int reducedWidth = (screen->w + 1) / 2;
+    const int reducedHeight = (screen->h + 1) / 2;
+    m_FadedPixels.resize (m_ReducedPixels.size ());
+    Blitter::fade (&m_ReducedPixels[0], reducedWidth * sizeof (uint32_t),
+                   &m_FadedPixels[0], reducedWidth * sizeof (uint32_t),
+                   reducedWidth, reducedHeight, alpha, getColorMask (screen));
+
+    SDL_LockSurface (screen);
+    for ( int y = 0 ; y < screen->h ; ++y )
+    {
+        uint32_t *screenRow = reinterpret_cast<uint32_t *>(
+                static_cast<uint8_t *>(screen->pixels) + y * screen->pitch);
+        if ( 1 == y % 2 )
+        {
+            std::copy (screenRow - screen->pitch / sizeof (uint32_t),
+                       screenRow - screen->pitch / sizeof (uint32_t) +
+                       screen->w, screenRow);
+            continue;
+        }
+        const uint32_t *fadedRow = &m_FadedPixels[(y / 2) * reducedWidth];
+        for ( int x = 0 ; x < screen->w ; ++x )
+        {
+            screenRow[x] = fadedRow[x / 2];
+        }
+    }
+    SDL_UnlockSurface (screen);
+}
+
+///
+/// \brief Gets the back buffer.
+///
+/// The back buffer has the screen's size and format.  It is created
+/// again when the screen changes.
+///
+/// \return The surface to draw the screen to fade to.
+///
+SDL_Surface *
+Fader::getBackBuffer (void)
+{
+    SDL_Surface *screen = System::getInstance ().getScreenSDLSurface ();
+    if ( 0 == m_BackBuffer || m_BackBuffer->w != screen->w ||
+         m_BackBuffer->h != screen->h ||
+         m_BackBuffer->format->format != screen->format->format )
+    {
+        SDL_FreeSurface (m_BackBuffer);
+        m_BackBuffer =
+            SDL_CreateRGBSurfaceWithFormat (0, screen->w, screen->h,
+                                            screen->format->BitsPerPixel,
+                                            screen->format->format);
+        if ( 0 == m_BackBuffer )
+        {
+            throw std::runtime_error (SDL_GetError ());
+        }
+        SDL_SetSurfaceBlendMode (m_BackBuffer, SDL_BLENDMODE_NONE);
+    }
+    // Whoever asks for the back buffer is going to draw to it.
+    m_ReducedOutdated = true;
+
+    return m_BackBuffer;
+}
+
+///
+/// \brief Gets the only instance of Fader.
+///
+/// \return The only available instance of Fader.
+/// \warning This code is not thread-safe.
+///
+Fader &
+Fader::getInstance (void)
+{
+    static Fader fader;
+    return fader;
+}
+
+///
+/// \brief Scales the back buffer down to half its resolution.
+///
+/// Each reduced pixel is the average of a square of four back buffer
+/// pixels.
+///
+void
+Fader::reduceBackBuffer (void)
+{
+    assert (0 != m_BackBuffer && "Tried to reduce a missing back buffer.");
+
+    const int reducedWidth = (m_BackBuffer->w + 1) / 2;
+    const int reducedHeight = (m_BackBuffer->h + 1) / 2;
+    m_ReducedPixels.resize (reducedWidth * reducedHeight);
+    SDL_LockSurface (m_BackBuffer);
+    for ( int y = 0 ; y < reducedHeight ; ++y )
+    {
+        const uint32_t *topRow = reinterpret_cast<uint32_t *>(
+                static_cast<uint8_t *>(m_BackBuffer->pixels) +
+                2 * y * m_BackBuffer->pitch);
+        const uint32_t *bottomRow = reinterpret_cast<uint32_t *>(
+                static_cast<uint8_t *>(m_BackBuffer->pixels) +
+                std::min (2 * y + 1, m_BackBuffer->h - 1) *
+                m_BackBuffer->pitch);
+        uint32_t *reducedRow = &m_ReducedPixels[y * reducedWidth];
+        for ( int x = 0 ; x < reducedWidth ; ++x )
+        {
+            const int left = 2 * x;
+            const int right = std::min (left + 1, m_BackBuffer->w - 1);
+            reducedRow[x] =
+                averagePixels (averagePixels (topRow[left], topRow[right]),
+                               averagePixels (bottomRow[left],
+                                              bottomRow[right]));
+        }
+    }
+    SDL_UnlockSurface (m_BackBuffer);
+    m_ReducedOutdated = false;
+}
@@ -0,0 +1,93 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_FADER_H)
+#define AMOEBAX_FADER_H
+
+#include <stdint.h>
+#include <vector>
+
+// Forward declarations.
+struct SDL_Surface;
+
+namespace Amoebax
+{
+    // Forward declarations.
+    class Surface;
+
+    ///
+    /// \class Fader.
+    /// \brief Fades and dims the whole screen.
+    ///
+    /// The fade states draw the screen faded to black every frame, so
+    /// the fader keeps a single back buffer in the screen's format that
+    /// every fade reuses, and multiplies it by the fade's alpha with
+    /// Blitter::fade() instead of blending it over a black screen.
+    /// On screens at least k_ReducedResolutionWidth pixels wide, the
+    /// fade is computed at half the resolution and then doubled.
+    ///
+    class Fader
+    {
+        public:
+            /// The minimum screen's width to fade at half resolution.
+            static const int k_ReducedResolutionWidth = 2560;
+
+            ~Fader (void);
+
+            void captureScreen (void);
+            static void dim (Surface &surface, uint8_t alpha);
+            void draw (uint8_t alpha, SDL_Surface *screen);
+            SDL_Surface *getBackBuffer (void);
+            static Fader &getInstance (void);
+
+        private:
+            // Prevent the Fader class to be instantied without
+            // calling getInstance().
+            Fader (void);
+
+            ///
+            /// \brief Copy constructor.
+            ///
+            /// \note This constructor is left unimplemented because we
+            /// don't want copies of Fader objects. Don't use it.
+            ///
+            Fader (const Fader &);
+
+            ///
+            /// \brief Assigment operator.
+            ///
+            /// \note This operator is left unimplemented because we don't
+            /// want copies of Fader objects. Don't use it.
+            ///
+            Fader &operator= (const Fader &);
+
+            void drawReduced (uint8_t alpha, SDL_Surface *screen);
+            void reduceBackBuffer (void);
+
+            /// The screen to fade, in the screen's format.
+            SDL_Surface *m_BackBuffer;
+            /// The faded pixels at half resolution.
+            std::vector<uint32_t> m_FadedPixels;
+            /// Tells if m_ReducedPixels must be computed again.
+            bool m_ReducedOutdated;
+            /// The back buffer's pixels at half resolution.
+            std::vector<uint32_t> m_ReducedPixels;
+    };
+}
+
+#endif // !AMOEBAX_FADER_H
@@ -18,6 +18,7 @@
 //
 #if defined (IS_WIN32_HOST)
 #include <dirent.h>
+#include <stdlib.h>
 #else // !IS_WIN32_HOST
 #include <unistd.h>
 #endif // IS_WIN32_HOST
@@ -57,6 +58,9 @@ File::ChangeWorkDirectory (const std::string &directory)
 ///
 /// \brief Gets the path to a data file.
 ///
+/// The data directory is the one in the AMOEBAX_DATADIR environment
+/// variable, if set, so the game can run from where it was built.
+///
 /// \param subdirectory The subdirectory where the file is located
 ///                     inside the data directory.
 /// \param fileName The name of the data file to get its path.
@@ -66,7 +70,9 @@ std::string
 File::getDataFilePath (const std::string &subdirectory,
                        const std::string &fileName)
 {
-    std::string filePath (k_DataDirectory);
+    const char *dataDirectory = getenv ("AMOEBAX_DATADIR");
+    std::string filePath (0 != dataDirectory ? dataDirectory :
+                                               k_DataDirectory);
     filePath += k_DirectorySeparator;
     filePath += subdirectory;
     filePath += k_DirectorySeparator;
@@ -0,0 +1,365 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <stdlib.h>
+#include <streambuf>
+#include <SDL.h>
+#if defined (__GNUG__)
+#include <cxxabi.h>
+#endif // __GNUG__
+#include "AIPlayer.h"
+#include "FlightRecorder.h"
+#include "FrameManager.h"
+#include "IState.h"
+
+using namespace Amoebax;
+
+// Class static members.
+IState *FlightRecorder::m_ActiveState = 0;
+std::vector<char> FlightRecorder::m_Boards (FlightRecorder::k_BoardsSize);
+size_t FlightRecorder::m_BoardsLength = 0;
+std::mutex FlightRecorder::m_DumpMutex;
+std::atomic<uint32_t> FlightRecorder::m_Dumps (0);
+std::atomic<uint32_t> FlightRecorder::m_LastFrameTime (0);
+std::string FlightRecorder::m_LogFileName ("amoebax-stalls.log");
+std::vector<char> FlightRecorder::m_NextBoards (FlightRecorder::k_BoardsSize);
+uint32_t FlightRecorder::m_NextDumpTime = 0;
+uint64_t FlightRecorder::m_PreviousAINodes = 0;
+std::vector<FlightRecorder::Record> FlightRecorder::m_Records (FlightRecorder::k_NumFrames);
+uint64_t FlightRecorder::m_RecordedFrames = 0;
+std::mutex FlightRecorder::m_RecordsMutex;
+std::condition_variable FlightRecorder::m_StopWatching;
+std::mutex FlightRecorder::m_StopMutex;
+std::thread FlightRecorder::m_Watchdog;
+bool FlightRecorder::m_Watching = false;
+
+// The definitions of the class' constants, for when they are used by reference.
+const size_t FlightRecorder::k_BoardsSize;
+const uint32_t FlightRecorder::k_HangTime;
+const uint32_t FlightRecorder::k_MinDumpInterval;
+const unsigned int FlightRecorder::k_NumFrames;
+const uint32_t FlightRecorder::k_SlowFrameFactor;
+const uint32_t FlightRecorder::k_WatchInterval;
+
+///
+/// \struct RecorderFinisher.
+/// \brief Stops the watchdog when the program exits.
+///
+/// It is defined after the recorder's members, so it is destroyed
+/// before them.
+///
+static struct RecorderFinisher
+{
+    ~RecorderFinisher (void)
+    {
+        FlightRecorder::stop ();
+    }
+} g_RecorderFinisher;
+
+///
+/// \class BoardsBuffer.
+/// \brief A stream buffer that writes to an array and drops what doesn't fit.
+///
+/// Writing the boards to it every frame doesn't allocate.
+///
+class BoardsBuffer: public std::streambuf
+{
+    public:
+        ///
+        /// \brief Starts writing at the beginning of an array.
+        ///
+        /// \param begin The array's first character.
+        /// \param size The array's size.
+        ///
+        void reset (char *begin, size_t size)
+        {
+            setp (begin, begin + size);
+        }
+
+        ///
+        /// \brief Gets the length of the text written since reset().
+        ///
+        /// \return The number of characters written.
+        ///
+        size_t getLength (void) const
+        {
+            return pptr () - pbase ();
+        }
+};
+
+/// The buffer the boards are written to.
+static BoardsBuffer g_BoardsBuffer;
+/// The stream that writes the boards to g_BoardsBuffer.
+static std::ostream g_BoardsStream (&g_BoardsBuffer);
+
+///
+/// \brief Gets the name of a state's class.
+///
+/// \param state The type of the state, or 0 for none.
+/// \return The state's class name, without the namespace.
+///
+static std::string
+getStateName (const std::type_info *state)
+{
+    if ( 0 == state )
+    {
+        return "none";
+    }
+    std::string name (state->name ());
+#if defined (__GNUG__)
+    int status = 0;
+    char *demangledName = abi::__cxa_demangle (state->name (), 0, 0, &status);
+    if ( 0 == status )
+    {
+        name = demangledName;
+    }
+    free (demangledName);
+#endif // __GNUG__
+    const std::string::size_type namespaceEnd = name.rfind ("::");
+    if ( std::string::npos != namespaceEnd )
+    {
+        name.erase (0, namespaceEnd + 2);
+    }
+    return name;
+}
+
+///
+/// \brief Appends the frames in the ring and the boards to the stall log.
+///
+/// \param reason Why the frames are dumped.
+///
+void
+FlightRecorder::dump (const std::string &reason)
+{
+    ++m_Dumps;
+    // Copy what the main thread recorded, so it can go on meanwhile.
+    std::vector<Record> records;
+    std::string boards;
+    uint64_t recordedFrames = 0;
+    {
+        std::lock_guard<std::mutex> lock (m_RecordsMutex);
+        records = m_Records;
+        boards.assign (&m_Boards[0], m_BoardsLength);
+        recordedFrames = m_RecordedFrames;
+    }
+
+    std::lock_guard<std::mutex> lock (m_DumpMutex);
+    std::ofstream log (m_LogFileName.c_str (), std::ios::app);
+    if ( !log )
+    {
+        std::cerr << "Couldn't open the stall log " << m_LogFileName <<
+            std::endl;
+        return;
+    }
+
+    log << "# Stall at " << SDL_GetTicks () << " ms: " << reason << std::endl;
+    log << "frame,time_ms,state,events_us,update_us,grid_us,ai_us,"
+           "background_us,render_us,present_us,ai_nodes,invalidated_pixels"
+        << std::endl;
+    for ( uint64_t frame = recordedFrames > k_NumFrames ?
+                           recordedFrames - k_NumFrames : 0 ;
+          frame < recordedFrames ; ++frame )
+    {
+        const Record &record = records[frame % k_NumFrames];
+        log << record.frame << "," << record.time << "," <<
+            getStateName (record.state);
+        for ( unsigned int phase = 0 ; phase < Profiler::k_NumPhases ; ++phase )
+        {
+            log << "," << record.phaseTimes[phase];
+        }
+        log << "," << record.aiNodes << "," << record.invalidatedArea << "\n";
+    }
+    log << "# Boards" << std::endl;
+    log << boards << std::endl;
+
+    std::cerr << "Stall: " << reason << ". The last frames were written to " <<
+        m_LogFileName << std::endl;
+}
+
+///
+/// \brief Adds the frame that just ended to the ring.
+///
+/// If the frame was slow, the ring is dumped, but no more often than
+/// every k_MinDumpInterval milliseconds.
+///
+/// \param invalidatedArea The number of pixels drawn again this frame.
+/// \note Call it after Profiler::endFrame(), from the main thread.
+///
+void
+FlightRecorder::endFrame (uint32_t invalidatedArea)
+{
+    const uint32_t now = SDL_GetTicks ();
+
+    // Write the boards now, while nothing changes them.
+    g_BoardsBuffer.reset (&m_NextBoards[0], m_NextBoards.size ());
+    g_BoardsStream.clear ();
+    if ( 0 != m_ActiveState )
+    {
+        m_ActiveState->writeBoards (g_BoardsStream);
+    }
+
+    uint64_t frame = 0;
+    uint32_t workTime = 0;
+    {
+        std::lock_guard<std::mutex> lock (m_RecordsMutex);
+        frame = m_RecordedFrames;
+        Record &record = m_Records[frame % k_NumFrames];
+
+        const uint64_t aiNodes = AIPlayer::getSearchedNodes ();
+        record.aiNodes = static_cast<uint32_t>(aiNodes - m_PreviousAINodes);
+        m_PreviousAINodes = aiNodes;
+        record.frame = frame;
+        record.invalidatedArea = invalidatedArea;
+        for ( unsigned int phase = 0 ; phase < Profiler::k_NumPhases ; ++phase )
+        {
+            record.phaseTimes[phase] =
+                Profiler::getPhaseTime (static_cast<Profiler::Phase>(phase));
+        }
+        record.state = 0 == m_ActiveState ? 0 : &typeid (*m_ActiveState);
+        record.time = now;
+        m_Boards.swap (m_NextBoards);
+        m_BoardsLength = g_BoardsBuffer.getLength ();
+        m_RecordedFrames = frame + 1;
+
+        // The events' phase is left out, since the states are created and
+        // load their resources there.  The grids and the computer players
+        // are already in the update's phase.
+        workTime = record.phaseTimes[Profiler::PhaseUpdate] +
+                   record.phaseTimes[Profiler::PhaseBackground] +
+                   record.phaseTimes[Profiler::PhaseRender] +
+                   record.phaseTimes[Profiler::PhasePresent];
+    }
+    m_LastFrameTime.store (now, std::memory_order_relaxed);
+
+    const uint32_t slowFrameTime = static_cast<uint32_t>(
+            k_SlowFrameFactor * 1000000.0f / FrameManager::getFrameRate ());
+    if ( workTime > slowFrameTime && now >= m_NextDumpTime )
+    {
+        m_NextDumpTime = now + k_MinDumpInterval;
+        std::ostringstream reason;
+        reason << "frame " << frame << " took " << workTime / 1000 << " ms";
+        dump (reason.str ());
+    }
+}
+
+///
+/// \brief Gets the number of dumps so far.
+///
+/// \return The times the ring was dumped, because of a slow frame or
+///         a hung main loop.
+///
+uint32_t
+FlightRecorder::getNumberOfDumps (void)
+{
+    return m_Dumps;
+}
+
+///
+/// \brief Sets the state whose boards are recorded.
+///
+/// \param state The active state, or 0 before the states are deleted.
+/// \note Call it from the main thread.
+///
+void
+FlightRecorder::setActiveState (IState *state)
+{
+    m_ActiveState = state;
+}
+
+///
+/// \brief Sets the file the dumps are appended to.
+///
+/// \param fileName The stall log's name.
+///
+void
+FlightRecorder::setLogFileName (const std::string &fileName)
+{
+    m_LogFileName = fileName;
+}
+
+///
+/// \brief Starts timing the frames and watching the main loop.
+///
+/// The profiler's timers keep running until the program exits.
+///
+void
+FlightRecorder::start (void)
+{
+    if ( m_Watchdog.joinable () )
+    {
+        return;
+    }
+    Profiler::setAlwaysEnabled (true);
+    m_LastFrameTime.store (SDL_GetTicks (), std::memory_order_relaxed);
+    m_Watching = true;
+    m_Watchdog = std::thread (watch);
+}
+
+///
+/// \brief Stops the watchdog.
+///
+void
+FlightRecorder::stop (void)
+{
+    if ( !m_Watchdog.joinable () )
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock (m_StopMutex);
+        m_Watching = false;
+    }
+    m_StopWatching.notify_one ();
+    m_Watchdog.join ();
+}
+
+///
+/// \brief Dumps the ring once each time the main loop hangs.
+///
+void
+FlightRecorder::watch (void)
+{
+    bool hung = false;
+    std::unique_lock<std::mutex> lock (m_StopMutex);
+    while ( m_Watching )
+    {
+        m_StopWatching.wait_for (lock,
+                                 std::chrono::milliseconds (k_WatchInterval));
+        const uint32_t lastFrameTime =
+            m_LastFrameTime.load (std::memory_order_relaxed);
+        const uint32_t stuckTime = SDL_GetTicks () - lastFrameTime;
+        if ( stuckTime < k_HangTime )
+        {
+            hung = false;
+        }
+        else if ( m_Watching && !hung )
+        {
+            hung = true;
+            std::ostringstream reason;
+            reason << "the main loop is stuck for " << stuckTime << " ms";
+            lock.unlock ();
+            dump (reason.str ());
+            lock.lock ();
+        }
+    }
+}
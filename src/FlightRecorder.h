@@ -0,0 +1,160 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_FLIGHT_RECORDER_H)
+#define AMOEBAX_FLIGHT_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+#include "Profiler.h"
+
+namespace Amoebax
+{
+    // Forward declarations.
+    class IState;
+
+    ///
+    /// \class FlightRecorder.
+    /// \brief Keeps the last frames' telemetry and writes it when the game stalls.
+    ///
+    /// At the end of each frame, the main loop adds the phases' times,
+    /// the active state, the positions the computer players checked and
+    /// the screen's area drawn again to a ring of the last k_NumFrames
+    /// frames, and writes the active state's boards to a preallocated
+    /// buffer.  Only the main thread writes the ring and the boards, and
+    /// it only holds m_RecordsMutex while it adds the frame.
+    ///
+    /// The ring, followed by the boards at the end of the last frame, is
+    /// appended to the stall log when the work of a frame takes longer
+    /// than k_SlowFrameFactor frames, or when the watchdog thread sees
+    /// that no frame ended for k_HangTime milliseconds.  A dump copies
+    /// the ring and the boards under the mutex first, so the watchdog
+    /// never reads the states, which the main thread could still be
+    /// changing if it is only slow.
+    ///
+    class FlightRecorder
+    {
+        public:
+            /// The maximum size of the boards' text, in bytes.
+            static const size_t k_BoardsSize = 4096;
+            /// The milliseconds without a frame before the main loop is hung.
+            static const uint32_t k_HangTime = 3000;
+            /// The minimum milliseconds between two slow frame's dumps.
+            static const uint32_t k_MinDumpInterval = 10000;
+            /// The number of frames kept in the ring.
+            static const unsigned int k_NumFrames = 512;
+            /// The frames that a slow frame's work takes at least.
+            static const uint32_t k_SlowFrameFactor = 3;
+            /// The milliseconds between the watchdog's checks.
+            static const uint32_t k_WatchInterval = 250;
+
+            static void endFrame (uint32_t invalidatedArea);
+            static uint32_t getNumberOfDumps (void);
+            static void setActiveState (IState *state);
+            static void setLogFileName (const std::string &fileName);
+            static void start (void);
+            static void stop (void);
+
+        private:
+            // This class it not instanciable.
+            ///
+            /// \brief Default constructor.
+            ///
+            FlightRecorder (void);
+            ///
+            /// \brief Copy constructor.
+            ///
+            /// \note This constructor is left unimplemented because we
+            /// don't want copies of FlightRecorder. Don't use it.
+            ///
+            FlightRecorder (const FlightRecorder &);
+            ///
+            /// \brief Assigment operator.
+            ///
+            /// \note This operator is left unimplemented because we
+            /// don't want copies of FlightRecorder. Don't use it.
+            ///
+            FlightRecorder &operator= (const FlightRecorder &);
+
+            ///
+            /// \struct Record.
+            /// \brief The telemetry of a frame.
+            ///
+            struct Record
+            {
+                /// The positions the computer players checked.
+                uint32_t aiNodes;
+                /// The frame's number.
+                uint64_t frame;
+                /// The number of pixels drawn again.
+                uint32_t invalidatedArea;
+                /// The time of each phase, in microseconds.
+                uint32_t phaseTimes[Profiler::k_NumPhases];
+                /// The type of the active state, or 0 for none.
+                const std::type_info *state;
+                /// The time the frame ended at, in milliseconds.
+                uint32_t time;
+            };
+
+            static void dump (const std::string &reason);
+            static void watch (void);
+
+            /// The state whose boards are recorded, or 0 for none.
+            static IState *m_ActiveState;
+            /// The boards' text at the end of the last frame.
+            static std::vector<char> m_Boards;
+            /// The length of the text in m_Boards.
+            static size_t m_BoardsLength;
+            /// Serializes the writes to the stall log.
+            static std::mutex m_DumpMutex;
+            /// The number of dumps started so far.
+            static std::atomic<uint32_t> m_Dumps;
+            /// The time the main loop ended its last frame at, in ms.
+            static std::atomic<uint32_t> m_LastFrameTime;
+            /// The file the dumps are appended to.
+            static std::string m_LogFileName;
+            /// The buffer the boards of the frame being ended are written to.
+            static std::vector<char> m_NextBoards;
+            /// The time a slow frame can be dumped again at, in ms.
+            static uint32_t m_NextDumpTime;
+            /// The positions the computer players checked until the last frame.
+            static uint64_t m_PreviousAINodes;
+            /// The telemetry of the last frames, at their number modulo k_NumFrames.
+            static std::vector<Record> m_Records;
+            /// The number of frames added to m_Records.
+            static uint64_t m_RecordedFrames;
+            /// Protects m_Boards, m_BoardsLength, m_Records and m_RecordedFrames.
+            static std::mutex m_RecordsMutex;
+            /// Wakes the watchdog up to stop.
+            static std::condition_variable m_StopWatching;
+            /// Protects m_Watching.
+            static std::mutex m_StopMutex;
+            /// The thread that checks whether the main loop is hung.
+            static std::thread m_Watchdog;
+            /// Tells if the watchdog must keep checking.
+            static bool m_Watching;
+    };
+}
+
+#endif // !AMOEBAX_FLIGHT_RECORDER_H
@@ -19,19 +19,60 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
+#include <assert.h>
+#include <fstream>
 #include <numeric>
 #include <SDL.h>
 #include <algorithm>
 #include <functional>
+#include <stdexcept>
 #include "Font.h"
 
 using namespace Amoebax;
 
+/// The first line of the glyph table files.
+static const char *k_GlyphTableSignature = "amoebax-glyphs 1";
+/// The extension of the glyph table files.
+static const char *k_GlyphTableExtension = ".glyphs";
+
+///
+/// \brief Computes the checksum of a file.
+///
+/// The checksum is the 32-bit FNV-1a hash of the file's bytes.
+///
+/// \param fileName The file to compute the checksum of.
+/// \param checksum Set to the checksum of \p fileName.
+/// \return \a false if \p fileName couldn't be read.
+///
+static bool
+getFileChecksum (const std::string &fileName, uint32_t &checksum)
+{
+    std::ifstream file (fileName.c_str (), std::ios::in | std::ios::binary);
+    if ( !file )
+    {
+        return false;
+    }
+
+    checksum = 2166136261u;
+    char buffer[4096];
+    while ( file.read (buffer, sizeof (buffer)) || 0 < file.gcount () )
+    {
+        for ( std::streamsize byte = 0 ; byte < file.gcount () ; ++byte )
+        {
+            checksum ^= static_cast<uint8_t>(buffer[byte]);
+            checksum *= 16777619u;
+        }
+    }
+    return file.eof ();
+}
+
 ///
 /// \brief Font's default constructor.
 ///
 Font::Font (void):
-    m_FontSurface (nullptr)
+    m_FontSurface (nullptr),
+    m_TextRunIndex (),
+    m_TextRuns ()
 {
 }
 
@@ -42,7 +83,9 @@ Font::Font (void):
 ///
 Font::Font (const Font &font):
     m_CharacterInformation (font.m_CharacterInformation),
-    m_FontSurface (new Surface (*font.m_FontSurface))
+    m_FontSurface (new Surface (*font.m_FontSurface)),
+    m_TextRunIndex (),
+    m_TextRuns ()
 {
 }
 
@@ -56,6 +99,50 @@ Font::~Font (void)
 {
 }
 
+///
+/// \brief Gets a text rendered with the font.
+///
+/// The text is only rendered the first time it is written.  The font
+/// keeps the last k_MaxTextRuns texts written and forgets about the
+/// least recently used text when it needs room for a new one.
+///
+/// \param text The text to get rendered.
+/// \return The surface with the rendered text, or 0 if \a text is empty.
+///
+Surface *
+Font::getTextRun (const std::string &text) const
+{
+    std::map<std::string, TextRunList::iterator>::iterator index =
+        m_TextRunIndex.find (text);
+    if ( m_TextRunIndex.end () != index )
+    {
+        m_TextRuns.splice (m_TextRuns.begin (), m_TextRuns, index->second);
+        return m_TextRuns.front ().surface.get ();
+    }
+
+    uint16_t width = getTextWidth (text);
+    if ( 0 == width )
+    {
+        return 0;
+    }
+    TextRun textRun;
+    textRun.text = text;
+    textRun.surface.reset (m_FontSurface->createCompatible (width,
+                                                            getHeight ()));
+    std::for_each (text.begin (), text.end (),
+                   TextWrite (this, textRun.surface.get ()));
+    m_TextRuns.push_front (std::move (textRun));
+    m_TextRunIndex[text] = m_TextRuns.begin ();
+
+    if ( m_TextRuns.size () > k_MaxTextRuns )
+    {
+        m_TextRunIndex.erase (m_TextRuns.back ().text);
+        m_TextRuns.pop_back ();
+    }
+
+    return m_TextRuns.front ().surface.get ();
+}
+
 ///
 /// \brief Gets the width that would take a text rendered.
 ///
@@ -69,6 +156,61 @@ Font::getTextWidth (const std::string &text) const
                             static_cast<uint16_t>(0), TextWidth (this));
 }
 
+///
+/// \brief Finds the characters in the font's bitmap.
+///
+/// The characters are separated by pink columns in the bitmap's first row.
+///
+void
+Font::findCharacters (void)
+{
+    SDL_Surface *surface = m_FontSurface->toSDLSurface ();
+    assert (4 == surface->format->BytesPerPixel &&
+            "Tried to find the characters of a font that is not 32-bit.");
+
+    // Gets the surface's pink color.
+    const uint32_t pinkColor = SDL_MapRGB (surface->format, 255, 0, 255);
+    m_CharacterInformation.clear ();
+    SDL_LockSurface (surface);
+    const uint32_t *row = static_cast<uint32_t *>(surface->pixels);
+    int16_t x = 0;
+    while ( x < surface->w )
+    {
+        if ( pinkColor != row[x] )
+        {
+            Character character;
+            character.first = x;
+            while ( x < surface->w && pinkColor != row[x] )
+            {
+                x++;
+            }
+            character.second = x;
+            m_CharacterInformation.push_back (character);
+        }
+        x++;
+    }
+    SDL_UnlockSurface (surface);
+}
+
+///
+/// \brief Gets the glyph table file of a font.
+///
+/// \param fileName The font's file name.
+/// \return The file name of the glyph table that goes with \p fileName.
+///
+std::string
+Font::getGlyphTableFilePath (const std::string &fileName)
+{
+    std::string::size_type extension = fileName.rfind ('.');
+    std::string::size_type directory = fileName.find_last_of ("/\\");
+    if ( std::string::npos == extension ||
+         (std::string::npos != directory && extension < directory) )
+    {
+        return fileName + k_GlyphTableExtension;
+    }
+    return fileName.substr (0, extension) + k_GlyphTableExtension;
+}
+
 ///
 /// \brief Creates a new from from a file.
 ///
@@ -80,7 +222,7 @@ Font::fromFile (const std::string &fileName)
 {
     Font *newFont = new Font ();
     newFont->m_FontSurface.reset(Surface::fromFile (fileName));
-    newFont->init ();
+    newFont->init (fileName);
 
     return newFont;
 }
@@ -88,35 +230,126 @@ Font::fromFile (const std::string &fileName)
 ///
 /// \brief Initializes the font.
 ///
+/// \param fileName The file name the font was loaded from.
+///
 void
-Font::init (void)
+Font::init (const std::string &fileName)
 {
-    // Gets the surface's pink color.
-    const uint32_t pinkColor = SDL_MapRGB (m_FontSurface->toSDLSurface ()->format,
-                                           255, 0, 255);
-    uint16_t x = 0;
-    m_CharacterInformation.clear ();
-    while ( x < m_FontSurface->toSDLSurface ()->w )
+    if ( !loadGlyphTable (fileName) )
     {
-        if ( pinkColor != m_FontSurface->getPixel (x, 0) )
-        {
-            Character character;
-            character.first = x;
-            while ( (x < m_FontSurface->toSDLSurface ()->w) &&
-                    (pinkColor != m_FontSurface->getPixel (x, 0)) )
-            {
-                x++;
-            }
-            character.second = x;
-            m_CharacterInformation.push_back (character);
-        }
-        x++;
+        findCharacters ();
     }
     uint32_t transparentPixel =
         m_FontSurface->getPixel (0, m_FontSurface->toSDLSurface ()->h - 1);
     m_FontSurface->setColorKey (transparentPixel);
 }
 
+///
+/// \brief Loads the characters' information from the font's glyph table.
+///
+/// The glyph table is only used when its checksum matches the font's
+/// file and all its characters are inside the font's bitmap.
+///
+/// \param fontFileName The file name the font was loaded from.
+/// \return \a true if the characters' information was loaded, \a false
+///         if they must be found in the bitmap.
+///
+bool
+Font::loadGlyphTable (const std::string &fontFileName)
+{
+    std::ifstream table (getGlyphTableFilePath (fontFileName).c_str ());
+    if ( !table )
+    {
+        return false;
+    }
+
+    std::string signature;
+    uint32_t checksum = 0;
+    uint32_t fontChecksum = 0;
+    size_t numberOfCharacters = 0;
+    if ( !std::getline (table, signature) ||
+         signature != k_GlyphTableSignature ||
+         !(table >> std::hex >> checksum >> std::dec >> numberOfCharacters) ||
+         !getFileChecksum (fontFileName, fontChecksum) ||
+         checksum != fontChecksum )
+    {
+        return false;
+    }
+
+    std::vector<Character> characters;
+    characters.reserve (numberOfCharacters);
+    int16_t previousEnd = 0;
+    for ( size_t current = 0 ; current < numberOfCharacters ; ++current )
+    {
+        Character character;
+        if ( !(table >> character.first >> character.second) ||
+             character.first < previousEnd ||
+             character.second <= character.first ||
+             character.second > m_FontSurface->getWidth () )
+        {
+            return false;
+        }
+        previousEnd = character.second;
+        characters.push_back (character);
+    }
+
+    m_CharacterInformation.swap (characters);
+    return true;
+}
+
+///
+/// \brief Saves the characters' information to a glyph table.
+///
+/// \param fontFileName The file name the font was loaded from.
+/// \param fileName The file to save the glyph table to.  Fonts only load
+///                 the glyph table from getGlyphTableFilePath().
+///
+void
+Font::saveGlyphTable (const std::string &fontFileName,
+                      const std::string &fileName) const
+{
+    uint32_t checksum = 0;
+    if ( !getFileChecksum (fontFileName, checksum) )
+    {
+        throw std::runtime_error ("Couldn't read the font " + fontFileName);
+    }
+
+    std::ofstream table (fileName.c_str ());
+    table << k_GlyphTableSignature << std::endl;
+    table << std::hex << checksum << std::dec << std::endl;
+    table << m_CharacterInformation.size () << std::endl;
+    for ( std::vector<Character>::const_iterator character =
+            m_CharacterInformation.begin () ;
+          character != m_CharacterInformation.end () ; ++character )
+    {
+        table << character->first << " " << character->second << std::endl;
+    }
+    if ( !table )
+    {
+        throw std::runtime_error ("Couldn't write the glyph table " +
+                                  fileName);
+    }
+}
+
+///
+/// \brief Renders some characters before they are written.
+///
+/// writeCharacters() renders each character the first time it writes
+/// it.  Preparing all the characters a text can have, like the digits
+/// of a score, renders them while loading instead.
+///
+/// \param characters The characters to render.
+///
+void
+Font::prepareCharacters (const std::string &characters) const
+{
+    for ( std::string::const_iterator character = characters.begin () ;
+          character != characters.end () ; ++character )
+    {
+        getTextRun (std::string (1, *character));
+    }
+}
+
 ///
 /// \brief Writes a text on a given position.
 ///
@@ -129,8 +362,11 @@ void
 Font::write (const std::string &text, uint16_t x, uint16_t y,
              SDL_Surface *destination) const
 {
-    std::for_each (text.begin (), text.end (),
-                   TextWrite (x, y, this, destination));
+    Surface *textRun = getTextRun (text);
+    if ( 0 != textRun )
+    {
+        textRun->blit (x, y, destination);
+    }
 }
 
 ///
@@ -145,3 +381,28 @@ Font::write (const std::string &text, uint16_t y, SDL_Surface *destination) cons
 {
     write (text, destination->w / 2 - getTextWidth (text) / 2, y, destination);
 }
+
+///
+/// \brief Writes a text a character at a time.
+///
+/// Unlike write(), only each character is rendered and kept, so texts
+/// that change every frame, like the scores, neither push the other
+/// texts out of the font nor allocate memory to render them.
+///
+/// \param text The text to write.
+/// \param x The x coordinate to write the text to.
+/// \param y The y coordinate to write the text to.
+/// \param destination The surface to write the text to.
+///
+void
+Font::writeCharacters (const std::string &text, uint16_t x, uint16_t y,
+                       SDL_Surface *destination) const
+{
+    for ( std::string::const_iterator character = text.begin () ;
+          character != text.end () ; ++character )
+    {
+        const std::string characterText (1, *character);
+        write (characterText, x, y, destination);
+        x += getTextWidth (characterText);
+    }
+}
@@ -22,6 +22,8 @@
 #if !defined (AMOEBAX_FONT_H)
 #define AMOEBAX_FONT_H
 
+#include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -44,12 +46,18 @@ namespace Amoebax
             ~Font (void);
 
             uint16_t getHeight (void) const;
+            static std::string getGlyphTableFilePath (const std::string &fileName);
             uint16_t getTextWidth (const std::string &text) const;
             static Font *fromFile (const std::string &fileName);
+            void prepareCharacters (const std::string &characters) const;
+            void saveGlyphTable (const std::string &fontFileName,
+                                 const std::string &fileName) const;
             void write (const std::string &text, uint16_t x, uint16_t y,
                         SDL_Surface *destination) const;
             void write (const std::string &text, uint16_t y,
                         SDL_Surface *destination) const;
+            void writeCharacters (const std::string &text, uint16_t x,
+                                  uint16_t y, SDL_Surface *destination) const;
 
         private:
             ///
@@ -110,34 +118,30 @@ namespace Amoebax
             };
 
             ///
-            /// \brief Writes a text, character by character, using a font.
+            /// \brief Renders a text, character by character, using a font.
             ///
             struct TextWrite
             {
                 /// The font to use to write the text.
                 const Font *currentFont;
                 /// The surface where to write the text.
-                SDL_Surface *destination;
+                Surface *destination;
                 /// The current X position.
                 uint16_t x;
-                /// The current Y position.
-                uint16_t y;
 
                 ///
                 /// \brief Initializes the structure.
                 ///
-                /// \param initialX The initial X position.
-                /// \param initialY The initial Y position.
                 /// \param fontToUse The font to use.
-                /// \param surfaceDestination the surface to write the text to.
+                /// \param surfaceDestination The surface to write the text
+                ///                           to. It must be created by
+                ///                           the font's surface
+                ///                           createCompatible().
                 ///
-                TextWrite (uint16_t initialX, uint16_t initialY,
-                           const Font *fontToUse,
-                           SDL_Surface *surfaceDestination):
+                TextWrite (const Font *fontToUse, Surface *surfaceDestination):
                     currentFont (fontToUse),
                     destination (surfaceDestination),
-                    x (initialX),
-                    y (initialY)
+                    x (0)
                 {
                 }
 
@@ -162,15 +166,29 @@ namespace Amoebax
                         currentFont->m_CharacterInformation[offset];
                     if ( writeCharacter )
                     {
-                        currentFont->m_FontSurface->blit (character.first, 0,
-                                character.second - character.first,
+                        currentFont->m_FontSurface->copyPixels (character.first,
+                                0, character.second - character.first,
                                 currentFont->getHeight (),
-                                x, y, destination);
+                                x, 0, *destination);
                     }
                     x += character.second - character.first;
                 }
             };
 
+            ///
+            /// \brief A text already rendered with the font.
+            ///
+            struct TextRun
+            {
+                /// The rendered text.
+                std::string text;
+                /// The surface with the rendered text.
+                std::unique_ptr<Surface> surface;
+            };
+
+            /// The list of text runs, from most to least recently used.
+            typedef std::list<TextRun> TextRunList;
+
             // Only copy constructor and using fromFile() functions
             // ara available to create a Font object.
             Font (void);
@@ -184,12 +202,22 @@ namespace Amoebax
             ///
             Font &operator= (const Font &font);
 
-            void init (void);
+            void findCharacters (void);
+            Surface *getTextRun (const std::string &text) const;
+            void init (const std::string &fileName);
+            bool loadGlyphTable (const std::string &fontFileName);
+
+            /// The maximum number of text runs to keep rendered.
+            static const size_t k_MaxTextRuns = 64;
 
             /// Characters' space information.
             std::vector<Character> m_CharacterInformation;
             /// The actual font surface.
             std::unique_ptr<Surface> m_FontSurface;
+            /// The text runs rendered so far, looked up by their text.
+            mutable std::map<std::string, TextRunList::iterator> m_TextRunIndex;
+            /// The text runs rendered so far.
+            mutable TextRunList m_TextRuns;
     };
 
     ///
@@ -16,49 +16,66 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
+#include <algorithm>
 #include <SDL.h>
 #include "FrameManager.h"
 
 using namespace Amoebax;
 
 // Class static members.
+uint64_t FrameManager::m_CadenceStart = 0;
+uint64_t FrameManager::m_CurrentFrame = 0;
 uint32_t FrameManager::m_ElapsedTime = 0;
-float FrameManager::m_FrameRate = 1000.0f / 10.0f;
-uint32_t FrameManager::m_LastTicks = 0;
-uint32_t FrameManager::m_MeanElapsedTime = 0;
-uint32_t FrameManager::m_NumUpdates = 0;
-uint32_t FrameManager::m_TotalElapsedTime = 0;
-
-// The numner of milliseconds the elased time can be.
-static const uint32_t k_MinElapsedTime = 10;
-// The number of milliseconds to wait to compute the mean elapsed time.
-static const uint32_t k_TimeToComputeMean = 4096;
-
-namespace
-{
-    ///
-    /// \brief Clamps a value between a minimum and a maximum.
-    ///
-    /// \param value The value to clamp.
-    /// \param min The minimum value that \p value can have.
-    /// \param max The maximum value that \p value can have.
-    /// \return \p max if \p value is greater than \p max.
-    ///         \p min if \p value is less than \p min.
-    ///         \p value otherwise.
-    ///
-    template <typename type> type
-    clamp (type value, type min, type max)
-    {
-        if ( value < min )
-        {
-            return min;
-        }
-        else if ( value > max )
-        {
-            return max;
-        }
-        return value;
-    }
+uint64_t FrameManager::m_ElapsedRemainder = 0;
+bool FrameManager::m_FixedStep = false;
+float FrameManager::m_FrameRate = 10.0f;
+bool FrameManager::m_Idle = false;
+std::vector<uint32_t> FrameManager::m_InputLatencies;
+std::vector<uint32_t> FrameManager::m_Intervals;
+uint64_t FrameManager::m_LastCounter = 0;
+unsigned int FrameManager::m_NextInputLatency = 0;
+unsigned int FrameManager::m_NextInterval = 0;
+std::vector<uint32_t> FrameManager::m_PendingInputs;
+bool FrameManager::m_ScreenPresented = false;
+bool FrameManager::m_VSyncEnabled = false;
+
+// The definitions of the class' constants, for when they are used by reference.
+const uint32_t FrameManager::k_MaxElapsedTime;
+const unsigned int FrameManager::k_NumInputLatencies;
+const unsigned int FrameManager::k_NumIntervals;
+const uint32_t FrameManager::k_SpinTime;
+
+///
+/// \brief Gets a percentile of some samples.
+///
+/// \param samples The samples to get the percentile of.  Must not be empty.
+/// \param percentile The percentage, from 0 to 100, of \p samples that
+///                   are not greater than the returned sample.
+/// \return The sample at \p percentile.
+///
+static uint32_t
+getPercentile (const std::vector<uint32_t> &samples, float percentile)
+{
+    std::vector<uint32_t> sorted (samples);
+    std::vector<uint32_t>::iterator sample = sorted.begin () +
+        std::min (sorted.size () - 1,
+                  static_cast<size_t>(percentile / 100.0f * sorted.size ()));
+    std::nth_element (sorted.begin (), sample, sorted.end ());
+    return *sample;
+}
+
+///
+/// \brief Tells that the game applied an input.
+///
+/// The input's latency is measured when the next screen is presented.
+///
+/// \param time The time the input was received at, as returned by
+///             getCurrentTime().
+///
+void
+FrameManager::addAppliedInput (uint32_t time)
+{
+    m_PendingInputs.push_back (time);
 }
 
 ///
@@ -75,6 +92,11 @@ FrameManager::getCurrentTime (void)
 ///
 /// \brief Gets the number of milliseconds between the two previous updates.
 ///
+/// The fractions of millisecond are carried over to the next updates,
+/// so the elapsed times add up to the real time.  A frame never lasts
+/// more than k_MaxElapsedTime, so a long stall doesn't make the game
+/// jump ahead.
+///
 /// \return The milliseconds between the two last consecutive calls to update().
 ///
 uint32_t
@@ -83,6 +105,88 @@ FrameManager::getElapsedTime (void)
     return m_ElapsedTime;
 }
 
+///
+/// \brief Gets a percentile of the last frame intervals.
+///
+/// \param percentile The percentage, from 0 to 100, of the last
+///                   k_NumIntervals frame intervals that are not longer
+///                   than the returned interval.  For instance, 50 for
+///                   the median and 99 for the worst intervals.
+/// \return The frame interval in milliseconds, or 0 if there are no
+///         frames yet.
+///
+float
+FrameManager::getFrameInterval (float percentile)
+{
+    if ( m_Intervals.empty () )
+    {
+        return 0.0f;
+    }
+    return getPercentile (m_Intervals, percentile) / 1000.0f;
+}
+
+///
+/// \brief Gets the expected frame rate.
+///
+/// \return The frames per second set in init().
+///
+float
+FrameManager::getFrameRate (void)
+{
+    return m_FrameRate;
+}
+
+///
+/// \brief Gets a percentile of the last input latencies.
+///
+/// \param percentile The percentage, from 0 to 100, of the last
+///                   k_NumInputLatencies inputs that didn't take longer
+///                   than the returned latency to be presented.
+/// \return The milliseconds from an input to the screen that showed it,
+///         or 0 if no input was applied yet.
+///
+uint32_t
+FrameManager::getInputLatency (float percentile)
+{
+    if ( m_InputLatencies.empty () )
+    {
+        return 0;
+    }
+    return getPercentile (m_InputLatencies, percentile);
+}
+
+///
+/// \brief Gets the performance counter when a frame must start.
+///
+/// \param frame The number of frames since m_CadenceStart.
+/// \return The performance counter when \p frame must start.
+///
+uint64_t
+FrameManager::getFrameStart (uint64_t frame)
+{
+    return m_CadenceStart +
+           static_cast<uint64_t>(frame *
+                                 static_cast<double>(SDL_GetPerformanceFrequency ()) /
+                                 m_FrameRate);
+}
+
+///
+/// \brief Waits for an event instead of the next frame.
+///
+/// The next update() doesn't wait for the frame's start, counts the
+/// whole wait as elapsed, even if longer than k_MaxElapsedTime, so the
+/// states' timers keep the real time, and leaves the wait out of the
+/// frame intervals.
+///
+/// \param timeout The maximum milliseconds to wait for an event.
+///
+void
+FrameManager::idle (uint32_t timeout)
+{
+    SDL_WaitEventTimeout (NULL, static_cast<int>(timeout));
+    m_Idle = true;
+}
+
 ///
 /// \brief Initializes the frame manager.
 ///
@@ -91,43 +195,190 @@ FrameManager::getElapsedTime (void)
 void
 FrameManager::init (float frameRate)
 {
+    m_CadenceStart = SDL_GetPerformanceCounter ();
+    m_CurrentFrame = 0;
     m_ElapsedTime = 0;
-    m_FrameRate = 1000.0f / frameRate;
-    m_LastTicks = getCurrentTime ();
-    m_MeanElapsedTime = static_cast<uint32_t> (m_FrameRate);
-    m_NumUpdates = 0;
-    m_TotalElapsedTime = 0;
+    m_ElapsedRemainder = 0;
+    m_FrameRate = frameRate;
+    m_Idle = false;
+    m_InputLatencies.clear ();
+    m_InputLatencies.reserve (k_NumInputLatencies);
+    m_Intervals.clear ();
+    m_Intervals.reserve (k_NumIntervals);
+    m_LastCounter = m_CadenceStart;
+    m_NextInputLatency = 0;
+    m_NextInterval = 0;
+    m_PendingInputs.clear ();
+    m_ScreenPresented = false;
+}
+
+///
+/// \brief Tells if each frame counts as exactly one frame.
+///
+/// \return \a true if update() neither waits nor measures the elapsed time.
+///
+bool
+FrameManager::isFixedStep (void)
+{
+    return m_FixedStep;
+}
+
+///
+/// \brief Tells if presenting the screen waits for the next frame.
+///
+/// \return \a true if the screen is presented with vertical sync at
+///         the expected frame rate.
+///
+bool
+FrameManager::isVSyncEnabled (void)
+{
+    return m_VSyncEnabled;
+}
+
+///
+/// \brief Tells that the screen was presented.
+///
+/// Keeps the latency of the inputs applied since the previous
+/// screen, which is the first to show them.
+/// With vertical sync, presenting waited for the next frame, so the next
+/// update() doesn't wait too.
+///
+void
+FrameManager::screenPresented (void)
+{
+    const uint32_t now = getCurrentTime ();
+    for ( std::vector<uint32_t>::const_iterator input = m_PendingInputs.begin () ;
+          input != m_PendingInputs.end () ; ++input )
+    {
+        const uint32_t latency = now - std::min (now, *input);
+        if ( m_InputLatencies.size () < k_NumInputLatencies )
+        {
+            m_InputLatencies.push_back (latency);
+        }
+        else
+        {
+            m_InputLatencies[m_NextInputLatency] = latency;
+        }
+        m_NextInputLatency = (m_NextInputLatency + 1) % k_NumInputLatencies;
+    }
+    m_PendingInputs.clear ();
+    m_ScreenPresented = true;
+}
+
+///
+/// \brief Sets whether each frame counts as exactly one frame.
+///
+/// With a fixed step, update() doesn't wait for the frame's start and
+/// the elapsed time is always a frame at the expected frame rate,
+/// whatever the real interval was.  The real intervals are still kept
+/// for the statistics.
+///
+/// \param enabled \a true to play frames as fast as possible with a
+///                fixed elapsed time.
+///
+void
+FrameManager::setFixedStep (bool enabled)
+{
+    m_FixedStep = enabled;
+}
+
+///
+/// \brief Sets whether presenting the screen waits for the next frame.
+///
+/// \param enabled \a true if the screen is presented with vertical sync
+///                at the expected frame rate, so update() must not wait.
+///
+void
+FrameManager::setVSyncEnabled (bool enabled)
+{
+    m_VSyncEnabled = enabled;
 }
 
 ///
 /// \brief Updates the frame manager.
 ///
-/// If the time elapsed from the last call to this function
-/// is not the expected time for the give frame rate in init(),
-/// this function makes the application wait the time necessary to accomplish
-/// the exoected frame rate.
+/// If the time for the next frame given the frame rate in init()
+/// hasn't come yet, this function makes the application wait until
+/// then.  If the frame is late by a whole frame or more, or the last
+/// frame was idle, the next frames are counted again from now, instead
+/// of rushing them to catch up.  With vertical sync, it only waits if
+/// no screen was presented since the last update, and with a fixed
+/// step, it never waits.
 ///
 void
-FrameManager::update ()
-{
-    uint32_t elapsedTime = getCurrentTime () - m_LastTicks;
-    // Accumulate the elapsed time period and the number of updates.
-    m_TotalElapsedTime += elapsedTime;
-    ++m_NumUpdates;
-    // Clamp the elapsed time between a minimum and the mean of the
-    // previous computed period, to prevent a peak elapsed time much
-    // greater (like, 600ms or so)
-    m_ElapsedTime = clamp (elapsedTime, k_MinElapsedTime, m_MeanElapsedTime);
-    // If the period is over, compute its mean elapsed time.
-    if ( m_TotalElapsedTime > k_TimeToComputeMean )
+FrameManager::update (void)
+{
+    ++m_CurrentFrame;
+    // Presenting with vertical sync already waited, but only if there
+    // was something to present.
+    if ( !m_FixedStep && !(m_VSyncEnabled && m_ScreenPresented) && !m_Idle )
+    {
+        waitUntil (getFrameStart (m_CurrentFrame));
+    }
+    m_ScreenPresented = false;
+
+    const uint64_t counter = SDL_GetPerformanceCounter ();
+    const uint64_t frequency = SDL_GetPerformanceFrequency ();
+    const uint64_t interval = counter - m_LastCounter;
+    m_LastCounter = counter;
+
+    // Keep the interval for the statistics.
+    if ( !m_Idle )
+    {
+        const uint32_t microseconds =
+            static_cast<uint32_t>(std::min (1000000.0 * interval / frequency,
+                                            4000000000.0));
+        if ( m_Intervals.size () < k_NumIntervals )
+        {
+            m_Intervals.push_back (microseconds);
+        }
+        else
+        {
+            m_Intervals[m_NextInterval] = microseconds;
+        }
+        m_NextInterval = (m_NextInterval + 1) % k_NumIntervals;
+    }
+
+    // Count the elapsed milliseconds, carrying the fractions over.
+    const uint64_t elapsedTicks = m_FixedStep ?
+        static_cast<uint64_t>(frequency / m_FrameRate) : interval;
+    const uint64_t elapsed = elapsedTicks * 1000 + m_ElapsedRemainder;
+    m_ElapsedTime = static_cast<uint32_t>(elapsed / frequency);
+    m_ElapsedRemainder = elapsed % frequency;
+    if ( m_ElapsedTime > k_MaxElapsedTime && !m_Idle )
     {
-        m_MeanElapsedTime = m_TotalElapsedTime / m_NumUpdates + k_MinElapsedTime;
-        m_TotalElapsedTime = 0;
-        m_NumUpdates = 0;
+        m_ElapsedTime = k_MaxElapsedTime;
+        m_ElapsedRemainder = 0;
     }
-    m_LastTicks = getCurrentTime ();
-    if ( static_cast<uint32_t>(m_FrameRate) > elapsedTime )
+
+    if ( m_Idle || counter >= getFrameStart (m_CurrentFrame + 1) )
     {
-        SDL_Delay (static_cast<uint32_t>(m_FrameRate) - m_ElapsedTime);
+        m_CadenceStart = counter;
+        m_CurrentFrame = 0;
+    }
+    m_Idle = false;
+}
+
+///
+/// \brief Waits until the performance counter reaches a value.
+///
+/// Sleeping can take longer than asked for, so it only sleeps
+/// until k_SpinTime milliseconds before \p counter, and then spins.
+///
+/// \param counter The performance counter to wait for.
+///
+void
+FrameManager::waitUntil (uint64_t counter)
+{
+    const uint64_t frequency = SDL_GetPerformanceFrequency ();
+    const uint64_t spinTicks = frequency * k_SpinTime / 1000;
+    for ( uint64_t now = SDL_GetPerformanceCounter () ; now < counter ;
+          now = SDL_GetPerformanceCounter () )
+    {
+        if ( counter - now > spinTicks )
+        {
+            SDL_Delay (static_cast<uint32_t>((counter - now - spinTicks) *
+                                             1000 / frequency));
+        }
     }
 }
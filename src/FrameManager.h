@@ -20,20 +20,60 @@
 #define AMOEBAX_FRAME_MANAGER_H
 
 #include <stdint.h>
+#include <vector>
 
 namespace Amoebax
 {
     ///
     /// \class FrameManager.
     /// \brief Manages the system's frame rate.
+    ///
+    /// The frames start at fixed intervals from the performance
+    /// counter, so the frame rate doesn't drift.  To reach each frame's
+    /// start time, the manager sleeps while there is more than
+    /// k_SpinTime milliseconds left, and then spins.  When the screen
+    /// is presented with vertical sync at the same rate, presenting
+    /// already waits for the next frame and the manager doesn't wait,
+    /// unless the last frame had nothing to present.
+    ///
+    /// When the active state has nothing to animate, the system can
+    /// instead wait for an event with idle(), and the next update()
+    /// doesn't wait for the frame's start.
+    ///
+    /// With a fixed step, for benchmarks, the manager never waits and
+    /// each frame counts as exactly one frame at the expected rate, so
+    /// the game plays the same however fast the frames are.
+    ///
+    /// The manager also measures the latency from the players' inputs
+    /// to the first screen presented after the game applied them.
+    ///
     /// \note This class is not thread safe.
     ///
     class FrameManager
     {
         public:
+            /// The maximum number of milliseconds a frame can last.
+            static const uint32_t k_MaxElapsedTime = 100;
+            /// The number of input latencies kept for the statistics.
+            static const unsigned int k_NumInputLatencies = 256;
+            /// The number of frame intervals kept for the statistics.
+            static const unsigned int k_NumIntervals = 1024;
+            /// The milliseconds before the frame's start to stop sleeping.
+            static const uint32_t k_SpinTime = 2;
+
+            static void addAppliedInput (uint32_t time);
             static uint32_t getCurrentTime (void);
             static uint32_t getElapsedTime (void);
+            static float getFrameInterval (float percentile);
+            static float getFrameRate (void);
+            static uint32_t getInputLatency (float percentile);
+            static void idle (uint32_t timeout);
             static void init (float frameRate = 10.0f);
+            static bool isFixedStep (void);
+            static bool isVSyncEnabled (void);
+            static void screenPresented (void);
+            static void setFixedStep (bool enabled);
+            static void setVSyncEnabled (bool enabled);
             static void update (void);
 
         private:
@@ -66,18 +106,39 @@ namespace Amoebax
             ///
             FrameManager &operator= (const FrameManager &object);
 
+            static uint64_t getFrameStart (uint64_t frame);
+            static void waitUntil (uint64_t counter);
+
+            /// The performance counter when the current frames started.
+            static uint64_t m_CadenceStart;
+            /// The number of frames since m_CadenceStart.
+            static uint64_t m_CurrentFrame;
             /// The number of elapsed milliseconds from the last update.
             static uint32_t m_ElapsedTime;
+            /// The thousandths of a counter tick not yet in m_ElapsedTime.
+            static uint64_t m_ElapsedRemainder;
+            /// Tells if each frame counts as exactly one frame.
+            static bool m_FixedStep;
             /// Expected frame rate.
             static float m_FrameRate;
-            /// The number of clock ticks from the last update.
-            static uint32_t m_LastTicks;
-            /// The mean elapsed time from the previous period.
-            static uint32_t m_MeanElapsedTime;
-            /// The number of time the update() function was called the last period.
-            static uint32_t m_NumUpdates;
-            /// The number if elapsed milliseconds from the last mean computation.
-            static uint32_t m_TotalElapsedTime;
+            /// Tells if the last frame waited for an event with idle().
+            static bool m_Idle;
+            /// The last input latencies, in milliseconds.
+            static std::vector<uint32_t> m_InputLatencies;
+            /// The last frame intervals, in microseconds.
+            static std::vector<uint32_t> m_Intervals;
+            /// The performance counter at the last update.
+            static uint64_t m_LastCounter;
+            /// The position in m_InputLatencies of the next latency.
+            static unsigned int m_NextInputLatency;
+            /// The position in m_Intervals of the next interval.
+            static unsigned int m_NextInterval;
+            /// The time of the inputs applied since the last present.
+            static std::vector<uint32_t> m_PendingInputs;
+            /// Tells if the screen was presented since the last update.
+            static bool m_ScreenPresented;
+            /// Tells if presenting the screen waits for the next frame.
+            static bool m_VSyncEnabled;
     };
 }
 
@@ -19,12 +19,17 @@
 #include <algorithm>
 #include <assert.h>
 #include <cmath>
+#include <iterator>
+#include <ostream>
 #include "ChainLabel.h"
 #include "File.h"
 #include "Grid.h"
 #include "GridStatus.h"
 #include "PairGenerator.h"
+#include "Profiler.h"
+#include "Random.h"
 #include "System.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
@@ -211,12 +216,16 @@ static const float k_Sin[360] = {0.000000f, 0.017452f, 0.034899f, 0.052336f,
                                  -0.139173f, -0.121869f, -0.104528f, -0.087156f,
                                  -0.069756f, -0.052336f, -0.034899f, -0.017452f};
 
-// The speed of the horizontal movement of the queue.
-static const float k_QueueHorizontalSpeed = 0.10f;
-// The speed of the vertical movement of the queue.
-static const float k_QueueVerticalSpeed = 0.25f;
-// The speed of the satellite rotation, in degress/ms.
-static const float k_RotationSpeed = 0.5f;
+// The number of rotation units in a degree.
+static const int32_t k_RotationPerDegree = 1000;
+// The speed of the movement of the queue, in pixels/s.
+static const uint32_t k_QueueSpeed = 250;
+// The speed of the satellite rotation, in thousandths of degree/ms.
+static const int32_t k_RotationSpeed = 500;
+
+// The definitions of the class' constants, for when they are used by reference.
+const uint32_t Grid::k_TickTime;
+const uint16_t Grid::k_UnknownAppearance;
 
 ///
 /// \brief Constructor.
@@ -236,19 +245,23 @@ static const float k_RotationSpeed = 0.5f;
 /// \param queueSide The side where the queue is located at.
 /// \param score The initial grid's score.
 /// \param layout The grid's layout.
+/// \param silent Tells if the grid must not play its sounds, because
+///               its match isn't shown.
 ///
 Grid::Grid (uint16_t gridPositionX, uint16_t gridPositionY,
             uint16_t queuePositionX, uint16_t queuePositionY,
             uint16_t waitingGhostPositionX, uint16_t waitingGhostPositionY,
             uint16_t amoebaSize, QueueSide queueSide, uint32_t score,
-            Layout layout):
+            Layout layout, bool silent):
     m_ActiveAmoebas (0),
     m_AmoebaSize (amoebaSize),
     m_BlinkTime (0),
-    m_ChainLabels (0),
+    m_ChainLabels (),
+    m_ChainGhosts (0),
+    m_ChainGroup (0),
     m_CurrentStepChain (0),
-    m_CurrentRotationDegrees (0.0f),
-    m_DegreesUntilRotationDone (0.0f),
+    m_CurrentRotation (0),
+    m_DrawnCells (k_GridHeight * k_GridWidth, k_UnknownAppearance),
     m_DyingAmoebas (0),
     m_DyingTime (0),
     m_FallingPair (),
@@ -264,6 +277,7 @@ Grid::Grid (uint16_t gridPositionX, uint16_t gridPositionY,
     m_InactiveAmoebas (0),
     m_Layout (layout),
     m_MaxFallingSpeed (false),
+    m_MaxStepChain (0),
     m_OpponentGhostAmoebas (0),
     m_Queue (0),
     m_QueuedAmoebas (0),
@@ -273,19 +287,41 @@ Grid::Grid (uint16_t gridPositionX, uint16_t gridPositionY,
     m_QueuePositionY (queuePositionY),
     m_RemainingQueueHorizontalOffset (0),
     m_RemainingQueueVerticalOffset (0),
-    m_RotationDirection (1.0f),
+    m_RotationDirection (1),
+    m_RotationUntilDone (0),
     m_Score (score),
     m_SilhouetteFrame (0),
     m_SilhouetteFrameDirection (-1),
     m_SilhouetteTime (0),
+    m_UnusedAmoebas (0),
     m_WaitingInitialAmoebas (true),
     m_WaitingGhostAmoebas (0),
     m_WaitingGhostAmoebasNumber (0),
     m_WaitingGhostPositionX (waitingGhostPositionX),
     m_WaitingGhostPositionY (waitingGhostPositionY)
 {
-    // Load sounds.
-    m_DieSound.reset (Sound::fromFile (File::getSoundFilePath ("die.wav")));
+    // Load sounds, unless the grid is silent.
+    if ( !silent )
+    {
+        m_DieSound.reset (Sound::fromFile (File::getSoundFilePath ("die.wav")));
+    }
+
+    // Keep room for, and create, as many amoebas as the grid can hold,
+    // so the amoebas and chain labels coming and going don't allocate.
+    m_ActiveAmoebas.reserve (k_GridHeight * k_GridWidth);
+    m_ChainLabels.reserve (k_GridHeight * k_GridWidth);
+    m_ChainGhosts.reserve (k_GridHeight * k_GridWidth);
+    m_ChainGroup.reserve (k_GridHeight * k_GridWidth);
+    m_DyingAmoebas.reserve (k_GridHeight * k_GridWidth);
+    m_FloatingAmoebas.reserve (k_GridHeight * k_GridWidth);
+    m_InactiveAmoebas.reserve (k_GridHeight * k_GridWidth);
+    m_Queue.reserve (k_GridHeight * k_GridWidth);
+    m_QueuedAmoebas.reserve (k_GridHeight * k_GridWidth);
+    m_UnusedAmoebas.reserve (k_GridHeight * k_GridWidth);
+    for ( uint16_t amoeba = 0 ; amoeba < k_GridHeight * k_GridWidth ; ++amoeba )
+    {
+        m_UnusedAmoebas.push_back (new Amoeba (Amoeba::ColourNone));
+    }
 
     // Create the waiting ghost amoebas.
     // There's only 6 waiting amoebas, but the "neighbour" state
@@ -333,10 +369,6 @@ Grid::~Grid (void)
                    DeleteObject<Amoeba> ());
     m_ActiveAmoebas.clear ();
 
-    std::for_each (m_ChainLabels.begin (), m_ChainLabels.end (),
-                   DeleteObject<ChainLabel> ());
-    m_ChainLabels.clear ();
-
     std::for_each (m_InactiveAmoebas.begin (), m_InactiveAmoebas.end (),
                    DeleteObject<Amoeba> ());
     m_InactiveAmoebas.clear ();
@@ -345,6 +377,10 @@ Grid::~Grid (void)
                    DeleteObject<Amoeba> ());
     m_QueuedAmoebas.clear ();
 
+    std::for_each (m_UnusedAmoebas.begin (), m_UnusedAmoebas.end (),
+                   DeleteObject<Amoeba> ());
+    m_UnusedAmoebas.clear ();
+
     std::for_each (m_WaitingGhostAmoebas.begin (), m_WaitingGhostAmoebas.end (),
                    DeleteObject<Amoeba> ());
     m_WaitingGhostAmoebas.clear ();
@@ -366,23 +402,23 @@ Grid::~Grid (void)
 void
 Grid::addChainLabel (uint8_t stepChain, int16_t x, int16_t y)
 {
-    m_ChainLabels.push_back (new ChainLabel (stepChain, x, y,
-                                             y - getAmoebaSize ()));
+    m_ChainLabels.push_back (ChainLabel (stepChain, x, y,
+                                         y - getAmoebaSize ()));
 }
 
 ///
 /// \brief Adds a new amoebas pair.
 ///
-/// \param main The main amoeba of the pair.
-/// \param satellite The satellite amoeba of the pair. This is the one that
-///                  will rotate around \a main.
+/// \param main The colour of the pair's main amoeba.
+/// \param satellite The colour of the pair's satellite amoeba. This is the
+///                  one that will rotate around the main amoeba.
 ///
 void
-Grid::addNewPair (Amoeba *main, Amoeba *satellite)
+Grid::addNewPair (Amoeba::Colour main, Amoeba::Colour satellite)
 {
     // Just add the to the list of waiting amoebas.
-    m_InactiveAmoebas.push_back (main);
-    m_InactiveAmoebas.push_back (satellite);
+    m_InactiveAmoebas.push_back (newAmoeba (main));
+    m_InactiveAmoebas.push_back (newAmoeba (satellite));
     // Set up the initial amoebas.
     // We need to how 6 amoebas for the set up: The falling pair and
     // the two waiting pairs.
@@ -404,7 +440,10 @@ Grid::addNewPair (Amoeba *main, Amoeba *satellite)
 void
 Grid::clearDyingAmoebas (void)
 {
-    m_DieSound->play ();
+    if ( 0 != m_DieSound )
+    {
+        m_DieSound->play ();
+    }
 
     uint8_t amoebasErased = 0;
     for (std::vector<FallingAmoeba>::iterator currentAmoeba =
@@ -416,13 +455,12 @@ Grid::clearDyingAmoebas (void)
             ++amoebasErased;
         }
         setAmoebaAt (currentAmoeba->x, currentAmoeba->y, 0);
-        m_ActiveAmoebas.remove (currentAmoeba->amoeba);
-        delete currentAmoeba->amoeba;
+        releaseAmoeba (currentAmoeba->amoeba);
     }
     m_DyingAmoebas.clear ();
 
     // Activates all chain label.
-    std::for_each (getChainLabels ().begin (), getChainLabels ().end (),
+    std::for_each (m_ChainLabels.begin (), m_ChainLabels.end (),
                    std::mem_fn (&ChainLabel::activate));
 
     // Increment the score based on the number of non-ghost amoebas erased
@@ -515,6 +553,87 @@ Grid::getAmoebaAt (int16_t x, int16_t y) const
     return 0;
 }
 
+///
+/// \brief Gets how a cell of the grid looks like.
+///
+/// \param x The X position of the cell in the grid.
+/// \param y The Y position of the cell in the grid.
+/// \return A value that is different for each way the cell can be
+///         drawn, and 0 for empty cells and hidden amoebas.
+///
+uint16_t
+Grid::getCellAppearance (int16_t x, int16_t y) const
+{
+    Amoeba *amoeba = getAmoebaAt (x, y);
+    if ( 0 == amoeba || !amoeba->isVisible () )
+    {
+        return 0;
+    }
+    return ((amoeba->getColour () + 1) << 8) | amoeba->getState ();
+}
+
+///
+/// \brief Gets the screen position of a grid's cell.
+///
+/// This is the position where the amoebas that are settled in the cell
+/// are drawn.
+///
+/// \param x The X position of the cell in the grid.
+/// \param y The Y position of the cell in the grid.
+/// \param screenX Set to the X position of the cell's top-left corner.
+/// \param screenY Set to the Y position of the cell's top-left corner.
+///
+void
+Grid::getCellPosition (int16_t x, int16_t y,
+                       int16_t &screenX, int16_t &screenY) const
+{
+    screenX = getGridPositionX ();
+    screenY = getGridPositionY ();
+    if ( Grid::LayoutVertical == getLayout () )
+    {
+        screenX += x * getAmoebaSize ();
+        screenY += (y - k_FirstVisibleHeight) * getAmoebaSize ();
+    }
+    else if ( Grid::QueueSideLeft == getQueueSide () )
+    {
+        screenX -= (y + 1 - k_FirstVisibleHeight) * getAmoebaSize ();
+        screenY += x * getAmoebaSize ();
+    }
+    else
+    {
+        screenX += (y - k_FirstVisibleHeight) * getAmoebaSize ();
+        screenY -= (x + 1) * getAmoebaSize ();
+    }
+}
+
+///
+/// \brief Gets the cells that changed since they were last drawn.
+///
+/// A cell changes when an amoeba settles in it or leaves it, when its
+/// amoeba changes its state because of its neighbours, or when the
+/// amoeba blinks before dying.  The falling pair and the floating
+/// amoebas are not settled in any cell.  \see getUnsettledAmoebas().
+///
+/// \return The mask of cells to draw again.
+///
+Grid::CellMask
+Grid::getChangedCells (void) const
+{
+    CellMask changedCells;
+    for ( int16_t y = 0 ; y < k_GridHeight ; ++y )
+    {
+        for ( int16_t x = 0 ; x < k_GridWidth ; ++x )
+        {
+            const size_t cell = y * k_GridWidth + x;
+            if ( m_DrawnCells[cell] != getCellAppearance (x, y) )
+            {
+                changedCells.set (cell);
+            }
+        }
+    }
+    return changedCells;
+}
+
 ///
 /// \brief Gets the current satellite rotation degree.
 ///
@@ -523,7 +642,7 @@ Grid::getAmoebaAt (int16_t x, int16_t y) const
 inline int16_t
 Grid::getCurrentRotationDegree (void) const
 {
-    return static_cast<int16_t> (m_CurrentRotationDegrees);
+    return static_cast<int16_t> (m_CurrentRotation / k_RotationPerDegree);
 }
 
 ///
@@ -563,7 +682,7 @@ Grid::getFollowingFallingMainAmoeba (void) const
 
     followingMain.x = k_GridWidth / 2;
     followingMain.y = -1;
-    std::list<FallingPair>::const_iterator pair = m_Queue.begin ();
+    std::vector<FallingPair>::const_iterator pair = m_Queue.begin ();
     ++pair;
     assert (m_Queue.end () != pair &&
             "The pairs queue doesn't have two pairs" );
@@ -587,7 +706,7 @@ Grid::getFollowingFallingSatelliteAmoeba (void) const
 
     followingSatellite.x = k_GridWidth / 2;
     followingSatellite.y = -1;
-    std::list<FallingPair>::const_iterator pair = m_Queue.begin ();
+    std::vector<FallingPair>::const_iterator pair = m_Queue.begin ();
     ++pair;
     assert (m_Queue.end () != pair &&
             "The pairs queue doesn't have two pairs" );
@@ -611,7 +730,7 @@ Grid::getNextFallingMainAmoeba (void) const
 
     nextMain.x = k_GridWidth / 2;
     nextMain.y = -1;
-    std::list<FallingPair>::const_iterator pair = m_Queue.begin ();
+    std::vector<FallingPair>::const_iterator pair = m_Queue.begin ();
     assert (m_Queue.end () != pair && "The pairs queue is empty" );
     nextMain.amoeba = pair->main.amoeba;
 
@@ -633,7 +752,7 @@ Grid::getNextFallingSatelliteAmoeba (void) const
 
     nextSatellite.x = k_GridWidth / 2;
     nextSatellite.y = -2;
-    std::list<FallingPair>::const_iterator pair = m_Queue.begin ();
+    std::vector<FallingPair>::const_iterator pair = m_Queue.begin ();
     assert (m_Queue.end () != pair && "The pairs queue is empty" );
     nextSatellite.amoeba = pair->satellite.amoeba;
 
@@ -658,10 +777,10 @@ Grid::getNextPair (void)
             "Tried to get the next pair, but the inactive list is empty.");
 
     // Gets the next pair from the inactive list.
-    Amoeba *main = m_InactiveAmoebas.front ();
-    m_InactiveAmoebas.pop_front ();
-    Amoeba *satellite = m_InactiveAmoebas.front ();
-    m_InactiveAmoebas.pop_front ();
+    Amoeba *main = m_InactiveAmoebas[0];
+    Amoeba *satellite = m_InactiveAmoebas[1];
+    m_InactiveAmoebas.erase (m_InactiveAmoebas.begin (),
+                             m_InactiveAmoebas.begin () + 2);
     // And set them to queued.
     m_QueuedAmoebas.push_back (main);
     m_QueuedAmoebas.push_back (satellite);
@@ -756,20 +875,53 @@ Grid::getQueuePositionY (void) const
 GridStatus
 Grid::getState (void) const
 {
-    std::vector<Amoeba::Colour> state (k_GridWidth * k_GridHeight,
-                                       Amoeba::ColourNone);
-    assert (state.size () == m_Grid.size () &&
+    Amoeba::Colour state[k_GridWidth * k_GridHeight];
+    assert (k_GridWidth * k_GridHeight == m_Grid.size () &&
             "The state's size and the grid's size doesn't match.");
-    for ( uint16_t currentAmoeba = 0 ; currentAmoeba < state.size () ;
+    for ( uint16_t currentAmoeba = 0 ; currentAmoeba < m_Grid.size () ;
           ++currentAmoeba )
     {
         Amoeba *amoeba = m_Grid.at (currentAmoeba);
-        if ( 0 != amoeba )
+        state[currentAmoeba] =
+            0 != amoeba ? amoeba->getColour () : Amoeba::ColourNone;
+    }
+    return GridStatus (state);
+}
+
+///
+/// \brief Gets the active amoebas that are not settled in a cell.
+///
+/// These are the amoebas of the falling pair and the floating amoebas,
+/// which move each frame.
+///
+/// \param amoebas The vector to set the unsettled amoebas to, in the
+///                same order as getActiveAmoebas().  Its memory is
+///                reused to sort the settled amoebas, so passing the
+///                same vector each frame doesn't allocate.
+///
+void
+Grid::getUnsettledAmoebas (std::vector<Amoeba *> &amoebas) const
+{
+    // The settled amoebas are at the beginning of the vector until
+    // the unsettled are found.
+    amoebas.clear ();
+    std::remove_copy (m_Grid.begin (), m_Grid.end (),
+                      std::back_inserter (amoebas),
+                      static_cast<Amoeba *>(0));
+    std::sort (amoebas.begin (), amoebas.end ());
+    const size_t numSettledAmoebas = amoebas.size ();
+
+    for ( std::vector<Amoeba *>::const_iterator amoeba = m_ActiveAmoebas.begin () ;
+          amoeba != m_ActiveAmoebas.end () ; ++amoeba )
+    {
+        if ( !std::binary_search (amoebas.begin (),
+                                  amoebas.begin () + numSettledAmoebas,
+                                  *amoeba) )
         {
-            state.at (currentAmoeba) = amoeba->getColour ();
+            amoebas.push_back (*amoeba);
         }
     }
-    return GridStatus (state);
+    amoebas.erase (amoebas.begin (), amoebas.begin () + numSettledAmoebas);
 }
 
 ///
@@ -838,7 +990,7 @@ Grid::isQueueMoving (void) const
 inline bool
 Grid::isSatelliteRotating (void) const
 {
-    return 0 != static_cast<int16_t> (m_DegreesUntilRotationDone);
+    return 0 != m_RotationUntilDone / k_RotationPerDegree;
 }
 
 ///
@@ -854,13 +1006,25 @@ Grid::incrementNumberOfWaitingGhosts (uint8_t amount)
     updateWaitingGhosts ();
 }
 
+///
+/// \brief Marks all cells as changed.
+///
+/// Used when whatever the cells were drawn to was lost.
+///
+void
+Grid::invalidateCells (void)
+{
+    std::fill (m_DrawnCells.begin (), m_DrawnCells.end (),
+               k_UnknownAppearance);
+}
+
 ///
 /// \brief Sets the waiting ghost as falling amoebas.
 ///
 void
 Grid::makeGhostsFall (void)
 {
-    std::vector<uint8_t> emptyPositions (k_GridWidth);
+    uint8_t emptyPositions[k_GridWidth];
     uint8_t remainingGhosts = getNumberOfWaitingGhosts ();
     int8_t remainingPositions = 0;
     int8_t y = -1;
@@ -872,19 +1036,19 @@ Grid::makeGhostsFall (void)
             for ( uint8_t currentPosition = 0 ; currentPosition < k_GridWidth ;
                   ++currentPosition )
             {
-                emptyPositions.at (currentPosition) = currentPosition;
+                emptyPositions[currentPosition] = currentPosition;
             }
             y -= 1;
             remainingPositions = k_GridWidth;
         }
-        uint8_t horizontalPositionIndex = rand () % remainingPositions;
-        int8_t x = emptyPositions.at (horizontalPositionIndex);
-        emptyPositions.at (horizontalPositionIndex) =
-        emptyPositions.at (remainingPositions - 1);
+        uint8_t horizontalPositionIndex = Random::get () % remainingPositions;
+        int8_t x = emptyPositions[horizontalPositionIndex];
+        emptyPositions[horizontalPositionIndex] =
+            emptyPositions[remainingPositions - 1];
         --remainingPositions;
 
         FallingAmoeba ghostAmoeba;
-        ghostAmoeba.amoeba = new Amoeba (Amoeba::ColourGhost);
+        ghostAmoeba.amoeba = newAmoeba (Amoeba::ColourGhost);
         ghostAmoeba.y = y;
         ghostAmoeba.x = x;
         m_ActiveAmoebas.push_back (ghostAmoeba.amoeba);
@@ -903,8 +1067,8 @@ Grid::makeGhostsFall (void)
 /// \param ghosts The ghosts amoebas that are in contact with the group.
 /// \param x The X position to look for a posible group candidate.
 /// \param y The Y position to look for a possible group candidate.
-/// \param visitedPositions The set of the already visited positions by the
-///                         algorithm. Initially should be empty.
+/// \param visitedCells The cells already visited by the algorithm.
+///                     Initially should be empty.
 /// \param colour The colour the amoeba should be to be part of the group.
 /// \param initialAmoeba Tells if the amoeba \a x and \a y should be the
 ///        first amoeba of the group.
@@ -912,17 +1076,17 @@ Grid::makeGhostsFall (void)
 void
 Grid::makeGroup (std::vector<FallingAmoeba> &group,
                  std::vector<FallingAmoeba> &ghosts, int16_t x, int16_t y,
-                 std::set<std::pair<int16_t, int16_t> > &visitedPositions,
+                 CellMask &visitedCells,
                  Amoeba::Colour colour, bool initialAmoeba)
 {
-    // Only check this possition if we didn't visited it yet.
-    if ( visitedPositions.end () ==
-            visitedPositions.find (std::make_pair (x, y)) )
+    // If there's any amoeba at the given position, check if is a member
+    // of the group.  There are no amoebas out of the grid.
+    Amoeba *amoeba = getAmoebaAt (x, y);
+    if ( 0 != amoeba && !amoeba->isDying () )
     {
-        // If there's any amoeba at the given position, check if is a member
-        // of the group.
-        Amoeba *amoeba = getAmoebaAt (x, y);
-        if ( 0 != amoeba && !amoeba->isDying () )
+        // Only check this possition if we didn't visited it yet.
+        const size_t cell = y * k_GridWidth + x;
+        if ( !visitedCells.test (cell) )
         {
             // The initial amoeba is always a member of the group, so
             // we get its colour and make it the group's colour.
@@ -941,7 +1105,7 @@ Grid::makeGroup (std::vector<FallingAmoeba> &group,
                 ghosts.push_back (ghost);
 
                 // Add the current position to the already visited positions.
-                visitedPositions.insert (std::make_pair (x, y));
+                visitedCells.set (cell);
             }
             else if ( colour == amoeba->getColour () )
             {
@@ -953,13 +1117,13 @@ Grid::makeGroup (std::vector<FallingAmoeba> &group,
                 group.push_back (groupMember);
 
                 // Add the current position to the already visited positions.
-                visitedPositions.insert (std::make_pair (x, y));
+                visitedCells.set (cell);
 
                 // Check neighbours.
-                makeGroup (group, ghosts, x, y - 1, visitedPositions, colour, false);
-                makeGroup (group, ghosts, x + 1, y, visitedPositions, colour, false);
-                makeGroup (group, ghosts, x, y + 1, visitedPositions, colour, false);
-                makeGroup (group, ghosts, x - 1, y, visitedPositions, colour, false);
+                makeGroup (group, ghosts, x, y - 1, visitedCells, colour, false);
+                makeGroup (group, ghosts, x + 1, y, visitedCells, colour, false);
+                makeGroup (group, ghosts, x, y + 1, visitedCells, colour, false);
+                makeGroup (group, ghosts, x - 1, y, visitedCells, colour, false);
             }
         }
     }
@@ -974,15 +1138,18 @@ Grid::makeGroup (std::vector<FallingAmoeba> &group,
 void
 Grid::makeChain (void)
 {
+    AMOEBAX_TRACE_ZONE ("Grid::makeChain");
     // First delete all groups.
+    std::vector<FallingAmoeba> &group = m_ChainGroup;
+    std::vector<FallingAmoeba> &ghosts = m_ChainGhosts;
     for ( int16_t row = 0 ; row < k_GridHeight ; ++row )
     {
         for ( int16_t column = 0 ; column < k_GridWidth ; ++column )
         {
-            std::set<std::pair<int16_t, int16_t> > visitedPositions;
-            std::vector<FallingAmoeba> group;
-            std::vector<FallingAmoeba> ghosts;
-            makeGroup (group, ghosts, column, row, visitedPositions);
+            CellMask visitedCells;
+            group.clear ();
+            ghosts.clear ();
+            makeGroup (group, ghosts, column, row, visitedCells);
             if ( 4 <= group.size () )
             {
                 int16_t meanXPosition = 0;
@@ -1061,6 +1228,24 @@ Grid::markAsFilled (void)
     m_Filled = true;
 }
 
+///
+/// \brief Marks all cells as drawn.
+///
+/// After calling this function, getChangedCells() returns only the cells
+/// that change from now on.
+///
+void
+Grid::markCellsAsDrawn (void)
+{
+    for ( int16_t y = 0 ; y < k_GridHeight ; ++y )
+    {
+        for ( int16_t x = 0 ; x < k_GridWidth ; ++x )
+        {
+            m_DrawnCells[y * k_GridWidth + x] = getCellAppearance (x, y);
+        }
+    }
+}
+
 ///
 /// \brief Moves the falling amoeba pair a position to the left.
 ///
@@ -1095,6 +1280,43 @@ Grid::moveRight (void)
     }
 }
 
+///
+/// \brief Gets a new amoeba.
+///
+/// The amoebas that left the grid are reused before allocating new ones.
+///
+/// \param colour The new amoeba's colour.
+/// \return The new amoeba, owned by the grid.
+///
+Amoeba *
+Grid::newAmoeba (Amoeba::Colour colour)
+{
+    if ( m_UnusedAmoebas.empty () )
+    {
+        return new Amoeba (colour);
+    }
+    Amoeba *amoeba = m_UnusedAmoebas.back ();
+    m_UnusedAmoebas.pop_back ();
+    *amoeba = Amoeba (colour);
+    return amoeba;
+}
+
+///
+/// \brief Removes an amoeba from the active amoebas.
+///
+/// The amoeba is kept to be reused by newAmoeba().
+///
+/// \param amoeba The active amoeba to remove.
+///
+void
+Grid::releaseAmoeba (Amoeba *amoeba)
+{
+    m_ActiveAmoebas.erase (std::remove (m_ActiveAmoebas.begin (),
+                                        m_ActiveAmoebas.end (), amoeba),
+                           m_ActiveAmoebas.end ());
+    m_UnusedAmoebas.push_back (amoeba);
+}
+
 ///
 /// \brief Removes some waiting ghost amoebas.
 ///
@@ -1127,8 +1349,8 @@ Grid::rotateClockwise (void)
 {
     if ( !isSatelliteRotating () )
     {
-        m_DegreesUntilRotationDone = 90.0f;
-        m_RotationDirection = -1.0f;
+        m_RotationUntilDone = 90 * k_RotationPerDegree;
+        m_RotationDirection = -1;
 
         if ( m_FallingPair.satellite.y < m_FallingPair.main.y )
         {
@@ -1147,7 +1369,7 @@ Grid::rotateClockwise (void)
             else
             {
                 // Can't rotate
-                m_DegreesUntilRotationDone = 0.0f;
+                m_RotationUntilDone = 0;
             }
         }
         else if ( m_FallingPair.satellite.y > m_FallingPair.main.y )
@@ -1167,7 +1389,7 @@ Grid::rotateClockwise (void)
             else
             {
                 // Can't rotate
-                m_DegreesUntilRotationDone = 0.0f;
+                m_RotationUntilDone = 0;
             }
         }
         else if ( m_FallingPair.satellite.x > m_FallingPair.main.x )
@@ -1180,7 +1402,7 @@ Grid::rotateClockwise (void)
             else
             {
                 // Can't rotate
-                m_DegreesUntilRotationDone = 0.0f;
+                m_RotationUntilDone = 0;
             }
         }
         else
@@ -1199,8 +1421,8 @@ Grid::rotateCounterClockwise (void)
 {
     if ( !isSatelliteRotating () )
     {
-        m_DegreesUntilRotationDone = 90.0f;
-        m_RotationDirection = 1.0f;
+        m_RotationUntilDone = 90 * k_RotationPerDegree;
+        m_RotationDirection = 1;
         if ( m_FallingPair.satellite.y < m_FallingPair.main.y )
         {
             if ( 0 < m_FallingPair.main.x &&
@@ -1218,7 +1440,7 @@ Grid::rotateCounterClockwise (void)
             else
             {
                 // Can't rotate
-                m_DegreesUntilRotationDone = 0.0f;
+                m_RotationUntilDone = 0;
             }
         }
         else if ( m_FallingPair.satellite.y > m_FallingPair.main.y )
@@ -1238,7 +1460,7 @@ Grid::rotateCounterClockwise (void)
             else
             {
                 // Can't rotate
-                m_DegreesUntilRotationDone = 0.0f;
+                m_RotationUntilDone = 0;
             }
         }
         else if ( m_FallingPair.satellite.x < m_FallingPair.main.x )
@@ -1251,7 +1473,7 @@ Grid::rotateCounterClockwise (void)
             else
             {
                 // Can't rotate
-                m_DegreesUntilRotationDone = 0.0f;
+                m_RotationUntilDone = 0;
             }
         }
         else
@@ -1265,26 +1487,26 @@ Grid::rotateCounterClockwise (void)
 ///
 /// \brief Rotates the satellite amoeba.
 ///
-/// \param degreesToRotate The degrees to make rotate the satellite amoeba.
+/// \param rotation The rotation to make the satellite amoeba rotate, in
+///                 thousandths of degree.
 ///
 void
-Grid::rotateSatelliteAmoeba (float degreesToRotate)
+Grid::rotateSatelliteAmoeba (int32_t rotation)
 {
-    if ( degreesToRotate > m_DegreesUntilRotationDone )
+    if ( rotation > m_RotationUntilDone )
     {
-        degreesToRotate = m_DegreesUntilRotationDone;
+        rotation = m_RotationUntilDone;
     }
 
-    m_DegreesUntilRotationDone -= degreesToRotate;
-    degreesToRotate *= m_RotationDirection;
-    m_CurrentRotationDegrees += degreesToRotate;
-    if ( m_CurrentRotationDegrees > 360.0f )
+    m_RotationUntilDone -= rotation;
+    m_CurrentRotation += rotation * m_RotationDirection;
+    if ( m_CurrentRotation >= 360 * k_RotationPerDegree )
     {
-        m_CurrentRotationDegrees -= 360.0f;
+        m_CurrentRotation -= 360 * k_RotationPerDegree;
     }
-    else if ( m_CurrentRotationDegrees < 0 )
+    else if ( m_CurrentRotation < 0 )
     {
-        m_CurrentRotationDegrees += 360.0f;
+        m_CurrentRotation += 360 * k_RotationPerDegree;
     }
     setFallingAmoebaScreenPosition (m_FallingPair.satellite,
                                     m_FallingPair.verticalOffset,
@@ -1378,10 +1600,10 @@ Grid::scheduleFallingPair (void)
             "Tried to get the next pair, but the inactive list is empty.");
 
     // Gets the next pair from the inactive list.
-    Amoeba *main = m_InactiveAmoebas.front ();
-    m_InactiveAmoebas.pop_front ();
-    Amoeba *satellite = m_InactiveAmoebas.front ();
-    m_InactiveAmoebas.pop_front ();
+    Amoeba *main = m_InactiveAmoebas[0];
+    Amoeba *satellite = m_InactiveAmoebas[1];
+    m_InactiveAmoebas.erase (m_InactiveAmoebas.begin (),
+                             m_InactiveAmoebas.begin () + 2);
     // And set them to queued.
     m_QueuedAmoebas.push_back (main);
     m_QueuedAmoebas.push_back (satellite);
@@ -1467,7 +1689,7 @@ Grid::setFallingAmoebaScreenPosition (FallingAmoeba &fallingAmoeba,
             if ( 0 <= getCurrentRotationDegree () &&
                       getCurrentRotationDegree () < 90 )
             {
-                if ( m_RotationDirection < 0.0f )
+                if ( m_RotationDirection < 0 )
                 {
                     directionX = -1;
                     directionY = 0;
@@ -1481,7 +1703,7 @@ Grid::setFallingAmoebaScreenPosition (FallingAmoeba &fallingAmoeba,
             else if ( 90 <= getCurrentRotationDegree () &&
                             getCurrentRotationDegree () < 180 )
             {
-                if ( m_RotationDirection < 0.0f )
+                if ( m_RotationDirection < 0 )
                 {
                     directionX = 0;
                     directionY = 1;
@@ -1495,7 +1717,7 @@ Grid::setFallingAmoebaScreenPosition (FallingAmoeba &fallingAmoeba,
             else if ( 180 <= getCurrentRotationDegree () &&
                              getCurrentRotationDegree () < 270 )
             {
-                if ( m_RotationDirection < 0.0f )
+                if ( m_RotationDirection < 0 )
                 {
                     directionX = 1;
                     directionY = 0;
@@ -1508,7 +1730,7 @@ Grid::setFallingAmoebaScreenPosition (FallingAmoeba &fallingAmoeba,
             }
             else if ( getCurrentRotationDegree () >= 270 )
             {
-                if ( m_RotationDirection < 0.0f )
+                if ( m_RotationDirection < 0 )
                 {
                     directionX = 0;
                     directionY = -1;
@@ -1544,7 +1766,7 @@ Grid::setFallingAmoebaScreenPosition (FallingAmoeba &fallingAmoeba,
             if ( 0 <= getCurrentRotationDegree () &&
                     getCurrentRotationDegree () < 90 )
             {
-                if ( m_RotationDirection < 0.0f )
+                if ( m_RotationDirection < 0 )
                 {
                     directionY = -1;
                     directionX = 0;
@@ -1558,7 +1780,7 @@ Grid::setFallingAmoebaScreenPosition (FallingAmoeba &fallingAmoeba,
             else if ( 90 <= getCurrentRotationDegree () &&
                     getCurrentRotationDegree () < 180 )
             {
-                if ( m_RotationDirection < 0.0f )
+                if ( m_RotationDirection < 0 )
                 {
                     directionY = 0;
                     directionX = 1;
@@ -1572,7 +1794,7 @@ Grid::setFallingAmoebaScreenPosition (FallingAmoeba &fallingAmoeba,
             else if ( 180 <= getCurrentRotationDegree () &&
                     getCurrentRotationDegree () < 270 )
             {
-                if ( m_RotationDirection < 0.0f )
+                if ( m_RotationDirection < 0 )
                 {
                     directionY = 1;
                     directionX = 0;
@@ -1585,7 +1807,7 @@ Grid::setFallingAmoebaScreenPosition (FallingAmoeba &fallingAmoeba,
             }
             else if ( getCurrentRotationDegree () >= 270 )
             {
-                if ( m_RotationDirection < 0.0f )
+                if ( m_RotationDirection < 0 )
                 {
                     directionY = 0;
                     directionX = -1;
@@ -1685,22 +1907,22 @@ void
 Grid::setupFallingPair (void)
 {
     // Get the two first queued amoebas and set it to be active.
-    m_ActiveAmoebas.push_back (m_QueuedAmoebas.front ());
-    m_QueuedAmoebas.pop_front ();
-    m_ActiveAmoebas.push_back (m_QueuedAmoebas.front ());
-    m_QueuedAmoebas.pop_front ();
+    m_ActiveAmoebas.insert (m_ActiveAmoebas.end (), m_QueuedAmoebas.begin (),
+                            m_QueuedAmoebas.begin () + 2);
+    m_QueuedAmoebas.erase (m_QueuedAmoebas.begin (),
+                           m_QueuedAmoebas.begin () + 2);
 
     m_FallingPair = m_Queue.front ();
-    m_Queue.pop_front ();
+    m_Queue.erase (m_Queue.begin ());
     // Set the screen position without any vertical offset. The grid
     // position is set at getNextPair().
     setFallingAmoebaScreenPosition (m_FallingPair.main, 0, false);
     setFallingAmoebaScreenPosition (m_FallingPair.satellite, 0, false);
 
     // Reset the current rotation.
-    m_CurrentRotationDegrees = 90.0f;
-    m_DegreesUntilRotationDone = 0.0f;
-    m_RotationDirection = 1.0f;
+    m_CurrentRotation = 90 * k_RotationPerDegree;
+    m_RotationUntilDone = 0;
+    m_RotationDirection = 1;
 
     // Now set the remainig pair to be the next to fall and
     // add a new pair.
@@ -1759,7 +1981,9 @@ Grid::setSilhouetteFrame (int8_t frame)
 /// \brief Updates the grid.
 ///
 /// Moves the amoebax according to its state and the time elapsed from the last
-/// time this function was called, as specified in \a elapsedTime.
+/// time this function was called, as specified in \a elapsedTime.  The
+/// states call it once for each logic tick, with k_TickTime, so the game
+/// plays the same whatever the frame rate.
 ///
 /// \param elapsedTime The elapsed time between the previous and current call,
 ///                    in milliseconds.
@@ -1767,6 +1991,13 @@ Grid::setSilhouetteFrame (int8_t frame)
 void
 Grid::update (uint32_t elapsedTime)
 {
+    Profiler::Timer timer (Profiler::PhaseGrid);
+    // Keep where the amoebas were, to draw them between ticks.
+    std::for_each (m_ActiveAmoebas.begin (), m_ActiveAmoebas.end (),
+                   std::mem_fn (&Amoeba::keepPosition));
+    std::for_each (m_QueuedAmoebas.begin (), m_QueuedAmoebas.end (),
+                   std::mem_fn (&Amoeba::keepPosition));
+
     // Only update if we are no waiting the initial amoebas
     // and the grid is not filled.
     if ( !m_WaitingInitialAmoebas && !isFilled () )
@@ -1780,11 +2011,11 @@ Grid::update (uint32_t elapsedTime)
         setOpponentGhostAmoebas (0);
 
         // Remove old label chain labels.
-        for ( std::list<ChainLabel *>::iterator currentLabel =
+        for ( std::vector<ChainLabel>::iterator currentLabel =
                 m_ChainLabels.begin () ;
               currentLabel != m_ChainLabels.end () ; )
         {
-            if ( !(*currentLabel)->isAlive () )
+            if ( !currentLabel->isAlive () )
             {
                 currentLabel = m_ChainLabels.erase (currentLabel);
             }
@@ -1794,12 +2025,12 @@ Grid::update (uint32_t elapsedTime)
             }
         }
         // And update the remaining.
-        for ( std::list<ChainLabel *>::iterator currentLabel =
+        for ( std::vector<ChainLabel>::iterator currentLabel =
                 m_ChainLabels.begin () ;
               currentLabel != m_ChainLabels.end () ;
               ++currentLabel )
         {
-            (*currentLabel)->update (elapsedTime);
+            currentLabel->update (elapsedTime);
         }
 
         if ( m_FloatingAmoebas.empty () && m_DyingAmoebas.empty () &&
@@ -1822,8 +2053,8 @@ Grid::update (uint32_t elapsedTime)
 
             if ( isSatelliteRotating () )
             {
-                float degreesToRotate = k_RotationSpeed * elapsedTime;
-                rotateSatelliteAmoeba (degreesToRotate);
+                rotateSatelliteAmoeba (k_RotationSpeed *
+                                       static_cast<int32_t> (elapsedTime));
             }
 
             m_FallingPair.fallingTime -= elapsedTime;
@@ -1895,7 +2126,7 @@ Grid::update (uint32_t elapsedTime)
         else if ( !m_FloatingAmoebas.empty () )
         {
             m_FloatingAmoebasVerticalOffset += getAmoebaSize () / 2;
-            std::list<FallingAmoeba>::iterator floatingAmoeba =
+            std::vector<FallingAmoeba>::iterator floatingAmoeba =
                 m_FloatingAmoebas.begin ();
             while ( floatingAmoeba != m_FloatingAmoebas.end () )
             {
@@ -1917,8 +2148,7 @@ Grid::update (uint32_t elapsedTime)
                         }
                         else
                         {
-                            m_ActiveAmoebas.remove (floatingAmoeba->amoeba);
-                            delete floatingAmoeba->amoeba;
+                            releaseAmoeba (floatingAmoeba->amoeba);
                         }
                         floatingAmoeba =
                             m_FloatingAmoebas.erase (floatingAmoeba);
@@ -1987,7 +2217,7 @@ void
 Grid::updateQueue (uint32_t elapsedTime)
 {
     uint16_t queueHorizontalOffset =
-        static_cast<uint16_t> (k_QueueVerticalSpeed * elapsedTime);
+        static_cast<uint16_t> (k_QueueSpeed * elapsedTime / 1000);
     if ( queueHorizontalOffset > m_RemainingQueueHorizontalOffset )
     {
         queueHorizontalOffset = m_RemainingQueueHorizontalOffset;
@@ -1995,7 +2225,7 @@ Grid::updateQueue (uint32_t elapsedTime)
     m_RemainingQueueHorizontalOffset -= queueHorizontalOffset;
 
     uint16_t queueVerticalOffset =
-        static_cast<uint16_t> (k_QueueVerticalSpeed * elapsedTime);
+        static_cast<uint16_t> (k_QueueSpeed * elapsedTime / 1000);
     if ( queueVerticalOffset > m_RemainingQueueVerticalOffset )
     {
         queueVerticalOffset = m_RemainingQueueVerticalOffset;
@@ -2021,7 +2251,7 @@ Grid::updateQueue (uint32_t elapsedTime)
         }
     }
 
-    std::list<Amoeba *>::iterator currentAmoeba = m_QueuedAmoebas.begin () ;
+    std::vector<Amoeba *>::iterator currentAmoeba = m_QueuedAmoebas.begin () ;
     for ( int amoebaNum = 0 ; currentAmoeba != m_QueuedAmoebas.end () ;
           ++currentAmoeba, ++amoebaNum )
     {
@@ -2055,22 +2285,23 @@ Grid::updateQueue (uint32_t elapsedTime)
         m_QueueIsMoving = false;
 
         // Get the two first queued amoebas and set it to be active.
-        m_ActiveAmoebas.push_back (m_QueuedAmoebas.front ());
-        m_QueuedAmoebas.pop_front ();
-        m_ActiveAmoebas.push_back (m_QueuedAmoebas.front ());
-        m_QueuedAmoebas.pop_front ();
+        m_ActiveAmoebas.insert (m_ActiveAmoebas.end (),
+                                m_QueuedAmoebas.begin (),
+                                m_QueuedAmoebas.begin () + 2);
+        m_QueuedAmoebas.erase (m_QueuedAmoebas.begin (),
+                               m_QueuedAmoebas.begin () + 2);
 
         m_FallingPair = m_Queue.front ();
-        m_Queue.pop_front ();
+        m_Queue.erase (m_Queue.begin ());
         // Set the screen position without any vertical offset. The grid
         // position is set at getNextPair().
         setFallingAmoebaScreenPosition (m_FallingPair.main, 0, false);
         setFallingAmoebaScreenPosition (m_FallingPair.satellite, 0, false);
 
         // Reset the current rotation.
-        m_CurrentRotationDegrees = 90.0f;
-        m_DegreesUntilRotationDone = 0.0f;
-        m_RotationDirection = 1.0f;
+        m_CurrentRotation = 90 * k_RotationPerDegree;
+        m_RotationUntilDone = 0;
+        m_RotationDirection = 1;
 
         setCurrentStepChain (0);
         setHasNewFallingPair (true);
@@ -2108,3 +2339,26 @@ Grid::updateWaitingGhosts (void)
                 static_cast<Amoeba::State> (Amoeba::StateTopRightBottomLeft - weight));
     }
 }
+
+///
+/// \brief Writes the grid's visible cells and the score as text.
+///
+/// Each row of the grid is written in a line, with an amoeba's letter
+/// or a dot for each cell.
+///
+/// \param stream The stream to write the grid to.
+///
+void
+Grid::write (std::ostream &stream) const
+{
+    stream << "score " << getScore () << std::endl;
+    for ( int16_t y = k_FirstVisibleHeight ; y < k_GridHeight ; ++y )
+    {
+        for ( int16_t x = 0 ; x < k_GridWidth ; ++x )
+        {
+            const Amoeba *amoeba = getAmoebaAt (x, y);
+            stream << (0 == amoeba ? '.' : amoeba->getLetter ());
+        }
+        stream << std::endl;
+    }
+}
@@ -19,19 +19,19 @@
 #if !defined (AMOEBAX_GRID_H)
 #define AMOEBAX_GRID_H
 
-#include <list>
+#include <bitset>
+#include <iosfwd>
 #include <memory>
-#include <set>
 #include <stdint.h>
 #include <vector>
 #include "Amoeba.h"
+#include "ChainLabel.h"
 #include "Sound.h"
 
 namespace Amoebax
 {
     // Forward declarations.
     class Amoeba;
-    class ChainLabel;
     class GridStatus;
     class PairGenerator;
 
@@ -51,10 +51,16 @@ namespace Amoebax
             static const uint16_t k_GridWidth = 6;
             /// The maximum number of silhouette frames.
             static const uint16_t k_MaxSilhouetteFrames = 5;
+            /// The time of each logic tick, in ms.  The states update the
+            /// grids in ticks of this time, whatever their frame rate.
+            static const uint32_t k_TickTime = 1000 / 30;
             /// The height that is visible to the user.
             static const uint16_t k_VisibleHeight = k_GridHeight -
                                                     k_FirstVisibleHeight;
 
+            /// A mask with a bit for each of the grid's cells, row by row.
+            typedef std::bitset<k_GridWidth * k_GridHeight> CellMask;
+
             ///
             /// \brief The grid's orientation.
             ///
@@ -100,14 +106,19 @@ namespace Amoebax
                   uint16_t waitingGhostPositionX,
                   uint16_t waitingGhostPositionY, uint16_t amoebaSize,
                   QueueSide queueSide, uint32_t score = 0,
-                  Layout layout = LayoutVertical);
+                  Layout layout = LayoutVertical, bool silent = false);
             ~Grid (void);
 
-            void addNewPair (Amoeba *main, Amoeba *satellite);
-            const std::list<Amoeba *> &getActiveAmoebas (void) const;
-            const std::list<ChainLabel *> &getChainLabels (void) const;
+            void addNewPair (Amoeba::Colour main, Amoeba::Colour satellite);
+            const std::vector<Amoeba *> &getActiveAmoebas (void) const;
+            Amoeba *getAmoebaAt (int16_t x, int16_t y) const;
+            void getCellPosition (int16_t x, int16_t y,
+                                  int16_t &screenX, int16_t &screenY) const;
+            const std::vector<ChainLabel> &getChainLabels (void) const;
+            CellMask getChangedCells (void) const;
             uint16_t getGridPositionX (void) const;
             uint16_t getGridPositionY (void) const;
+            uint8_t getMaxStepChain (void) const;
             FallingAmoeba getFallingMainAmoeba (void) const;
             FallingAmoeba getFallingSatelliteAmoeba (void) const;
             FallingAmoeba getFollowingFallingMainAmoeba (void) const;
@@ -115,19 +126,22 @@ namespace Amoebax
             FallingAmoeba getNextFallingMainAmoeba (void) const;
             FallingAmoeba getNextFallingSatelliteAmoeba (void) const;
             uint8_t getOpponentGhostAmoebas (void) const;
-            const std::list<Amoeba *> &getQueuedAmoebas (void) const;
+            const std::vector<Amoeba *> &getQueuedAmoebas (void) const;
             uint16_t getQueuePositionX (void) const;
             uint16_t getQueuePositionY (void) const;
             uint32_t getScore (void) const;
             int8_t getSilhouetteFrame (void) const;
             GridStatus getState (void) const;
+            void getUnsettledAmoebas (std::vector<Amoeba *> &amoebas) const;
             uint16_t getWaitingGhostPositionX (void) const;
             uint16_t getWaitingGhostPositionY (void) const;
             const std::vector<Amoeba *> &getWaitingGhostAmoebas (void) const;
             bool hasNewFallingPair (void) const;
             void incrementNumberOfWaitingGhosts (uint8_t amount = 1);
+            void invalidateCells (void);
             bool isFilled (void) const;
             bool isQueueMoving (void) const;
+            void markCellsAsDrawn (void);
             void moveLeft (void);
             void moveRight (void);
             void rotateClockwise (void);
@@ -138,6 +152,7 @@ namespace Amoebax
             void setGenerator (PairGenerator *generator);
             void setMaxFallingSpeed (void);
             void setNormalFallingSpeed (void);
+            void write (std::ostream &stream) const;
 
         private:
             /// Default blinking time (ms).
@@ -148,6 +163,8 @@ namespace Amoebax
             static const int32_t k_DefaultFallingTime = 500;
             /// The time required for the silhouette to be shown (ms.)
             static const int32_t k_SilhouetteTime = 100;
+            /// The appearance of a cell that must be drawn no matter what.
+            static const uint16_t k_UnknownAppearance = 0xffff;
 
             ///
             /// \struct FallingPair
@@ -172,8 +189,8 @@ namespace Amoebax
             void addChainLabel (uint8_t stepChain, int16_t x, int16_t y);
             void clearDyingAmoebas (void);
             void findFloatingAmoebas (void);
-            Amoeba *getAmoebaAt (int16_t x, int16_t y) const;
             uint16_t getAmoebaSize (void) const;
+            uint16_t getCellAppearance (int16_t x, int16_t y) const;
             uint8_t getCurrentStepChain (void) const;
             int16_t getCurrentRotationDegree (void) const;
             Layout getLayout (void) const;
@@ -188,11 +205,12 @@ namespace Amoebax
             void makeGroup (std::vector<FallingAmoeba> &group,
                             std::vector<FallingAmoeba> &ghosts,
                             int16_t x, int16_t y,
-                            std::set<std::pair<int16_t, int16_t> > &visitedPositions,
+                            CellMask &visitedCells,
                             Amoeba::Colour colour = Amoeba::ColourNone,
                             bool initialAmoeba = true);
             void makeChain (void);
             void markAsFilled (void);
+            Amoeba *newAmoeba (Amoeba::Colour colour);
             void setAmoebaAt (int16_t x, int16_t y, Amoeba *amoeba);
             void setAmoebaStateAt (int16_t x, int16_t y, bool neighbors = true);
             void setCurrentStepChain (uint8_t stepChain);
@@ -205,26 +223,32 @@ namespace Amoebax
             void setScore (uint32_t score);
             void setSilhouetteFrame (int8_t frame);
             void setupFallingPair (void);
+            void releaseAmoeba (Amoeba *amoeba);
             uint8_t removeGhostAmoebas (uint8_t newGhostAmoebas);
-            void rotateSatelliteAmoeba (float degreesToRotate);
+            void rotateSatelliteAmoeba (int32_t rotation);
             void updateWaitingGhosts (void);
 
             /// The list of amoebas that are in the grid, not waiting.
-            std::list<Amoeba *> m_ActiveAmoebas;
+            std::vector<Amoeba *> m_ActiveAmoebas;
             /// The size (width and height are the same) of a single amoeba.
             uint16_t m_AmoebaSize;
             /// The time need to switch the blink of dying amoebas.
             int32_t m_BlinkTime;
             /// The list of chain labels.
-            std::list<ChainLabel *> m_ChainLabels;
+            std::vector<ChainLabel> m_ChainLabels;
+            /// The ghost amoebas of the group that makeChain() is making.
+            std::vector<FallingAmoeba> m_ChainGhosts;
+            /// The group of amoebas that makeChain() is making.
+            std::vector<FallingAmoeba> m_ChainGroup;
             /// The current chain step.
             uint8_t m_CurrentStepChain;
-            /// The current satellite amoeba's rotation degrees.
-            float m_CurrentRotationDegrees;
-            /// The remaing degrees until the rotation is done.
-            float m_DegreesUntilRotationDone;
-            /// Dying sound.
+            /// The current satellite amoeba's rotation, in thousandths
+            /// of degree.
+            int32_t m_CurrentRotation;
+            /// Dying sound, or null if the grid is silent.
             std::unique_ptr<Sound> m_DieSound;
+            /// The appearance of each cell when it was last drawn.
+            std::vector<uint16_t> m_DrawnCells;
             /// Dying amoebas.
             std::vector<FallingAmoeba> m_DyingAmoebas;
             /// Dying time.
@@ -236,7 +260,7 @@ namespace Amoebax
             /// Tells that we are just making fall the first pair.
             bool m_FirstFallingPair;
             /// The amoebas that have lost they lowe neighbor and are floating.
-            std::list<FallingAmoeba> m_FloatingAmoebas;
+            std::vector<FallingAmoeba> m_FloatingAmoebas;
             /// The verical offset of all floating amoebas.
             int16_t m_FloatingAmoebasVerticalOffset;
             /// This grid's amoebas pair generator.
@@ -250,17 +274,19 @@ namespace Amoebax
             /// Tells the if falling pair is new in this update or not.
             bool m_HasNewFallingPair;
             /// The list of amoebas that are waiting to be in play.
-            std::list<Amoeba *> m_InactiveAmoebas;
+            std::vector<Amoeba *> m_InactiveAmoebas;
             /// The grid's layout.
             Layout m_Layout;
             /// Tells if we are falling at max speed.
             bool m_MaxFallingSpeed;
+            /// The longest chain step reached so far.
+            uint8_t m_MaxStepChain;
             /// The number of ghost amoebas to send to the opponent.
             uint8_t m_OpponentGhostAmoebas;
             /// The queue, amoebas waiting to fall.
-            std::list<FallingPair> m_Queue;
+            std::vector<FallingPair> m_Queue;
             /// The list of pointer to the amoebas in the queue.
-            std::list<Amoeba *> m_QueuedAmoebas;
+            std::vector<Amoeba *> m_QueuedAmoebas;
             /// Tells if the queue is moving.
             bool m_QueueIsMoving;
             /// The side of the queue.
@@ -274,7 +300,9 @@ namespace Amoebax
             /// The remaining vertical offset to move the queued amoebas.
             uint16_t m_RemainingQueueVerticalOffset;
             /// The direction (clockwise or anti-clockwise) of the satellite rotation.
-            float m_RotationDirection;
+            int8_t m_RotationDirection;
+            /// The remaing rotation until it is done, in thousandths of degree.
+            int32_t m_RotationUntilDone;
             /// The current player's score.
             uint32_t m_Score;
             /// The current silhouette frame.
@@ -283,6 +311,8 @@ namespace Amoebax
             int8_t m_SilhouetteFrameDirection;
             /// The time required for the silhouette to change.
             int32_t m_SilhouetteTime;
+            /// The amoebas that left the grid, to be reused by newAmoeba().
+            std::vector<Amoeba *> m_UnusedAmoebas;
             /// Tell if we are waiting for the initial 3 pairs.
             bool m_WaitingInitialAmoebas;
             /// The ghost amoebas waiting to fall to the grid.
@@ -305,7 +335,7 @@ namespace Amoebax
     ///
     /// \return The list of amoebas that are active.
     ///
-    inline const std::list<Amoeba *> &
+    inline const std::vector<Amoeba *> &
     Grid::getActiveAmoebas (void) const
     {
         return m_ActiveAmoebas;
@@ -328,7 +358,7 @@ namespace Amoebax
     ///
     /// \return The list of chain labels to show to the user.
     ///
-    inline const std::list<ChainLabel *> &
+    inline const std::vector<ChainLabel> &
     Grid::getChainLabels (void) const
     {
         return m_ChainLabels;
@@ -345,6 +375,18 @@ namespace Amoebax
         return m_CurrentStepChain;
     }
 
+    ///
+    /// \brief Gets the longest step chain made in this grid.
+    ///
+    /// \return The highest step chain value the grid had since it was
+    ///         created.
+    ///
+    inline uint8_t
+    Grid::getMaxStepChain (void) const
+    {
+        return m_MaxStepChain;
+    }
+
     ///
     /// \brief Gets the grid's top-left corner X position.
     ///
@@ -408,7 +450,7 @@ namespace Amoebax
     ///
     /// \return The list of amoebas that are active.
     ///
-    inline const std::list<Amoeba *> &
+    inline const std::vector<Amoeba *> &
     Grid::getQueuedAmoebas (void) const
     {
         return m_QueuedAmoebas;
@@ -520,6 +562,10 @@ namespace Amoebax
     Grid::setCurrentStepChain (uint8_t stepChain)
     {
         m_CurrentStepChain = stepChain;
+        if ( stepChain > m_MaxStepChain )
+        {
+            m_MaxStepChain = stepChain;
+        }
     }
 
     ///
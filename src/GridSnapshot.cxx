@@ -0,0 +1,197 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <ostream>
+#include "GridSnapshot.h"
+
+using namespace Amoebax;
+
+///
+/// \brief Default constructor.
+///
+/// The snapshot is empty until take() is called.  It keeps room for
+/// as many amoebas as a grid can hold, so taking it doesn't allocate.
+///
+GridSnapshot::GridSnapshot (void):
+    m_Cells (Grid::k_GridWidth * Grid::k_GridHeight,
+             Amoeba (Amoeba::ColourNone)),
+    m_ChangedCells (),
+    m_ChainLabels (),
+    m_FallingMainAmoeba (Amoeba::ColourNone),
+    m_FallingMainX (0),
+    m_FallingMainY (0),
+    m_HasFallingPair (false),
+    m_OccupiedCells (),
+    m_QueuedAmoebas (),
+    m_Score (0),
+    m_SilhouetteFrame (0),
+    m_UnsettledAmoebas (),
+    m_UnsettledPointers (),
+    m_WaitingGhostAmoebas ()
+{
+    m_ChainLabels.reserve (Grid::k_GridWidth * Grid::k_GridHeight);
+    m_QueuedAmoebas.reserve (Grid::k_GridWidth * Grid::k_GridHeight);
+    m_UnsettledAmoebas.reserve (Grid::k_GridWidth * Grid::k_GridHeight);
+    m_UnsettledPointers.reserve (Grid::k_GridWidth * Grid::k_GridHeight);
+    m_WaitingGhostAmoebas.reserve (Grid::k_GridWidth * Grid::k_GridHeight);
+}
+
+///
+/// \brief Adds the cells not drawn yet from another snapshot.
+///
+/// When a newer snapshot replaces one that wasn't drawn, the cells
+/// that the older snapshot had to draw must be drawn with the newer.
+///
+/// \param snapshot The older snapshot of the same grid.
+///
+void
+GridSnapshot::addChangedCells (const GridSnapshot &snapshot)
+{
+    m_ChangedCells |= snapshot.m_ChangedCells;
+}
+
+///
+/// \brief Gets the amoeba at a grid's position.
+///
+/// \param x The X position of the cell.
+/// \param y The Y position of the cell.
+/// \return The copy of the amoeba settled at \p x and \p y, or 0 if
+///         the cell is empty or outside the grid.
+///
+const Amoeba *
+GridSnapshot::getAmoebaAt (int16_t x, int16_t y) const
+{
+    if ( 0 <= x && x < Grid::k_GridWidth &&
+         0 <= y && y < Grid::k_GridHeight &&
+         m_OccupiedCells.test (y * Grid::k_GridWidth + x) )
+    {
+        return &m_Cells[y * Grid::k_GridWidth + x];
+    }
+    return 0;
+}
+
+///
+/// \brief Gets the main amoeba of the falling pair.
+///
+/// \param x Set to the amoeba's X position in the grid.
+/// \param y Set to the amoeba's Y position in the grid.
+/// \return The copy of the main falling amoeba, or 0 if there is no
+///         falling pair or it has no silhouette, in which case \p x and
+///         \p y are left unchanged.
+///
+const Amoeba *
+GridSnapshot::getFallingMainAmoeba (int16_t &x, int16_t &y) const
+{
+    if ( !m_HasFallingPair )
+    {
+        return 0;
+    }
+    x = m_FallingMainX;
+    y = m_FallingMainY;
+    return &m_FallingMainAmoeba;
+}
+
+///
+/// \brief Copies the current state of a grid.
+///
+/// The grid's changed cells are kept in the snapshot and then marked
+/// as drawn in the grid.
+///
+/// \param grid The grid to copy.
+///
+void
+GridSnapshot::take (Grid &grid)
+{
+    m_OccupiedCells.reset ();
+    for ( int16_t y = 0 ; y < Grid::k_GridHeight ; ++y )
+    {
+        for ( int16_t x = 0 ; x < Grid::k_GridWidth ; ++x )
+        {
+            const Amoeba *amoeba = grid.getAmoebaAt (x, y);
+            if ( 0 != amoeba )
+            {
+                m_Cells[y * Grid::k_GridWidth + x] = *amoeba;
+                m_OccupiedCells.set (y * Grid::k_GridWidth + x);
+            }
+        }
+    }
+    m_ChangedCells = grid.getChangedCells ();
+    grid.markCellsAsDrawn ();
+
+    m_ChainLabels = grid.getChainLabels ();
+
+    // Once the pair lands, the grid still points to its main amoeba,
+    // which can then die, but it no longer has a silhouette.
+    const Grid::FallingAmoeba mainAmoeba = grid.getFallingMainAmoeba ();
+    m_HasFallingPair = 0 != mainAmoeba.amoeba &&
+                       0 < grid.getSilhouetteFrame ();
+    if ( m_HasFallingPair )
+    {
+        m_FallingMainAmoeba = *mainAmoeba.amoeba;
+        m_FallingMainX = mainAmoeba.x;
+        m_FallingMainY = mainAmoeba.y;
+    }
+
+    m_QueuedAmoebas.clear ();
+    const std::vector<Amoeba *> &queuedAmoebas = grid.getQueuedAmoebas ();
+    for ( std::vector<Amoeba *>::const_iterator amoeba = queuedAmoebas.begin () ;
+          amoeba != queuedAmoebas.end () ; ++amoeba )
+    {
+        m_QueuedAmoebas.push_back (**amoeba);
+    }
+
+    m_Score = grid.getScore ();
+    m_SilhouetteFrame = grid.getSilhouetteFrame ();
+
+    grid.getUnsettledAmoebas (m_UnsettledPointers);
+    m_UnsettledAmoebas.clear ();
+    for ( std::vector<Amoeba *>::const_iterator amoeba = m_UnsettledPointers.begin () ;
+          amoeba != m_UnsettledPointers.end () ; ++amoeba )
+    {
+        m_UnsettledAmoebas.push_back (**amoeba);
+    }
+
+    m_WaitingGhostAmoebas.clear ();
+    const std::vector<Amoeba *> &ghostAmoebas = grid.getWaitingGhostAmoebas ();
+    for ( std::vector<Amoeba *>::const_iterator amoeba = ghostAmoebas.begin () ;
+          amoeba != ghostAmoebas.end () ; ++amoeba )
+    {
+        m_WaitingGhostAmoebas.push_back (**amoeba);
+    }
+}
+
+///
+/// \brief Writes the snapshot's visible cells and the score as text.
+///
+/// \param stream The stream to write the snapshot to.
+/// \see Grid::write()
+///
+void
+GridSnapshot::write (std::ostream &stream) const
+{
+    stream << "score " << getScore () << std::endl;
+    for ( int16_t y = Grid::k_FirstVisibleHeight ; y < Grid::k_GridHeight ; ++y )
+    {
+        for ( int16_t x = 0 ; x < Grid::k_GridWidth ; ++x )
+        {
+            const Amoeba *amoeba = getAmoebaAt (x, y);
+            stream << (0 == amoeba ? '.' : amoeba->getLetter ());
+        }
+        stream << std::endl;
+    }
+}
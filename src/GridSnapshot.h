@@ -0,0 +1,176 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_GRID_SNAPSHOT_H)
+#define AMOEBAX_GRID_SNAPSHOT_H
+
+#include <iosfwd>
+#include <vector>
+#include "Amoeba.h"
+#include "ChainLabel.h"
+#include "Grid.h"
+
+namespace Amoebax
+{
+    ///
+    /// \class GridSnapshot.
+    /// \brief A copy of what a grid draws at a given tick.
+    ///
+    /// While a thread updates a grid, another can draw the grid's last
+    /// snapshot.  The snapshot copies the amoebas, the chain labels and
+    /// the score, but not the grid's positions on the screen, which
+    /// don't change while playing, so they are still read from the grid.
+    ///
+    class GridSnapshot
+    {
+        public:
+            GridSnapshot (void);
+
+            void addChangedCells (const GridSnapshot &snapshot);
+            const Amoeba *getAmoebaAt (int16_t x, int16_t y) const;
+            const std::vector<ChainLabel> &getChainLabels (void) const;
+            Grid::CellMask getChangedCells (void) const;
+            const Amoeba *getFallingMainAmoeba (int16_t &x, int16_t &y) const;
+            const std::vector<Amoeba> &getQueuedAmoebas (void) const;
+            uint32_t getScore (void) const;
+            int8_t getSilhouetteFrame (void) const;
+            const std::vector<Amoeba> &getUnsettledAmoebas (void) const;
+            const std::vector<Amoeba> &getWaitingGhostAmoebas (void) const;
+            void markCellsAsDrawn (void);
+            void take (Grid &grid);
+            void write (std::ostream &stream) const;
+
+        private:
+            /// The amoeba of each grid's cell, if the cell is occupied.
+            std::vector<Amoeba> m_Cells;
+            /// The cells changed since they were last drawn.
+            Grid::CellMask m_ChangedCells;
+            /// The chain labels.
+            std::vector<ChainLabel> m_ChainLabels;
+            /// The main amoeba of the falling pair.
+            Amoeba m_FallingMainAmoeba;
+            /// The X position in the grid of the main falling amoeba.
+            int16_t m_FallingMainX;
+            /// The Y position in the grid of the main falling amoeba.
+            int16_t m_FallingMainY;
+            /// Tells if there is a falling pair.
+            bool m_HasFallingPair;
+            /// The cells that have an amoeba.
+            Grid::CellMask m_OccupiedCells;
+            /// The amoebas waiting to fall.
+            std::vector<Amoeba> m_QueuedAmoebas;
+            /// The player's score.
+            uint32_t m_Score;
+            /// The silhouette frame of the main falling amoeba.
+            int8_t m_SilhouetteFrame;
+            /// The active amoebas that are not settled in a cell.
+            std::vector<Amoeba> m_UnsettledAmoebas;
+            /// The grid's unsettled amoebas, reused by take().
+            std::vector<Amoeba *> m_UnsettledPointers;
+            /// The ghost amoebas waiting to fall to the grid.
+            std::vector<Amoeba> m_WaitingGhostAmoebas;
+    };
+
+    ///
+    /// \brief Gets the chain labels.
+    ///
+    /// \return The copies of the grid's chain labels.
+    ///
+    inline const std::vector<ChainLabel> &
+    GridSnapshot::getChainLabels (void) const
+    {
+        return m_ChainLabels;
+    }
+
+    ///
+    /// \brief Gets the cells changed since they were last drawn.
+    ///
+    /// \return The mask of the cells to draw again.
+    ///
+    inline Grid::CellMask
+    GridSnapshot::getChangedCells (void) const
+    {
+        return m_ChangedCells;
+    }
+
+    ///
+    /// \brief Gets the queued amoebas.
+    ///
+    /// \return The copies of the amoebas waiting to fall.
+    ///
+    inline const std::vector<Amoeba> &
+    GridSnapshot::getQueuedAmoebas (void) const
+    {
+        return m_QueuedAmoebas;
+    }
+
+    ///
+    /// \brief Gets the player's score.
+    ///
+    /// \return The grid's score when the snapshot was taken.
+    ///
+    inline uint32_t
+    GridSnapshot::getScore (void) const
+    {
+        return m_Score;
+    }
+
+    ///
+    /// \brief Gets the silhouette frame of the main falling amoeba.
+    ///
+    /// \return The silhouette frame to draw, or 0 for none.
+    ///
+    inline int8_t
+    GridSnapshot::getSilhouetteFrame (void) const
+    {
+        return m_SilhouetteFrame;
+    }
+
+    ///
+    /// \brief Gets the active amoebas not settled in a cell.
+    ///
+    /// \return The copies of the falling, floating and dying amoebas.
+    ///
+    inline const std::vector<Amoeba> &
+    GridSnapshot::getUnsettledAmoebas (void) const
+    {
+        return m_UnsettledAmoebas;
+    }
+
+    ///
+    /// \brief Gets the ghost amoebas waiting to fall.
+    ///
+    /// \return The copies of the waiting ghost amoebas.
+    ///
+    inline const std::vector<Amoeba> &
+    GridSnapshot::getWaitingGhostAmoebas (void) const
+    {
+        return m_WaitingGhostAmoebas;
+    }
+
+    ///
+    /// \brief Marks all the cells as drawn.
+    ///
+    inline void
+    GridSnapshot::markCellsAsDrawn (void)
+    {
+        m_ChangedCells.reset ();
+    }
+}
+
+#endif // !AMOEBAX_GRID_SNAPSHOT_H
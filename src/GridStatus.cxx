@@ -16,6 +16,7 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
+#include <algorithm>
 #include <cassert>
 #include <limits>
 #include "Amoeba.h"
@@ -29,9 +30,10 @@ using namespace Amoebax;
 ///
 /// Creates an empty state.
 ///
-GridStatus::GridStatus (void):
-    m_State (Grid::k_GridWidth * Grid::k_GridHeight, Amoeba::ColourNone)
+GridStatus::GridStatus (void)
 {
+    std::fill (m_State, m_State + Grid::k_GridWidth * Grid::k_GridHeight,
+               Amoeba::ColourNone);
 }
 
 ///
@@ -39,11 +41,9 @@ GridStatus::GridStatus (void):
 ///
 /// \param state The current state of the grid.
 ///
-GridStatus::GridStatus (const std::vector<Amoeba::Colour> &state):
-    m_State (state)
+GridStatus::GridStatus (const Amoeba::Colour (&state)[Grid::k_GridWidth * Grid::k_GridHeight])
 {
-    assert ( m_State.size () == (Grid::k_GridWidth * Grid::k_GridHeight) &&
-             "The state size is not the same as the grid size." );
+    std::copy (state, state + Grid::k_GridWidth * Grid::k_GridHeight, m_State);
 }
 
 ///
@@ -91,25 +91,25 @@ GridStatus::checkPositions (const Grid::FallingAmoeba &main,
     // Now check the groups that the main and satellite amoebas can make.
     {
         uint16_t stepChainGroup = 0;
-        std::set<Position> visitedPositions;
+        Grid::CellMask visitedCells;
         Group group;
         Group ghosts;
         // Main amoeba.
-        makeGroup (group, ghosts, main.x, mainY, visitedPositions);
-        if ( 4 <= group.size () )
+        makeGroup (group, ghosts, main.x, mainY, visitedCells);
+        if ( 4 <= group.count () )
         {
-            stepChainGroup += group.size ();
+            stepChainGroup += group.count ();
             removeAmoebaGroup (group);
-            result.ghostAmoebasRemoved += ghosts.size ();
+            result.ghostAmoebasRemoved += ghosts.count ();
             removeAmoebaGroup (ghosts);
         }
         // Satellite amoeba.
-        makeGroup (group, ghosts, satellite.x, satelliteY, visitedPositions);
-        if ( 4 <= group.size () )
+        makeGroup (group, ghosts, satellite.x, satelliteY, visitedCells);
+        if ( 4 <= group.count () )
         {
-            stepChainGroup += group.size ();
+            stepChainGroup += group.count ();
             removeAmoebaGroup (group);
-            result.ghostAmoebasRemoved += ghosts.size ();
+            result.ghostAmoebasRemoved += ghosts.count ();
             removeAmoebaGroup (ghosts);
         }
         result.stepChains.clear ();
@@ -120,28 +120,11 @@ GridStatus::checkPositions (const Grid::FallingAmoeba &main,
     // for groups and remove the groups, until there are no more floating
     // amoebas.
     Group floatingAmoebas (findFloatingAmoebas ());
-    while ( !floatingAmoebas.empty () )
+    while ( floatingAmoebas.any () )
     {
-        std::vector<Group> groups (makeFloatingAmoebasFall (floatingAmoebas));
-        std::vector<Group>::const_iterator currentGroup = groups.begin ();
-        uint16_t stepChainGroup = 0;
-        for ( bool isGhostGroup = false ;
-              currentGroup != groups.end () ;
-              ++currentGroup, isGhostGroup = !isGhostGroup )
-        {
-            // For each floating there's two consecutive groups: one for
-            // the "regular" amoebas and the other for the ghosts groups.
-            if ( isGhostGroup )
-            {
-                result.ghostAmoebasRemoved += currentGroup->size ();
-            }
-            else
-            {
-                stepChainGroup += currentGroup->size ();
-            }
-            removeAmoebaGroup (*currentGroup);
-        }
-        result.stepChains.push_back (stepChainGroup);
+        result.stepChains.push_back (
+                makeFloatingAmoebasFall (floatingAmoebas,
+                                         result.ghostAmoebasRemoved));
         floatingAmoebas = findFloatingAmoebas ();
     }
     // Now get the height of each column, accumulate the height to then
@@ -176,7 +159,7 @@ GridStatus::checkPositions (const Grid::FallingAmoeba &main,
     // Get the number of groups of less than 4 amoebas (i.e., at this state
     // just the groups since there's no group of 4 or more amoebas.)
     {
-        std::set<Position> visitedPositions;
+        Grid::CellMask visitedCells;
         result.groups.clear ();
         result.groupsAmoebasNumber = 0;
         for ( int16_t currentY = 0 ; currentY < Grid::k_GridHeight ; ++currentY )
@@ -185,11 +168,11 @@ GridStatus::checkPositions (const Grid::FallingAmoeba &main,
             {
                 Group group;
                 Group ghosts;
-                makeGroup (group, ghosts, currentX, currentY, visitedPositions);
-                if ( 1 < group.size () )
+                makeGroup (group, ghosts, currentX, currentY, visitedCells);
+                if ( 1 < group.count () )
                 {
-                    result.groupsAmoebasNumber += group.size ();
-                    result.groups.push_back (group.size ());
+                    result.groupsAmoebasNumber += group.count ();
+                    result.groups.push_back (group.count ());
                 }
             }
         }
@@ -202,10 +185,9 @@ GridStatus::checkPositions (const Grid::FallingAmoeba &main,
 /// A floating amoeba is just an amoeba that has lost its supporting
 /// amoeba and so it's "floating" on the grid.
 ///
-/// \return The list of all floating amoebas starting from the lower
-///         grid's line.
+/// \return The cells of all floating amoebas.
 ///
-std::vector<GridStatus::Position>
+GridStatus::Group
 GridStatus::findFloatingAmoebas (void) const
 {
     // Check all but the last line.
@@ -217,7 +199,7 @@ GridStatus::findFloatingAmoebas (void) const
             if ( Amoeba::ColourNone != getAmoebaColourAt (column, row) &&
                  Amoeba::ColourNone == getAmoebaColourAt (column, row + 1) )
             {
-                floatingAmoebas.push_back (std::make_pair (column, row));
+                floatingAmoebas.set (row * Grid::k_GridWidth + column);
             }
         }
     }
@@ -249,47 +231,61 @@ GridStatus::getAmoebaColourAt (int16_t x, int16_t y) const
 ///
 /// Once a floating amoeba is identified, this function just takes it and
 /// makes it fall until another amoeba is found or the bottom-most line
-/// is reached. Then it checks if it can make more groups and stores it.
+/// is reached. Then it checks if it can make more groups and removes them.
 ///
-/// \param floatingAmoebas The floating amoebas to make fall.
-/// \return A list with all groups made when the amoebas felt.
+/// \param floatingAmoebas The floating amoebas to make fall.  They fall
+///                        starting from the lower grid's line.
+/// \param ghostAmoebasRemoved The number of removed ghost amoebas, which
+///                            is incremented by the ghosts removed.
+/// \return The number of amoebas in the groups made when the amoebas felt.
 ///
-std::vector<GridStatus::Group>
-GridStatus::makeFloatingAmoebasFall (const Group &floatingAmoebas)
+uint16_t
+GridStatus::makeFloatingAmoebasFall (const Group &floatingAmoebas,
+                                     uint16_t &ghostAmoebasRemoved)
 {
-    Group positionsToCheck;
-    for ( Group::const_iterator currentAmoeba = floatingAmoebas.begin () ;
-          currentAmoeba != floatingAmoebas.end () ; ++currentAmoeba )
+    Position positionsToCheck[Grid::k_GridWidth * Grid::k_GridHeight];
+    size_t numPositionsToCheck = 0;
+    for ( int16_t row = Grid::k_GridHeight - 2 ; row >= 0 ; --row )
     {
-        int x = currentAmoeba->first;
-        int y = currentAmoeba->second;
-        Amoeba::Colour colour = getAmoebaColourAt (x, y);
-        setAmoebaColourAt (x, y, Amoeba::ColourNone);
-        y = Grid::k_GridHeight - 1;
-        while ( Amoeba::ColourNone != getAmoebaColourAt (x, y) )
+        for ( int16_t x = 0 ; x < Grid::k_GridWidth ; ++x )
         {
-            --y;
+            if ( !floatingAmoebas.test (row * Grid::k_GridWidth + x) )
+            {
+                continue;
+            }
+            Amoeba::Colour colour = getAmoebaColourAt (x, row);
+            setAmoebaColourAt (x, row, Amoeba::ColourNone);
+            int16_t y = Grid::k_GridHeight - 1;
+            while ( Amoeba::ColourNone != getAmoebaColourAt (x, y) )
+            {
+                --y;
+            }
+            setAmoebaColourAt (x, y, colour);
+            positionsToCheck[numPositionsToCheck++] = std::make_pair (x, y);
         }
-        setAmoebaColourAt (x, y, colour);
-        positionsToCheck.push_back (std::make_pair (x, y));
     }
-    // Now check if we can make groups from the floating amoebas once fallen.
-    std::vector<Group> floatingGroups;
-    std::set<Position> visitedPositions;
-    for ( Group::const_iterator currentPosition = positionsToCheck.begin () ;
-          currentPosition != positionsToCheck.end () ; ++currentPosition )
+    // Now check if we can make groups from the floating amoebas once
+    // fallen.  The groups are removed once all are found, since a ghost
+    // only counts for the first group it touches.
+    uint16_t stepChainGroup = 0;
+    Group removedAmoebas;
+    Grid::CellMask visitedCells;
+    for ( size_t position = 0 ; position < numPositionsToCheck ; ++position )
     {
         Group group;
         Group ghosts;
-        makeGroup (group, ghosts, currentPosition->first,
-                   currentPosition->second, visitedPositions);
-        if ( 4 <= group.size () )
+        makeGroup (group, ghosts, positionsToCheck[position].first,
+                   positionsToCheck[position].second, visitedCells);
+        if ( 4 <= group.count () )
         {
-            floatingGroups.push_back (group);
-            floatingGroups.push_back (ghosts);
+            stepChainGroup += group.count ();
+            ghostAmoebasRemoved += ghosts.count ();
+            removedAmoebas |= group;
+            removedAmoebas |= ghosts;
         }
     }
-    return floatingGroups;
+    removeAmoebaGroup (removedAmoebas);
+    return stepChainGroup;
 }
 
 ///
@@ -299,8 +295,8 @@ GridStatus::makeFloatingAmoebasFall (const Group &floatingAmoebas)
 /// \param ghosts The ghosts amoebas that are in contact with the group.
 /// \param x The X position to look for a possible group candidate.
 /// \param y The Y position to look for a possible group candidate.
-/// \param visitedPositions The set of the already visited position by the
-///                         algorithm. Initially, this should be empty.
+/// \param visitedCells The cells already visited by the algorithm.
+///                     Initially, this should be empty.
 /// \param groupColour The colour of the amoeba to be part of the group.
 /// \param initialAmoeba Tells if the amoeba at \p x and \p y should be the
 ///                      first amoeba of the group and use its colour to check
@@ -308,20 +304,21 @@ GridStatus::makeFloatingAmoebasFall (const Group &floatingAmoebas)
 ///
 void
 GridStatus::makeGroup (Group &group, Group &ghosts, int16_t x, int16_t y,
-                      std::set<Position> &visitedPositions,
+                      Grid::CellMask &visitedCells,
                       Amoeba::Colour groupColour, bool initialAmoeba)
 {
-    Position currentPosition (std::make_pair (x, y));
-    // Only check this position if we didn't visited it yet.
-    if ( visitedPositions.end () == visitedPositions.find (currentPosition) )
+    // If there's any amoeba at the given position, check if is of the
+    // same colour as the others in the group.  The positions out of
+    // the grid have no amoeba, so they are never visited.
+    Amoeba::Colour colour = getAmoebaColourAt (x, y);
+    const size_t currentCell = y * Grid::k_GridWidth + x;
+    if ( Amoeba::ColourNone != colour )
     {
-        // If there's any amoeba at the given position, check if is of the
-        // same colour as the others in the group.
-        Amoeba::Colour colour = getAmoebaColourAt (x, y);
-        if ( Amoeba::ColourNone != colour )
+        // Only check this position if we didn't visited it yet.
+        if ( !visitedCells.test (currentCell) )
         {
             // Add the current position to the already visited positions.
-            visitedPositions.insert (currentPosition);
+            visitedCells.set (currentCell);
 
             // If this amoeba is the first one, then we need to use its
             // colour as the group's colour.
@@ -334,18 +331,18 @@ GridStatus::makeGroup (Group &group, Group &ghosts, int16_t x, int16_t y,
             // any further.
             if ( Amoeba::ColourGhost == colour )
             {
-                ghosts.push_back (currentPosition);
+                ghosts.set (currentCell);
             }
             // Otherwise, if the amoeba's colour is the same as the
             // group's colour, add it to the group vector and check for its
             // neighbours.
             else if ( colour == groupColour )
             {
-                group.push_back (currentPosition);
-                makeGroup (group, ghosts, x, y - 1, visitedPositions, groupColour, false);
-                makeGroup (group, ghosts, x + 1, y, visitedPositions, groupColour, false);
-                makeGroup (group, ghosts, x, y + 1, visitedPositions, groupColour, false);
-                makeGroup (group, ghosts, x - 1, y, visitedPositions, groupColour, false);
+                group.set (currentCell);
+                makeGroup (group, ghosts, x, y - 1, visitedCells, groupColour, false);
+                makeGroup (group, ghosts, x + 1, y, visitedCells, groupColour, false);
+                makeGroup (group, ghosts, x, y + 1, visitedCells, groupColour, false);
+                makeGroup (group, ghosts, x - 1, y, visitedCells, groupColour, false);
             }
         }
     }
@@ -359,11 +356,12 @@ GridStatus::makeGroup (Group &group, Group &ghosts, int16_t x, int16_t y,
 void
 GridStatus::removeAmoebaGroup (const Group &group)
 {
-    for ( Group::const_iterator currentPosition = group.begin () ;
-          currentPosition != group.end () ; ++currentPosition )
+    for ( size_t cell = 0 ; cell < group.size () ; ++cell )
     {
-        setAmoebaColourAt (currentPosition->first, currentPosition->second,
-                           Amoeba::ColourNone);
+        if ( group.test (cell) )
+        {
+            m_State[cell] = Amoeba::ColourNone;
+        }
     }
 }
 
@@ -40,8 +40,8 @@ namespace Amoebax
         public:
             /// The position (x, y) of a amoeba in the grid.
             typedef std::pair<int16_t, int16_t> Position;
-            /// A Group of amoebas identified by they position.
-            typedef std::vector<Position> Group;
+            /// A Group of amoebas, with a bit set for each amoeba's cell.
+            typedef Grid::CellMask Group;
 
             ///
             /// \struct PositionResult
@@ -70,7 +70,7 @@ namespace Amoebax
             };
 
             explicit GridStatus ();
-            explicit GridStatus (const std::vector<Amoeba::Colour> &state);
+            explicit GridStatus (const Amoeba::Colour (&state)[Grid::k_GridWidth * Grid::k_GridHeight]);
 
             void checkPositions (const Grid::FallingAmoeba &main,
                                  const Grid::FallingAmoeba &satellite,
@@ -79,18 +79,19 @@ namespace Amoebax
         private:
             Group findFloatingAmoebas (void) const;
             Amoeba::Colour getAmoebaColourAt (int16_t x, int16_t y) const;
-            std::vector<Group> makeFloatingAmoebasFall (const Group &floatingAmoebas);
+            uint16_t makeFloatingAmoebasFall (const Group &floatingAmoebas,
+                                              uint16_t &ghostAmoebasRemoved);
             void makeGroup (Group &group,
                             Group &ghosts,
                             int16_t x, int16_t y,
-                            std::set<Position> &visitedPositions,
+                            Grid::CellMask &visitedCells,
                             Amoeba::Colour groupColour = Amoeba::ColourNone,
                             bool initialAmoeba = true);
             void removeAmoebaGroup (const Group &group);
             void setAmoebaColourAt (int16_t x, int16_t y, Amoeba::Colour colour);
 
             /// The current grid's state.
-            std::vector<Amoeba::Colour> m_State;
+            Amoeba::Colour m_State[Grid::k_GridWidth * Grid::k_GridHeight];
     };
 }
 
@@ -22,6 +22,7 @@
 #include "HighScoreState.h"
 #include "Options.h"
 #include "System.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
@@ -38,6 +39,7 @@ HighScoreState::HighScoreState (int32_t scoreToHighLight):
     m_ScoreToHighLight (scoreToHighLight),
     m_StateRemoved (false)
 {
+    AMOEBAX_TRACE_ZONE ("HighScoreState::HighScoreState");
     loadGraphicResources ();
 }
 
@@ -52,6 +54,13 @@ HighScoreState::getScoreToHighLight (void) const
     return m_ScoreToHighLight;
 }
 
+uint32_t
+HighScoreState::getIdleTime (void)
+{
+    // The screen only changes with the events.
+    return k_MaxIdleTime;
+}
+
 void
 HighScoreState::joyMotion (uint8_t joystick, uint8_t axis, int16_t value)
 {
@@ -85,6 +94,7 @@ HighScoreState::keyUp (uint32_t key)
 void
 HighScoreState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("HighScoreState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
     m_Background.reset (
             Surface::fromFile (File::getGraphicsFilePath ("menuBackground.png")));
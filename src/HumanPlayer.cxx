@@ -17,6 +17,7 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
 #include "HumanPlayer.h"
+#include "System.h"
 
 using namespace Amoebax;
 
@@ -28,12 +29,58 @@ using namespace Amoebax;
 ///
 HumanPlayer::HumanPlayer (IPlayer::PlayerSide side):
     IPlayer (side),
+    m_Inputs (),
+    m_InputsMutex (),
     m_Joystick (),
     m_PlayerControls ()
 {
     loadOptions ();
 }
 
+///
+/// \brief Applies the queued actions received until a time.
+///
+/// \param time The time the logic tick ends at.
+/// \param appliedInputs The vector to add the time of the applied
+///                      actions to.
+///
+void
+HumanPlayer::applyInputs (uint32_t time, std::vector<uint32_t> &appliedInputs)
+{
+    std::lock_guard<std::mutex> lock (m_InputsMutex);
+    while ( !m_Inputs.empty () && m_Inputs.front ().time <= time )
+    {
+        const Input &input = m_Inputs.front ();
+        switch ( input.action )
+        {
+            case MaxFallingSpeed:
+                getGrid ()->setMaxFallingSpeed ();
+                break;
+
+            case MoveLeft:
+                getGrid ()->moveLeft ();
+                break;
+
+            case MoveRight:
+                getGrid ()->moveRight ();
+                break;
+
+            case NormalFallingSpeed:
+                getGrid ()->setNormalFallingSpeed ();
+                break;
+
+            case RotateClockwise:
+                getGrid ()->rotateClockwise ();
+                break;
+
+            case RotateCounterClockwise:
+                getGrid ()->rotateCounterClockwise ();
+                break;
+        }
+        appliedInputs.push_back (input.time);
+        m_Inputs.pop_front ();
+    }
+}
 
 void
 HumanPlayer::joyMotion (uint8_t joystick, uint8_t axis, int16_t value)
@@ -41,19 +88,19 @@ HumanPlayer::joyMotion (uint8_t joystick, uint8_t axis, int16_t value)
     switch (m_Joystick.motion (joystick, axis, value))
     {
         case Joystick::DownPressed:
-            getGrid ()->setMaxFallingSpeed ();
+            queueAction (MaxFallingSpeed);
             break;
 
         case Joystick::DownReleased:
-            getGrid ()->setNormalFallingSpeed ();
+            queueAction (NormalFallingSpeed);
             break;
 
         case Joystick::LeftPressed:
-            getGrid ()->moveLeft ();
+            queueAction (MoveLeft);
             break;
 
         case Joystick::RightPressed:
-            getGrid ()->moveRight ();
+            queueAction (MoveRight);
             break;
 
         default:
@@ -69,24 +116,24 @@ HumanPlayer::joyDown (uint8_t joystick, SDL_GameControllerButton button)
     {
         case SDL_CONTROLLER_BUTTON_A:
         case SDL_CONTROLLER_BUTTON_LEFTSHOULDER:
-            getGrid ()->rotateCounterClockwise ();
+            queueAction (RotateCounterClockwise);
         break;
 
         case SDL_CONTROLLER_BUTTON_B:
         case SDL_CONTROLLER_BUTTON_RIGHTSHOULDER:
-            getGrid ()->rotateClockwise ();
+            queueAction (RotateClockwise);
         break;
 
         case SDL_CONTROLLER_BUTTON_DPAD_DOWN:
-            getGrid ()->setMaxFallingSpeed ();
+            queueAction (MaxFallingSpeed);
         break;
 
         case SDL_CONTROLLER_BUTTON_DPAD_LEFT:
-            getGrid ()->moveLeft ();
+            queueAction (MoveLeft);
         break;
 
         case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:
-            getGrid ()->moveRight ();
+            queueAction (MoveRight);
         break;
 
         default:
@@ -97,11 +144,11 @@ HumanPlayer::joyDown (uint8_t joystick, SDL_GameControllerButton button)
     switch ( m_Joystick.down (joystick, button) )
     {
         case Joystick::RotateCWPressed:
-            getGrid ()->rotateClockwise ();
+            queueAction (RotateClockwise);
             break;
 
         case Joystick::RotateCCWPressed:
-            getGrid ()->rotateCounterClockwise ();
+            queueAction (RotateCounterClockwise);
             break;
 
         default:
@@ -115,7 +162,7 @@ HumanPlayer::joyUp (uint8_t joystick, SDL_GameControllerButton button)
 {
     if ( SDL_CONTROLLER_BUTTON_DPAD_DOWN == button )
     {
-        getGrid ()->setNormalFallingSpeed ();
+        queueAction (NormalFallingSpeed);
     }
 }
 
@@ -126,23 +173,23 @@ HumanPlayer::keyDown (uint32_t key)
     {
         if ( m_PlayerControls.keyboard.moveLeft == key )
         {
-            getGrid ()->moveLeft ();
+            queueAction (MoveLeft);
         }
         else if ( m_PlayerControls.keyboard.moveRight == key )
         {
-            getGrid ()->moveRight ();
+            queueAction (MoveRight);
         }
         else if ( m_PlayerControls.keyboard.pushDown == key )
         {
-            getGrid ()->setMaxFallingSpeed ();
+            queueAction (MaxFallingSpeed);
         }
         else if ( m_PlayerControls.keyboard.rotateClockwise == key )
         {
-            getGrid ()->rotateClockwise ();
+            queueAction (RotateClockwise);
         }
         else if ( m_PlayerControls.keyboard.rotateCounterClockwise == key )
         {
-            getGrid ()->rotateCounterClockwise ();
+            queueAction (RotateCounterClockwise);
         }
     }
 }
@@ -153,7 +200,7 @@ HumanPlayer::keyUp (uint32_t key)
     if ( Options::KeyboardControls == m_PlayerControls.controlsType &&
          m_PlayerControls.keyboard.pushDown == key )
     {
-        getGrid ()->setNormalFallingSpeed ();
+        queueAction (NormalFallingSpeed);
     }
 }
 
@@ -163,3 +210,18 @@ HumanPlayer::loadOptions (void)
     m_PlayerControls = Options::getInstance ().getPlayerControls (getSide ());
     m_Joystick.setControls (m_PlayerControls);
 }
+
+///
+/// \brief Queues an action to apply at the tick it happened in.
+///
+/// \param action The action to queue with the time of the current event.
+///
+void
+HumanPlayer::queueAction (Action action)
+{
+    Input input;
+    input.action = action;
+    input.time = System::getInstance ().getEventTime ();
+    std::lock_guard<std::mutex> lock (m_InputsMutex);
+    m_Inputs.push_back (input);
+}
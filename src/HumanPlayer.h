@@ -19,6 +19,8 @@
 #if !defined (AMOEBAX_HUMAN_PLAYER_H)
 #define AMOEBAX_HUMAN_PLAYER_H
 
+#include <deque>
+#include <mutex>
 #include "IPlayer.h"
 #include "Joystick.h"
 #include "Options.h"
@@ -29,11 +31,18 @@ namespace Amoebax
     /// \class HumanPlayer
     /// \brief A player controlled by keyboard or joystick.
     ///
+    /// The keys and buttons are not applied to the grid when they are
+    /// received, but queued with the time of their event and applied
+    /// at the start of the logic tick that they happened in, which can
+    /// be in another thread.
+    ///
     class HumanPlayer: public IPlayer
     {
         public:
             explicit HumanPlayer (IPlayer::PlayerSide side);
 
+            virtual void applyInputs (uint32_t time,
+                                      std::vector<uint32_t> &appliedInputs);
             virtual void joyMotion (uint8_t joystick, uint8_t axis,
                                     int16_t value);
             virtual void joyDown (uint8_t joystick, SDL_GameControllerButton button);
@@ -42,8 +51,45 @@ namespace Amoebax
             virtual void keyUp (uint32_t key);
 
         private:
+            ///
+            /// \enum Action
+            /// \brief The actions the player can do to the grid.
+            ///
+            enum Action
+            {
+                /// Make the falling pair fall at the maximum speed.
+                MaxFallingSpeed,
+                /// Move the falling pair to the left.
+                MoveLeft,
+                /// Move the falling pair to the right.
+                MoveRight,
+                /// Make the falling pair fall at the normal speed.
+                NormalFallingSpeed,
+                /// Rotate the falling pair clockwise.
+                RotateClockwise,
+                /// Rotate the falling pair counter clockwise.
+                RotateCounterClockwise
+            };
+
+            ///
+            /// \struct Input
+            /// \brief An action and the time the player did it.
+            ///
+            struct Input
+            {
+                /// The action to apply to the grid.
+                Action action;
+                /// The time of the event that did the action.
+                uint32_t time;
+            };
+
             void loadOptions (void);
+            void queueAction (Action action);
 
+            /// The actions not yet applied to the grid, oldest first.
+            std::deque<Input> m_Inputs;
+            /// Guards m_Inputs.
+            std::mutex m_InputsMutex;
             /// The joystick handler.
             Joystick m_Joystick;
             /// The player's controls.
@@ -20,6 +20,7 @@
 #define AMOEBAX_IPLAYER_H
 
 #include <memory>
+#include <vector>
 #include <SDL.h>
 #include "Grid.h"
 
@@ -59,6 +60,23 @@ namespace Amoebax
             ///
             inline virtual ~IPlayer (void) { }
 
+            ///
+            /// \brief Applies the inputs received until a time.
+            ///
+            /// The states call this function before each logic tick,
+            /// so the players that queue their inputs can apply them
+            /// at the tick they happened in.  By default it does nothing.
+            ///
+            /// \param time The time the tick ends at, in the same
+            ///             milliseconds as System::getEventTime().
+            /// \param appliedInputs The vector to add the time of each
+            ///                      applied input to, so the state can
+            ///                      tell FrameManager once they are
+            ///                      drawn.
+            ///
+            virtual void applyInputs (uint32_t time,
+                                      std::vector<uint32_t> &appliedInputs) { }
+
             ///
             /// \brief Gets the player's grid.
             ///
@@ -19,6 +19,7 @@
 #if !defined (AMOEBAX_ISTATE_H)
 #define AMOEBAX_ISTATE_H
 
+#include <iosfwd>
 #include <memory>
 #include <stdint.h>
 #include "Font.h"
@@ -47,6 +48,9 @@ namespace Amoebax
     class IState
     {
         public:
+            /// The maximum time the system waits for events, in ms.
+            static const uint32_t k_MaxIdleTime = 1000;
+
             ///
             /// \brief IState default constructor.
             ///
@@ -68,6 +72,20 @@ namespace Amoebax
             ///
             virtual void activate (void) { }
 
+            ///
+            /// \brief Gets how long the state has nothing to animate.
+            ///
+            /// While the state has nothing to animate, the system
+            /// waits for events instead of updating and rendering the
+            /// same frame again.  The system waits at most
+            /// k_MaxIdleTime.
+            ///
+            /// \return The milliseconds the state can go without
+            ///         updates if no event arrives, or 0 if the state
+            ///         must be updated every frame.
+            ///
+            inline virtual uint32_t getIdleTime (void) { return 0; }
+
             ///
             /// \brief A joystick axis motion event was received.
             ///
@@ -175,6 +193,17 @@ namespace Amoebax
             /// new mode.
             ///
             virtual void videoModeChanged (void) = 0;
+
+            ///
+            /// \brief Writes the state's boards as text.
+            ///
+            /// The flight recorder calls this when it dumps the last
+            /// frames, maybe from its watchdog thread while the main
+            /// loop is stuck.  States without boards write nothing.
+            ///
+            /// \param stream The stream to write the boards to.
+            ///
+            inline virtual void writeBoards (std::ostream &stream) { }
     };
 }
 
@@ -34,6 +34,7 @@
 #include "SimpleAIPlayer.h"
 #include "System.h"
 #include "TournamentMenuState.h"
+#include "Tracer.h"
 #include "TrainingState.h"
 #include "TwoPlayersState.h"
 
@@ -52,6 +53,7 @@ MainMenuState::MainMenuState (void):
     m_SelectedOption (m_MenuOptions.begin ()),
     m_TimeToDemo (k_TimeToDemo)
 {
+    AMOEBAX_TRACE_ZONE ("MainMenuState::MainMenuState");
     loadGraphicResources ();
 
     // Initialize menu option.
@@ -93,6 +95,13 @@ MainMenuState::activateMenuOption (void)
     (*(*m_SelectedOption)) ();
 }
 
+uint32_t
+MainMenuState::getIdleTime (void)
+{
+    // Besides the events, only starting the demo changes the screen.
+    return std::max (getTimeToDemo (), 0);
+}
+
 ///
 /// \brief Gets the time until the demo is activated.
 ///
@@ -179,6 +188,7 @@ MainMenuState::keyUp (uint32_t key)
 void
 MainMenuState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("MainMenuState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
 
     m_Background.reset (
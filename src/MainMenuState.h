@@ -34,6 +34,7 @@ namespace Amoebax
             virtual ~MainMenuState (void);
 
             virtual void activate (void);
+            virtual uint32_t getIdleTime (void);
             virtual void joyMotion (uint8_t joystick, uint8_t axis,
                                     int16_t value);
             virtual void joyDown (uint8_t joystick, SDL_GameControllerButton button);
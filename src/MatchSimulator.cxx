@@ -0,0 +1,122 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <cassert>
+#include "AIPlayerFactory.h"
+#include "Grid.h"
+#include "MatchSimulator.h"
+#include "Random.h"
+#include "TwoPlayersMatch.h"
+
+using namespace Amoebax;
+
+/// The amoebas' size. The same TwoPlayersState uses at 1280x960.
+static const uint16_t k_AmoebasSize = 64;
+
+// The definitions of the class' constants, for when they are used by reference.
+const uint32_t MatchSimulator::k_DefaultStepTime;
+const uint32_t MatchSimulator::k_DefaultMaxMatchTime;
+
+///
+/// \brief Gets the winner of a match, even if it's not finished.
+///
+/// If the match is finished, the winner is the result's winner.
+/// Otherwise the player that made more points during the match wins,
+/// and if both made the same points the winner is chosen at random
+/// with AIPlayerFactory::getWinner().
+///
+/// \param result The match's result.
+/// \param leftLevel The level of the left computer player.
+/// \param rightLevel The level of the right computer player.
+/// \param leftScore The initial score of the left player.
+/// \param rightScore The initial score of the right player.
+/// \return The side of the player that won the match.
+///
+IPlayer::PlayerSide
+MatchSimulator::adjudicate (const Result &result, uint8_t leftLevel,
+                            uint8_t rightLevel, uint32_t leftScore,
+                            uint32_t rightScore)
+{
+    if ( result.finished )
+    {
+        return result.winner;
+    }
+
+    uint32_t leftPoints = result.leftScore - leftScore;
+    uint32_t rightPoints = result.rightScore - rightScore;
+    if ( leftPoints != rightPoints )
+    {
+        return leftPoints > rightPoints ? IPlayer::LeftSide :
+                                          IPlayer::RightSide;
+    }
+    return AIPlayerFactory::getWinner (leftLevel, rightLevel);
+}
+
+///
+/// \brief Plays a whole match between two computer players.
+///
+/// \param leftLevel The level of the left computer player.
+/// \param rightLevel The level of the right computer player.
+/// \param seed The seed of the match's pseudo-random numbers.
+/// \param leftScore The initial score of the left player.
+/// \param rightScore The initial score of the right player.
+/// \param stepTime The elapsed time to pass to each update, in ms.
+/// \param maxMatchTime The max. time the match can last, in ms.
+///                     Matches that last more are not finished.
+/// \param stop If not null, the match is stopped, and left not finished,
+///             as soon as this flag is set to \a true by another thread.
+/// \return The match's result.
+///
+MatchSimulator::Result
+MatchSimulator::play (uint8_t leftLevel, uint8_t rightLevel, uint32_t seed,
+                      uint32_t leftScore, uint32_t rightScore,
+                      uint32_t stepTime, uint32_t maxMatchTime,
+                      const std::atomic<bool> *stop)
+{
+    assert ( 0 < stepTime && "The step time must be greater than 0." );
+
+    Random::init (seed);
+    TwoPlayersMatch match (
+            AIPlayerFactory::create (leftLevel, IPlayer::LeftSide),
+            AIPlayerFactory::create (rightLevel, IPlayer::RightSide));
+    // Nothing is drawn, so the grids' positions are irrelevant, and
+    // nothing is heard either, so they are silent.
+    match.setGrids (new Grid (0, 0, 0, 0, 0, 0, k_AmoebasSize,
+                              Grid::QueueSideRight, leftScore,
+                              Grid::LayoutVertical, true),
+                    new Grid (0, 0, 0, 0, 0, 0, k_AmoebasSize,
+                              Grid::QueueSideLeft, rightScore,
+                              Grid::LayoutVertical, true));
+
+    while ( !match.isOver () && match.getElapsedTime () < maxMatchTime &&
+            (0 == stop || !stop->load ()) )
+    {
+        match.update (stepTime);
+    }
+
+    Result result;
+    result.finished = match.isOver ();
+    result.winner = match.getWinner ();
+    result.leftScore = match.getLeftGrid ()->getScore ();
+    result.rightScore = match.getRightGrid ()->getScore ();
+    result.duration = match.getElapsedTime ();
+    result.leftMaxChain = match.getLeftGrid ()->getMaxStepChain ();
+    result.rightMaxChain = match.getRightGrid ()->getMaxStepChain ();
+
+    return result;
+}
@@ -0,0 +1,94 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_MATCH_SIMULATOR_H)
+#define AMOEBAX_MATCH_SIMULATOR_H
+
+#include <atomic>
+#include <stdint.h>
+#include "Grid.h"
+#include "IPlayer.h"
+
+namespace Amoebax
+{
+    ///
+    /// \class MatchSimulator.
+    /// \brief Plays matches between two computer players without a screen.
+    ///
+    /// The match is the same TwoPlayersMatch that TwoPlayersState plays,
+    /// but updated with a fixed elapsed time as fast as the CPU can,
+    /// without loading any graphic, sound or music. All random numbers
+    /// come from the Random generator of the calling thread, seeded with
+    /// the match's seed, so many matches can be played in parallel and
+    /// the same seed always gives the same match.
+    ///
+    class MatchSimulator
+    {
+        public:
+            /// The default time between two updates, in ms: a logic tick.
+            static const uint32_t k_DefaultStepTime = Grid::k_TickTime;
+            /// The default max. match's time before calling it a draw, in ms.
+            static const uint32_t k_DefaultMaxMatchTime = 30 * 60 * 1000;
+
+            ///
+            /// \struct Result
+            /// \brief The outcome of a simulated match.
+            ///
+            struct Result
+            {
+                /// Tells if the match ended before the max. match time.
+                bool finished;
+                /// The winner's side. Only valid if \a finished is \a true.
+                IPlayer::PlayerSide winner;
+                /// The left player's score at the end of the match.
+                uint32_t leftScore;
+                /// The right player's score at the end of the match.
+                uint32_t rightScore;
+                /// The match's duration in simulated milliseconds.
+                uint32_t duration;
+                /// The longest chain made by the left player.
+                uint8_t leftMaxChain;
+                /// The longest chain made by the right player.
+                uint8_t rightMaxChain;
+            };
+
+            static IPlayer::PlayerSide adjudicate (const Result &result,
+                                                   uint8_t leftLevel,
+                                                   uint8_t rightLevel,
+                                                   uint32_t leftScore = 0,
+                                                   uint32_t rightScore = 0);
+            static Result play (uint8_t leftLevel, uint8_t rightLevel,
+                                uint32_t seed,
+                                uint32_t leftScore = 0,
+                                uint32_t rightScore = 0,
+                                uint32_t stepTime = k_DefaultStepTime,
+                                uint32_t maxMatchTime = k_DefaultMaxMatchTime,
+                                const std::atomic<bool> *stop = 0);
+
+        private:
+            ///
+            /// \brief Constructor.
+            ///
+            /// \note Declared private because we don't want objects
+            ///       of this class.
+            ///
+            MatchSimulator (void);
+    };
+}
+
+#endif // !AMOEBAX_MATCH_SIMULATOR_H
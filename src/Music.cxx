@@ -21,6 +21,7 @@
 #include <stdexcept>
 #include "Music.h"
 #include "System.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
@@ -49,6 +50,7 @@ Music::~Music (void)
 Music *
 Music::fromFile (const std::string &fileName)
 {
+    AMOEBAX_TRACE_ZONE ("Music::fromFile");
     Music *newMusic = new Music;
     if ( System::getInstance ().isSoundEnabled () )
     {
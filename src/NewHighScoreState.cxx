@@ -23,6 +23,7 @@
 #include "NewHighScoreState.h"
 #include "Options.h"
 #include "System.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
@@ -44,6 +45,7 @@ NewHighScoreState::NewHighScoreState (uint32_t score):
     m_NameFont (nullptr),
     m_Score (score)
 {
+    AMOEBAX_TRACE_ZONE ("NewHighScoreState::NewHighScoreState");
     loadGraphicResources ();
 }
 
@@ -250,6 +252,7 @@ NewHighScoreState::keyUp (uint32_t key)
 void
 NewHighScoreState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("NewHighScoreState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
 
     // Load fonts.
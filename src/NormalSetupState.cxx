@@ -21,6 +21,7 @@
 #include "System.h"
 #include "NormalSetupState.h"
 #include "NormalState.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
@@ -46,6 +47,7 @@ NormalSetupState::NormalSetupState (void):
     m_SelectedCharacter (0),
     m_StateRemoved (false)
 {
+    AMOEBAX_TRACE_ZONE ("NormalSetupState::NormalSetupState");
     loadGraphicResources ();
 }
 
@@ -148,6 +150,7 @@ NormalSetupState::keyUp (uint32_t key)
 void
 NormalSetupState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("NormalSetupState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
     const float originalScale = 1.0f;
     m_Background.reset (
@@ -23,6 +23,7 @@
 #include "HumanPlayer.h"
 #include "NormalState.h"
 #include "System.h"
+#include "Tracer.h"
 #include "TryAgainState.h"
 #include "TwoPlayersState.h"
 #include "VersusState.h"
@@ -50,6 +51,7 @@ NormalState::NormalState (const std::string &characterName):
     m_TryAgain (false),
     m_Winner (IPlayer::RightSide)
 {
+    AMOEBAX_TRACE_ZONE ("NormalState::NormalState");
     loadGraphicsResources ();
 }
 
@@ -161,6 +163,7 @@ NormalState::keyUp (uint32_t key)
 void
 NormalState::loadGraphicsResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("NormalState::loadGraphicsResources");
 }
 
 ///
@@ -16,6 +16,8 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
+#include <algorithm>
+#include <assert.h>
 #include <SDL.h>
 #include <sstream>
 #include "Options.h"
@@ -57,10 +59,20 @@ static std::string k_PlayersName[2] =
     std::string ("leftPlayer"),
     std::string ("rightPlayer")
 };
+// Default frame rate.
+static const unsigned int k_FrameRate = 30;
+// The frame rates that can be set, in frames per second.
+static const unsigned int k_FrameRates[] = { 30, 60, 120, 144 };
+// The number of frame rates that can be set.
+static const size_t k_NumFrameRates = sizeof (k_FrameRates) / sizeof (k_FrameRates[0]);
 // Default screen's height.
 static const unsigned int k_ScreenHeight = 600;
 // Default screen's width.
 static const unsigned int k_ScreenWidth = 800;
+// The screen heights that have fonts, at a 4:3 aspect ratio.
+static const unsigned int k_ScreenHeights[] = { 480, 600, 768, 960 };
+// The number of screen heights that have fonts.
+static const size_t k_NumScreenHeights = sizeof (k_ScreenHeights) / sizeof (k_ScreenHeights[0]);
 // Default volume level.
 static const int k_VolumeLevel = 5;
 // Maximum volume level.
@@ -214,6 +226,20 @@ Options::getPlayerControls (IPlayer::PlayerSide player)
     return playerControls;
 }
 
+///
+/// \brief Gets the frame rate to use.
+///
+/// \return The frames per second to render.  If the configured frame
+///         rate isn't supported, the default frame rate.
+///
+unsigned int
+Options::getFrameRate (void)
+{
+    unsigned int frameRate = getIntegerValue ("screen", "framerate",
+                                              k_FrameRate);
+    return isFrameRateSupported (frameRate) ? frameRate : k_FrameRate;
+}
+
 ///
 /// \brief Gets the screen height to use.
 ///
@@ -263,6 +289,20 @@ Options::incrementVolume (void)
     }
 }
 
+///
+/// \brief Tells if a frame rate can be set.
+///
+/// \param frameRate The frames per second to check.
+/// \return \a true if \p frameRate is one of 30, 60, 120 or 144
+///         frames per second, \a false otherwise.
+///
+bool
+Options::isFrameRateSupported (unsigned int frameRate)
+{
+    return std::find (k_FrameRates, k_FrameRates + k_NumFrameRates,
+                      frameRate) != k_FrameRates + k_NumFrameRates;
+}
+
 ///
 /// \brief Tells if the screen is configured in full screen mode.
 ///
@@ -287,6 +327,22 @@ Options::isHighScore (uint32_t score)
     return findScorePosition (score) != m_HighScore.end();
 }
 
+///
+/// \brief Tells if a screen resolution can be set.
+///
+/// \param width The screen's width to check.
+/// \param height The screen's height to check.
+/// \return \a true if \p width and \p height are one of 640x480,
+///         800x600, 1024x768 or 1280x960, \a false otherwise.
+///
+bool
+Options::isScreenResolutionSupported (unsigned int width, unsigned int height)
+{
+    return width * 3 == height * 4 &&
+           std::find (k_ScreenHeights, k_ScreenHeights + k_NumScreenHeights,
+                      height) != k_ScreenHeights + k_NumScreenHeights;
+}
+
 ///
 /// \brief Tells if the sound is enabled.
 ///
@@ -476,6 +532,20 @@ Options::setPlayerControls (IPlayer::PlayerSide player,
     setIntegerValue (sectionName, "JoyRotateCCW", controls.joystick.rotateCounterClockwise);
 }
 
+///
+/// \brief Sets the frame rate to use.
+///
+/// \param frameRate The frames per second to render.  Must be one of
+///                  the supported frame rates.
+///
+void
+Options::setFrameRate (unsigned int frameRate)
+{
+    assert (isFrameRateSupported (frameRate) &&
+            "Tried to set an unsupported frame rate.");
+    setIntegerValue ("screen", "framerate", frameRate);
+}
+
 ///
 /// \brief Sets the screen height to use.
 ///
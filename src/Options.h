@@ -92,6 +92,7 @@ namespace Amoebax
             virtual ~Options (void);
 
             void decrementVolume (void);
+            unsigned int getFrameRate (void);
             std::list<HighScore> &getHighScoreList(void);
             static Options &getInstance (void);
             static unsigned int getMaxVolumeLevel (void);
@@ -100,12 +101,16 @@ namespace Amoebax
             unsigned int getScreenWidth (void);
             unsigned int getVolumeLevel (void);
             void incrementVolume (void);
+            static bool isFrameRateSupported (unsigned int frameRate);
             bool isFullScreen (void);
             bool isHighScore (uint32_t score);
+            static bool isScreenResolutionSupported (unsigned int width,
+                                                     unsigned int height);
             bool isSoundEnabled (void);
             bool isVideoOptionsAtDefault (void);
             void setDefaultVideoOptions (void);
             void setDefaultPlayersControls (void);
+            void setFrameRate (unsigned int frameRate);
             void setFullScreen (bool fullScreen);
             void setHighScore (uint32_t score, const std::string &name);
             void setPlayerControls (IPlayer::PlayerSide player,
@@ -25,6 +25,7 @@
 #include "OptionsMenuState.h"
 #include "Options.h"
 #include "System.h"
+#include "Tracer.h"
 #include "TrainingState.h"
 
 using namespace Amoebax;
@@ -42,6 +43,7 @@ OptionsMenuState::OptionsMenuState (void):
     m_RightControls (Options::getInstance ().getPlayerControls (IPlayer::RightSide)),
     m_SelectedOption ()
 {
+    AMOEBAX_TRACE_ZONE ("OptionsMenuState::OptionsMenuState");
     loadGraphicResources ();
 
     // Initialize menu options option.
@@ -81,6 +83,13 @@ OptionsMenuState::activateMenuOption (void)
     (*(*m_SelectedOption)) ();
 }
 
+uint32_t
+OptionsMenuState::getIdleTime (void)
+{
+    // The screen only changes with the events.
+    return k_MaxIdleTime;
+}
+
 void
 OptionsMenuState::joyMotion (uint8_t joystick, uint8_t axis, int16_t value)
 {
@@ -171,6 +180,7 @@ OptionsMenuState::keyUp (uint32_t key)
 void
 OptionsMenuState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("OptionsMenuState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
 
     m_Background.reset (
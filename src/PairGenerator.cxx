@@ -22,6 +22,7 @@
 #include <stdexcept>
 #include "Grid.h"
 #include "PairGenerator.h"
+#include "Random.h"
 
 using namespace Amoebax;
 
@@ -48,9 +49,9 @@ PairGenerator::generate (uint8_t pairsToGenerate) const
     for ( uint8_t currentPair = 0 ; currentPair < pairsToGenerate ; ++currentPair )
     {
         Amoeba::Colour firstAmoeba =
-            static_cast<Amoeba::Colour>(rand () % Amoeba::ColourGhost);
+            static_cast<Amoeba::Colour>(Random::get () % Amoeba::ColourGhost);
         Amoeba::Colour secondAmoeba =
-            static_cast<Amoeba::Colour>(rand () % Amoeba::ColourGhost);
+            static_cast<Amoeba::Colour>(Random::get () % Amoeba::ColourGhost);
 
         std::for_each (m_Grids.begin (), m_Grids.end (),
                        GeneratePair (firstAmoeba, secondAmoeba));
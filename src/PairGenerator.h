@@ -65,30 +65,15 @@ namespace Amoebax
                 ///
                 /// \brief Adds a new amoeba pair to a grid.
                 ///
-                /// The new pair will be created using the colours given at the
-                /// constructor and will be passed to the \a grid. The grid
-                /// then has the ownership and those amoebas and must
-                /// destroy it when no longer needed.
+                /// The grid will create the new pair using the colours given
+                /// at the constructor.
                 ///
                 /// \param grid The grid to add the new pair to.
                 ///
                 void
                 operator() (Grid *grid)
                 {
-                    Amoeba *firstAmoeba = 0;
-                    Amoeba *secondAmoeba = 0;
-                    try
-                    {
-                        firstAmoeba = new Amoeba (firstAmoebaColour);
-                        secondAmoeba = new Amoeba (secondAmoebaColour);
-                    }
-                    catch (std::exception &e)
-                    {
-                        delete firstAmoeba;
-                        delete secondAmoeba;
-                        throw e;
-                    }
-                    grid->addNewPair (firstAmoeba, secondAmoeba);
+                    grid->addNewPair (firstAmoebaColour, secondAmoebaColour);
                 }
             };
 
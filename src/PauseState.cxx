@@ -17,11 +17,13 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
 #include <SDL.h>
+#include "Fader.h"
 #include "File.h"
 #include "Font.h"
 #include "Options.h"
 #include "PauseState.h"
 #include "System.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
@@ -31,6 +33,7 @@ using namespace Amoebax;
 PauseState::PauseState (void):
     IState ()
 {
+    AMOEBAX_TRACE_ZONE ("PauseState::PauseState");
     loadGraphicResources ();
 
     // Initialize menu options.
@@ -128,21 +131,10 @@ PauseState::keyUp (uint32_t key)
 void
 PauseState::loadGraphicResources (void)
 {
-    // Capture the background from the screen, and blit an alpha blended
-    // black surface.
+    AMOEBAX_TRACE_ZONE ("PauseState::loadGraphicResources");
+    // Capture the background from the screen, and dim it.
     m_Background.reset (Surface::fromScreen ());
-    SDL_Surface *blackBox =
-        SDL_CreateRGBSurface (0,
-                              m_Background->getWidth (),
-                              m_Background->getHeight (),
-                              m_Background->toSDLSurface ()->format->BitsPerPixel,
-                              m_Background->toSDLSurface ()->format->Rmask,
-                              m_Background->toSDLSurface ()->format->Gmask,
-                              m_Background->toSDLSurface ()->format->Bmask,
-                              m_Background->toSDLSurface ()->format->Amask);
-    SDL_FillRect (blackBox, NULL, SDL_MapRGB (blackBox->format, 0, 0, 0));
-    SDL_SetSurfaceAlphaMod (blackBox, 128);
-    SDL_BlitSurface (blackBox, NULL, m_Background->toSDLSurface (), NULL);
+    Fader::dim (*m_Background, 128);
 
     // Load fonts.
     m_Font.reset (Font::fromFile (File::getFontFilePath ("fontMenu")));
@@ -0,0 +1,341 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <algorithm>
+#include <stdexcept>
+#include "AllocationTracker.h"
+#include "FrameManager.h"
+#include "Profiler.h"
+#include "System.h"
+
+using namespace Amoebax;
+
+// Class static members.
+bool Profiler::m_AlwaysEnabled = false;
+std::atomic<bool> Profiler::m_Enabled (false);
+std::vector<Profiler::Frame> Profiler::m_Frames (Profiler::k_NumFrames);
+bool Profiler::m_GraphVisible = false;
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+uint64_t Profiler::m_LastAllocatedBytes = 0;
+uint64_t Profiler::m_LastAllocations = 0;
+#endif // AMOEBAX_ALLOCATION_TRACKING
+uint64_t Profiler::m_LastFrameEnd = 0;
+unsigned int Profiler::m_NextFrame = 0;
+std::atomic<uint64_t> Profiler::m_PhaseTimes[Profiler::k_NumPhases];
+std::ofstream Profiler::m_RecordFile;
+std::string Profiler::m_RecordFileName ("amoebax-profile.csv");
+uint64_t Profiler::m_RecordedFrames = 0;
+
+// The definitions of the class' constants, for when they are used by reference.
+const unsigned int Profiler::k_NumPhases;
+const unsigned int Profiler::k_NumFrames;
+
+/// The width of each frame's bar, in pixels.
+static const int k_BarWidth = 3;
+/// The graph's height, in pixels.  The middle is the frame's duration.
+static const int k_GraphHeight = 150;
+/// The distance from the graph to the screen's bottom-left corner.
+static const int k_GraphMargin = 8;
+/// The colour of each phase in the graph, in red, green and blue.
+static const uint8_t k_PhaseColours[Profiler::k_NumPhases][3] =
+{
+    {160, 160, 160},    // Events.
+    {64, 128, 255},     // Update.
+    {64, 224, 64},      // Grid.
+    {255, 64, 64},      // AI.
+    {255, 192, 64},     // Background.
+    {192, 64, 255},     // Render.
+    {64, 224, 224}      // Present.
+};
+/// The order the phases are stacked in the graph's bars, from the bottom.
+static const Profiler::Phase k_StackedPhases[Profiler::k_NumPhases] =
+{
+    Profiler::PhaseEvents, Profiler::PhaseAI, Profiler::PhaseGrid,
+    Profiler::PhaseUpdate, Profiler::PhaseBackground, Profiler::PhaseRender,
+    Profiler::PhasePresent
+};
+
+///
+/// \brief Converts performance counter ticks to microseconds.
+///
+/// \param counter The performance counter ticks to convert.
+/// \return The microseconds in \p counter.
+///
+static uint32_t
+toMicroseconds (uint64_t counter)
+{
+    return static_cast<uint32_t>(1000000.0 * counter /
+                                 SDL_GetPerformanceFrequency ());
+}
+
+///
+/// \brief Adds time to a phase of the current frame.
+///
+/// \param phase The phase to add the time to.
+/// \param counter The performance counter ticks to add.
+///
+void
+Profiler::addTime (Phase phase, uint64_t counter)
+{
+    m_PhaseTimes[phase].fetch_add (counter, std::memory_order_relaxed);
+}
+
+///
+/// \brief Draws the bar graph of the last frames, if it is visible.
+///
+/// Each bar stacks the time of a frame's phases.  The time updating the
+/// grids and the players is drawn apart from the rest of the update, and
+/// the white line is the time a frame lasts at the current frame rate.
+/// The frames that allocated, if tracked, are marked in red at the top.
+///
+/// \param screen The screen to draw the graph to.
+///
+void
+Profiler::draw (SDL_Surface *screen)
+{
+    if ( !isGraphVisible () )
+    {
+        return;
+    }
+
+    SDL_Rect graph;
+    graph.x = k_GraphMargin;
+    graph.y = screen->h - k_GraphHeight - k_GraphMargin;
+    graph.w = k_NumFrames * k_BarWidth;
+    graph.h = k_GraphHeight;
+    SDL_FillRect (screen, &graph, SDL_MapRGB (screen->format, 0, 0, 0));
+
+    const float graphTime = 2000000.0f / FrameManager::getFrameRate ();
+    for ( unsigned int bar = 0 ; bar < k_NumFrames ; ++bar )
+    {
+        Frame frame = m_Frames[(m_NextFrame + bar) % k_NumFrames];
+        frame.phaseTimes[PhaseUpdate] -=
+            std::min (frame.phaseTimes[PhaseUpdate],
+                      frame.phaseTimes[PhaseGrid] + frame.phaseTimes[PhaseAI]);
+
+        uint32_t frameTime = 0;
+        int16_t barTop = graph.y + graph.h;
+        for ( unsigned int stacked = 0 ; stacked < k_NumPhases ; ++stacked )
+        {
+            const Phase phase = k_StackedPhases[stacked];
+            frameTime += frame.phaseTimes[phase];
+            const int16_t phaseTop = graph.y + graph.h -
+                static_cast<int16_t>(std::min (1.0f, frameTime / graphTime) *
+                                     graph.h);
+            if ( phaseTop < barTop )
+            {
+                SDL_Rect phaseBar;
+                phaseBar.x = graph.x + bar * k_BarWidth;
+                phaseBar.y = phaseTop;
+                phaseBar.w = k_BarWidth;
+                phaseBar.h = barTop - phaseTop;
+                SDL_FillRect (screen, &phaseBar,
+                              SDL_MapRGB (screen->format,
+                                          k_PhaseColours[phase][0],
+                                          k_PhaseColours[phase][1],
+                                          k_PhaseColours[phase][2]));
+                barTop = phaseTop;
+            }
+        }
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+        if ( 0 < frame.allocations )
+        {
+            SDL_Rect allocationMark;
+            allocationMark.x = graph.x + bar * k_BarWidth;
+            allocationMark.y = graph.y;
+            allocationMark.w = k_BarWidth;
+            allocationMark.h = k_BarWidth;
+            SDL_FillRect (screen, &allocationMark,
+                          SDL_MapRGB (screen->format, 255, 0, 0));
+        }
+#endif // AMOEBAX_ALLOCATION_TRACKING
+    }
+
+    SDL_Rect frameLine;
+    frameLine.x = graph.x;
+    frameLine.y = graph.y + graph.h / 2;
+    frameLine.w = graph.w;
+    frameLine.h = 1;
+    SDL_FillRect (screen, &frameLine,
+                  SDL_MapRGB (screen->format, 255, 255, 255));
+
+    System::getInstance ().invalidateScreenRegion (&graph);
+}
+
+///
+/// \brief Keeps the times of the frame that just ended.
+///
+/// If the frames are being recorded, also writes them to the CSV file,
+/// in microseconds.
+///
+void
+Profiler::endFrame (void)
+{
+    const uint64_t frameEnd = SDL_GetPerformanceCounter ();
+    Frame &frame = m_Frames[m_NextFrame];
+    for ( unsigned int phase = 0 ; phase < k_NumPhases ; ++phase )
+    {
+        frame.phaseTimes[phase] =
+            toMicroseconds (m_PhaseTimes[phase].exchange (0));
+    }
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+    const uint64_t allocations = AllocationTracker::getAllocations ();
+    const uint64_t allocatedBytes = AllocationTracker::getAllocatedBytes ();
+    frame.allocations = static_cast<uint32_t>(allocations - m_LastAllocations);
+    frame.allocatedBytes =
+        static_cast<uint32_t>(allocatedBytes - m_LastAllocatedBytes);
+    m_LastAllocations = allocations;
+    m_LastAllocatedBytes = allocatedBytes;
+#endif // AMOEBAX_ALLOCATION_TRACKING
+    m_NextFrame = (m_NextFrame + 1) % k_NumFrames;
+
+    if ( isRecording () )
+    {
+        m_RecordFile << m_RecordedFrames;
+        for ( unsigned int phase = 0 ; phase < k_NumPhases ; ++phase )
+        {
+            m_RecordFile << "," << frame.phaseTimes[phase];
+        }
+        m_RecordFile << "," << toMicroseconds (frameEnd - m_LastFrameEnd);
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+        m_RecordFile << "," << frame.allocations << "," << frame.allocatedBytes;
+#endif // AMOEBAX_ALLOCATION_TRACKING
+        m_RecordFile << "\n";
+        ++m_RecordedFrames;
+    }
+    m_LastFrameEnd = frameEnd;
+}
+
+///
+/// \brief Gets the time a phase took in the last frame.
+///
+/// \param phase The phase to get the time of.
+/// \return The phase's time in the frame that ended last, in
+///         microseconds.
+///
+uint32_t
+Profiler::getPhaseTime (Phase phase)
+{
+    return m_Frames[(m_NextFrame + k_NumFrames - 1) % k_NumFrames].phaseTimes[phase];
+}
+
+///
+/// \brief Tells if the bar graph is shown.
+///
+/// \return \a true if draw() draws the graph, \a false otherwise.
+///
+bool
+Profiler::isGraphVisible (void)
+{
+    return m_GraphVisible;
+}
+
+///
+/// \brief Tells if the frames are being written to the CSV file.
+///
+/// \return \a true if each frame is written, \a false otherwise.
+///
+bool
+Profiler::isRecording (void)
+{
+    return m_RecordFile.is_open ();
+}
+
+///
+/// \brief Keeps the timers running even without graph or recording.
+///
+/// \param enabled \a true if the timers must always run.
+///
+void
+Profiler::setAlwaysEnabled (bool enabled)
+{
+    m_AlwaysEnabled = enabled;
+    updateEnabled ();
+}
+
+///
+/// \brief Sets the CSV file to write the frames to.
+///
+/// \param fileName The name of the file that startRecording() creates.
+///
+void
+Profiler::setRecordFileName (const std::string &fileName)
+{
+    m_RecordFileName = fileName;
+}
+
+///
+/// \brief Starts writing each frame's phase times to the CSV file.
+///
+/// The file is created again each time the recording starts.
+///
+void
+Profiler::startRecording (void)
+{
+    if ( isRecording () )
+    {
+        return;
+    }
+    m_RecordFile.open (m_RecordFileName.c_str ());
+    if ( !m_RecordFile )
+    {
+        m_RecordFile.close ();
+        m_RecordFile.clear ();
+        throw std::runtime_error ("Couldn't create the profile file " +
+                                  m_RecordFileName);
+    }
+    m_RecordFile << "frame,events_us,update_us,grid_us,ai_us,"
+                    "background_us,render_us,present_us,frame_us";
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+    m_RecordFile << ",allocations,allocated_bytes";
+#endif // AMOEBAX_ALLOCATION_TRACKING
+    m_RecordFile << "\n";
+    m_RecordedFrames = 0;
+    m_LastFrameEnd = SDL_GetPerformanceCounter ();
+    updateEnabled ();
+}
+
+///
+/// \brief Stops writing the frames to the CSV file and closes it.
+///
+void
+Profiler::stopRecording (void)
+{
+    m_RecordFile.close ();
+    updateEnabled ();
+}
+
+///
+/// \brief Shows the bar graph if it is hidden, or hides it otherwise.
+///
+void
+Profiler::toggleGraph (void)
+{
+    m_GraphVisible = !m_GraphVisible;
+    updateEnabled ();
+}
+
+///
+/// \brief Turns the timers on only if someone needs them.
+///
+void
+Profiler::updateEnabled (void)
+{
+    m_Enabled.store (m_AlwaysEnabled || isGraphVisible () || isRecording (),
+                     std::memory_order_relaxed);
+}
@@ -0,0 +1,221 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_PROFILER_H)
+#define AMOEBAX_PROFILER_H
+
+#include <atomic>
+#include <fstream>
+#include <SDL.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Amoebax
+{
+    ///
+    /// \class Profiler.
+    /// \brief Measures how long each phase of the frames takes.
+    ///
+    /// The system and the match's logic time their phases with Timer
+    /// objects.  The times of the last k_NumFrames frames can be shown
+    /// over the screen as a bar graph, and each frame's times can be
+    /// written to a CSV file.  While neither is on, and the flight
+    /// recorder doesn't need them, the timers don't read the performance
+    /// counter.
+    ///
+    /// The grids and the computer players can be updated in another
+    /// thread.  Their time is added to the frame that is running when
+    /// they finish.
+    ///
+    /// When built with the ALLOCATION_TRACKING CMake option, the heap
+    /// allocations of each frame, of all threads, are written to the CSV
+    /// file too, and the graph marks the frames that allocated.
+    ///
+    class Profiler
+    {
+        public:
+            ///
+            /// \enum Phase
+            /// \brief The phases of a frame that are timed.
+            ///
+            enum Phase
+            {
+                /// Activating the state and handling the events.
+                PhaseEvents,
+                /// Updating the state, including the grids and players.
+                PhaseUpdate,
+                /// Updating the grids.
+                PhaseGrid,
+                /// Choosing the computer players' moves.
+                PhaseAI,
+                /// Drawing the background of the changed screen regions.
+                PhaseBackground,
+                /// Drawing the state.
+                PhaseRender,
+                /// Presenting the screen.
+                PhasePresent
+            };
+
+            ///
+            /// \class Timer.
+            /// \brief Adds the time from its creation to its destruction.
+            ///
+            class Timer
+            {
+                public:
+                    ///
+                    /// \brief Starts timing a phase.
+                    ///
+                    /// \param phase The phase to add the time to.
+                    ///
+                    explicit Timer (Phase phase):
+                        m_Phase (phase),
+                        m_Start (isEnabled () ?
+                                 SDL_GetPerformanceCounter () : 0)
+                    {
+                    }
+
+                    ///
+                    /// \brief Adds the time since the start to the phase.
+                    ///
+                    ~Timer (void)
+                    {
+                        stop ();
+                    }
+
+                    ///
+                    /// \brief Adds the time since the start to the phase
+                    ///        before the timer is destroyed.
+                    ///
+                    void stop (void)
+                    {
+                        if ( 0 != m_Start )
+                        {
+                            addTime (m_Phase,
+                                     SDL_GetPerformanceCounter () - m_Start);
+                            m_Start = 0;
+                        }
+                    }
+
+                private:
+                    /// The phase to add the time to.
+                    Phase m_Phase;
+                    /// The performance counter at the start, or 0.
+                    uint64_t m_Start;
+            };
+
+            /// The number of timed phases.
+            static const unsigned int k_NumPhases = PhasePresent + 1;
+            /// The number of frames shown in the bar graph.
+            static const unsigned int k_NumFrames = 128;
+
+            static void addTime (Phase phase, uint64_t counter);
+            static void draw (SDL_Surface *screen);
+            static void endFrame (void);
+            static uint32_t getPhaseTime (Phase phase);
+            static bool isEnabled (void);
+            static bool isGraphVisible (void);
+            static bool isRecording (void);
+            static void setAlwaysEnabled (bool enabled);
+            static void setRecordFileName (const std::string &fileName);
+            static void startRecording (void);
+            static void stopRecording (void);
+            static void toggleGraph (void);
+
+        private:
+            // This class it not instanciable.
+            ///
+            /// \brief Default constructor.
+            ///
+            Profiler (void);
+            ///
+            /// \brief Copy constructor.
+            ///
+            /// \note This constructor is left unimplemented because we
+            /// don't want copies of Profiler. Don't use it.
+            ///
+            Profiler (const Profiler &);
+            ///
+            /// \brief Assigment operator.
+            ///
+            /// \note This operator is left unimplemented because we
+            /// don't want copies of Profiler. Don't use it.
+            ///
+            Profiler &operator= (const Profiler &);
+
+            ///
+            /// \struct Frame.
+            /// \brief The times of a frame's phases.
+            ///
+            struct Frame
+            {
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+                /// The number of heap allocations.
+                uint32_t allocations;
+                /// The bytes allocated.
+                uint32_t allocatedBytes;
+#endif // AMOEBAX_ALLOCATION_TRACKING
+                /// The time of each phase, in microseconds.
+                uint32_t phaseTimes[k_NumPhases];
+            };
+
+            static void updateEnabled (void);
+
+            /// Tells if the timers must run without graph or recording.
+            static bool m_AlwaysEnabled;
+            /// Tells if the timers must read the performance counter.
+            static std::atomic<bool> m_Enabled;
+            /// The times of the last frames.
+            static std::vector<Frame> m_Frames;
+            /// Tells if the bar graph is shown.
+            static bool m_GraphVisible;
+#if defined (AMOEBAX_ALLOCATION_TRACKING)
+            /// The bytes allocated until the end of the last frame.
+            static uint64_t m_LastAllocatedBytes;
+            /// The allocations until the end of the last frame.
+            static uint64_t m_LastAllocations;
+#endif // AMOEBAX_ALLOCATION_TRACKING
+            /// The performance counter at the end of the last frame.
+            static uint64_t m_LastFrameEnd;
+            /// The position in m_Frames of the next frame.
+            static unsigned int m_NextFrame;
+            /// The performance counter ticks of each phase this frame.
+            static std::atomic<uint64_t> m_PhaseTimes[k_NumPhases];
+            /// The CSV file to write the frames to, when open.
+            static std::ofstream m_RecordFile;
+            /// The name of the CSV file to write the frames to.
+            static std::string m_RecordFileName;
+            /// The number of frames written to m_RecordFile.
+            static uint64_t m_RecordedFrames;
+    };
+
+    ///
+    /// \brief Tells if the phases are being timed.
+    ///
+    /// \return \a true if the graph is shown, the frames recorded or
+    ///         the timers must always run.
+    ///
+    inline bool
+    Profiler::isEnabled (void)
+    {
+        return m_Enabled.load (std::memory_order_relaxed);
+    }
+}
+
+#endif // !AMOEBAX_PROFILER_H
@@ -0,0 +1,48 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <random>
+#include "Random.h"
+
+using namespace Amoebax;
+
+/// The generator of the current thread.
+static thread_local std::mt19937 g_Generator;
+
+///
+/// \brief Gets the next pseudo-random number of the current thread.
+///
+/// \return A pseudo-random number between 0 and 2^31 - 1, which
+///         can be used the same way than the value returned by rand().
+///
+int32_t
+Random::get (void)
+{
+    return static_cast<int32_t>(g_Generator () >> 1);
+}
+
+///
+/// \brief Seeds the generator of the current thread.
+///
+/// \param seed The seed to use. The same seed gives the same sequence.
+///
+void
+Random::init (uint32_t seed)
+{
+    g_Generator.seed (seed);
+}
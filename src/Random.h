@@ -0,0 +1,72 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_RANDOM_H)
+#define AMOEBAX_RANDOM_H
+
+#include <stdint.h>
+
+namespace Amoebax
+{
+    ///
+    /// \class Random.
+    /// \brief Pseudo-random numbers for the game's logic.
+    ///
+    /// Every thread has its own generator, so matches simulated at the
+    /// same time on different threads don't share their sequence and
+    /// a match played with the same seed always gives the same result.
+    ///
+    class Random
+    {
+        public:
+            static int32_t get (void);
+            static void init (uint32_t seed);
+
+        private:
+            // This class it not instanciable.
+            ///
+            /// \brief Default constructor.
+            ///
+            Random (void);
+            ///
+            /// \brief Destructor.
+            ///
+            ~Random (void);
+            ///
+            /// \brief Copy constructor.
+            ///
+            /// \note This constructor is left unimplemented because we
+            /// don't want copies of Random. Don't use it.
+            ///
+            /// \param object The source object to make a copy from.
+            ///
+            Random (const Random &object);
+            ///
+            /// \brief Assigment operator.
+            ///
+            /// \note This operator is left unimplemented because we
+            /// don't want copies of Random. Don't use it.
+            ///
+            /// \param object The source object to make a copy from.
+            /// \return A reference to the current object.
+            ///
+            Random &operator= (const Random &object);
+    };
+}
+
+#endif // !AMOEBAX_RANDOM_H
@@ -16,22 +16,332 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
+#include <algorithm>
 #include <assert.h>
+#include <functional>
 #include <math.h>
 #include <SDL.h>
 #include <stdexcept>
+#include <vector>
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#endif // __SSE2__
+#include "Blitter.h"
+#include "Compositor.h"
 #include "cute_png.h"
 #include "Surface.h"
 #include "System.h"
+#include "ThreadPool.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
+/// The color of the transparent pixels of the converted sprites.
+static const uint8_t k_ColorKeyRed = 255;
+static const uint8_t k_ColorKeyGreen = 0;
+static const uint8_t k_ColorKeyBlue = 255;
+
+/// The number of fractional bits of the bilinear filter's weights.
+static const int k_ScaleWeightBits = 8;
+/// The weight of a pixel that fully covers the scaled pixel.
+static const uint32_t k_ScaleWeightOne = 1 << k_ScaleWeightBits;
+/// How many tasks to split the rows of a scaled surface into per thread.
+static const unsigned int k_ScaleTasksPerThread = 4;
+
+///
+/// \struct ScaleColumn
+/// \brief The two source columns of a scaled column and their weight.
+///
+struct ScaleColumn
+{
+    /// The left source column.
+    int left;
+    /// The right source column, clamped to the surface's width.
+    int right;
+    /// The fixed-point weight of the right source column.
+    uint32_t weight;
+};
+
+///
+/// \struct ScaleJob
+/// \brief Everything the threads need to scale a range of rows.
+///
+struct ScaleJob
+{
+    /// The source columns of each scaled column.
+    std::vector<ScaleColumn> columns;
+    /// The surface to scale.
+    const SDL_Surface *original;
+    /// The scale factor used to compute the source rows.
+    float scaleFactor;
+    /// The surface to write the scaled pixels to.
+    SDL_Surface *scaled;
+};
+
+///
+/// \brief Gets the bits of a surface's pixels that hold the color.
+///
+/// \param surface The surface to get the color bits of.
+/// \return The union of the red, green and blue masks of \p surface.
+///
+static uint32_t
+getColorMask (const SDL_Surface *surface)
+{
+    return surface->format->Rmask | surface->format->Gmask |
+           surface->format->Bmask;
+}
+
+///
+/// \brief Tells whether Blitter can copy a color keyed surface.
+///
+/// \param source The surface to copy.
+/// \param destination The surface to copy \p source to.
+/// \param colorKey Set to the color key of \p source, with only the
+///                 color bits.
+/// \return \a true if \p source is a color keyed surface with the same
+///         format as \p destination, and is neither blended nor
+///         translucent.
+///
+static bool
+canCopyColorKey (SDL_Surface *source, const SDL_Surface *destination,
+                 uint32_t &colorKey)
+{
+    if ( 32 != source->format->BitsPerPixel ||
+         0 != source->format->Amask ||
+         source->format->format != destination->format->format ||
+         0 != SDL_GetColorKey (source, &colorKey) )
+    {
+        return false;
+    }
+    colorKey &= getColorMask (source);
+
+    uint8_t alpha = 0;
+    SDL_GetSurfaceAlphaMod (source, &alpha);
+    SDL_BlendMode blendMode = SDL_BLENDMODE_BLEND;
+    SDL_GetSurfaceBlendMode (source, &blendMode);
+    return Surface::k_MaxAlpha == alpha && SDL_BLENDMODE_NONE == blendMode;
+}
+
+///
+/// \brief Tells whether a surface can be copied without blending.
+///
+/// \param source The surface to copy.
+/// \param destination The surface to copy \p source to.
+/// \return \a true if \p source is a 32-bit surface with the same
+///         format as \p destination, has no color key, and is neither
+///         blended nor translucent.
+///
+static bool
+canCopy (SDL_Surface *source, const SDL_Surface *destination)
+{
+    uint32_t colorKey = 0;
+    if ( 32 != source->format->BitsPerPixel ||
+         source->format->format != destination->format->format ||
+         0 == SDL_GetColorKey (source, &colorKey) )
+    {
+        return false;
+    }
+
+    uint8_t alpha = 0;
+    SDL_GetSurfaceAlphaMod (source, &alpha);
+    SDL_BlendMode blendMode = SDL_BLENDMODE_BLEND;
+    SDL_GetSurfaceBlendMode (source, &blendMode);
+    return Surface::k_MaxAlpha == alpha && SDL_BLENDMODE_NONE == blendMode;
+}
+
+///
+/// \brief Clips the rectangles of a blit like SDL_BlitSurface does.
+///
+/// \param source The surface to blit.
+/// \param sourceRect The part of \p source to blit.  Set to the part
+///                   that ends up inside \p destination's clip
+///                   rectangle.
+/// \param destination The surface to blit to.
+/// \param destinationRect The position to blit to.  Set to the
+///                        rectangle of \p destination that the blit
+///                        changes.
+/// \return \a false if there is nothing to blit.
+///
+static bool
+clipBlit (const SDL_Surface *source, SDL_Rect &sourceRect,
+          const SDL_Surface *destination, SDL_Rect &destinationRect)
+{
+    const SDL_Rect sourceBounds = {0, 0, source->w, source->h};
+    SDL_Rect clippedSource;
+    if ( !SDL_IntersectRect (&sourceRect, &sourceBounds, &clippedSource) )
+    {
+        destinationRect.w = 0;
+        destinationRect.h = 0;
+        return false;
+    }
+    destinationRect.x += clippedSource.x - sourceRect.x;
+    destinationRect.y += clippedSource.y - sourceRect.y;
+    destinationRect.w = clippedSource.w;
+    destinationRect.h = clippedSource.h;
+
+    SDL_Rect clippedDestination;
+    if ( !SDL_IntersectRect (&destinationRect, &destination->clip_rect,
+                             &clippedDestination) )
+    {
+        destinationRect.w = 0;
+        destinationRect.h = 0;
+        return false;
+    }
+    sourceRect.x = clippedSource.x + clippedDestination.x - destinationRect.x;
+    sourceRect.y = clippedSource.y + clippedDestination.y - destinationRect.y;
+    sourceRect.w = clippedDestination.w;
+    sourceRect.h = clippedDestination.h;
+    destinationRect = clippedDestination;
+
+    return true;
+}
+
+///
+/// \brief Gets the two source pixels a filtered coordinate falls between.
+///
+/// \param coordinate The coordinate in the original surface.
+/// \param size The original surface's size along the coordinate's axis.
+/// \param first Set to the source pixel at or before \p coordinate.
+/// \param second Set to the source pixel after \p coordinate, or
+///               to \p first at the surface's last pixel.
+/// \param weight Set to the fixed-point weight of \p second.
+///
+static void
+getFilterCoordinate (float coordinate, int size, int &first, int &second,
+                     uint32_t &weight)
+{
+    first = std::min (static_cast<int>(floorf (coordinate)), size - 1);
+    second = std::min (first + 1, size - 1);
+    weight = static_cast<uint32_t>((coordinate - first) * k_ScaleWeightOne +
+                                   0.5f);
+    weight = std::min (weight, k_ScaleWeightOne);
+}
+
+///
+/// \brief Gets the thread pool that scales the surfaces.
+///
+/// \return The thread pool shared by all resize operations.
+///
+static ThreadPool &
+getScalePool (void)
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+///
+/// \brief Scales a range of rows of a scale job.
+///
+/// Each channel is filtered independently, thus the pixel format doesn't
+/// matter as long as it is 32-bit.
+///
+/// \param job The scale job to do.
+/// \param firstRow The first scaled row to compute.
+/// \param lastRow The row after the last scaled row to compute.
+///
+static void
+scaleRows (const ScaleJob *job, int firstRow, int lastRow)
+{
+    const uint8_t *originalPixels =
+        static_cast<const uint8_t *>(job->original->pixels);
+    uint8_t *scaledPixels = static_cast<uint8_t *>(job->scaled->pixels);
+    const int scaledWidth = job->scaled->w;
+
+    for ( int scaledY = firstRow ; scaledY < lastRow ; ++scaledY )
+    {
+        int topY = 0;
+        int bottomY = 0;
+        uint32_t yWeight = 0;
+        getFilterCoordinate (scaledY / job->scaleFactor, job->original->h,
+                             topY, bottomY, yWeight);
+
+        const uint32_t *top = reinterpret_cast<const uint32_t *>(
+                originalPixels + topY * job->original->pitch);
+        const uint32_t *bottom = reinterpret_cast<const uint32_t *>(
+                originalPixels + bottomY * job->original->pitch);
+        uint32_t *currentScaledPixel = reinterpret_cast<uint32_t *>(
+                scaledPixels + scaledY * job->scaled->pitch);
+
+#if defined (__SSE2__)
+        // Each pixel's four channels are in a vector of 16-bit lanes. The
+        // horizontal pass fits in 16 bits, while the vertical pass needs
+        // the whole 32-bit product.
+        const __m128i zero = _mm_setzero_si128 ();
+        const __m128i verticalWeights =
+            _mm_unpacklo_epi64 (
+                    _mm_set1_epi16 (static_cast<short>(k_ScaleWeightOne -
+                                                       yWeight)),
+                    _mm_set1_epi16 (static_cast<short>(yWeight)));
+        for ( int scaledX = 0 ; scaledX < scaledWidth ; ++scaledX )
+        {
+            const ScaleColumn &column (job->columns[scaledX]);
+            const __m128i horizontalWeights =
+                _mm_unpacklo_epi64 (
+                        _mm_set1_epi16 (static_cast<short>(k_ScaleWeightOne -
+                                                           column.weight)),
+                        _mm_set1_epi16 (static_cast<short>(column.weight)));
+
+            __m128i topPixels = _mm_unpacklo_epi8 (
+                    _mm_unpacklo_epi32 (
+                        _mm_cvtsi32_si128 (static_cast<int>(top[column.left])),
+                        _mm_cvtsi32_si128 (static_cast<int>(top[column.right]))),
+                    zero);
+            __m128i bottomPixels = _mm_unpacklo_epi8 (
+                    _mm_unpacklo_epi32 (
+                        _mm_cvtsi32_si128 (static_cast<int>(bottom[column.left])),
+                        _mm_cvtsi32_si128 (static_cast<int>(bottom[column.right]))),
+                    zero);
+            topPixels = _mm_mullo_epi16 (topPixels, horizontalWeights);
+            topPixels = _mm_add_epi16 (topPixels, _mm_srli_si128 (topPixels, 8));
+            bottomPixels = _mm_mullo_epi16 (bottomPixels, horizontalWeights);
+            bottomPixels = _mm_add_epi16 (bottomPixels,
+                                          _mm_srli_si128 (bottomPixels, 8));
+
+            const __m128i rows = _mm_unpacklo_epi64 (topPixels, bottomPixels);
+            const __m128i low = _mm_mullo_epi16 (rows, verticalWeights);
+            const __m128i high = _mm_mulhi_epu16 (rows, verticalWeights);
+            __m128i color = _mm_add_epi32 (_mm_unpacklo_epi16 (low, high),
+                                           _mm_unpackhi_epi16 (low, high));
+            color = _mm_srli_epi32 (color, 2 * k_ScaleWeightBits);
+            color = _mm_packs_epi32 (color, color);
+            color = _mm_packus_epi16 (color, color);
+            *currentScaledPixel = static_cast<uint32_t>(_mm_cvtsi128_si32 (color));
+            ++currentScaledPixel;
+        }
+#else // !__SSE2__
+        for ( int scaledX = 0 ; scaledX < scaledWidth ; ++scaledX )
+        {
+            const ScaleColumn &column (job->columns[scaledX]);
+            const uint32_t leftWeight = k_ScaleWeightOne - column.weight;
+            const uint32_t topWeight = k_ScaleWeightOne - yWeight;
+
+            uint32_t scaledPixel = 0;
+            for ( int shift = 0 ; shift < 32 ; shift += 8 )
+            {
+                uint32_t topColor =
+                    ((top[column.left] >> shift) & 0xff) * leftWeight +
+                    ((top[column.right] >> shift) & 0xff) * column.weight;
+                uint32_t bottomColor =
+                    ((bottom[column.left] >> shift) & 0xff) * leftWeight +
+                    ((bottom[column.right] >> shift) & 0xff) * column.weight;
+                uint32_t color = (topColor * topWeight + bottomColor * yWeight) >>
+                                 (2 * k_ScaleWeightBits);
+                scaledPixel |= color << shift;
+            }
+            *currentScaledPixel = scaledPixel;
+            ++currentScaledPixel;
+        }
+#endif // __SSE2__
+    }
+}
+
 ///
 /// \brief Surface's default constructor.
 ///
 /// Makes an empty (NULL) surface.
 ///
 Surface::Surface (void):
+    m_Premultiplied (false),
     m_SDLSurface (0)
 {
 }
@@ -43,6 +353,7 @@ Surface::Surface (void):
 ///                   ownership of.
 ///
 Surface::Surface (SDL_Surface *SDLSurface):
+    m_Premultiplied (false),
     m_SDLSurface (SDLSurface)
 {
 }
@@ -53,9 +364,20 @@ Surface::Surface (SDL_Surface *SDLSurface):
 /// \param surface The surface to copy from.
 ///
 Surface::Surface (const Surface &surface):
+    m_Premultiplied (surface.m_Premultiplied),
     m_SDLSurface (0)
 {
-    if ( 0 != surface.m_SDLSurface )
+    if ( 0 != surface.m_SDLSurface && surface.m_Premultiplied )
+    {
+        // Blitting the premultiplied pixels would blend them again.
+        m_SDLSurface = SDL_ConvertSurface (surface.m_SDLSurface,
+                                           surface.m_SDLSurface->format, 0);
+        if ( NULL == m_SDLSurface )
+        {
+            throw std::runtime_error (SDL_GetError ());
+        }
+    }
+    else if ( 0 != surface.m_SDLSurface )
     {
         SDL_Surface *tempSDLSurface =
             SDL_CreateRGBSurface (0,
@@ -138,10 +460,286 @@ Surface::blit (uint16_t sourceX, uint16_t sourceY,
     destinationRect.w = sourceWidth;
     destinationRect.h = sourceHeight;
 
-    SDL_BlitSurface (m_SDLSurface, &sourceRect, destination, &destinationRect);
+    // The first time the surface is blit to the screen, convert it to the
+    // screen's format so SDL doesn't need to convert it every time.
+    if ( destination->format->format != m_SDLSurface->format->format &&
+         destination == System::getInstance ().getScreenSDLSurface () )
+    {
+        convertToFormat (destination->format);
+    }
+
+    Compositor::Blit blit;
+    if ( m_Premultiplied )
+    {
+        blit.type = Compositor::Blit::BlendPremultiplied;
+        blit.alpha = k_MaxAlpha;
+        SDL_GetSurfaceAlphaMod (m_SDLSurface, &blit.alpha);
+    }
+    else if ( canCopyColorKey (m_SDLSurface, destination, blit.colorKey) )
+    {
+        blit.type = Compositor::Blit::CopyColorKey;
+        blit.colorMask = getColorMask (m_SDLSurface);
+    }
+    else if ( canCopy (m_SDLSurface, destination) )
+    {
+        blit.type = Compositor::Blit::Copy;
+    }
+    else
+    {
+        // SDL draws it right away, after the blits it could cover.
+        System::getInstance ().getCompositor ().flush ();
+        SDL_BlitSurface (m_SDLSurface, &sourceRect, destination,
+                         &destinationRect);
+        System::getInstance ().invalidateScreenRegion (&destinationRect);
+        return;
+    }
+
+    assert ( 32 == destination->format->BitsPerPixel &&
+             "Tried to blit to a non 32-bit surface." );
+    if ( clipBlit (m_SDLSurface, sourceRect, destination, destinationRect) )
+    {
+        blit.source = m_SDLSurface;
+        blit.sourceRect = sourceRect;
+        blit.destinationRect = destinationRect;
+        System::getInstance ().getCompositor ().blit (blit, destination);
+    }
     System::getInstance ().invalidateScreenRegion (&destinationRect);
 }
 
+///
+/// \brief Converts the surface to the format of another surface.
+///
+/// Opaque surfaces are just converted to \p format, without blending.
+/// Surfaces whose pixels are either opaque or fully transparent get
+/// a color key instead of the alpha channel, that Blitter skips when
+/// copying them to surfaces of the same format.  Only the surfaces with
+/// translucent pixels keep the alpha channel, in \p format with the
+/// alpha in its unused bits when possible, and premultiplied so Blitter
+/// can blend them with a single multiplication per channel.
+///
+/// \param format The format to convert the surface to.  Usually the
+///               screen's format.
+///
+void
+Surface::convertToFormat (const SDL_PixelFormat *format)
+{
+    uint8_t alphaMod = k_MaxAlpha;
+    SDL_GetSurfaceAlphaMod (m_SDLSurface, &alphaMod);
+    uint32_t colorKey = 0;
+    bool hasColorKey = 0 == SDL_GetColorKey (m_SDLSurface, &colorKey);
+    uint8_t colorKeyRed = k_ColorKeyRed;
+    uint8_t colorKeyGreen = k_ColorKeyGreen;
+    uint8_t colorKeyBlue = k_ColorKeyBlue;
+    if ( hasColorKey )
+    {
+        SDL_GetRGB (colorKey, m_SDLSurface->format,
+                    &colorKeyRed, &colorKeyGreen, &colorKeyBlue);
+    }
+
+    bool opaque = true;
+    bool translucent = false;
+    bool colorKeyInUse = false;
+    if ( !hasColorKey && SDL_PIXELFORMAT_RGBA32 == m_SDLSurface->format->format )
+    {
+        SDL_LockSurface (m_SDLSurface);
+        for ( int y = 0 ; y < m_SDLSurface->h ; ++y )
+        {
+            uint8_t *pixel = static_cast<uint8_t *>(m_SDLSurface->pixels) +
+                             y * m_SDLSurface->pitch;
+            for ( int x = 0 ; x < m_SDLSurface->w ; ++x, pixel += 4 )
+            {
+                if ( 0 == pixel[3] )
+                {
+                    opaque = false;
+                }
+                else if ( k_MaxAlpha != pixel[3] )
+                {
+                    opaque = false;
+                    translucent = true;
+                }
+                else if ( k_ColorKeyRed == pixel[0] &&
+                          k_ColorKeyGreen == pixel[1] &&
+                          k_ColorKeyBlue == pixel[2] )
+                {
+                    colorKeyInUse = true;
+                }
+            }
+        }
+        if ( !opaque && !translucent && !colorKeyInUse )
+        {
+            // Paint the transparent pixels with the color key.
+            for ( int y = 0 ; y < m_SDLSurface->h ; ++y )
+            {
+                uint8_t *pixel = static_cast<uint8_t *>(m_SDLSurface->pixels) +
+                                 y * m_SDLSurface->pitch;
+                for ( int x = 0 ; x < m_SDLSurface->w ; ++x, pixel += 4 )
+                {
+                    if ( 0 == pixel[3] )
+                    {
+                        pixel[0] = k_ColorKeyRed;
+                        pixel[1] = k_ColorKeyGreen;
+                        pixel[2] = k_ColorKeyBlue;
+                    }
+                }
+            }
+        }
+        SDL_UnlockSurface (m_SDLSurface);
+    }
+
+    SDL_Surface *convertedSurface = 0;
+    if ( translucent || colorKeyInUse )
+    {
+        uint32_t alphaFormat = SDL_PIXELFORMAT_RGBA32;
+        if ( 32 == format->BitsPerPixel )
+        {
+            alphaFormat =
+                SDL_MasksToPixelFormatEnum (32, format->Rmask, format->Gmask,
+                                            format->Bmask,
+                                            ~(format->Rmask | format->Gmask |
+                                              format->Bmask));
+        }
+        convertedSurface = SDL_ConvertSurfaceFormat (m_SDLSurface,
+                                                     alphaFormat, 0);
+        if ( 0 != convertedSurface )
+        {
+            SDL_SetSurfaceBlendMode (convertedSurface, SDL_BLENDMODE_BLEND);
+            SDL_LockSurface (convertedSurface);
+            Blitter::premultiply (static_cast<uint32_t *>(convertedSurface->pixels),
+                                  convertedSurface->pitch,
+                                  convertedSurface->w, convertedSurface->h,
+                                  convertedSurface->format->Ashift);
+            SDL_UnlockSurface (convertedSurface);
+            m_Premultiplied = true;
+        }
+    }
+    else
+    {
+        convertedSurface = SDL_ConvertSurface (m_SDLSurface, format, 0);
+        if ( 0 != convertedSurface )
+        {
+            if ( !opaque || hasColorKey )
+            {
+                SDL_SetColorKey (convertedSurface, SDL_TRUE,
+                                 SDL_MapRGB (convertedSurface->format,
+                                             colorKeyRed, colorKeyGreen,
+                                             colorKeyBlue));
+            }
+            SDL_SetSurfaceBlendMode (convertedSurface, SDL_BLENDMODE_NONE);
+        }
+    }
+    if ( 0 == convertedSurface )
+    {
+        throw std::runtime_error (SDL_GetError ());
+    }
+
+    // The recorded blits could still read the original surface.
+    System::getInstance ().getCompositor ().flush ();
+    std::swap (m_SDLSurface, convertedSurface);
+    SDL_FreeSurface (convertedSurface);
+    setAlpha (alphaMod);
+}
+
+///
+/// \brief Copies a part of the surface into another surface as is.
+///
+/// Unlike blit(), the pixels are neither blended nor color keyed,
+/// so both surfaces must have the same format.  \see createCompatible().
+///
+/// \param sourceX The X origin of the source surface to copy.
+/// \param sourceY The Y origin of the source surface to copy.
+/// \param sourceWidth The width of the source surface part to copy.
+/// \param sourceHeight The height of the source surface part to copy.
+/// \param destinationX The X position where to copy the source into the
+///                     destination.
+/// \param destinationY The Y position where to copy the source into the
+///                     destination.
+/// \param destination The destination surface.
+///
+void
+Surface::copyPixels (uint16_t sourceX, uint16_t sourceY,
+                     uint16_t sourceWidth, uint16_t sourceHeight,
+                     uint16_t destinationX, uint16_t destinationY,
+                     Surface &destination) const
+{
+    SDL_Surface *source = toSDLSurface ();
+    SDL_Surface *target = destination.toSDLSurface ();
+    assert (source->format->format == target->format->format &&
+            "Tried to copy pixels between surfaces of different formats.");
+    // The recorded blits could still read the destination.
+    System::getInstance ().getCompositor ().flush ();
+
+    SDL_Rect sourceRect;
+    sourceRect.x = sourceX;
+    sourceRect.y = sourceY;
+    sourceRect.w = sourceWidth;
+    sourceRect.h = sourceHeight;
+    SDL_Rect destinationRect;
+    destinationRect.x = destinationX;
+    destinationRect.y = destinationY;
+    if ( !clipBlit (source, sourceRect, target, destinationRect) )
+    {
+        return;
+    }
+
+    const int bytesPerPixel = source->format->BytesPerPixel;
+    SDL_LockSurface (source);
+    SDL_LockSurface (target);
+    for ( int y = 0 ; y < sourceRect.h ; ++y )
+    {
+        const uint8_t *sourceRow = static_cast<uint8_t *>(source->pixels) +
+                                   (sourceRect.y + y) * source->pitch +
+                                   sourceRect.x * bytesPerPixel;
+        uint8_t *targetRow = static_cast<uint8_t *>(target->pixels) +
+                             (destinationRect.y + y) * target->pitch +
+                             destinationRect.x * bytesPerPixel;
+        std::copy (sourceRow, sourceRow + sourceRect.w * bytesPerPixel,
+                   targetRow);
+    }
+    SDL_UnlockSurface (target);
+    SDL_UnlockSurface (source);
+}
+
+///
+/// \brief Creates an empty surface that is blit like this surface.
+///
+/// The new surface has the same format, color key, alpha and blend mode
+/// as this surface, and all its pixels are transparent.
+///
+/// \param width The width of the new surface.
+/// \param height The height of the new surface.
+/// \return The new surface.
+///
+Surface *
+Surface::createCompatible (uint16_t width, uint16_t height) const
+{
+    SDL_Surface *surface = toSDLSurface ();
+    SDL_Surface *compatible =
+        SDL_CreateRGBSurfaceWithFormat (0, width, height,
+                                        surface->format->BitsPerPixel,
+                                        surface->format->format);
+    if ( 0 == compatible )
+    {
+        throw std::runtime_error (SDL_GetError ());
+    }
+
+    uint32_t colorKey = 0;
+    if ( 0 == SDL_GetColorKey (surface, &colorKey) )
+    {
+        SDL_SetColorKey (compatible, SDL_TRUE, colorKey);
+        SDL_FillRect (compatible, NULL, colorKey);
+    }
+    uint8_t alphaMod = k_MaxAlpha;
+    SDL_GetSurfaceAlphaMod (surface, &alphaMod);
+    SDL_SetSurfaceAlphaMod (compatible, alphaMod);
+    SDL_BlendMode blendMode = SDL_BLENDMODE_NONE;
+    SDL_GetSurfaceBlendMode (surface, &blendMode);
+    SDL_SetSurfaceBlendMode (compatible, blendMode);
+
+    Surface *compatibleSurface = new Surface (compatible);
+    compatibleSurface->m_Premultiplied = m_Premultiplied;
+    return compatibleSurface;
+}
+
 ///
 /// \brief Surface's destructor.
 ///
@@ -149,6 +747,8 @@ Surface::blit (uint16_t sourceX, uint16_t sourceY,
 ///
 Surface::~Surface (void)
 {
+    // The recorded blits could still read the surface.
+    System::getInstance ().getCompositor ().flush ();
     SDL_FreeSurface (m_SDLSurface);
 }
 
@@ -230,6 +830,7 @@ Surface::getWidth (void) const
 Surface *
 Surface::fromFile (std::string fileName)
 {
+    AMOEBAX_TRACE_ZONE ("Surface::fromFile");
     cp_image_t img = cp_load_png (fileName.c_str ());
     if ( 0 == img.pix )
     {
@@ -270,11 +871,13 @@ Surface *
 Surface::fromScreen (void)
 {
     SDL_Surface *screen = System::getInstance ().getScreenSDLSurface ();
-    // FIXME: hardcoding RGBA order
+    System::getInstance ().getCompositor ().flush ();
+    // Keep the screen's format, so blitting the copy back is a plain copy.
     SDL_Surface *copy =
         SDL_CreateRGBSurfaceWithFormat (0,
-                                        screen->w, screen->h, 32,
-                                        SDL_PIXELFORMAT_RGBA32);
+                                        screen->w, screen->h,
+                                        screen->format->BitsPerPixel,
+                                        screen->format->format);
     if ( 0 == copy )
     {
         throw std::runtime_error (SDL_GetError ());
@@ -301,11 +904,16 @@ Surface::operator= (const Surface &surface)
 ///
 /// \brief Scales the image using an scale factor.
 ///
+/// The scaled pixels are computed with a fixed-point bilinear filter
+/// that works on the raw 32-bit pixels, splitting the rows between
+/// the threads of a thread pool.
+///
 /// \param scaleFactor The scale factor to use to resize the image.
 ///
 void
 Surface::resize (float scaleFactor)
 {
+    AMOEBAX_TRACE_ZONE ("Surface::resize");
     // Can only resize 32-bit surfaces.
     assert ( 0 != m_SDLSurface && "Tried to resize an unloaded surface" );
     assert ( 32 == m_SDLSurface->format->BitsPerPixel &&
@@ -320,14 +928,11 @@ Surface::resize (float scaleFactor)
 
     // Create the new scaled surface.
     SDL_Surface *scaledSDLSurface =
-        SDL_CreateRGBSurface (m_SDLSurface->flags,
-                              static_cast<int>(m_SDLSurface->w * scaleFactor),
-                              static_cast<int>(m_SDLSurface->h * scaleFactor),
-                              m_SDLSurface->format->BitsPerPixel,
-                              m_SDLSurface->format->Rmask,
-                              m_SDLSurface->format->Gmask,
-                              m_SDLSurface->format->Bmask,
-                              m_SDLSurface->format->Amask);
+        SDL_CreateRGBSurfaceWithFormat (0,
+                            static_cast<int>(m_SDLSurface->w * scaleFactor),
+                            static_cast<int>(m_SDLSurface->h * scaleFactor),
+                            m_SDLSurface->format->BitsPerPixel,
+                            m_SDLSurface->format->format);
     if ( 0 == scaledSDLSurface )
     {
         throw std::runtime_error (SDL_GetError ());
@@ -335,94 +940,43 @@ Surface::resize (float scaleFactor)
 
     // Now, for each pixel in the scaled surface, get the corresponding
     // coordinate on the original surface and using a bilinear filter,
-    // smooth the color for the scaled pixel.
+    // smooth the color for the scaled pixel. The columns are the same
+    // for every row, thus they are computed only once.
     SDL_LockSurface (m_SDLSurface);
     SDL_LockSurface (scaledSDLSurface);
 
-    uint32_t *scaledPixels = static_cast<uint32_t *>(scaledSDLSurface->pixels);
-    uint32_t *originalPixels = static_cast<uint32_t *>(m_SDLSurface->pixels);
-    int scaledPitch = scaledSDLSurface->pitch / sizeof (uint32_t);
-    int originalPitch = m_SDLSurface->pitch / sizeof (uint32_t);
-    for ( int scaledY = 0 ; scaledY < scaledSDLSurface->h ; ++scaledY )
+    ScaleJob job;
+    job.scaleFactor = scaleFactor;
+    job.original = m_SDLSurface;
+    job.scaled = scaledSDLSurface;
+    job.columns.resize (scaledSDLSurface->w);
+    for ( int scaledX = 0 ; scaledX < scaledSDLSurface->w ; ++scaledX )
     {
-        float originalY = scaledY / scaleFactor;
-        int destinationY = static_cast<int>(floorf (originalY));
-        float yRatio = originalY - destinationY;
-        float yOpposite = 1 - yRatio;
-
-        uint32_t *currentScaledPixel = scaledPixels + scaledY * scaledPitch;
+        getFilterCoordinate (scaledX / scaleFactor, m_SDLSurface->w,
+                             job.columns[scaledX].left,
+                             job.columns[scaledX].right,
+                             job.columns[scaledX].weight);
+    }
 
-        for ( int scaledX = 0 ; scaledX < scaledSDLSurface->w ; ++scaledX )
-        {
-            float scaledAlpha = 0.0f;
-            float scaledBlue = 0.0f;
-            float scaledGreen = 0.0f;
-            float scaledRed = 0.0f;
-
-            float originalX = scaledX / scaleFactor;
-            int destinationX = static_cast<int>(floorf (originalX));
-            float xRatio = originalX - destinationX;
-            float xOpposite = 1 - xRatio;
-
-            uint8_t originalAlpha = 0;
-            uint8_t originalBlue = 0;
-            uint8_t originalGreen = 0;
-            uint8_t originalRed = 0;
-
-            // Left-top pixel.
-            SDL_GetRGBA (originalPixels[destinationY * originalPitch + destinationX],
-                         m_SDLSurface->format,
-                         &originalRed, &originalGreen, &originalBlue,
-                         &originalAlpha);
-            scaledAlpha += originalAlpha * xOpposite * yOpposite;
-            scaledBlue += originalBlue * xOpposite * yOpposite;
-            scaledGreen += originalGreen * xOpposite * yOpposite;
-            scaledRed += originalRed * xOpposite * yOpposite;
-
-            // Right-top pixel.
-            SDL_GetRGBA (originalPixels[destinationY * originalPitch + destinationX + 1],
-                         m_SDLSurface->format,
-                         &originalRed, &originalGreen, &originalBlue,
-                         &originalAlpha);
-            scaledAlpha += originalAlpha * xRatio * yOpposite;
-            scaledBlue += originalBlue * xRatio * yOpposite;
-            scaledGreen += originalGreen * xRatio * yOpposite;
-            scaledRed += originalRed * xRatio * yOpposite;
-
-            // Left-bottom pixel.
-            SDL_GetRGBA (originalPixels[(destinationY + 1) * originalPitch + destinationX],
-                         m_SDLSurface->format,
-                         &originalRed, &originalGreen, &originalBlue,
-                         &originalAlpha);
-            scaledAlpha += originalAlpha * xOpposite * yRatio;
-            scaledBlue += originalBlue * xOpposite * yRatio;
-            scaledGreen += originalGreen * xOpposite * yRatio;
-            scaledRed += originalRed * xOpposite * yRatio;
-
-            // Right-bottom pixel.
-            SDL_GetRGBA (originalPixels[(destinationY + 1) * originalPitch + destinationX + 1],
-                         m_SDLSurface->format,
-                         &originalRed, &originalGreen, &originalBlue,
-                         &originalAlpha);
-            scaledAlpha += originalAlpha * xRatio * yRatio;
-            scaledBlue += originalBlue * xRatio * yRatio;
-            scaledGreen += originalGreen * xRatio * yRatio;
-            scaledRed += originalRed * xRatio * yRatio;
-
-            *currentScaledPixel =
-                SDL_MapRGBA (scaledSDLSurface->format,
-                             static_cast<uint8_t>(scaledRed),
-                             static_cast<uint8_t>(scaledGreen),
-                             static_cast<uint8_t>(scaledBlue),
-                             static_cast<uint8_t>(scaledAlpha));
-            currentScaledPixel++;
-        }
+    ThreadPool &pool (getScalePool ());
+    const int rowsPerTask =
+        std::max (1, scaledSDLSurface->h /
+                     static_cast<int>(pool.getNumberOfThreads () *
+                                      k_ScaleTasksPerThread));
+    for ( int firstRow = 0 ; firstRow < scaledSDLSurface->h ;
+          firstRow += rowsPerTask )
+    {
+        pool.schedule (std::bind (scaleRows, &job, firstRow,
+                                  std::min (firstRow + rowsPerTask,
+                                            scaledSDLSurface->h)));
     }
+    pool.wait ();
 
     SDL_UnlockSurface (scaledSDLSurface);
     SDL_UnlockSurface (m_SDLSurface);
 
     // Done. Swap the surfaces and free the original surface.
+    System::getInstance ().getCompositor ().flush ();
     std::swap (m_SDLSurface, scaledSDLSurface);
     SDL_FreeSurface (scaledSDLSurface);
 }
@@ -436,6 +990,13 @@ void
 Surface::setAlpha (uint8_t alpha)
 {
     SDL_SetSurfaceAlphaMod (toSDLSurface (), alpha);
+    // Surfaces without alpha channel only need blending when translucent.
+    if ( 0 == toSDLSurface ()->format->Amask )
+    {
+        SDL_SetSurfaceBlendMode (toSDLSurface (),
+                                 k_MaxAlpha == alpha ? SDL_BLENDMODE_NONE :
+                                                       SDL_BLENDMODE_BLEND);
+    }
 }
 
 ///
@@ -458,5 +1019,6 @@ Surface::setColorKey (uint32_t colorKey)
 void
 Surface::swap (Surface &lhs, Surface &rhs)
 {
+    std::swap (lhs.m_Premultiplied, rhs.m_Premultiplied);
     std::swap (lhs.m_SDLSurface, rhs.m_SDLSurface);
 }
@@ -22,6 +22,7 @@
 #include <string>
 
 // Forward declarations.
+struct SDL_PixelFormat;
 struct SDL_Surface;
 
 namespace Amoebax
@@ -47,6 +48,11 @@ namespace Amoebax
                        uint16_t sourceWidth, uint16_t sourceHeight,
                        uint16_t destinationX, uint16_t destinationY,
                        SDL_Surface *destination);
+            void copyPixels (uint16_t sourceX, uint16_t sourceY,
+                             uint16_t sourceWidth, uint16_t sourceHeight,
+                             uint16_t destinationX, uint16_t destinationY,
+                             Surface &destination) const;
+            Surface *createCompatible (uint16_t width, uint16_t height) const;
             uint32_t getPixel (uint16_t x, uint16_t y);
             static Surface *fromFile (const std::string fileName);
             static Surface *fromScreen (void);
@@ -62,6 +68,10 @@ namespace Amoebax
         private:
             Surface (SDL_Surface *SDLSurface);
 
+            void convertToFormat (const SDL_PixelFormat *format);
+
+            /// Tells whether the color channels are multiplied by alpha.
+            bool m_Premultiplied;
             /// The real image's SDL surface.
             SDL_Surface *m_SDLSurface;
     };
@@ -19,7 +19,6 @@
 #include <assert.h>
 #include <cstdlib>
 #include <iostream>
-#include <limits>
 #include <SDL.h>
 #include <SDL_mixer.h>
 #include <sstream>
@@ -35,10 +34,14 @@
 #include "FadeInState.h"
 #include "FadeOutState.h"
 #include "File.h"
+#include "FlightRecorder.h"
 #include "IState.h"
 #include "Options.h"
 #include "PauseState.h"
+#include "Profiler.h"
+#include "Random.h"
 #include "System.h"
+#include "Tracer.h"
 #include "VideoErrorState.h"
 
 using namespace Amoebax;
@@ -51,8 +54,6 @@ static const int k_AudioChannels = 2;
 static const int k_AudioFormat = AUDIO_S16SYS;
 /// The audio rate to use.
 static const int k_AudioRate = 44100;
-/// Maximum frame rate (in FPS.)
-static const float k_FrameRate = 30.0f;
 /// Maximum screen's vertical resolution (in pixels.)
 static const float k_ScreenMaxHeight = 960.0f;
 /// Maximum screen's horizontal resolution (in pixels.)
@@ -92,14 +93,24 @@ changeToExecutableDirectory (void)
 ///
 System::System (void):
     m_ActiveState (0),
-    m_InvalidatedRegion (),
+    m_Canvas (0),
+    m_CanvasTexture (0),
+    m_Compositor (),
+    m_EventTime (0),
+    m_InvalidatedRegions (),
+    m_PresentedArea (0),
     m_PreviousActiveState (0),
+    m_Renderer (0),
+    m_RendererEnabled (false),
     m_Window (0),
     m_ScreenScaleFactor (1.0f),
     m_SoundEnabled (false),
     m_States (0),
-    m_StatesToDelete (0)
+    m_StatesToDelete (0),
+    m_UpdatedRects ()
 {
+    // The background's dirty regions and then the frame's.
+    m_UpdatedRects.reserve (2 * DirtyRegions::k_MaxRects);
 }
 
 ///
@@ -118,6 +129,11 @@ System::~System (void)
     std::for_each (m_Joysticks.begin (), m_Joysticks.end (),
                    SDL_JoystickClose);
     // Shuts down all SDL systems.
+    destroyCanvas ();
+    if ( 0 != m_Renderer )
+    {
+        SDL_DestroyRenderer (m_Renderer);
+    }
     if ( m_SoundEnabled )
     {
         Mix_CloseAudio ();
@@ -169,6 +185,12 @@ System::changeVideoMode (void)
     {
         toggleFullScreen ();
     }
+    // The renderer scales the canvas to the window, but the canvas
+    // must have the new resolution.
+    if ( 0 != m_Renderer )
+    {
+        createCanvas ();
+    }
     // Rescales
     m_ScreenScaleFactor = std::max (w / k_ScreenMaxWidth,
                                     h / k_ScreenMaxHeight);
@@ -182,6 +204,56 @@ System::changeVideoMode (void)
     invalidateWholeScreen ();
 }
 
+///
+/// \brief Creates the canvas the states draw to when using the renderer.
+///
+/// The canvas has the resolution set in the options, and the renderer
+/// scales it to the window's size each time it presents the screen, so
+/// a full screen window needs no new video mode.
+///
+/// The renderer only presents the canvas: the graphics are still resized
+/// to the canvas's resolution when loaded and blit in software, and the
+/// canvas and its texture take memory on top of them.  Drawing the
+/// sprites from an atlas texture with batched render calls, scaled at
+/// draw time, is still to be done.
+///
+void
+System::createCanvas (void)
+{
+    destroyCanvas ();
+
+    int w = Options::getInstance ().getScreenWidth ();
+    int h = Options::getInstance ().getScreenHeight ();
+    m_Canvas = SDL_CreateRGBSurfaceWithFormat (0, w, h, 32,
+                                               SDL_PIXELFORMAT_RGB888);
+    if ( 0 == m_Canvas )
+    {
+        throw std::runtime_error (SDL_GetError ());
+    }
+    m_CanvasTexture = SDL_CreateTexture (m_Renderer, SDL_PIXELFORMAT_RGB888,
+                                         SDL_TEXTUREACCESS_STREAMING, w, h);
+    if ( 0 == m_CanvasTexture )
+    {
+        throw std::runtime_error (SDL_GetError ());
+    }
+    SDL_RenderSetLogicalSize (m_Renderer, w, h);
+}
+
+///
+/// \brief Destroys the canvas and its texture, if any.
+///
+void
+System::destroyCanvas (void)
+{
+    if ( 0 != m_CanvasTexture )
+    {
+        SDL_DestroyTexture (m_CanvasTexture);
+        m_CanvasTexture = 0;
+    }
+    SDL_FreeSurface (m_Canvas);
+    m_Canvas = 0;
+}
+
 ///
 /// \brief Gets the factor between the maxium screen resolution and the current.
 ///
@@ -201,6 +273,10 @@ System::getScreenScaleFactor (void)
 SDL_Surface *
 System::getScreenSDLSurface (void)
 {
+    if ( 0 != m_Canvas )
+    {
+        return m_Canvas;
+    }
     return SDL_GetWindowSurface( m_Window );
 }
 
@@ -218,8 +294,9 @@ System::init (void)
     changeToExecutableDirectory ();
 #endif // IS_WIN32_HOST
 
-    // Initialize pseudo-random generator.
+    // Initialize pseudo-random generators.
     srand ( (unsigned)time (0));
+    Random::init (static_cast<uint32_t>(time (0)));
 
     // Initialize SDL.
     if ( SDL_Init (SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER | SDL_INIT_VIDEO) < 0 )
@@ -231,7 +308,7 @@ System::init (void)
     // Set the window's title for windowed modes.
     SDL_SetWindowTitle (m_Window, PACKAGE_NAME);
     // Set the maximum frame rate.
-    FrameManager::init (k_FrameRate);
+    FrameManager::init (Options::getInstance ().getFrameRate ());
     // Open the audio device, if enabled.
     if ( Options::getInstance ().isSoundEnabled () )
     {
@@ -365,25 +442,38 @@ System::returnToMainMenu (void)
 ///
 /// \brief Redraws the state's background.
 ///
+/// Only the invalidated rectangles are redrawn.  They are also the
+/// first rectangles to update on the screen at the end of the frame.
+///
 void
 System::redrawStateBackground (void)
 {
-    if ( 0 != m_ActiveState &&
-         m_InvalidatedRegion.x1 < m_InvalidatedRegion.x2 &&
-         m_InvalidatedRegion.y1 < m_InvalidatedRegion.y2 )
+    if ( 0 != m_ActiveState )
     {
-        SDL_Rect redrawRegion;
-        redrawRegion.h = m_InvalidatedRegion.y2 - m_InvalidatedRegion.y1;
-        redrawRegion.w = m_InvalidatedRegion.x2 - m_InvalidatedRegion.x1;
-        redrawRegion.x = m_InvalidatedRegion.x1;
-        redrawRegion.y = m_InvalidatedRegion.y1;
-
-        m_ActiveState->redrawBackground (&redrawRegion, getScreenSDLSurface ());
-
-        m_InvalidatedRegion.x1 = std::numeric_limits<int16_t>::max ();
-        m_InvalidatedRegion.y1 = std::numeric_limits<int16_t>::max ();
-        m_InvalidatedRegion.x2 = std::numeric_limits<int16_t>::min ();
-        m_InvalidatedRegion.y2 = std::numeric_limits<int16_t>::min ();
+        SDL_Surface *screen = getScreenSDLSurface ();
+        SDL_Rect screenRect;
+        screenRect.h = screen->h;
+        screenRect.w = screen->w;
+        screenRect.x = 0;
+        screenRect.y = 0;
+
+        const std::vector<SDL_Rect> &regions = m_InvalidatedRegions.getRects ();
+        for ( std::vector<SDL_Rect>::const_iterator region = regions.begin () ;
+              region != regions.end () ; ++region )
+        {
+            SDL_Rect redrawRegion;
+            if ( SDL_IntersectRect (&(*region), &screenRect, &redrawRegion) )
+            {
+                m_UpdatedRects.push_back (redrawRegion);
+            }
+        }
+        for ( std::vector<SDL_Rect>::iterator region = m_UpdatedRects.begin () ;
+              region != m_UpdatedRects.end () ; ++region )
+        {
+            m_ActiveState->redrawBackground (&(*region), screen);
+        }
+        // Drawing the background invalidates the regions again.
+        m_InvalidatedRegions.clear ();
     }
 }
 
@@ -400,9 +490,11 @@ System::run (void)
 {
     assert (0 != getScreenSDLSurface () &&
             "Tried to run the system without initializing it.");
+    FlightRecorder::start ();
     bool end = false;
     do
     {
+        AMOEBAX_TRACE_ZONE ("System::run");
         // Get the active state or set it 0 if no state is active.
         if ( m_States.empty () )
         {
@@ -412,9 +504,17 @@ System::run (void)
         {
             m_ActiveState = m_States.back ();
         }
+        FlightRecorder::setActiveState (m_ActiveState);
 
         // If we are going too fast, slow down so we won't burn the CPU.
-        FrameManager::update ();
+        {
+            AMOEBAX_TRACE_ZONE ("FrameManager::update");
+            FrameManager::update ();
+        }
+
+        // Activating the state and processing the events is timed as
+        // a single phase, since both create states and load resources.
+        Profiler::Timer eventsTimer (Profiler::PhaseEvents);
 
         // If there's no active state, then we are done.
         if ( 0 == m_ActiveState )
@@ -442,6 +542,7 @@ System::run (void)
             }
             else if ( 0 != m_ActiveState )
             {
+                m_EventTime = event.common.timestamp;
                 switch ( event.type )
                 {
 #if 0 // TODO
@@ -465,7 +566,13 @@ System::run (void)
 #endif
 
                     case SDL_WINDOWEVENT:
-                        if ( event.window.event == SDL_WINDOWEVENT_MINIMIZED )
+                        if ( event.window.event == SDL_WINDOWEVENT_EXPOSED ||
+                             event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED )
+                        {
+                            // The window's contents are lost.
+                            invalidateWholeScreen ();
+                        }
+                        else if ( event.window.event == SDL_WINDOWEVENT_MINIMIZED )
                         {
                             // Window is minimized.
                             Music::pause ();
@@ -480,6 +587,37 @@ System::run (void)
                         {
                             toggleFullScreen ();
                         }
+                        // F3 and F4 are reserved to profile the frames.
+                        else if ( SDLK_F3 == event.key.keysym.sym )
+                        {
+                            Profiler::toggleGraph ();
+                            invalidateWholeScreen ();
+                        }
+                        else if ( SDLK_F4 == event.key.keysym.sym )
+                        {
+                            if ( Profiler::isRecording () )
+                            {
+                                Profiler::stopRecording ();
+                            }
+                            else
+                            {
+                                Profiler::startRecording ();
+                            }
+                        }
+#if defined (AMOEBAX_TRACING)
+                        // F5 is reserved to trace the zones.
+                        else if ( SDLK_F5 == event.key.keysym.sym )
+                        {
+                            if ( Tracer::isTracing () )
+                            {
+                                Tracer::stop ();
+                            }
+                            else
+                            {
+                                Tracer::start ();
+                            }
+                        }
+#endif // AMOEBAX_TRACING
                         else
                         {
                             m_ActiveState->keyDown (event.key.keysym.sym);
@@ -493,25 +631,51 @@ System::run (void)
             }
         }
 
+        eventsTimer.stop ();
+
         // Update and render the active state.
         if ( 0 != m_ActiveState )
         {
             // Update the state's logic.
-            m_ActiveState->update (FrameManager::getElapsedTime ());
+            {
+                Profiler::Timer timer (Profiler::PhaseUpdate);
+                AMOEBAX_TRACE_ZONE ("IState::update");
+                m_ActiveState->update (FrameManager::getElapsedTime ());
+            }
             // Remove any previously set clip rectangle.
             SDL_SetClipRect (getScreenSDLSurface (), NULL);
+            // Record the blits to large screens, to draw them in bands.
+            m_Compositor.begin (getScreenSDLSurface ());
             // Draw the state's background for the invalided screen region.
-            redrawStateBackground ();
-            // Render the state.
-            m_ActiveState->render (getScreenSDLSurface ());
+            {
+                Profiler::Timer timer (Profiler::PhaseBackground);
+                AMOEBAX_TRACE_ZONE ("System::redrawStateBackground");
+                redrawStateBackground ();
+            }
+            // Render the state and draw the recorded blits.
+            {
+                Profiler::Timer timer (Profiler::PhaseRender);
+                AMOEBAX_TRACE_ZONE ("IState::render");
+                m_ActiveState->render (getScreenSDLSurface ());
+                m_Compositor.end ();
+            }
+            // Draw the frames' graph over the state.
+            Profiler::draw (getScreenSDLSurface ());
         }
 
         // Refresh the screen.
-        SDL_UpdateWindowSurface ( m_Window );
+        {
+            Profiler::Timer timer (Profiler::PhasePresent);
+            AMOEBAX_TRACE_ZONE ("System::updateScreen");
+            updateScreen ();
+        }
+        Profiler::endFrame ();
+        FlightRecorder::endFrame (m_PresentedArea);
 
         // Deletes the not longer used states.
         if ( !m_StatesToDelete.empty () )
         {
+            FlightRecorder::setActiveState (0);
             std::for_each (m_StatesToDelete.begin (), m_StatesToDelete.end (),
                            DeleteObject<IState> ());
             m_StatesToDelete.clear ();
@@ -519,8 +683,26 @@ System::run (void)
 
         // Set the active state as the previous active state.
         m_PreviousActiveState = m_ActiveState;
+
+        // If the active state stays active and has nothing to animate,
+        // wait for an event instead of drawing the same frame again,
+        // unless the frames' graph must keep moving.
+        if ( !end && !m_States.empty () && m_States.back () == m_ActiveState &&
+             !Profiler::isGraphVisible () )
+        {
+            uint32_t idleTime = m_ActiveState->getIdleTime ();
+            if ( 0 < idleTime )
+            {
+                if ( idleTime > IState::k_MaxIdleTime )
+                {
+                    idleTime = IState::k_MaxIdleTime;
+                }
+                FrameManager::idle (idleTime);
+            }
+        }
     }
     while ( !end );
+    FlightRecorder::stop ();
 }
 
 ///
@@ -548,6 +730,24 @@ System::setActiveState (IState *state, uint8_t fade)
     }
 }
 
+///
+/// \brief Sets whether to present the screen with an SDL renderer.
+///
+/// With the renderer, the states draw to a canvas with the resolution
+/// from the options, which the renderer scales to the window.  Any
+/// renderer works, including SDL's software renderer.  Without the
+/// renderer, the states draw directly to the window's surface.
+///
+/// \param enabled Set to \a true to use the renderer.
+/// \note This must be called before init().
+///
+void
+System::setRendererEnabled (bool enabled)
+{
+    assert ( 0 == m_Window && "Tried to change the renderer after init()" );
+    m_RendererEnabled = enabled;
+}
+
 ///
 /// \brief Sets the video mode reading the parameters from the options.
 ///
@@ -585,10 +785,51 @@ System::setVideoMode (void)
             throw std::runtime_error (SDL_GetError ());
         }
     }
+    // Create the renderer, falling back to the window's surface if
+    // there is no renderer available.
+    if ( m_RendererEnabled && 0 == m_Renderer )
+    {
+        SDL_SetHint (SDL_HINT_RENDER_SCALE_QUALITY, "linear");
+        // Present with vertical sync when the display refreshes at the
+        // frame rate, so presenting the screen paces the frames, unless
+        // the frames must be as fast as possible.
+        SDL_DisplayMode displayMode;
+        uint32_t rendererFlags = 0;
+        if ( !FrameManager::isFixedStep () &&
+             0 == SDL_GetCurrentDisplayMode (SDL_GetWindowDisplayIndex (m_Window),
+                                             &displayMode) &&
+             displayMode.refresh_rate ==
+             static_cast<int>(Options::getInstance ().getFrameRate ()) )
+        {
+            rendererFlags = SDL_RENDERER_PRESENTVSYNC;
+        }
+        m_Renderer = SDL_CreateRenderer (m_Window, -1, rendererFlags);
+        if ( 0 == m_Renderer )
+        {
+            std::cerr << "Couldn't create the renderer: " << SDL_GetError ();
+            std::cerr << std::endl;
+        }
+        else
+        {
+            SDL_RendererInfo rendererInfo;
+            FrameManager::setVSyncEnabled (
+                    0 == SDL_GetRendererInfo (m_Renderer, &rendererInfo) &&
+                    0 != (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC));
+            createCanvas ();
+        }
+    }
     // Get the current screen's scale factor.
     int w = 0;
     int h = 0;
-    SDL_GetWindowSize ( m_Window, &w, &h);
+    if ( 0 != m_Canvas )
+    {
+        w = m_Canvas->w;
+        h = m_Canvas->h;
+    }
+    else
+    {
+        SDL_GetWindowSize ( m_Window, &w, &h);
+    }
     m_ScreenScaleFactor = std::max (w / k_ScreenMaxWidth,
                                     h / k_ScreenMaxHeight);
     // Hide the cursor on the screen. Do only if the video mode is set
@@ -639,3 +880,68 @@ System::toggleFullScreen (void)
     // when it passes over the window...
     SDL_ShowCursor (newState ? SDL_DISABLE : SDL_ENABLE);
 }
+
+///
+/// \brief Updates the changed rectangles of the window.
+///
+/// The changed rectangles are those whose background was redrawn and
+/// those where the state rendered to, which are going to be redrawn
+/// the next frame.
+///
+void
+System::updateScreen (void)
+{
+    SDL_Surface *screen = getScreenSDLSurface ();
+    SDL_Rect screenRect;
+    screenRect.h = screen->h;
+    screenRect.w = screen->w;
+    screenRect.x = 0;
+    screenRect.y = 0;
+
+    const std::vector<SDL_Rect> &regions = m_InvalidatedRegions.getRects ();
+    for ( std::vector<SDL_Rect>::const_iterator region = regions.begin () ;
+          region != regions.end () ; ++region )
+    {
+        SDL_Rect updateRegion;
+        if ( SDL_IntersectRect (&(*region), &screenRect, &updateRegion) )
+        {
+            m_UpdatedRects.push_back (updateRegion);
+        }
+    }
+
+    m_PresentedArea = 0;
+    for ( std::vector<SDL_Rect>::const_iterator rect = m_UpdatedRects.begin () ;
+          rect != m_UpdatedRects.end () ; ++rect )
+    {
+        m_PresentedArea += rect->w * rect->h;
+    }
+
+    if ( !m_UpdatedRects.empty () )
+    {
+        if ( 0 != m_Renderer )
+        {
+            // Only the changed rectangles are uploaded, but the whole
+            // texture is copied because the renderer's back buffer is
+            // undefined after presenting it.
+            for ( std::vector<SDL_Rect>::const_iterator rect = m_UpdatedRects.begin () ;
+                  rect != m_UpdatedRects.end () ; ++rect )
+            {
+                SDL_UpdateTexture (m_CanvasTexture, &(*rect),
+                                   static_cast<uint8_t *>(screen->pixels) +
+                                   rect->y * screen->pitch +
+                                   rect->x * screen->format->BytesPerPixel,
+                                   screen->pitch);
+            }
+            SDL_RenderClear (m_Renderer);
+            SDL_RenderCopy (m_Renderer, m_CanvasTexture, NULL, NULL);
+            SDL_RenderPresent (m_Renderer);
+        }
+        else
+        {
+            SDL_UpdateWindowSurfaceRects (m_Window, &m_UpdatedRects[0],
+                                          static_cast<int> (m_UpdatedRects.size ()));
+        }
+        m_UpdatedRects.clear ();
+        FrameManager::screenPresented ();
+    }
+}
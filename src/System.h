@@ -23,8 +23,11 @@
 #include <algorithm>
 #include <vector>
 
+#include <SDL_render.h>
 #include <SDL_video.h>
 #include <SDL_joystick.h>
+#include "Compositor.h"
+#include "DirtyRegions.h"
 
 namespace Amoebax
 {
@@ -74,6 +77,8 @@ namespace Amoebax
 
             void applyVideoMode (void);
             void applyVolumeLevel (void);
+            Compositor &getCompositor (void);
+            uint32_t getEventTime (void) const;
             static System &getInstance (void);
             float getScreenScaleFactor (void);
             SDL_Surface *getScreenSDLSurface (void);
@@ -87,36 +92,10 @@ namespace Amoebax
             void run (void);
             void setActiveState (IState *state,
                                  uint8_t fade = FadeIn | FadeOut);
+            void setRendererEnabled (bool enabled);
             static void showFatalError (const std::string &error);
 
         private:
-            ///
-            /// \struct Region.
-            /// \brief An screen region.
-            ///
-            struct Region
-            {
-                /// The top-left X coordinate of the region.
-                int x1;
-                /// The top-left Y coordinate of the region.
-                int y1;
-                /// The bottom-right X coordinate of the region.
-                int x2;
-                /// The bottom-right Y coordinate of the region.
-                int y2;
-
-                ///
-                /// Default constructor.
-                ///
-                Region (void):
-                    x1 (0),
-                    y1 (0),
-                    x2 (0),
-                    y2 (0)
-                {
-                }
-            };
-
             // Prevent the System class to be instantied without
             // calling getInstance().
             System (void);
@@ -140,19 +119,36 @@ namespace Amoebax
             System &operator= (const System &);
 
             void changeVideoMode (void);
+            void createCanvas (void);
+            void destroyCanvas (void);
             void invalidateWholeScreen (void);
             void redrawStateBackground (void);
             void setVideoMode (void);
             void toggleFullScreen (void);
+            void updateScreen (void);
 
             /// The currently active state.
             IState *m_ActiveState;
-            /// The screen region invalidated.
-            Region m_InvalidatedRegion;
+            /// The surface the states draw to when using the renderer.
+            SDL_Surface *m_Canvas;
+            /// The texture the renderer scales the canvas from.
+            SDL_Texture *m_CanvasTexture;
+            /// Draws the blits to the screen in parallel.
+            Compositor m_Compositor;
+            /// The time the event being processed was received at.
+            uint32_t m_EventTime;
+            /// The screen regions invalidated.
+            DirtyRegions m_InvalidatedRegions;
             /// The list of open joysticks.
             std::vector<SDL_Joystick *> m_Joysticks;
+            /// The number of pixels presented by the last updateScreen().
+            uint32_t m_PresentedArea;
             /// The previous active state.
             IState *m_PreviousActiveState;
+            /// The renderer that presents the canvas on the window.
+            SDL_Renderer *m_Renderer;
+            /// Tells whether to present the screen with a renderer.
+            bool m_RendererEnabled;
             /// The main window.
             SDL_Window *m_Window;
             /// The factor between the maximum screen size and the current size.
@@ -163,10 +159,38 @@ namespace Amoebax
             std::vector<IState *> m_States;
             /// The list of states to delete.
             std::vector<IState *> m_StatesToDelete;
+            /// The screen rectangles changed in the current frame.
+            std::vector<SDL_Rect> m_UpdatedRects;
             /// The only system instance.
             static System m_SystemInstance;
     };
 
+    ///
+    /// \brief Gets the compositor that draws the blits to the screen.
+    ///
+    /// \return The compositor of the screen.
+    ///
+    inline Compositor &
+    System::getCompositor (void)
+    {
+        return m_Compositor;
+    }
+
+    ///
+    /// \brief Gets the time the event being processed was received at.
+    ///
+    /// The states and players can use it to apply an input at the
+    /// time it happened instead of when the frame started.
+    ///
+    /// \return The time of the event passed to the active state, in the
+    ///         same milliseconds as FrameManager::getCurrentTime().
+    ///
+    inline uint32_t
+    System::getEventTime (void) const
+    {
+        return m_EventTime;
+    }
+
     ///
     /// \brief Gets the only instance of System.
     ///
@@ -192,12 +216,7 @@ namespace Amoebax
     inline void
     System::invalidateScreenRegion (SDL_Rect *region)
     {
-        m_InvalidatedRegion.x1 = std::min (m_InvalidatedRegion.x1, region->x);
-        m_InvalidatedRegion.y1 = std::min (m_InvalidatedRegion.y1, region->y);
-        m_InvalidatedRegion.x2 = std::max (m_InvalidatedRegion.x2,
-                                           region->x + region->w);
-        m_InvalidatedRegion.y2 = std::max (m_InvalidatedRegion.y2,
-                                           region->y + region->h);
+        m_InvalidatedRegions.add (*region);
     }
 
 }
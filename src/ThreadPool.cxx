@@ -0,0 +1,161 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "ThreadPool.h"
+
+using namespace Amoebax;
+
+///
+/// \brief Constructor.
+///
+/// \param numberOfThreads The number of worker threads to start. If 0,
+///                        starts getDefaultNumberOfThreads() threads.
+///
+ThreadPool::ThreadPool (unsigned int numberOfThreads):
+    m_AllDone (),
+    m_Mutex (),
+    m_NextTask (0),
+    m_RunningTasks (0),
+    m_Stop (false),
+    m_TaskAvailable (),
+    m_Tasks (),
+    m_Workers ()
+{
+    if ( 0 == numberOfThreads )
+    {
+        numberOfThreads = getDefaultNumberOfThreads ();
+    }
+    // Keep room for a task per worker, so scheduling that many tasks
+    // doesn't allocate.
+    m_Tasks.reserve (numberOfThreads);
+    m_Workers.reserve (numberOfThreads);
+    for ( unsigned int thread = 0 ; thread < numberOfThreads ; ++thread )
+    {
+        m_Workers.push_back (std::thread (&ThreadPool::work, this));
+    }
+}
+
+///
+/// \brief Destructor.
+///
+/// Waits for all the scheduled tasks to finish and stops the workers.
+///
+ThreadPool::~ThreadPool (void)
+{
+    wait ();
+    {
+        std::lock_guard<std::mutex> lock (m_Mutex);
+        m_Stop = true;
+    }
+    m_TaskAvailable.notify_all ();
+    for ( std::vector<std::thread>::iterator worker = m_Workers.begin () ;
+          worker != m_Workers.end () ; ++worker )
+    {
+        worker->join ();
+    }
+}
+
+///
+/// \brief Gets the number of threads to use when none is given.
+///
+/// \return The number of CPU cores, or 1 if it can't be known.
+///
+unsigned int
+ThreadPool::getDefaultNumberOfThreads (void)
+{
+    unsigned int cores = std::thread::hardware_concurrency ();
+    return 0 < cores ? cores : 1;
+}
+
+///
+/// \brief Tells if there are tasks not done yet.
+///
+/// \return \a true if a task is waiting or running, \a false if
+///         wait() would return right away.
+///
+bool
+ThreadPool::isBusy (void)
+{
+    std::lock_guard<std::mutex> lock (m_Mutex);
+    return m_NextTask < m_Tasks.size () || 0 < m_RunningTasks;
+}
+
+///
+/// \brief Adds a new task to run.
+///
+/// \param task The task to run in one of the worker threads.
+///
+void
+ThreadPool::schedule (const Task &task)
+{
+    {
+        std::lock_guard<std::mutex> lock (m_Mutex);
+        m_Tasks.push_back (task);
+    }
+    m_TaskAvailable.notify_one ();
+}
+
+///
+/// \brief Waits until all the scheduled tasks are done.
+///
+void
+ThreadPool::wait (void)
+{
+    std::unique_lock<std::mutex> lock (m_Mutex);
+    while ( m_NextTask < m_Tasks.size () || 0 < m_RunningTasks )
+    {
+        m_AllDone.wait (lock);
+    }
+}
+
+///
+/// \brief The loop of every worker thread.
+///
+void
+ThreadPool::work (void)
+{
+    std::unique_lock<std::mutex> lock (m_Mutex);
+    for (;;)
+    {
+        while ( !m_Stop && m_NextTask == m_Tasks.size () )
+        {
+            m_TaskAvailable.wait (lock);
+        }
+        if ( m_Stop )
+        {
+            return;
+        }
+        Task task;
+        task.swap (m_Tasks[m_NextTask]);
+        ++m_NextTask;
+        if ( m_NextTask == m_Tasks.size () )
+        {
+            m_Tasks.clear ();
+            m_NextTask = 0;
+        }
+        ++m_RunningTasks;
+        lock.unlock ();
+        task ();
+        lock.lock ();
+        --m_RunningTasks;
+        if ( m_NextTask == m_Tasks.size () && 0 == m_RunningTasks )
+        {
+            m_AllDone.notify_all ();
+        }
+    }
+}
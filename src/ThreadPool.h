@@ -0,0 +1,102 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_THREAD_POOL_H)
+#define AMOEBAX_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Amoebax
+{
+    ///
+    /// \class ThreadPool.
+    /// \brief A fixed set of worker threads that run queued tasks.
+    ///
+    /// Tasks are run in the same order they are scheduled, but since
+    /// there can be many workers, they can finish in any order. Tasks
+    /// must not throw exceptions.
+    ///
+    class ThreadPool
+    {
+        public:
+            /// A single task to run.
+            typedef std::function<void (void)> Task;
+
+            explicit ThreadPool (unsigned int numberOfThreads = 0);
+            ~ThreadPool (void);
+
+            static unsigned int getDefaultNumberOfThreads (void);
+            unsigned int getNumberOfThreads (void) const;
+            bool isBusy (void);
+            void schedule (const Task &task);
+            void wait (void);
+
+        private:
+            ///
+            /// \brief Copy constructor.
+            ///
+            /// \note This constructor is left unimplemented because we
+            /// don't want copies of ThreadPool. Don't use it.
+            ///
+            ThreadPool (const ThreadPool &);
+            ///
+            /// \brief Assigment operator.
+            ///
+            /// \note This operator is left unimplemented because we
+            /// don't want copies of ThreadPool. Don't use it.
+            ///
+            ThreadPool &operator= (const ThreadPool &);
+
+            void work (void);
+
+            /// Signaled when all tasks are done.
+            std::condition_variable m_AllDone;
+            /// Guards the queue and the counters.
+            std::mutex m_Mutex;
+            /// The index in m_Tasks of the next task to run.
+            size_t m_NextTask;
+            /// The number of tasks being run right now.
+            unsigned int m_RunningTasks;
+            /// Tells the workers to quit.
+            bool m_Stop;
+            /// Signaled when there's a new task or the workers must quit.
+            std::condition_variable m_TaskAvailable;
+            /// The tasks waiting for a worker, from m_NextTask on.  Emptied
+            /// once all are taken, keeping its memory for the next ones.
+            std::vector<Task> m_Tasks;
+            /// The worker threads.
+            std::vector<std::thread> m_Workers;
+    };
+
+    ///
+    /// \brief Gets the number of worker threads.
+    ///
+    /// \return The number of threads that run the tasks.
+    ///
+    inline unsigned int
+    ThreadPool::getNumberOfThreads (void) const
+    {
+        return static_cast<unsigned int>(m_Workers.size ());
+    }
+}
+
+#endif // !AMOEBAX_THREAD_POOL_H
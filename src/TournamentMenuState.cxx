@@ -22,6 +22,7 @@
 #include "TournamentMenuState.h"
 #include "TournamentSetupState.h"
 #include "System.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
@@ -31,6 +32,7 @@ using namespace Amoebax;
 TournamentMenuState::TournamentMenuState (void):
     IState ()
 {
+    AMOEBAX_TRACE_ZONE ("TournamentMenuState::TournamentMenuState");
     loadGraphicResources ();
 
     m_Players.push_back (2);
@@ -126,6 +128,7 @@ TournamentMenuState::keyUp (uint32_t key)
 void
 TournamentMenuState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("TournamentMenuState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
     m_Background.reset (
             Surface::fromFile (File::getGraphicsFilePath ("menuBackground.png")));
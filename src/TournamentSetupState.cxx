@@ -21,6 +21,7 @@
 #include "System.h"
 #include "TournamentSetupState.h"
 #include "TournamentState.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
@@ -65,6 +66,7 @@ TournamentSetupState::TournamentSetupState (uint8_t players):
     m_Selection (nullptr),
     m_TimeToWait (k_TimeToWait)
 {
+    AMOEBAX_TRACE_ZONE ("TournamentSetupState::TournamentSetupState");
     m_Characters[0].name = "Kim";
     m_Characters[1].name = "Sasha";
     m_Characters[2].name = "Brooke";
@@ -352,6 +354,7 @@ TournamentSetupState::getSelectedRow (void) const
 void
 TournamentSetupState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("TournamentSetupState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
     const float originalScale = 1.0f;
     const uint16_t faceHeight = k_FaceHeight;
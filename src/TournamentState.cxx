@@ -22,8 +22,10 @@
 #include "CongratulationsState.h"
 #include "File.h"
 #include "HumanPlayer.h"
+#include "Random.h"
 #include "System.h"
 #include "TournamentState.h"
+#include "Tracer.h"
 #include "TwoComputerPlayersState.h"
 #include "TwoPlayersState.h"
 #include "VersusState.h"
@@ -54,12 +56,16 @@ TournamentState::TournamentState (const std::vector<TournamentState::Player> &pl
     m_Matches (),
     m_NumPlayers (players.size ()),
     m_ShowCurrentOpponents (true),
+    m_Simulation (),
+    m_SimulationStop (false),
     m_SoundLose (Sound::fromFile (File::getSoundFilePath ("youlose.wav"))),
     m_SoundWin (Sound::fromFile (File::getSoundFilePath ("youwin.wav"))),
     m_VerticalPosition ()
 {
+    AMOEBAX_TRACE_ZONE ("TournamentState::TournamentState");
     loadGraphicResources ();
     createMatchTree (players);
+    simulateCurrentMatch ();
 }
 
 ///
@@ -67,6 +73,7 @@ TournamentState::TournamentState (const std::vector<TournamentState::Player> &pl
 ///
 TournamentState::~TournamentState (void)
 {
+    stopSimulation ();
     deleteMatch (m_Matches.children.first);
     deleteMatch (m_Matches.children.second);
 }
@@ -238,6 +245,8 @@ TournamentState::endOfMatch (IPlayer::PlayerSide winner,
         setCurrentMatch (getCurrentMatch ()->parent);
     }
 
+    simulateCurrentMatch ();
+
     // Play the "winner" sound effect if the winner is human, otherwise
     // play the "lose" sound effect.
     if ( winnerPlayer.isComputerPlayer )
@@ -273,9 +282,21 @@ TournamentState::getBestTwoPlayersState (const Player &leftCharacter,
     IState *twoPlayersState = 0;
     if ( leftCharacter.isComputerPlayer && rightCharacter.isComputerPlayer )
     {
+        assert ( m_Simulation.valid () &&
+                 "The computer players' match must be already simulating." );
+        MatchSimulator::Result result (stopSimulation ());
+        // If the time was up, let the points decide.
+        result.winner =
+            MatchSimulator::adjudicate (result,
+                                        leftCharacter.computerPlayerLevel,
+                                        rightCharacter.computerPlayerLevel,
+                                        leftCharacter.score,
+                                        rightCharacter.score);
         twoPlayersState =
             new TwoComputerPlayersState (leftCharacter.computerPlayerLevel,
                                          rightCharacter.computerPlayerLevel,
+                                         result.winner,
+                                         result.leftScore, result.rightScore,
                                          this);
     }
     else
@@ -407,6 +428,7 @@ TournamentState::keyUp (uint32_t key)
 void
 TournamentState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("TournamentState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
     m_Background.reset (
             Surface::fromFile (File::getGraphicsFilePath ("menuBackground.png")));
@@ -556,6 +578,40 @@ TournamentState::setShowCurrentOpponents (bool showCurrentOpponents)
     m_ShowCurrentOpponents = showCurrentOpponents;
 }
 
+///
+/// \brief Starts playing the current match in background.
+///
+/// If both opponents of the current match are computer players, the
+/// match is played by MatchSimulator in a worker thread while the
+/// tournament's tree is shown.  The simulation runs as fast as the CPU
+/// can until the match is over or until stopSimulation() is called
+/// when the match should start.
+///
+/// If any of the opponents is human, this function does nothing.
+///
+void
+TournamentState::simulateCurrentMatch (void)
+{
+    Match *match = getCurrentMatch ();
+    if ( match != &m_Matches &&
+         match->opponents.first.isComputerPlayer &&
+         match->opponents.second.isComputerPlayer )
+    {
+        stopSimulation ();
+        m_SimulationStop = false;
+        m_Simulation =
+            std::async (std::launch::async, MatchSimulator::play,
+                        match->opponents.first.computerPlayerLevel,
+                        match->opponents.second.computerPlayerLevel,
+                        static_cast<uint32_t> (Random::get ()),
+                        match->opponents.first.score,
+                        match->opponents.second.score,
+                        MatchSimulator::k_DefaultStepTime,
+                        MatchSimulator::k_DefaultMaxMatchTime,
+                        &m_SimulationStop);
+    }
+}
+
 ///
 /// \brief Starts the current match.
 ///
@@ -585,6 +641,26 @@ TournamentState::startCurrentMatch (void)
     }
 }
 
+///
+/// \brief Stops the match being played in background.
+///
+/// \return The result of the simulated match.  If there is no match
+///         being simulated, the returned result is not finished and
+///         has both scores at 0.
+///
+MatchSimulator::Result
+TournamentState::stopSimulation (void)
+{
+    MatchSimulator::Result result = MatchSimulator::Result ();
+    if ( m_Simulation.valid () )
+    {
+        m_SimulationStop = true;
+        result = m_Simulation.get ();
+    }
+
+    return result;
+}
+
 void
 TournamentState::update (uint32_t elapsedTime)
 {
@@ -19,9 +19,12 @@
 #if !defined (AMOEBAX_TOURNAMENT_STATE_H)
 #define AMOEBAX_TOURNAMENT_STATE_H
 
+#include <atomic>
+#include <future>
 #include "IMatchObserver.h"
 #include "IState.h"
 #include "IPlayer.h"
+#include "MatchSimulator.h"
 
 namespace Amoebax
 {
@@ -102,7 +105,9 @@ namespace Amoebax
             void setCurrentMatchBlinkTime (int32_t blinkTime);
             void setCurrentMatchStartTime (int32_t startTime);
             void setShowCurrentOpponents (bool showCurrentOpponents);
+            void simulateCurrentMatch (void);
             void startCurrentMatch (void);
+            MatchSimulator::Result stopSimulation (void);
 
             /// The current match.
             Match *m_CurrentMatch;
@@ -124,6 +129,10 @@ namespace Amoebax
             size_t m_NumPlayers;
             /// Tells if show the current match's opponents.
             bool m_ShowCurrentOpponents;
+            /// The computer vs. computer match being played in background.
+            std::future<MatchSimulator::Result> m_Simulation;
+            /// Tells the match being played in background to stop.
+            std::atomic<bool> m_SimulationStop;
             /// The sound of when you lose.
             std::unique_ptr<Sound> m_SoundLose;
             /// The sound of when you win.
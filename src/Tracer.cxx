@@ -0,0 +1,260 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Tracer.h"
+
+#if defined (AMOEBAX_TRACING)
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+using namespace Amoebax;
+
+// Class static members.
+std::vector<std::unique_ptr<Tracer::Buffer> > Tracer::m_Buffers;
+std::mutex Tracer::m_BuffersMutex;
+std::string Tracer::m_FileName ("amoebax-trace.json");
+bool Tracer::m_FirstZone = true;
+std::thread Tracer::m_FlushThread;
+uint64_t Tracer::m_StartCounter = 0;
+std::condition_variable Tracer::m_StopFlushing;
+std::mutex Tracer::m_StopMutex;
+thread_local Tracer::Buffer *Tracer::m_ThreadBuffer = 0;
+std::ofstream Tracer::m_TraceFile;
+std::atomic<bool> Tracer::m_Tracing (false);
+
+// The definitions of the class' constants, for when they are used by reference.
+const size_t Tracer::k_BufferSize;
+const uint32_t Tracer::k_FlushInterval;
+
+///
+/// \struct TraceFinisher.
+/// \brief Closes the trace file when the program exits.
+///
+/// It is defined after the tracer's members, so it is destroyed before
+/// them.
+///
+static struct TraceFinisher
+{
+    ~TraceFinisher (void)
+    {
+        Tracer::stop ();
+    }
+} g_TraceFinisher;
+
+///
+/// \brief Creates an empty buffer.
+///
+/// \param thread The thread's number in the trace.
+///
+Tracer::Buffer::Buffer (unsigned int thread):
+    droppedZones (0),
+    events (k_BufferSize),
+    knownReadPosition (0),
+    readPosition (0),
+    thread (thread),
+    writePosition (0)
+{
+}
+
+///
+/// \brief Adds a zone to the current thread's buffer.
+///
+/// If the buffer is full, the zone is dropped.
+///
+/// \param name The zone's name.
+/// \param start The performance counter at the zone's start.
+/// \param end The performance counter at the zone's end.
+///
+void
+Tracer::addZone (const char *name, uint64_t start, uint64_t end)
+{
+    Buffer *buffer = getThreadBuffer ();
+    const size_t position =
+        buffer->writePosition.load (std::memory_order_relaxed);
+    // Only look at where the flushing thread is when the buffer seems
+    // full, to not read its cache line for each zone.
+    if ( position - buffer->knownReadPosition >= k_BufferSize )
+    {
+        buffer->knownReadPosition =
+            buffer->readPosition.load (std::memory_order_acquire);
+        if ( position - buffer->knownReadPosition >= k_BufferSize )
+        {
+            buffer->droppedZones.store (
+                    buffer->droppedZones.load (std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+            return;
+        }
+    }
+    Event &event = buffer->events[position % k_BufferSize];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    buffer->writePosition.store (position + 1, std::memory_order_release);
+}
+
+///
+/// \brief Writes the zones in the threads' buffers to the trace file.
+///
+/// \note Only the flushing thread, or the thread that stops the trace
+///       once the flushing thread ended, can call it.
+///
+void
+Tracer::flush (void)
+{
+    const double frequency = static_cast<double>(SDL_GetPerformanceFrequency ());
+    std::lock_guard<std::mutex> lock (m_BuffersMutex);
+    for ( std::vector<std::unique_ptr<Buffer> >::iterator buffer =
+            m_Buffers.begin () ;
+          buffer != m_Buffers.end () ; ++buffer )
+    {
+        size_t position = (*buffer)->readPosition.load (std::memory_order_relaxed);
+        const size_t end = (*buffer)->writePosition.load (std::memory_order_acquire);
+        for ( ; position != end ; ++position )
+        {
+            const Event &event = (*buffer)->events[position % k_BufferSize];
+            // Zones that started before the trace are from a previous one.
+            if ( event.start >= m_StartCounter )
+            {
+                m_TraceFile << (m_FirstZone ? "\n" : ",\n");
+                m_TraceFile << "{\"name\":\"" << event.name << "\",";
+                m_TraceFile << "\"ph\":\"X\",\"pid\":1,";
+                m_TraceFile << "\"tid\":" << (*buffer)->thread << ",";
+                m_TraceFile << "\"ts\":" <<
+                    1000000.0 * (event.start - m_StartCounter) / frequency;
+                m_TraceFile << ",\"dur\":" <<
+                    1000000.0 * (event.end - event.start) / frequency << "}";
+                m_FirstZone = false;
+            }
+        }
+        (*buffer)->readPosition.store (position, std::memory_order_release);
+    }
+}
+
+///
+/// \brief Writes the buffers to the trace file until the trace stops.
+///
+void
+Tracer::flushPeriodically (void)
+{
+    std::unique_lock<std::mutex> lock (m_StopMutex);
+    while ( isTracing () )
+    {
+        m_StopFlushing.wait_for (lock,
+                                 std::chrono::milliseconds (k_FlushInterval));
+        flush ();
+    }
+}
+
+///
+/// \brief Gets the current thread's buffer.
+///
+/// The buffer is created the first time a thread adds a zone, and kept
+/// after the thread ends, so its last zones can still be written.
+///
+/// \return The buffer to add the current thread's zones to.
+///
+Tracer::Buffer *
+Tracer::getThreadBuffer (void)
+{
+    if ( 0 == m_ThreadBuffer )
+    {
+        std::lock_guard<std::mutex> lock (m_BuffersMutex);
+        m_Buffers.push_back (std::unique_ptr<Buffer> (
+                    new Buffer (static_cast<unsigned int>(m_Buffers.size ()))));
+        m_ThreadBuffer = m_Buffers.back ().get ();
+    }
+    return m_ThreadBuffer;
+}
+
+///
+/// \brief Sets the trace file's name.
+///
+/// \param fileName The name of the file that start() creates.
+///
+void
+Tracer::setFileName (const std::string &fileName)
+{
+    m_FileName = fileName;
+}
+
+///
+/// \brief Starts tracing the zones.
+///
+/// The trace file is created again each time the trace starts.
+///
+void
+Tracer::start (void)
+{
+    if ( isTracing () )
+    {
+        return;
+    }
+    m_TraceFile.open (m_FileName.c_str ());
+    if ( !m_TraceFile )
+    {
+        m_TraceFile.close ();
+        m_TraceFile.clear ();
+        throw std::runtime_error ("Couldn't create the trace file " +
+                                  m_FileName);
+    }
+    m_TraceFile << std::fixed << std::setprecision (3);
+    m_TraceFile << "{\"traceEvents\":[";
+    m_FirstZone = true;
+    m_StartCounter = SDL_GetPerformanceCounter ();
+    m_Tracing.store (true);
+    m_FlushThread = std::thread (flushPeriodically);
+}
+
+///
+/// \brief Stops tracing the zones and closes the trace file.
+///
+void
+Tracer::stop (void)
+{
+    if ( !isTracing () )
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock (m_StopMutex);
+        m_Tracing.store (false);
+    }
+    m_StopFlushing.notify_one ();
+    m_FlushThread.join ();
+    flush ();
+    m_TraceFile << "\n]}\n";
+    m_TraceFile.close ();
+
+    uint64_t droppedZones = 0;
+    {
+        std::lock_guard<std::mutex> lock (m_BuffersMutex);
+        for ( std::vector<std::unique_ptr<Buffer> >::iterator buffer =
+                m_Buffers.begin () ;
+              buffer != m_Buffers.end () ; ++buffer )
+        {
+            droppedZones += (*buffer)->droppedZones.exchange (0);
+        }
+    }
+    if ( 0 < droppedZones )
+    {
+        std::cerr << "Dropped " << droppedZones << " trace zones." << std::endl;
+    }
+}
+#endif // AMOEBAX_TRACING
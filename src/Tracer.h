@@ -0,0 +1,208 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_TRACER_H)
+#define AMOEBAX_TRACER_H
+
+#if defined (AMOEBAX_TRACING)
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <SDL.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Amoebax
+{
+    ///
+    /// \class Tracer.
+    /// \brief Writes the time spent in the game's zones as Chrome trace events.
+    ///
+    /// Each thread adds its zones to its own ring buffer, without locks,
+    /// and another thread moves them from the buffers to the trace file
+    /// every k_FlushInterval milliseconds.  The file is in the Chrome's
+    /// trace event format, which chrome://tracing and Perfetto can open.
+    ///
+    /// The tracer is only compiled in with the TRACING CMake option.
+    /// Otherwise, AMOEBAX_TRACE_ZONE() expands to nothing.
+    ///
+    class Tracer
+    {
+        public:
+            ///
+            /// \class Zone.
+            /// \brief Traces the time from its creation to its destruction.
+            ///
+            class Zone
+            {
+                public:
+                    ///
+                    /// \brief Starts the zone.
+                    ///
+                    /// \param name The zone's name.  It must be a string
+                    ///             literal, since only the pointer is kept.
+                    ///
+                    explicit Zone (const char *name):
+                        m_Name (name),
+                        m_Start (isTracing () ?
+                                 SDL_GetPerformanceCounter () : 0)
+                    {
+                    }
+
+                    ///
+                    /// \brief Ends the zone and adds it to the trace.
+                    ///
+                    ~Zone (void)
+                    {
+                        if ( 0 != m_Start )
+                        {
+                            addZone (m_Name, m_Start,
+                                     SDL_GetPerformanceCounter ());
+                        }
+                    }
+
+                private:
+                    /// The zone's name.
+                    const char *m_Name;
+                    /// The performance counter at the start, or 0.
+                    uint64_t m_Start;
+            };
+
+            /// The number of zones each thread's buffer holds.
+            static const size_t k_BufferSize = 16384;
+            /// The milliseconds between moving the buffers to the file.
+            static const uint32_t k_FlushInterval = 50;
+
+            static void addZone (const char *name, uint64_t start,
+                                 uint64_t end);
+            static bool isTracing (void);
+            static void setFileName (const std::string &fileName);
+            static void start (void);
+            static void stop (void);
+
+        private:
+            // This class it not instanciable.
+            ///
+            /// \brief Default constructor.
+            ///
+            Tracer (void);
+            ///
+            /// \brief Copy constructor.
+            ///
+            /// \note This constructor is left unimplemented because we
+            /// don't want copies of Tracer. Don't use it.
+            ///
+            Tracer (const Tracer &);
+            ///
+            /// \brief Assigment operator.
+            ///
+            /// \note This operator is left unimplemented because we
+            /// don't want copies of Tracer. Don't use it.
+            ///
+            Tracer &operator= (const Tracer &);
+
+            ///
+            /// \struct Event.
+            /// \brief A zone waiting in a buffer to be written.
+            ///
+            struct Event
+            {
+                /// The zone's name.
+                const char *name;
+                /// The performance counter at the zone's start.
+                uint64_t start;
+                /// The performance counter at the zone's end.
+                uint64_t end;
+            };
+
+            ///
+            /// \struct Buffer.
+            /// \brief The ring buffer of a thread's zones.
+            ///
+            /// Only its thread writes to the buffer, and only the
+            /// flushing thread reads from it.
+            ///
+            struct Buffer
+            {
+                /// The number of zones dropped because the buffer was full.
+                std::atomic<uint64_t> droppedZones;
+                /// The zones, at their position modulo k_BufferSize.
+                std::vector<Event> events;
+                /// The last readPosition seen by the buffer's thread.
+                size_t knownReadPosition;
+                /// The position of the next zone to read.
+                std::atomic<size_t> readPosition;
+                /// The thread's number in the trace.
+                unsigned int thread;
+                /// The position of the next zone to write.
+                std::atomic<size_t> writePosition;
+
+                explicit Buffer (unsigned int thread);
+            };
+
+            static void flush (void);
+            static void flushPeriodically (void);
+            static Buffer *getThreadBuffer (void);
+
+            /// The buffers of the threads that added zones.
+            static std::vector<std::unique_ptr<Buffer> > m_Buffers;
+            /// Guards m_Buffers.
+            static std::mutex m_BuffersMutex;
+            /// The name of the trace file.
+            static std::string m_FileName;
+            /// Tells if no zone was written to the file yet.
+            static bool m_FirstZone;
+            /// The thread that moves the buffers to the file.
+            static std::thread m_FlushThread;
+            /// The performance counter when the trace started.
+            static uint64_t m_StartCounter;
+            /// Signaled to wake up the flushing thread when it must stop.
+            static std::condition_variable m_StopFlushing;
+            /// Guards the flushing thread's stop.
+            static std::mutex m_StopMutex;
+            /// The buffer of the current thread, once it added a zone.
+            static thread_local Buffer *m_ThreadBuffer;
+            /// The trace file.
+            static std::ofstream m_TraceFile;
+            /// Tells if the zones are traced.
+            static std::atomic<bool> m_Tracing;
+    };
+
+    ///
+    /// \brief Tells if the zones are being traced.
+    ///
+    /// \return \a true if the zones are added to the trace file.
+    ///
+    inline bool
+    Tracer::isTracing (void)
+    {
+        return m_Tracing.load (std::memory_order_relaxed);
+    }
+}
+
+/// Traces the rest of the current scope as a zone with the given name.
+#define AMOEBAX_TRACE_ZONE(name) Amoebax::Tracer::Zone traceZone (name)
+#else // !AMOEBAX_TRACING
+#define AMOEBAX_TRACE_ZONE(name)
+#endif // AMOEBAX_TRACING
+
+#endif // !AMOEBAX_TRACER_H
@@ -18,16 +18,19 @@
 //
 #include <algorithm>
 #include <cassert>
+#include <ostream>
 #include <SDL.h>
-#include <sstream>
+#include <string>
 #include "Amoeba.h"
 #include "DrawAmoeba.h"
 #include "DrawChainLabel.h"
 #include "File.h"
+#include "FrameManager.h"
 #include "HumanPlayer.h"
 #include "NewHighScoreState.h"
 #include "Options.h"
 #include "System.h"
+#include "Tracer.h"
 #include "TrainingState.h"
 
 using namespace Amoebax;
@@ -99,8 +102,10 @@ TrainingState::TrainingState (void):
     m_ScoreFont (nullptr),
     m_SilhouetteBorder (k_SilhouetteBorder),
     m_Silhouettes (nullptr),
-    m_SoundLose (Sound::fromFile (File::getSoundFilePath ("youlose.wav")))
+    m_SoundLose (Sound::fromFile (File::getSoundFilePath ("youlose.wav"))),
+    m_TickRemainder (0)
 {
+    AMOEBAX_TRACE_ZONE ("TrainingState::TrainingState");
     loadGraphicResources ();
 
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
@@ -211,6 +216,22 @@ TrainingState::getGoTime (void) const
     return m_GoTime;
 }
 
+///
+/// \brief Gets how far the amoebas are between the last two logic ticks.
+///
+/// \return The interpolation to draw the falling and queued amoebas with,
+///         from 0 to Amoeba::k_MaxInterpolation.
+///
+uint16_t
+TrainingState::getInterpolation (void) const
+{
+    if ( getPlayerGrid ()->isFilled () )
+    {
+        return Amoeba::k_MaxInterpolation;
+    }
+    return m_TickRemainder * Amoeba::k_MaxInterpolation / Grid::k_TickTime;
+}
+
 ///
 /// \brief Gets the training player.
 ///
@@ -325,6 +346,7 @@ TrainingState::keyUp (uint32_t key)
 void
 TrainingState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("TrainingState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
 
     m_Amoebas.reset (
@@ -357,6 +379,8 @@ TrainingState::loadGraphicResources (void)
     m_Silhouettes->resize (screenScale);
 
     m_ScoreFont.reset (Font::fromFile (File::getFontFilePath ("score")));
+    // The scores and the chain labels are written a character at a time.
+    m_ScoreFont->prepareCharacters ("0123456789 ");
 
     // Load the "Go!" and "Ready?" labels only if they are going to be shown.
     if ( mustShowInitialLabels () )
@@ -545,21 +569,25 @@ TrainingState::render (SDL_Surface *screen)
             m_Silhouettes->blit (silhouetteSize * silhouetteFrame,
                     silhouetteSize * amoeba->getColour (),
                     silhouetteSize, silhouetteSize,
-                    amoeba->getX () - getSilhouetteBorder (),
-                    amoeba->getY () - getSilhouetteBorder (),
+                    amoeba->getX (getInterpolation (), getAmoebasSize ()) -
+                    getSilhouetteBorder (),
+                    amoeba->getY (getInterpolation (), getAmoebasSize ()) -
+                    getSilhouetteBorder (),
                     screen);
         }
     }
     // Draw grid's amoebas.
-    const std::list<Amoeba *> &activeAmoebas = getPlayerGrid ()->getActiveAmoebas ();
+    const std::vector<Amoeba *> &activeAmoebas = getPlayerGrid ()->getActiveAmoebas ();
     for_each (activeAmoebas.begin (), activeAmoebas.end (),
-            DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen));
+            DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen,
+                        getInterpolation ()));
 
     // Set the clip rectangle for the qeued amoebas.
     SDL_SetClipRect (screen, &queueRectangle);
-    const std::list<Amoeba *> &queuedAmoebas = getPlayerGrid ()->getQueuedAmoebas ();
+    const std::vector<Amoeba *> &queuedAmoebas = getPlayerGrid ()->getQueuedAmoebas ();
     for_each (queuedAmoebas.begin (), queuedAmoebas.end (),
-            DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen));
+            DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen,
+                        getInterpolation ()));
 
 
     // Set the clip rectangle for the ghost amoebas.
@@ -574,7 +602,7 @@ TrainingState::render (SDL_Surface *screen)
     SDL_SetClipRect (screen, 0);
 
     // Draw chain labels.
-    const std::list<ChainLabel *> &chainLabels = getPlayerGrid ()->getChainLabels ();
+    const std::vector<ChainLabel> &chainLabels = getPlayerGrid ()->getChainLabels ();
     for_each (chainLabels.begin (), chainLabels.end (),
               DrawChainLabel (m_ChainLabel.get (), m_ScoreFont.get (), screen));
 
@@ -582,22 +610,21 @@ TrainingState::render (SDL_Surface *screen)
     // its position.
     const float scaleFactor = System::getInstance ().getScreenScaleFactor ();
 
-    std::stringstream scoreString;
-    scoreString << getPlayerGrid ()->getScore ();
-    uint16_t scoreWidth = m_ScoreFont->getTextWidth (scoreString.str ());
+    // Both numbers are short enough to not need any heap memory.
+    const std::string scoreString (std::to_string (getPlayerGrid ()->getScore ()));
+    uint16_t scoreWidth = m_ScoreFont->getTextWidth (scoreString);
     uint16_t scoreX = static_cast<uint16_t>(k_PositionXScore * scaleFactor) -
                       scoreWidth;
     uint16_t scoreY = static_cast<uint16_t>(k_PositionYScore * scaleFactor);
 
-    std::stringstream levelString;
-    levelString << getCurrentLevel ();
-    uint16_t levelWidth = m_ScoreFont->getTextWidth (levelString.str ());
+    const std::string levelString (std::to_string (getCurrentLevel ()));
+    uint16_t levelWidth = m_ScoreFont->getTextWidth (levelString);
     uint16_t levelX = static_cast<uint16_t>(k_PositionXLevel * scaleFactor) -
                       levelWidth;
     uint16_t levelY = static_cast<uint16_t>(k_PositionYLevel * scaleFactor);
 
-    m_ScoreFont->write (scoreString.str (), scoreX, scoreY, screen);
-    m_ScoreFont->write (levelString.str (), levelX, levelY, screen);
+    m_ScoreFont->writeCharacters (scoreString, scoreX, scoreY, screen);
+    m_ScoreFont->write (levelString, levelX, levelY, screen);
 
     // Draw the 'Level Up!' label if it must be show.
     if ( m_LevelUpTime > 0 )
@@ -642,8 +669,13 @@ TrainingState::render (SDL_Surface *screen)
     }
 }
 
+///
+/// \brief Updates the training for a single logic tick.
+///
+/// \param elapsedTime The time elapsed in the tick.
+///
 void
-TrainingState::update (uint32_t elapsedTime)
+TrainingState::step (uint32_t elapsedTime)
 {
     if ( mustShowInitialLabels () )
     {
@@ -684,8 +716,36 @@ TrainingState::update (uint32_t elapsedTime)
     }
 }
 
+void
+TrainingState::update (uint32_t elapsedTime)
+{
+    // Play the elapsed time in logic ticks, so the grid behaves the same
+    // whatever the frame rate, and keep the time left to draw the amoebas
+    // between the last two ticks.
+    const uint32_t currentTime = FrameManager::getCurrentTime ();
+    m_TickRemainder += elapsedTime;
+    while ( Grid::k_TickTime <= m_TickRemainder )
+    {
+        // The player's inputs until the tick's end are applied before it.
+        std::vector<uint32_t> appliedInputs;
+        getPlayer ()->applyInputs (currentTime - m_TickRemainder +
+                                   Grid::k_TickTime, appliedInputs);
+        std::for_each (appliedInputs.begin (), appliedInputs.end (),
+                       FrameManager::addAppliedInput);
+        step (Grid::k_TickTime);
+        m_TickRemainder -= Grid::k_TickTime;
+    }
+}
+
 void
 TrainingState::videoModeChanged (void)
 {
     loadGraphicResources ();
 }
+
+void
+TrainingState::writeBoards (std::ostream &stream)
+{
+    stream << "level " << getCurrentLevel () << " ";
+    getPlayerGrid ()->write (stream);
+}
@@ -46,6 +46,7 @@ namespace Amoebax
             virtual void render (SDL_Surface *screen);
             virtual void update (uint32_t elapsedTime);
             virtual void videoModeChanged (void);
+            virtual void writeBoards (std::ostream &stream);
 
         private:
             /// The actual amoebas' size when the screen scale factor is 1.0f.
@@ -78,6 +79,7 @@ namespace Amoebax
             uint8_t getAmoebasSize (void) const;
             uint16_t getCurrentLevel (void) const;
             int32_t getGoTime (void) const;
+            uint16_t getInterpolation (void) const;
             IPlayer *getPlayer (void) const;
             Grid *getPlayerGrid (void) const;
             int32_t getReadyTime (void) const;
@@ -93,6 +95,7 @@ namespace Amoebax
             void setGoTime (int32_t time);
             void setReadyTime (int32_t time);
             void setSilhouetteBorder (uint8_t border);
+            void step (uint32_t elapsedTime);
 
             /// Amoebas sprites.
             std::unique_ptr<Surface> m_Amoebas;
@@ -136,6 +139,8 @@ namespace Amoebax
             std::unique_ptr<Surface> m_Silhouettes;
             /// The sound of when you lose.
             std::unique_ptr<Sound> m_SoundLose;
+            /// The time not yet played in a logic tick, in ms.
+            uint32_t m_TickRemainder;
     };
 }
 
@@ -17,9 +17,11 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 //
 #include <SDL.h>
+#include "Fader.h"
 #include "File.h"
 #include "Font.h"
 #include "Options.h"
+#include "Tracer.h"
 #include "TryAgainState.h"
 #include "System.h"
 
@@ -34,6 +36,7 @@ static const uint16_t k_TryAgainYPos = 100;
 TryAgainState::TryAgainState (void):
     IState ()
 {
+    AMOEBAX_TRACE_ZONE ("TryAgainState::TryAgainState");
     loadGraphicResources ();
 
     // Initialize menu options.
@@ -131,21 +134,10 @@ TryAgainState::keyUp (uint32_t key)
 void
 TryAgainState::loadGraphicResources (void)
 {
-    // Capture the background from the screen, and blit an alpha blended
-    // black surface.
+    AMOEBAX_TRACE_ZONE ("TryAgainState::loadGraphicResources");
+    // Capture the background from the screen, and dim it.
     m_Background.reset (Surface::fromScreen ());
-    SDL_Surface *blackBox =
-        SDL_CreateRGBSurface (0,
-                              m_Background->getWidth (),
-                              m_Background->getHeight (),
-                              m_Background->toSDLSurface ()->format->BitsPerPixel,
-                              m_Background->toSDLSurface ()->format->Rmask,
-                              m_Background->toSDLSurface ()->format->Gmask,
-                              m_Background->toSDLSurface ()->format->Bmask,
-                              m_Background->toSDLSurface ()->format->Amask);
-    SDL_FillRect (blackBox, NULL, SDL_MapRGB (blackBox->format, 0, 0, 0));
-    SDL_SetSurfaceAlphaMod (blackBox, 128);
-    SDL_BlitSurface (blackBox, NULL, m_Background->toSDLSurface (), NULL);
+    Fader::dim (*m_Background, 128);
     {
         std::unique_ptr<Surface> title (
                 Surface::fromFile (File::getGraphicsFilePath ("TryAgain.png")));
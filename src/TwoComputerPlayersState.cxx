@@ -22,6 +22,7 @@
 #include "File.h"
 #include "IMatchObserver.h"
 #include "System.h"
+#include "Tracer.h"
 #include "TwoComputerPlayersState.h"
 
 using namespace Amoebax;
@@ -30,21 +31,33 @@ uint16_t k_SeparationBetweenPlayerAndLabel = 30;
 ///
 /// \brief Default constructor.
 ///
+/// The match is not played by this state, but in advance by whoever
+/// creates it (i.e., TournamentState using MatchSimulator.)  This state
+/// only shows the winner and notifies the result to the observer.
+///
 /// \param leftPlayerLevel The level of the left player.
 /// \param rightPlayerLevel The level of the right player.
+/// \param winnerSide The side of the player that won the match.
+/// \param leftPlayerScore The left player's score at the end of the match.
+/// \param rightPlayerScore The right player's score at the end of the match.
 /// \param observer The class that will receive an end of match notify.
 ///
 TwoComputerPlayersState::TwoComputerPlayersState (uint8_t leftPlayerLevel,
                                                   uint8_t rightPlayerLevel,
+                                                  IPlayer::PlayerSide winnerSide,
+                                                  uint32_t leftPlayerScore,
+                                                  uint32_t rightPlayerScore,
                                                   IMatchObserver *observer):
     IState (),
     m_Background (nullptr),
+    m_LeftPlayerScore (leftPlayerScore),
     m_Observer (observer),
     m_ObserverNotified (false),
+    m_RightPlayerScore (rightPlayerScore),
     m_StateAlreadyRemoved (false),
-    m_WinnerSide (
-        AIPlayerFactory::getWinner (leftPlayerLevel, rightPlayerLevel))
+    m_WinnerSide (winnerSide)
 {
+    AMOEBAX_TRACE_ZONE ("TwoComputerPlayersState::TwoComputerPlayersState");
     if ( IPlayer::LeftSide == getWinnerSide () )
     {
         m_WinnerName = AIPlayerFactory::getPlayerName (leftPlayerLevel);
@@ -174,6 +187,7 @@ TwoComputerPlayersState::keyUp (uint32_t key)
 void
 TwoComputerPlayersState::loadGraphicsResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("TwoComputerPlayersState::loadGraphicsResources");
     float screenScale = System::getInstance ().getScreenScaleFactor ();
 
     uint16_t nameY = k_SeparationBetweenPlayerAndLabel;
@@ -241,7 +255,8 @@ TwoComputerPlayersState::update (uint32_t elapsedTime)
 {
     if ( !isObserverNotified () && getObserver () != 0 )
     {
-        getObserver ()->endOfMatch (getWinnerSide (), 0, 0);
+        getObserver ()->endOfMatch (getWinnerSide (), m_LeftPlayerScore,
+                                    m_RightPlayerScore);
         setObserverNotified ();
         Music::stop ();
     }
@@ -37,6 +37,9 @@ namespace Amoebax
         public:
             TwoComputerPlayersState (uint8_t leftPlayerLevel,
                                      uint8_t rightPlayerLevel,
+                                     IPlayer::PlayerSide winnerSide,
+                                     uint32_t leftPlayerScore,
+                                     uint32_t rightPlayerScore,
                                      IMatchObserver *observer = 0);
 
             virtual void activate (void);
@@ -62,10 +65,14 @@ namespace Amoebax
 
             /// Two players mode's background.
             std::unique_ptr<Surface> m_Background;
+            /// The left player's score at the end of the match.
+            uint32_t m_LeftPlayerScore;
             /// The match observer to notify when the match is over.
             IMatchObserver *m_Observer;
             /// Tells if the observer is already notified or not.
             bool m_ObserverNotified;
+            /// The right player's score at the end of the match.
+            uint32_t m_RightPlayerScore;
             /// Tells if the state was already removed.
             bool m_StateAlreadyRemoved;
             /// The side of the winner.
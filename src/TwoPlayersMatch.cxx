@@ -0,0 +1,104 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <cassert>
+#include "Grid.h"
+#include "TwoPlayersMatch.h"
+
+using namespace Amoebax;
+
+///
+/// \brief Default constructor.
+///
+/// \param leftPlayer The player that will control the left grid. The
+///                   match takes the ownership of the player.
+/// \param rightPlayer The player that will control the right grid. The
+///                    match takes the ownership of the player.
+///
+TwoPlayersMatch::TwoPlayersMatch (IPlayer *leftPlayer, IPlayer *rightPlayer):
+    m_ElapsedTime (0),
+    m_Generator (new PairGenerator ()),
+    m_LeftPlayer (leftPlayer),
+    m_RightPlayer (rightPlayer)
+{
+    assert ( 0 != getLeftPlayer () && "The left player is NULL." );
+    assert ( 0 != getRightPlayer () && "The right player is NULL." );
+}
+
+///
+/// \brief Gets the winner's side.
+///
+/// \return The side whose player won the match. This is only
+///         meaningful once isOver() returns \a true.
+///
+IPlayer::PlayerSide
+TwoPlayersMatch::getWinner (void) const
+{
+    return getLeftGrid ()->isFilled () ? IPlayer::RightSide :
+                                         IPlayer::LeftSide;
+}
+
+///
+/// \brief Tells if the match is over.
+///
+/// \return \a true if any of the two grids is filled, \a false otherwise.
+///
+bool
+TwoPlayersMatch::isOver (void) const
+{
+    return getRightGrid ()->isFilled () || getLeftGrid ()->isFilled ();
+}
+
+///
+/// \brief Sets the grids of both players and starts the match.
+///
+/// Gives each player its grid, attaches both grids to the pair
+/// generator and generates the first amoebas.
+///
+/// \param leftGrid The grid to give to the left player.
+/// \param rightGrid The grid to give to the right player.
+///
+void
+TwoPlayersMatch::setGrids (Grid *leftGrid, Grid *rightGrid)
+{
+    getLeftPlayer ()->setGrid (leftGrid);
+    m_Generator->addGrid (getLeftGrid ());
+    getRightPlayer ()->setGrid (rightGrid);
+    m_Generator->addGrid (getRightGrid ());
+
+    // Generate the four first amoebas.
+    m_Generator->generate (4);
+}
+
+///
+/// \brief Updates both players and exchanges their ghost amoebas.
+///
+/// \param elapsedTime The time elapsed since the last call, in ms.
+///
+void
+TwoPlayersMatch::update (uint32_t elapsedTime)
+{
+    m_ElapsedTime += elapsedTime;
+    getLeftPlayer ()->update (elapsedTime);
+    getRightPlayer ()->update (elapsedTime);
+    // Update the waiting ghost amoebas from the opponent.
+    getLeftGrid ()->incrementNumberOfWaitingGhosts (
+            getRightGrid ()->getOpponentGhostAmoebas ());
+    getRightGrid ()->incrementNumberOfWaitingGhosts (
+            getLeftGrid ()->getOpponentGhostAmoebas ());
+}
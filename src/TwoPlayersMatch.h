@@ -0,0 +1,139 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#if !defined (AMOEBAX_TWO_PLAYERS_MATCH_H)
+#define AMOEBAX_TWO_PLAYERS_MATCH_H
+
+#include <memory>
+#include "IPlayer.h"
+#include "PairGenerator.h"
+
+namespace Amoebax
+{
+    // Forward declarations.
+    class Grid;
+
+    ///
+    /// \class TwoPlayersMatch.
+    /// \brief The logic of a match between two players.
+    ///
+    /// Holds the two players and the generator of amoebas pairs they
+    /// share, exchanges the ghost amoebas between both grids and tells
+    /// when the match is over and who won it. It doesn't draw anything,
+    /// so it can be used both by TwoPlayersState and to simulate matches
+    /// without a screen.
+    ///
+    class TwoPlayersMatch
+    {
+        public:
+            TwoPlayersMatch (IPlayer *leftPlayer, IPlayer *rightPlayer);
+
+            uint32_t getElapsedTime (void) const;
+            Grid *getLeftGrid (void) const;
+            IPlayer *getLeftPlayer (void) const;
+            Grid *getRightGrid (void) const;
+            IPlayer *getRightPlayer (void) const;
+            IPlayer::PlayerSide getWinner (void) const;
+            bool isOver (void) const;
+            void setGrids (Grid *leftGrid, Grid *rightGrid);
+            void update (uint32_t elapsedTime);
+
+        private:
+            ///
+            /// \brief Copy constructor.
+            ///
+            /// \note This constructor is left unimplemented because we
+            /// don't want copies of TwoPlayersMatch. Don't use it.
+            ///
+            TwoPlayersMatch (const TwoPlayersMatch &);
+            ///
+            /// \brief Assigment operator.
+            ///
+            /// \note This operator is left unimplemented because we
+            /// don't want copies of TwoPlayersMatch. Don't use it.
+            ///
+            TwoPlayersMatch &operator= (const TwoPlayersMatch &);
+
+            /// The time the match has been played, in milliseconds.
+            uint32_t m_ElapsedTime;
+            /// The generator of amoebas pairs.
+            std::unique_ptr<PairGenerator> m_Generator;
+            /// Left player.
+            std::unique_ptr<IPlayer> m_LeftPlayer;
+            /// Right player.
+            std::unique_ptr<IPlayer> m_RightPlayer;
+    };
+
+    ///
+    /// \brief Gets the time the match has been played.
+    ///
+    /// \return The sum of all the elapsed times passed to update(),
+    ///         in milliseconds.
+    ///
+    inline uint32_t
+    TwoPlayersMatch::getElapsedTime (void) const
+    {
+        return m_ElapsedTime;
+    }
+
+    ///
+    /// \brief Gets the left player's grid.
+    ///
+    /// \return The grid of the left player.
+    ///
+    inline Grid *
+    TwoPlayersMatch::getLeftGrid (void) const
+    {
+        return getLeftPlayer ()->getGrid ();
+    }
+
+    ///
+    /// \brief Gets the player of the left grid.
+    ///
+    /// \return The pointer to the player that controls the left grid.
+    ///
+    inline IPlayer *
+    TwoPlayersMatch::getLeftPlayer (void) const
+    {
+        return m_LeftPlayer.get ();
+    }
+
+    ///
+    /// \brief Gets the right player's grid.
+    ///
+    /// \return The grid of the right player.
+    ///
+    inline Grid *
+    TwoPlayersMatch::getRightGrid (void) const
+    {
+        return getRightPlayer ()->getGrid ();
+    }
+
+    ///
+    /// \brief Gets the player of the right grid.
+    ///
+    /// \return The pointer to the player that controls the right grid.
+    ///
+    inline IPlayer *
+    TwoPlayersMatch::getRightPlayer (void) const
+    {
+        return m_RightPlayer.get ();
+    }
+}
+
+#endif // !AMOEBAX_TWO_PLAYERS_MATCH_H
@@ -18,20 +18,48 @@
 //
 #include <cassert>
 #include <SDL.h>
-#include <sstream>
+#include <ostream>
+#include <string>
 #include <algorithm>
+#include <functional>
 #include "Amoeba.h"
 #include "DrawAmoeba.h"
 #include "DrawChainLabel.h"
 #include "File.h"
+#include "FrameManager.h"
 #include "NormalState.h"
+#include "Random.h"
 #include "System.h"
+#include "Tracer.h"
 #include "TwoPlayersState.h"
 
 using namespace Amoebax;
 
+// The definitions of the class' constants, for when they are used by reference.
+const uint8_t TwoPlayersState::k_FastestTimeScale;
+const uint8_t TwoPlayersState::k_MaxTimeScale;
+
 /// The size of the silhouettes' border in pixels.
 static const uint8_t k_SilhouetteBorder = 8;
+/// The time to spend updating each frame at the fastest time scale, in ms.
+static const uint32_t k_FastestUpdateTime = 25;
+
+///
+/// \brief Formats a score only when it changed since it was last formatted.
+///
+/// \param score The score to format.
+/// \param formattedScore The score that \p text holds.  Set to \p score.
+/// \param text The score as text.
+///
+static void
+updateScoreText (uint32_t score, uint32_t &formattedScore, std::string &text)
+{
+    if ( text.empty () || score != formattedScore )
+    {
+        text = std::to_string (score);
+        formattedScore = score;
+    }
+}
 
 ///
 /// \brief Default constructor.
@@ -54,42 +82,48 @@ TwoPlayersState::TwoPlayersState (IPlayer *leftPlayer, IPlayer *rightPlayer,
     m_Background (nullptr),
     m_BackgroundFileName (backgroundFileName),
     m_BackgroundMusic (nullptr),
+    m_BoardLayer (nullptr),
     m_ChainLabel (nullptr),
+    m_FrontSnapshot (0),
     m_GameIsOver (false),
-    m_Generator (new PairGenerator ()),
     m_Go (nullptr),
     m_GoTime (k_DefaultGoTime),
-    m_LeftPlayer (leftPlayer),
+    m_LeftScore (0),
+    m_LeftScoreText (),
+    m_Match (new TwoPlayersMatch (leftPlayer, rightPlayer)),
     m_Observer(observer),
     m_Ready (nullptr),
     m_ReadyTime (k_DefaultGoTime * 2),
-    m_RightPlayer (rightPlayer),
+    m_RightScore (0),
+    m_RightScoreText (),
     m_ScoreFont (nullptr),
     m_SilhouetteBorder (k_SilhouetteBorder),
     m_Silhouettes (nullptr),
+    m_Simulation (new ThreadPool (1)),
+    m_Snapshots (),
+    m_SnapshotPending (false),
     m_StateAlreadyRemoved (false),
+    m_TickRemainder (0),
+    m_TickTimes (),
+    m_TimeScale (1),
     m_YouLose (nullptr),
     m_YouWin (nullptr),
     m_Winner (IPlayer::RightSide)
 {
+    AMOEBAX_TRACE_ZONE ("TwoPlayersState::TwoPlayersState");
     assert ( 0 < getAmoebasSize () && "The amoebas' size is invalid." );
-    assert ( 0 != getLeftPlayer () && "The left player is NULL." );
-    assert ( 0 != getRightPlayer () && "The right player is NULL." );
 
     loadGraphicsResources ();
 
     float screenScale = System::getInstance ().getScreenScaleFactor ();
-    getLeftPlayer ()->setGrid (
+    m_Match->setGrids (
             new Grid (static_cast<uint16_t>(k_PositionXLeftGrid * screenScale),
                       static_cast<uint16_t>(k_PositionYLeftGrid * screenScale),
                       static_cast<uint16_t>(k_PositionXLeftQueue * screenScale),
                       static_cast<uint16_t>(k_PositionYLeftQueue * screenScale),
                       static_cast<uint16_t>(k_PositionXLeftWaiting * screenScale),
                       static_cast<uint16_t>(k_PositionYLeftWaiting * screenScale),
-                      getAmoebasSize (), Grid::QueueSideRight, leftPlayerScore));
-    m_Generator->addGrid (getLeftGrid ());
-
-    getRightPlayer ()->setGrid (
+                      getAmoebasSize (), Grid::QueueSideRight, leftPlayerScore),
             new Grid (static_cast<uint16_t>(k_PositionXRightGrid * screenScale),
                       static_cast<uint16_t>(k_PositionYRightGrid * screenScale),
                       static_cast<uint16_t>(k_PositionXRightQueue * screenScale),
@@ -97,10 +131,16 @@ TwoPlayersState::TwoPlayersState (IPlayer *leftPlayer, IPlayer *rightPlayer,
                       static_cast<uint16_t>(k_PositionXRightWaiting * screenScale),
                       static_cast<uint16_t>(k_PositionYRightWaiting * screenScale),
                       getAmoebasSize (), Grid::QueueSideLeft, rightPlayerScore));
-    m_Generator->addGrid (getRightGrid ());
+    getFrontSnapshot ().leftGrid.take (*getLeftGrid ());
+    getFrontSnapshot ().rightGrid.take (*getRightGrid ());
+    // Keep room for the ticks of the longest frame at the fastest scale.
+    m_TickTimes.reserve (FrameManager::k_MaxElapsedTime * k_MaxTimeScale /
+                         Grid::k_TickTime + 1);
 
-    // Generate the four first amoebas.
-    m_Generator->generate (4);
+    // The logic thread has its own random generator, which must follow
+    // from this thread's one, so a seeded game plays the same again.
+    const uint32_t seed = static_cast<uint32_t>(Random::get ());
+    m_Simulation->schedule ([seed] () { Random::init (seed); });
 
     // Load music.
     std::string musicFileName (backgroundFileName);
@@ -109,9 +149,19 @@ TwoPlayersState::TwoPlayersState (IPlayer *leftPlayer, IPlayer *rightPlayer,
             Music::fromFile (File::getMusicFilePath (musicFileName)));
 }
 
+///
+/// \brief Destructor.
+///
+TwoPlayersState::~TwoPlayersState (void)
+{
+    // The logic thread could still be playing ticks with the snapshots.
+    m_Simulation->wait ();
+}
+
 void
 TwoPlayersState::activate (void)
 {
+    m_Simulation->wait ();
     getLeftPlayer ()->loadOptions ();
     getRightPlayer ()->loadOptions ();
     if ( Music::isPaused () )
@@ -124,6 +174,20 @@ TwoPlayersState::activate (void)
     }
 }
 
+///
+/// \brief Applies the players' inputs received until a time.
+///
+/// \param time The time the next logic tick ends at.
+/// \param appliedInputs The vector to add the applied inputs' times to.
+///
+void
+TwoPlayersState::applyInputs (uint32_t time,
+                              std::vector<uint32_t> &appliedInputs)
+{
+    getLeftPlayer ()->applyInputs (time, appliedInputs);
+    getRightPlayer ()->applyInputs (time, appliedInputs);
+}
+
 ///
 /// \brief Checks if the key should remove the current state.
 ///
@@ -168,6 +232,117 @@ TwoPlayersState::checkForRemoveStateKey (uint32_t key)
     }
 }
 
+///
+/// \brief Counts down the time to show the "Ready?" and "Go!!" labels.
+///
+/// \param elapsedTime The simulated time elapsed since the last count.
+///
+void
+TwoPlayersState::countDownLabels (uint32_t elapsedTime)
+{
+    if ( mustShowReadyLabel () )
+    {
+        setReadyTime (getReadyTime () - elapsedTime);
+    }
+    else
+    {
+        setGoTime (getGoTime () - elapsedTime);
+    }
+}
+
+///
+/// \brief Draws the amoebas of a grid.
+///
+/// The settled amoebas are kept in the board layer, where only the cells
+/// that changed since the last frame are drawn again, and copied to the
+/// screen.  The falling pair, its silhouette, and the floating amoebas
+/// move each frame and are drawn straight to the screen.
+///
+/// \param grid The grid whose amoebas to draw.
+/// \param snapshot The last snapshot of \p grid.
+/// \param screen The screen surface to draw the amoebas to.
+///
+void
+TwoPlayersState::drawGridAmoebas (Grid *grid, GridSnapshot &snapshot,
+                                  SDL_Surface *screen)
+{
+    DrawAmoeba drawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen,
+                           getInterpolation ());
+    DrawAmoeba drawAmoebaToLayer (getAmoebasSize (), m_Amoebas.get (),
+                                  m_BoardLayer->toSDLSurface ());
+
+    const Grid::CellMask changedCells = snapshot.getChangedCells ();
+    if ( changedCells.any () )
+    {
+        for ( int16_t y = Grid::k_FirstVisibleHeight ;
+              y < Grid::k_GridHeight ; ++y )
+        {
+            for ( int16_t x = 0 ; x < Grid::k_GridWidth ; ++x )
+            {
+                if ( changedCells.test (y * Grid::k_GridWidth + x) )
+                {
+                    int16_t cellX;
+                    int16_t cellY;
+                    grid->getCellPosition (x, y, cellX, cellY);
+                    m_Background->blit (cellX, cellY,
+                                        getAmoebasSize (), getAmoebasSize (),
+                                        cellX, cellY,
+                                        m_BoardLayer->toSDLSurface ());
+                    const Amoeba *amoeba = snapshot.getAmoebaAt (x, y);
+                    if ( 0 != amoeba )
+                    {
+                        drawAmoebaToLayer (amoeba);
+                    }
+                    m_BoardLayer->blit (cellX, cellY,
+                                        getAmoebasSize (), getAmoebasSize (),
+                                        cellX, cellY, screen);
+                }
+            }
+        }
+        snapshot.markCellsAsDrawn ();
+    }
+
+    // Draw the main falling amoeba's silhouette and then the settled
+    // amoebas it overlaps, so it stays behind them.
+    int16_t mainX;
+    int16_t mainY;
+    const Amoeba *amoeba = snapshot.getFallingMainAmoeba (mainX, mainY);
+    if ( 0 != amoeba )
+    {
+        int8_t silhouetteFrame = snapshot.getSilhouetteFrame ();
+        if ( 0 < silhouetteFrame )
+        {
+            uint8_t silhouetteSize = getAmoebasSize () +
+                2 * getSilhouetteBorder ();
+            m_Silhouettes->blit (silhouetteSize * silhouetteFrame,
+                    silhouetteSize * amoeba->getColour (),
+                    silhouetteSize, silhouetteSize,
+                    amoeba->getX (getInterpolation (), getAmoebasSize ()) -
+                    getSilhouetteBorder (),
+                    amoeba->getY (getInterpolation (), getAmoebasSize ()) -
+                    getSilhouetteBorder (),
+                    screen);
+
+            for ( int16_t y = mainY - 1 ; y <= mainY + 2 ; ++y )
+            {
+                for ( int16_t x = mainX - 1 ; x <= mainX + 1 ; ++x )
+                {
+                    const Amoeba *neighbour = snapshot.getAmoebaAt (x, y);
+                    if ( 0 != neighbour && y >= Grid::k_FirstVisibleHeight )
+                    {
+                        drawAmoeba (neighbour);
+                    }
+                }
+            }
+        }
+    }
+
+    const std::vector<Amoeba> &unsettledAmoebas =
+        snapshot.getUnsettledAmoebas ();
+    std::for_each (unsettledAmoebas.begin (), unsettledAmoebas.end (),
+                   drawAmoeba);
+}
+
 ///
 /// \brief Tells if the game is over.
 ///
@@ -191,6 +366,18 @@ TwoPlayersState::getAmoebasSize (void) const
     return m_AmoebasSize;
 }
 
+///
+/// \brief Gets the snapshot to draw.
+///
+/// \return The last snapshot the logic thread took and the main
+///         thread published.
+///
+inline TwoPlayersState::Snapshot &
+TwoPlayersState::getFrontSnapshot (void)
+{
+    return m_Snapshots[m_FrontSnapshot];
+}
+
 ///
 /// \brief Gets the time to display the "Go!" label.
 ///
@@ -202,6 +389,25 @@ TwoPlayersState::getGoTime (void) const
     return m_GoTime;
 }
 
+///
+/// \brief Gets how far the amoebas are between the last two logic ticks.
+///
+/// \return The interpolation to draw the falling and queued amoebas with,
+///         from 0 to Amoeba::k_MaxInterpolation.
+///
+uint16_t
+TwoPlayersState::getInterpolation (void) const
+{
+    if ( gameIsOver () || k_FastestTimeScale == getTimeScale () )
+    {
+        return Amoeba::k_MaxInterpolation;
+    }
+    // While the logic thread is busy, the time accumulates past the
+    // last tick drawn.
+    return std::min (m_TickRemainder, Grid::k_TickTime) *
+           Amoeba::k_MaxInterpolation / Grid::k_TickTime;
+}
+
 ///
 /// \brief Gets the left player's grid.
 ///
@@ -210,9 +416,7 @@ TwoPlayersState::getGoTime (void) const
 inline Grid *
 TwoPlayersState::getLeftGrid (void) const
 {
-    IPlayer *player = getLeftPlayer ();
-    assert ( 0 != player && "The left player is NULL." );
-    return player->getGrid ();
+    return m_Match->getLeftGrid ();
 }
 
 ///
@@ -223,7 +427,7 @@ TwoPlayersState::getLeftGrid (void) const
 inline IPlayer *
 TwoPlayersState::getLeftPlayer (void) const
 {
-    return m_LeftPlayer.get ();
+    return m_Match->getLeftPlayer ();
 }
 
 ///
@@ -245,9 +449,7 @@ TwoPlayersState::getReadyTime (void) const
 inline Grid *
 TwoPlayersState::getRightGrid (void) const
 {
-    IPlayer *player = getRightPlayer ();
-    assert ( 0 != player && "The right player is NULL." );
-    return player->getGrid ();
+    return m_Match->getRightGrid ();
 }
 
 ///
@@ -258,7 +460,7 @@ TwoPlayersState::getRightGrid (void) const
 inline IPlayer *
 TwoPlayersState::getRightPlayer (void) const
 {
-    return m_RightPlayer.get ();
+    return m_Match->getRightPlayer ();
 }
 
 ///
@@ -272,6 +474,19 @@ TwoPlayersState::getSilhouetteBorder (void) const
     return m_SilhouetteBorder;
 }
 
+///
+/// \brief Gets the time scale.
+///
+/// \return How many times faster than real time the match is played,
+///         or k_FastestTimeScale if the match is played as fast as
+///         possible.
+///
+uint8_t
+TwoPlayersState::getTimeScale (void) const
+{
+    return m_TimeScale;
+}
+
 ///
 /// \brief Gets the winner's side.
 ///
@@ -355,6 +570,7 @@ TwoPlayersState::keyUp (uint32_t key)
 void
 TwoPlayersState::loadGraphicsResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("TwoPlayersState::loadGraphicsResources");
     float screenScale = System::getInstance ().getScreenScaleFactor ();
 
     m_Amoebas.reset (
@@ -370,6 +586,7 @@ TwoPlayersState::loadGraphicsResources (void)
         gridBackground->blit (m_Background->toSDLSurface ());
     }
     m_Background->resize (screenScale);
+    m_BoardLayer.reset (new Surface (*m_Background));
 
     m_ChainLabel.reset (
             Surface::fromFile (File::getGraphicsFilePath ("chain.png")));
@@ -390,6 +607,8 @@ TwoPlayersState::loadGraphicsResources (void)
     m_YouWin->resize (screenScale);
 
     m_ScoreFont.reset (Font::fromFile (File::getFontFilePath ("score")));
+    // The scores and the chain labels are written a character at a time.
+    m_ScoreFont->prepareCharacters ("0123456789 ");
 
     // Load the "Go!" and "Ready?" labels only if they are going to be shown.
     if ( mustShowInitialLabels () )
@@ -435,16 +654,48 @@ TwoPlayersState::mustShowReadyLabel (void) const
     return getReadyTime () > 0;
 }
 
+///
+/// \brief Draws the snapshot the logic thread took.
+///
+/// The cells changed in the snapshot being drawn, but not yet drawn,
+/// are still to be drawn from the new snapshot.  Also ends the game if
+/// the logic thread found that the match is over.
+///
+/// \note The logic thread must be idle.
+///
+void
+TwoPlayersState::publishSnapshot (void)
+{
+    Snapshot &backSnapshot = m_Snapshots[1 - m_FrontSnapshot];
+    backSnapshot.leftGrid.addChangedCells (getFrontSnapshot ().leftGrid);
+    backSnapshot.rightGrid.addChangedCells (getFrontSnapshot ().rightGrid);
+    m_FrontSnapshot = 1 - m_FrontSnapshot;
+    m_SnapshotPending = false;
+
+    const std::vector<uint32_t> &appliedInputs =
+        getFrontSnapshot ().appliedInputs;
+    std::for_each (appliedInputs.begin (), appliedInputs.end (),
+                   FrameManager::addAppliedInput);
+
+    if ( m_Match->isOver () )
+    {
+        setGameOver ();
+        Music::stop ();
+    }
+}
+
 void
 TwoPlayersState::redrawBackground (SDL_Rect *region, SDL_Surface *screen)
 {
-    m_Background->blit (region->x, region->y, region->w, region->h,
+    m_BoardLayer->blit (region->x, region->y, region->w, region->h,
                         region->x, region->y, screen);
 }
 
 void
 TwoPlayersState::render (SDL_Surface *screen)
 {
+    Snapshot &snapshot = getFrontSnapshot ();
+
     // Draw left grid's amoebas.
     {
         SDL_Rect gridRectangle;
@@ -455,30 +706,7 @@ TwoPlayersState::render (SDL_Surface *screen)
         gridRectangle.h = getAmoebasSize () * Grid::k_VisibleHeight;
         SDL_SetClipRect (screen, &gridRectangle);
 
-        // Draw the main falling amoeba's silhouette.
-        const Grid::FallingAmoeba mainAmoeba =
-            getLeftGrid ()->getFallingMainAmoeba ();
-        if ( 0 != mainAmoeba.amoeba )
-        {
-            int8_t silhouetteFrame = getLeftGrid ()->getSilhouetteFrame ();
-            if ( 0 < silhouetteFrame )
-            {
-                Amoeba *amoeba = mainAmoeba.amoeba;
-                uint8_t silhouetteSize = getAmoebasSize () +
-                    2 * getSilhouetteBorder ();
-                m_Silhouettes->blit (silhouetteSize * silhouetteFrame,
-                        silhouetteSize * amoeba->getColour (),
-                        silhouetteSize, silhouetteSize,
-                        amoeba->getX () - getSilhouetteBorder (),
-                        amoeba->getY () - getSilhouetteBorder (),
-                        screen);
-            }
-        }
-
-        const std::list<Amoeba *> &leftActiveAmoebas =
-            getLeftGrid ()->getActiveAmoebas ();
-        std::for_each (leftActiveAmoebas.begin (), leftActiveAmoebas.end (),
-                       DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen));
+        drawGridAmoebas (getLeftGrid (), snapshot.leftGrid, screen);
     }
     // Draw left queued amoebas.
     {
@@ -489,9 +717,11 @@ TwoPlayersState::render (SDL_Surface *screen)
         queueRectangle.h = 4 * getAmoebasSize ();
 
         SDL_SetClipRect (screen, &queueRectangle);
-        const std::list<Amoeba *> &queuedAmoebas = getLeftGrid ()->getQueuedAmoebas ();
+        const std::vector<Amoeba> &queuedAmoebas =
+            snapshot.leftGrid.getQueuedAmoebas ();
         for_each (queuedAmoebas.begin (), queuedAmoebas.end (),
-                DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen));
+                DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen,
+                            getInterpolation ()));
     }
     // Draw left waiting amoebas.
     {
@@ -502,8 +732,8 @@ TwoPlayersState::render (SDL_Surface *screen)
         waitingGhosts.h = getAmoebasSize ();
         SDL_SetClipRect (screen, &waitingGhosts);
 
-        const std::vector<Amoeba *> &leftGhostAmoebas =
-            getLeftGrid ()->getWaitingGhostAmoebas ();
+        const std::vector<Amoeba> &leftGhostAmoebas =
+            snapshot.leftGrid.getWaitingGhostAmoebas ();
         std::for_each (leftGhostAmoebas.begin (), leftGhostAmoebas.end (),
                        DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen));
     }
@@ -518,30 +748,7 @@ TwoPlayersState::render (SDL_Surface *screen)
         gridRectangle.h = getAmoebasSize () * Grid::k_VisibleHeight;
         SDL_SetClipRect (screen, &gridRectangle);
 
-        // Draw the main falling amoeba's silhouette.
-        const Grid::FallingAmoeba mainAmoeba =
-            getRightGrid ()->getFallingMainAmoeba ();
-        if ( 0 != mainAmoeba.amoeba )
-        {
-            int8_t silhouetteFrame = getRightGrid ()->getSilhouetteFrame ();
-            if ( 0 < silhouetteFrame )
-            {
-                Amoeba *amoeba = mainAmoeba.amoeba;
-                uint8_t silhouetteSize = getAmoebasSize () +
-                    2 * getSilhouetteBorder ();
-                m_Silhouettes->blit (silhouetteSize * silhouetteFrame,
-                        silhouetteSize * amoeba->getColour (),
-                        silhouetteSize, silhouetteSize,
-                        amoeba->getX () - getSilhouetteBorder (),
-                        amoeba->getY () - getSilhouetteBorder (),
-                        screen);
-            }
-        }
-
-        const std::list<Amoeba *> &rightActiveAmoebas =
-            getRightGrid ()->getActiveAmoebas ();
-        std::for_each (rightActiveAmoebas.begin (), rightActiveAmoebas.end (),
-                       DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen));
+        drawGridAmoebas (getRightGrid (), snapshot.rightGrid, screen);
     }
     // Draw right queued amoebas.
     {
@@ -552,9 +759,11 @@ TwoPlayersState::render (SDL_Surface *screen)
         queueRectangle.h = 4 * getAmoebasSize ();
 
         SDL_SetClipRect (screen, &queueRectangle);
-        const std::list<Amoeba *> &queuedAmoebas = getRightGrid ()->getQueuedAmoebas ();
+        const std::vector<Amoeba> &queuedAmoebas =
+            snapshot.rightGrid.getQueuedAmoebas ();
         for_each (queuedAmoebas.begin (), queuedAmoebas.end (),
-                DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen));
+                DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen,
+                            getInterpolation ()));
     }
 
     // Draw right waiting amoebas.
@@ -566,8 +775,8 @@ TwoPlayersState::render (SDL_Surface *screen)
         waitingGhosts.h = getAmoebasSize ();
         SDL_SetClipRect (screen, &waitingGhosts);
 
-        const std::vector<Amoeba *> &rightGhostAmoebas =
-            getRightGrid ()->getWaitingGhostAmoebas ();
+        const std::vector<Amoeba> &rightGhostAmoebas =
+            snapshot.rightGrid.getWaitingGhostAmoebas ();
         std::for_each (rightGhostAmoebas.begin (), rightGhostAmoebas.end (),
                        DrawAmoeba (getAmoebasSize (), m_Amoebas.get (), screen));
     }
@@ -577,40 +786,41 @@ TwoPlayersState::render (SDL_Surface *screen)
 
     // Draw all grids' chain labels.
     {
-        const std::list<ChainLabel *> rightChainLabels =
-            getRightGrid()->getChainLabels ();
-        std::list<ChainLabel *> chainLabels (getLeftGrid ()->getChainLabels ());
-
-        std::copy (rightChainLabels.begin (), rightChainLabels.end (),
-                   std::back_inserter (chainLabels));
-        std::for_each (chainLabels.begin (), chainLabels.end (),
-                       DrawChainLabel (m_ChainLabel.get (), m_ScoreFont.get (),
-                                       screen));
+        DrawChainLabel drawChainLabel (m_ChainLabel.get (), m_ScoreFont.get (),
+                                       screen);
+        const std::vector<ChainLabel> &leftChainLabels =
+            snapshot.leftGrid.getChainLabels ();
+        std::for_each (leftChainLabels.begin (), leftChainLabels.end (),
+                       drawChainLabel);
+        const std::vector<ChainLabel> &rightChainLabels =
+            snapshot.rightGrid.getChainLabels ();
+        std::for_each (rightChainLabels.begin (), rightChainLabels.end (),
+                       drawChainLabel);
     }
 
     // Draw the current players' score. The right player has its
     // score right aligned and the left player left aligned.
     const float scaleFactor = System::getInstance ().getScreenScaleFactor ();
 
-    std::stringstream leftScoreString;
-    leftScoreString << getLeftGrid ()->getScore ();
+    updateScoreText (snapshot.leftGrid.getScore (), m_LeftScore,
+                     m_LeftScoreText);
     uint16_t leftScoreX = static_cast<uint16_t>(k_PositionXLeftScore *
                                                 scaleFactor);
     uint16_t leftScoreY = static_cast<uint16_t>(k_PositionYLeftScore *
                                                 scaleFactor);
 
-    std::stringstream rightScoreString;
-    rightScoreString << getRightGrid ()->getScore ();
-    uint16_t rightScoreWidth =
-        m_ScoreFont->getTextWidth (rightScoreString.str ());
+    updateScoreText (snapshot.rightGrid.getScore (), m_RightScore,
+                     m_RightScoreText);
+    uint16_t rightScoreWidth = m_ScoreFont->getTextWidth (m_RightScoreText);
     uint16_t rightScoreX = static_cast<uint16_t>(k_PositionXRightScore *
                                                  scaleFactor) - rightScoreWidth;
     uint16_t rightScoreY = static_cast<uint16_t>(k_PositionYRightScore *
                                                  scaleFactor);
 
-    m_ScoreFont->write (leftScoreString.str (), leftScoreX, leftScoreY, screen);
-    m_ScoreFont->write (rightScoreString.str (), rightScoreX, rightScoreY,
-                        screen);
+    m_ScoreFont->writeCharacters (m_LeftScoreText, leftScoreX, leftScoreY,
+                                  screen);
+    m_ScoreFont->writeCharacters (m_RightScoreText, rightScoreX, rightScoreY,
+                                  screen);
 
     // Draw the 'You Lose', 'You Win!!' labels if the game is over.
     if ( gameIsOver () )
@@ -696,8 +906,7 @@ void
 TwoPlayersState::setGameOver (void)
 {
     m_GameIsOver = true;
-    m_Winner = getLeftGrid ()->isFilled () ? IPlayer::RightSide :
-                                             IPlayer::LeftSide;
+    m_Winner = m_Match->getWinner ();
     if ( m_Observer != 0 )
     {
         m_Observer->endOfMatch (m_Winner,
@@ -749,42 +958,164 @@ TwoPlayersState::setSilhouetteBorder (uint8_t border)
     m_SilhouetteBorder = border;
 }
 
+///
+/// \brief Sets the time scale.
+///
+/// Only meant for matches between computer players.  The screen is still
+/// rendered at the normal frame rate, so at higher scales most of the
+/// updates are never shown.
+///
+/// \param timeScale How many times faster than real time the match is
+///                  played, from 1 to k_MaxTimeScale, or
+///                  k_FastestTimeScale to play it as fast as possible.
+///
+void
+TwoPlayersState::setTimeScale (uint8_t timeScale)
+{
+    assert ( timeScale <= k_MaxTimeScale && "Invalid time scale." );
+    m_TimeScale = timeScale;
+}
+
+///
+/// \brief Plays the logic ticks in the logic thread.
+///
+/// Plays a tick for each time in m_TickTimes, or as many as possible
+/// for k_FastestUpdateTime, and then takes the grids' snapshot.
+///
+/// \param fastest Tells if the match is played as fast as possible.
+///
+void
+TwoPlayersState::simulate (bool fastest)
+{
+    AMOEBAX_TRACE_ZONE ("TwoPlayersState::simulate");
+    Snapshot &snapshot = m_Snapshots[1 - m_FrontSnapshot];
+    snapshot.appliedInputs.clear ();
+    if ( fastest )
+    {
+        const uint32_t currentTime = FrameManager::getCurrentTime ();
+        uint32_t startTime = SDL_GetTicks ();
+        do
+        {
+            applyInputs (currentTime, snapshot.appliedInputs);
+            m_Match->update (Grid::k_TickTime);
+        }
+        while ( !m_Match->isOver () &&
+                SDL_GetTicks () - startTime < k_FastestUpdateTime );
+    }
+    else
+    {
+        for ( std::vector<uint32_t>::const_iterator tickTime =
+                m_TickTimes.begin () ;
+              tickTime != m_TickTimes.end () && !m_Match->isOver () ;
+              ++tickTime )
+        {
+            applyInputs (*tickTime, snapshot.appliedInputs);
+            m_Match->update (Grid::k_TickTime);
+        }
+    }
+    snapshot.leftGrid.take (*getLeftGrid ());
+    snapshot.rightGrid.take (*getRightGrid ());
+}
+
 void
 TwoPlayersState::update (uint32_t elapsedTime)
 {
-    if ( !gameIsOver () )
+    const bool fastest = k_FastestTimeScale == getTimeScale ();
+    // Keep drawing the last snapshot while the logic thread is still
+    // playing the ticks of a previous frame.  The time that passes
+    // meanwhile is played in the next ticks.
+    if ( m_Simulation->isBusy () )
+    {
+        if ( !fastest )
+        {
+            m_TickRemainder += elapsedTime * getTimeScale ();
+        }
+        return;
+    }
+    if ( m_SnapshotPending )
+    {
+        publishSnapshot ();
+    }
+    if ( gameIsOver () )
+    {
+        m_TickRemainder = 0;
+        return;
+    }
+
+    const uint32_t currentTime = FrameManager::getCurrentTime ();
+    std::vector<uint32_t> appliedInputs;
+    m_TickTimes.clear ();
+    if ( fastest )
     {
-        if ( mustShowInitialLabels () )
+        while ( mustShowInitialLabels () )
         {
-            if ( mustShowReadyLabel () )
+            applyInputs (currentTime, appliedInputs);
+            countDownLabels (Grid::k_TickTime);
+        }
+    }
+    else
+    {
+        // Play the scaled time in logic ticks, so the players and grids
+        // behave the same whatever the frame rate, and keep the time
+        // left to draw the amoebas between the last two ticks.
+        m_TickRemainder += elapsedTime * getTimeScale ();
+        while ( Grid::k_TickTime <= m_TickRemainder )
+        {
+            // The players' inputs until the tick's end are applied
+            // before it, instead of all before the frame's first tick.
+            const uint32_t tickTime =
+                currentTime - (m_TickRemainder - Grid::k_TickTime) /
+                              getTimeScale ();
+            // The labels are counted down here, since the match
+            // doesn't start until they are gone.
+            if ( mustShowInitialLabels () )
             {
-                setReadyTime (getReadyTime () - elapsedTime);
+                applyInputs (tickTime, appliedInputs);
+                countDownLabels (Grid::k_TickTime);
             }
             else
             {
-                setGoTime (getGoTime () - elapsedTime);
-            }
-        }
-        else
-        {
-            getLeftPlayer ()->update (elapsedTime);
-            getRightPlayer ()->update (elapsedTime);
-            // Update the waiting ghost amoebas from the opponent.
-            getLeftGrid ()->incrementNumberOfWaitingGhosts (
-                    getRightGrid ()->getOpponentGhostAmoebas ());
-            getRightGrid ()->incrementNumberOfWaitingGhosts (
-                    getLeftGrid ()->getOpponentGhostAmoebas ());
-            if (getRightGrid ()->isFilled () || getLeftGrid ()->isFilled ())
-            {
-                setGameOver ();
-                Music::stop ();
+                m_TickTimes.push_back (tickTime);
             }
+            m_TickRemainder -= Grid::k_TickTime;
         }
     }
+    std::for_each (appliedInputs.begin (), appliedInputs.end (),
+                   FrameManager::addAppliedInput);
+
+    if ( fastest || !m_TickTimes.empty () )
+    {
+        m_SnapshotPending = true;
+        // Unlike std::bind()'s, this task is small enough to be kept
+        // inside the std::function, so scheduling it doesn't allocate.
+        m_Simulation->schedule ([this, fastest] () { simulate (fastest); });
+    }
 }
 
 void
 TwoPlayersState::videoModeChanged (void)
 {
+    m_Simulation->wait ();
     loadGraphicsResources ();
+    getLeftGrid ()->invalidateCells ();
+    getRightGrid ()->invalidateCells ();
+    if ( m_SnapshotPending )
+    {
+        publishSnapshot ();
+    }
+    // The snapshot still has the amoebas at the old size.
+    getFrontSnapshot ().leftGrid.take (*getLeftGrid ());
+    getFrontSnapshot ().rightGrid.take (*getRightGrid ());
+}
+
+void
+TwoPlayersState::writeBoards (std::ostream &stream)
+{
+    // The logic thread doesn't touch the front snapshot, so it can be
+    // written even while a frame's ticks are being played.
+    Snapshot &snapshot = getFrontSnapshot ();
+    stream << "left ";
+    snapshot.leftGrid.write (stream);
+    stream << "right ";
+    snapshot.rightGrid.write (stream);
 }
@@ -19,13 +19,17 @@
 #if !defined (AMOEBAX_TWO_PLAYERS_STATE_H)
 #define AMOEBAX_TWO_PLAYERS_STATE_H
 
+#include <vector>
+#include "GridSnapshot.h"
 #include "IPlayer.h"
 #include "IState.h"
-#include "PairGenerator.h"
+#include "ThreadPool.h"
+#include "TwoPlayersMatch.h"
 
 namespace Amoebax
 {
     // Forward declarations.
+    class Amoeba;
     class Grid;
     class IMatchObserver;
 
@@ -33,16 +37,29 @@ namespace Amoebax
     /// \class TwoPlayersState.
     /// \brief Two players playing at the same time.
     ///
+    /// The match's logic runs in its own thread, while the main thread
+    /// draws the last snapshot of both grids.  Once the logic thread
+    /// finishes playing the ticks of a frame, the main thread swaps the
+    /// snapshot being drawn with the one the logic thread just took and
+    /// gives it the ticks of the next frame.
+    ///
     class TwoPlayersState: public IState
     {
         public:
+            /// The time scale that updates the match as fast as possible.
+            static const uint8_t k_FastestTimeScale = 0;
+            /// The maximum time scale, besides k_FastestTimeScale.
+            static const uint8_t k_MaxTimeScale = 64;
+
             TwoPlayersState (IPlayer *leftPlayer, IPlayer *rightPlayer,
                              const std::string &backgroundFileName = "menuBackground.png",
                              uint32_t leftPlayerScore = 0,
                              uint32_t rightPlayerScore = 0,
                              IMatchObserver *observer = 0);
+            virtual ~TwoPlayersState (void);
 
             virtual void activate (void);
+            uint8_t getTimeScale (void) const;
             virtual void joyMotion (uint8_t joystick, uint8_t axis,
                                     int16_t value);
             virtual void joyDown (uint8_t joystick, SDL_GameControllerButton button);
@@ -52,8 +69,10 @@ namespace Amoebax
             inline virtual bool shouldBePaused (void) { return true; }
             virtual void redrawBackground (SDL_Rect *region, SDL_Surface *screen);
             virtual void render (SDL_Surface *screen);
+            void setTimeScale (uint8_t timeScale);
             virtual void update (uint32_t elapsedTime);
             virtual void videoModeChanged (void);
+            virtual void writeBoards (std::ostream &stream);
 
         private:
             /// The time to show the "Go!!" label in milliseconds.
@@ -93,10 +112,30 @@ namespace Amoebax
             /// The Y position of the right waiting ghost amoebas' top-left corner.
             static const uint16_t k_PositionYRightWaiting = 55;
 
+            ///
+            /// \struct Snapshot.
+            /// \brief What the logic thread left after playing some ticks.
+            ///
+            struct Snapshot
+            {
+                /// The times of the players' inputs applied in the ticks.
+                std::vector<uint32_t> appliedInputs;
+                /// The left grid after the ticks.
+                GridSnapshot leftGrid;
+                /// The right grid after the ticks.
+                GridSnapshot rightGrid;
+            };
+
+            void applyInputs (uint32_t time,
+                              std::vector<uint32_t> &appliedInputs);
             void checkForRemoveStateKey (uint32_t key);
+            void countDownLabels (uint32_t elapsedTime);
+            void drawGridAmoebas (Grid *grid, GridSnapshot &snapshot,
+                                  SDL_Surface *screen);
             bool gameIsOver (void) const;
             uint8_t getAmoebasSize (void) const;
             int32_t getGoTime (void) const;
+            uint16_t getInterpolation (void) const;
             Grid *getLeftGrid (void) const;
             IPlayer *getLeftPlayer (void) const;
             int32_t getReadyTime (void) const;
@@ -104,15 +143,18 @@ namespace Amoebax
             IPlayer *getRightPlayer (void) const;
             uint8_t getSilhouetteBorder (void) const;
             IPlayer::PlayerSide getWinnerSide (void) const;
+            Snapshot &getFrontSnapshot (void);
             void loadGraphicsResources (void);
             bool mustShowGoLabel (void) const;
             bool mustShowInitialLabels (void) const;
             bool mustShowReadyLabel (void) const;
+            void publishSnapshot (void);
             void setAmoebasSize (uint8_t size);
             void setGameOver (void);
             void setGoTime (int32_t time);
             void setReadyTime (int32_t time);
             void setSilhouetteBorder (uint8_t border);
+            void simulate (bool fastest);
 
             /// Amoebas's sprites.
             std::unique_ptr<Surface> m_Amoebas;
@@ -124,34 +166,54 @@ namespace Amoebax
             std::string m_BackgroundFileName;
             /// Background music.
             std::unique_ptr<Music> m_BackgroundMusic;
+            /// The background with the settled amoebas of both grids.
+            std::unique_ptr<Surface> m_BoardLayer;
             /// The chain label image.
             std::unique_ptr<Surface> m_ChainLabel;
+            /// The index in m_Snapshots of the snapshot being drawn.
+            unsigned int m_FrontSnapshot;
             /// Tells if the game is over.
             bool m_GameIsOver;
-            /// The generator of amoebas pairs.
-            std::unique_ptr<PairGenerator> m_Generator;
             /// The "Go!!" label.
             std::unique_ptr<Surface> m_Go;
             /// The time the "Go!!" label is displayed.
             int32_t m_GoTime;
-            /// Left player.
-            std::unique_ptr<IPlayer> m_LeftPlayer;
+            /// The left player's score written in m_LeftScoreText.
+            uint32_t m_LeftScore;
+            /// The left player's score, as text.
+            std::string m_LeftScoreText;
+            /// The match's logic, with both players.
+            std::unique_ptr<TwoPlayersMatch> m_Match;
             /// Observer for the end of match.
             IMatchObserver *m_Observer;
             /// The "Ready?" label.
             std::unique_ptr<Surface> m_Ready;
             /// The time the "Ready?" label is displayed.
             int32_t m_ReadyTime;
-            /// Right player.
-            std::unique_ptr<IPlayer> m_RightPlayer;
+            /// The right player's score written in m_RightScoreText.
+            uint32_t m_RightScore;
+            /// The right player's score, as text.
+            std::string m_RightScoreText;
             /// The score font.
             std::unique_ptr<Font> m_ScoreFont;
             /// The border size of the silhouettes.
             uint8_t m_SilhouetteBorder;
             /// The silhouettes image.
             std::unique_ptr<Surface> m_Silhouettes;
+            /// The thread that plays the match's logic.
+            std::unique_ptr<ThreadPool> m_Simulation;
+            /// The snapshot being drawn and the one the logic thread takes.
+            Snapshot m_Snapshots[2];
+            /// Tells if the logic thread took a snapshot not yet drawn.
+            bool m_SnapshotPending;
             /// Tells if the state was already removed.
             bool m_StateAlreadyRemoved;
+            /// The simulated time not yet played in a logic tick, in ms.
+            uint32_t m_TickRemainder;
+            /// The times the ticks given to the logic thread end at.
+            std::vector<uint32_t> m_TickTimes;
+            /// How many times faster than real time the match is played.
+            uint8_t m_TimeScale;
             /// The loser's text.
             std::unique_ptr<Surface> m_YouLose;
             /// The winner's text.
@@ -19,6 +19,7 @@
 #include "File.h"
 #include "Font.h"
 #include "System.h"
+#include "Tracer.h"
 #include "VersusState.h"
 
 using namespace Amoebax;
@@ -130,6 +131,7 @@ VersusState::keyUp (uint32_t key)
 void
 VersusState::loadGraphicResources (void)
 {
+    AMOEBAX_TRACE_ZONE ("VersusState::loadGraphicResources");
     const float screenScale = System::getInstance ().getScreenScaleFactor ();
     uint16_t playersSeparation = k_PlayersSeparation;
 
@@ -16,6 +16,7 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
+#include "Fader.h"
 #include "File.h"
 #include "Font.h"
 #include "System.h"
@@ -47,18 +48,7 @@ VideoErrorState::activate (void)
     region.h = m_Background->getHeight ();
     m_ActiveState->redrawBackground (&region, m_Background->toSDLSurface ());
 
-    SDL_Surface *blackBox =
-        SDL_CreateRGBSurface (0,
-                              m_Background->getWidth (),
-                              m_Background->getHeight (),
-                              m_Background->toSDLSurface ()->format->BitsPerPixel,
-                              m_Background->toSDLSurface ()->format->Rmask,
-                              m_Background->toSDLSurface ()->format->Gmask,
-                              m_Background->toSDLSurface ()->format->Bmask,
-                              m_Background->toSDLSurface ()->format->Amask);
-    SDL_FillRect (blackBox, NULL, SDL_MapRGB (blackBox->format, 0, 0, 0));
-    SDL_SetSurfaceAlphaMod (blackBox, 128);
-    SDL_BlitSurface (blackBox, NULL, m_Background->toSDLSurface (), NULL);
+    Fader::dim (*m_Background, 128);
 
     std::unique_ptr<Font> font (Font::fromFile (File::getFontFilePath ("fontMenu")));
     font->write ("there was an error setting the video mode",
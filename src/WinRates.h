@@ -0,0 +1,66 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Generated by amoebax-sim --matrix. Don't edit by hand, rebuild it
+// with the win_rates target after changing any AI player.
+//
+#if !defined (AMOEBAX_WIN_RATES_H)
+#define AMOEBAX_WIN_RATES_H
+
+#include <stdint.h>
+
+namespace Amoebax
+{
+    /// The least number of matches played between two levels.
+    static const uint32_t k_WinRateMatches = 32;
+
+    /// The probability, in 1/1000, that the left level wins.
+    static const uint16_t k_WinRate[6][6] =
+    {
+        { 500,   0,   0,   0,   0,   0 },
+        {1000, 500, 219,  31,  47,  94 },
+        {1000, 781, 500, 141, 188, 141 },
+        {1000, 969, 859, 500, 578, 484 },
+        {1000, 953, 813, 422, 500, 406 },
+        {1000, 906, 859, 516, 594, 500 }
+    };
+
+    /// The lower bound of k_WinRate's 95% confidence interval.
+    static const uint16_t k_WinRateLowerBound[6][6] =
+    {
+        { 500,   0,   0,   0,   0,   0 },
+        { 893, 500, 110,   6,  11,  32 },
+        { 893, 612, 500,  59,  89,  59 },
+        { 893, 843, 701, 500, 408, 322 },
+        { 893, 820, 647, 268, 500, 255 },
+        { 893, 758, 701, 350, 423, 500 }
+    };
+
+    /// The upper bound of k_WinRate's 95% confidence interval.
+    static const uint16_t k_WinRateUpperBound[6][6] =
+    {
+        { 500, 107, 107, 107, 107, 107 },
+        {1000, 500, 388, 157, 180, 242 },
+        {1000, 890, 500, 299, 353, 299 },
+        {1000, 994, 941, 500, 732, 650 },
+        {1000, 989, 911, 592, 500, 577 },
+        {1000, 968, 941, 678, 745, 500 }
+    };
+}
+
+#endif // !AMOEBAX_WIN_RATES_H
@@ -0,0 +1,115 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "Font.h"
+
+using namespace Amoebax;
+
+static void showUsage (void);
+
+///
+/// \brief Writes the glyph table of each font given in the command line.
+///
+/// The glyph tables are written to the output directory with the name
+/// Font::getGlyphTableFilePath() gives to each font, so they can be
+/// installed next to the fonts.
+///
+int
+main (int argc, char **argv)
+{
+    try
+    {
+        std::string outputDirectory (".");
+        int currentArgument = 1;
+        for ( ; currentArgument < argc ; ++currentArgument )
+        {
+            std::string argument (argv[currentArgument]);
+            if ( argument == "-h" || argument == "--help" )
+            {
+                showUsage ();
+                return EXIT_SUCCESS;
+            }
+            else if ( (argument == "-o" || argument == "--output-dir") &&
+                      currentArgument + 1 < argc )
+            {
+                outputDirectory = argv[++currentArgument];
+            }
+            else
+            {
+                break;
+            }
+        }
+        if ( currentArgument == argc )
+        {
+            showUsage ();
+            return EXIT_FAILURE;
+        }
+
+        for ( ; currentArgument < argc ; ++currentArgument )
+        {
+            std::string fontFileName (argv[currentArgument]);
+            std::string tableFileName (
+                    Font::getGlyphTableFilePath (fontFileName));
+            std::string::size_type directory =
+                tableFileName.find_last_of ("/\\");
+            if ( std::string::npos != directory )
+            {
+                tableFileName.erase (0, directory + 1);
+            }
+
+            std::unique_ptr<Font> font (Font::fromFile (fontFileName));
+            font->saveGlyphTable (fontFileName,
+                                  outputDirectory + "/" + tableFileName);
+        }
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "amoebax-glyphs: " << e.what () << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+///
+/// \brief Shows the application's usage information.
+///
+void
+showUsage (void)
+{
+    using namespace std;
+    const int optionWidth = 25;
+
+    cout << "Usage: amoebax-glyphs [OPTION] FONT..." << endl;
+    cout << endl;
+    cout << "Writes the glyph table of each FONT, so the game doesn't ";
+    cout << "need to look for" << endl;
+    cout << "the characters in the font's bitmap." << endl;
+    cout << endl;
+
+    cout << left << setw (optionWidth) << "  -h, --help";
+    cout << right << "display this help message and exit" << endl;
+
+    cout << left << setw (optionWidth) << "  -o, --output-dir DIR";
+    cout << right << "write the glyph tables to DIR (default .)" << endl;
+}
@@ -1,8 +1,8 @@
 
-target_sources(amoebax PRIVATE
+target_sources(amoebax_core PRIVATE
 	macos/OSXOptions.cxx macos/OSXOptions.h)
-target_compile_definitions(amoebax PRIVATE IS_OSX_HOST)
-target_link_libraries(amoebax PRIVATE "-framework CoreFoundation")
+target_compile_definitions(amoebax_core PUBLIC IS_OSX_HOST)
+target_link_libraries(amoebax_core PUBLIC "-framework CoreFoundation")
 
 # Add SDL2 Frameworks
 add_custom_command(TARGET amoebax POST_BUILD
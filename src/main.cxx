@@ -19,15 +19,43 @@
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <SDL.h>
+#include <sstream>
 #include <stdexcept>
+#include "BenchmarkState.h"
+#include "CreditsState.h"
+#include "DemoState.h"
+#include "FlightRecorder.h"
+#include "FrameManager.h"
 #include "MainMenuState.h"
+#include "NormalSetupState.h"
 #include "Options.h"
+#include "OptionsMenuState.h"
+#include "Profiler.h"
+#include "Random.h"
 #include "System.h"
+#include "TournamentMenuState.h"
+#include "Tracer.h"
 
 using namespace Amoebax;
 
+/// The seed of the random generators in the benchmark.
+static const uint32_t k_BenchmarkSeed = 1;
+/// How many times each menu state is created to measure its startup time.
+static const unsigned int k_StartupTimeRepetitions = 10;
+/// The number of frames to benchmark, or 0 to play.
+static uint32_t g_BenchmarkFrames = 0;
+/// Tells if the menus' startup time must be measured instead of playing.
+static bool g_MeasureStartupTime = false;
+/// Tells if the frame intervals must be written when the game ends.
+static bool g_ShowFrameStatistics = false;
+
+template<class State> static double getStartupTime (void);
+static void measureStartupTime (void);
 static void parseCommandLine (int argc, char **argv);
+static void runBenchmark (void);
+static void showFrameStatistics (void);
 static void showUsage (void);
 static void showVersion (void);
 
@@ -36,11 +64,39 @@ main (int argc, char **argv)
 {
     try
     {
+        // The benchmark's options must not be saved.
+        const unsigned int screenHeight = Options::getInstance ().getScreenHeight ();
+        const unsigned int screenWidth = Options::getInstance ().getScreenWidth ();
+        const bool soundEnabled = Options::getInstance ().isSoundEnabled ();
+
         parseCommandLine (argc, argv);
+        // After all the arguments, so none of them can undo these.
+        if ( 0 < g_BenchmarkFrames )
+        {
+            Options::getInstance ().setSoundEnabled (false);
+            FrameManager::setFixedStep (true);
+        }
         System::getInstance ().init ();
+        if ( 0 < g_BenchmarkFrames )
+        {
+            runBenchmark ();
+            Options::getInstance ().setScreenHeight (screenHeight);
+            Options::getInstance ().setScreenWidth (screenWidth);
+            Options::getInstance ().setSoundEnabled (soundEnabled);
+            return EXIT_SUCCESS;
+        }
+        if ( g_MeasureStartupTime )
+        {
+            measureStartupTime ();
+            return EXIT_SUCCESS;
+        }
         System::getInstance ().setActiveState (new MainMenuState (),
                                                System::FadeIn);
         System::getInstance ().run ();
+        if ( g_ShowFrameStatistics )
+        {
+            showFrameStatistics ();
+        }
     }
     catch (std::exception &e)
     {
@@ -50,6 +106,50 @@ main (int argc, char **argv)
     return EXIT_SUCCESS;
 }
 
+///
+/// \brief Gets how long a state takes to start.
+///
+/// \return The average time to create and destroy the state, in ms.
+///
+template<class State> double
+getStartupTime (void)
+{
+    uint64_t start = SDL_GetPerformanceCounter ();
+    for ( unsigned int repetition = 0 ;
+          repetition < k_StartupTimeRepetitions ; ++repetition )
+    {
+        std::unique_ptr<IState> state (new State ());
+    }
+    uint64_t elapsed = SDL_GetPerformanceCounter () - start;
+
+    return 1000.0 * elapsed / SDL_GetPerformanceFrequency () /
+           k_StartupTimeRepetitions;
+}
+
+///
+/// \brief Writes how long the menu states take to start.
+///
+/// Most of the time goes to load the states' graphics and fonts.
+///
+void
+measureStartupTime (void)
+{
+    using namespace std;
+    const int nameWidth = 16;
+
+    cout << fixed << setprecision (2);
+    cout << left << setw (nameWidth) << "main menu";
+    cout << right << getStartupTime<MainMenuState> () << " ms" << endl;
+    cout << left << setw (nameWidth) << "normal setup";
+    cout << right << getStartupTime<NormalSetupState> () << " ms" << endl;
+    cout << left << setw (nameWidth) << "tournament menu";
+    cout << right << getStartupTime<TournamentMenuState> () << " ms" << endl;
+    cout << left << setw (nameWidth) << "options menu";
+    cout << right << getStartupTime<OptionsMenuState> () << " ms" << endl;
+    cout << left << setw (nameWidth) << "credits";
+    cout << right << getStartupTime<CreditsState> () << " ms" << endl;
+}
+
 ///
 /// \brief Parses the command line for options.
 ///
@@ -63,8 +163,20 @@ parseCommandLine (int argc, char **argv)
     {
         std::string argument (argv[currentArgument]);
 
+        // Benchmark.
+        if ( argument == "--benchmark" && currentArgument + 1 < argc )
+        {
+            std::string value (argv[++currentArgument]);
+            std::istringstream stream (value);
+            if ( !(stream >> g_BenchmarkFrames) || !stream.eof () ||
+                 0 == g_BenchmarkFrames )
+            {
+                throw std::runtime_error ("Invalid number of frames: " + value);
+            }
+        }
+
         // Fullscreen.
-        if ( argument == "-f" || argument == "--fullscreen" )
+        else if ( argument == "-f" || argument == "--fullscreen" )
         {
             Options::getInstance ().setFullScreen (true);
         }
@@ -81,6 +193,26 @@ parseCommandLine (int argc, char **argv)
             Options::getInstance ().setSoundEnabled (false);
         }
 
+        // Frame rate.
+        else if ( argument == "--frame-rate" && currentArgument + 1 < argc )
+        {
+            std::string value (argv[++currentArgument]);
+            std::istringstream stream (value);
+            unsigned int frameRate = 0;
+            if ( !(stream >> frameRate) || !stream.eof () ||
+                 !Options::isFrameRateSupported (frameRate) )
+            {
+                throw std::runtime_error ("Invalid frame rate: " + value);
+            }
+            Options::getInstance ().setFrameRate (frameRate);
+        }
+
+        // Frame intervals.
+        else if ( argument == "--frame-stats" )
+        {
+            g_ShowFrameStatistics = true;
+        }
+
         // Help.
         else if ( argument == "-h" || argument == "--help" )
         {
@@ -88,6 +220,84 @@ parseCommandLine (int argc, char **argv)
             exit (EXIT_SUCCESS);
         }
 
+        // No window nor sound device.
+        else if ( argument == "--headless" )
+        {
+            SDL_setenv ("SDL_AUDIODRIVER", "dummy", 1);
+            SDL_setenv ("SDL_VIDEODRIVER", "dummy", 1);
+        }
+
+        // Frames' profile.
+        else if ( argument == "--profile" && currentArgument + 1 < argc )
+        {
+            Profiler::setRecordFileName (argv[++currentArgument]);
+            Profiler::startRecording ();
+        }
+
+        // Present the screen with a renderer.
+        else if ( argument == "--renderer" )
+        {
+            System::getInstance ().setRendererEnabled (true);
+        }
+
+        // Screen resolution.
+        else if ( argument == "--resolution" && currentArgument + 1 < argc )
+        {
+            std::string value (argv[++currentArgument]);
+            std::istringstream stream (value);
+            unsigned int width = 0;
+            unsigned int height = 0;
+            char separator = 0;
+            if ( !(stream >> width >> separator >> height) || !stream.eof () ||
+                 'x' != separator ||
+                 !Options::isScreenResolutionSupported (width, height) )
+            {
+                throw std::runtime_error ("Invalid resolution: " + value);
+            }
+            Options::getInstance ().setScreenHeight (height);
+            Options::getInstance ().setScreenWidth (width);
+        }
+
+        // Stalls' log.
+        else if ( argument == "--stall-log" && currentArgument + 1 < argc )
+        {
+            FlightRecorder::setLogFileName (argv[++currentArgument]);
+        }
+
+        // Menus' startup time.
+        else if ( argument == "--startup-time" )
+        {
+            g_MeasureStartupTime = true;
+        }
+
+        // Demo's time scale.
+        else if ( argument == "--time-scale" && currentArgument + 1 < argc )
+        {
+            std::string value (argv[++currentArgument]);
+            std::istringstream stream (value);
+            unsigned int timeScale = 0;
+            if ( value == "max" )
+            {
+                timeScale = TwoPlayersState::k_FastestTimeScale;
+            }
+            else if ( !(stream >> timeScale) || !stream.eof () ||
+                      timeScale < 1 ||
+                      timeScale > TwoPlayersState::k_MaxTimeScale )
+            {
+                throw std::runtime_error ("Invalid time scale: " + value);
+            }
+            DemoState::setInitialTimeScale (static_cast<uint8_t>(timeScale));
+        }
+
+#if defined (AMOEBAX_TRACING)
+        // Zones' trace.
+        else if ( argument == "--trace" && currentArgument + 1 < argc )
+        {
+            Tracer::setFileName (argv[++currentArgument]);
+            Tracer::start ();
+        }
+#endif // AMOEBAX_TRACING
+
         // Version.
         else if ( argument == "-V" || argument == "--version" )
         {
@@ -111,6 +321,46 @@ parseCommandLine (int argc, char **argv)
     }
 }
 
+///
+/// \brief Plays the benchmark's frames and writes how long they took.
+///
+/// The random generators are seeded again after the system seeded
+/// them with the time, so every benchmark plays the same matches.
+///
+void
+runBenchmark (void)
+{
+    srand (k_BenchmarkSeed);
+    Random::init (k_BenchmarkSeed);
+    System::getInstance ().setActiveState (
+            new BenchmarkState (g_BenchmarkFrames, k_BenchmarkSeed),
+            System::FadeNone);
+    System::getInstance ().run ();
+}
+
+///
+/// \brief Writes the median and worst intervals of the last frames.
+///
+void
+showFrameStatistics (void)
+{
+    using namespace std;
+
+    cout << fixed << setprecision (2);
+    cout << "target: " << 1000.0f / FrameManager::getFrameRate () << " ms";
+    cout << (FrameManager::isVSyncEnabled () ? " (vsync)" : "") << endl;
+    cout << "p50:    " << FrameManager::getFrameInterval (50.0f) << " ms";
+    cout << endl;
+    cout << "p99:    " << FrameManager::getFrameInterval (99.0f) << " ms";
+    cout << endl;
+    if ( 0 < FrameManager::getInputLatency (100.0f) )
+    {
+        cout << "input:  " << FrameManager::getInputLatency (50.0f);
+        cout << " ms p50, " << FrameManager::getInputLatency (99.0f);
+        cout << " ms p99" << endl;
+    }
+}
+
 ///
 /// \brief Shows the application's usage information.
 ///
@@ -125,6 +375,9 @@ showUsage (void)
     cout << "Free Puyo-Puyo clone game." << endl;
     cout << endl;
 
+    cout << left << setw (optionWidth) << "      --benchmark N";
+    cout << right << "play N frames of a seeded demo and print their times" << endl;
+
     cout << left << setw (optionWidth) << "  -f, --fullscreen";
     cout << right << "start in full screen mode" << endl;
 
@@ -134,9 +387,41 @@ showUsage (void)
     cout << left << setw (optionWidth) << "      --disable-sound";
     cout << right << "disables the sound" << endl;
 
+    cout << left << setw (optionWidth) << "      --frame-rate HZ";
+    cout << right << "render 30, 60, 120 or 144 frames per second" << endl;
+
+    cout << left << setw (optionWidth) << "      --frame-stats";
+    cout << right << "print the frame intervals and input latencies at exit" << endl;
+
     cout << left << setw (optionWidth) << "  -h, --help";
     cout << right << "display this help message and exit" << endl;
 
+    cout << left << setw (optionWidth) << "      --headless";
+    cout << right << "use SDL's dummy video and audio drivers" << endl;
+
+    cout << left << setw (optionWidth) << "      --profile FILE";
+    cout << right << "write each frame's phase times to FILE" << endl;
+
+    cout << left << setw (optionWidth) << "      --renderer";
+    cout << right << "scale the screen to the window with SDL_Renderer" << endl;
+
+    cout << left << setw (optionWidth) << "      --resolution WxH";
+    cout << right << "use 640x480, 800x600, 1024x768 or 1280x960 pixels" << endl;
+
+    cout << left << setw (optionWidth) << "      --stall-log FILE";
+    cout << right << "append the last frames to FILE when the game stalls" << endl;
+
+    cout << left << setw (optionWidth) << "      --startup-time";
+    cout << right << "measure how long the menus take to start" << endl;
+
+    cout << left << setw (optionWidth) << "      --time-scale N";
+    cout << right << "play the demo N (1-64 or max) times faster" << endl;
+
+#if defined (AMOEBAX_TRACING)
+    cout << left << setw (optionWidth) << "      --trace FILE";
+    cout << right << "write the zones' Chrome trace to FILE" << endl;
+#endif // AMOEBAX_TRACING
+
     cout << left << setw (optionWidth) << "  -V, --version";
     cout << right << "print version information" << endl;
 
@@ -0,0 +1,749 @@
+//
+// Cross-platform free Puyo-Puyo clone.
+// Copyright (C) 2006, 2007 Emma's Software
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "AIPlayerFactory.h"
+#include "Bracket.h"
+#include "MatchSimulator.h"
+#include "ThreadPool.h"
+
+using namespace Amoebax;
+
+namespace
+{
+    /// The number of matches to play before writing their results.
+    const size_t k_BatchSize = 4096;
+
+    /// A pair of computer player levels, left and right.
+    typedef std::pair<uint8_t, uint8_t> LevelPair;
+
+    ///
+    /// \struct LevelStats
+    /// \brief The matches a level played against another level.
+    ///
+    struct LevelStats
+    {
+        /// The matches played, at either side.
+        uint32_t matches;
+        /// The matches won.
+        uint32_t wins;
+        /// The matches that reached the max. match time.
+        uint32_t draws;
+    };
+
+    /// The stats of each level, by [level][opponent's level].
+    typedef LevelStats StatsMatrix[AIPlayerFactory::k_MaxPlayerLevel]
+                                  [AIPlayerFactory::k_MaxPlayerLevel];
+
+    ///
+    /// \struct Settings
+    /// \brief The simulator's settings from the command line.
+    ///
+    struct Settings
+    {
+        /// The level pairs to play.
+        std::vector<LevelPair> levels;
+        /// The number of players in the tournament.
+        uint32_t entrants;
+        /// The seed of the first match of each level pair.
+        uint32_t firstSeed;
+        /// The number of matches to play for each level pair.
+        uint32_t matches;
+        /// The header file to write the win rates table to, if any.
+        std::string matrixFileName;
+        /// The file to write the results to. Empty means stdout.
+        std::string outputFileName;
+        /// The time to pass to each match update, in ms.
+        uint32_t stepTime;
+        /// The number of threads to use. 0 means one per core.
+        unsigned int threads;
+        /// Tells if a tournament is played instead of levels pairs.
+        bool tournament;
+        /// The tournament's format.
+        Bracket::Format tournamentFormat;
+    };
+
+    ///
+    /// \struct Job
+    /// \brief A single match to play and, once played, its result.
+    ///
+    struct Job
+    {
+        /// The match's levels.
+        LevelPair levels;
+        /// The match's seed.
+        uint32_t seed;
+        /// The match's result.
+        MatchSimulator::Result result;
+    };
+}
+
+static uint32_t parseNumber (const std::string &text, const std::string &option);
+static std::vector<LevelPair> parseLevels (const std::string &text);
+static void addResult (StatsMatrix &stats, const Job &job);
+static void parseCommandLine (int argc, char **argv, Settings &settings);
+static void playMatch (Job *job, uint32_t stepTime);
+static void playTournament (const Settings &settings, std::ostream &output);
+static void showUsage (void);
+static void writeMatrix (const std::string &fileName,
+                         const StatsMatrix &stats);
+static void writeResult (std::ostream &output, const Job &job);
+
+int
+main (int argc, char **argv)
+{
+    try
+    {
+        Settings settings;
+        parseCommandLine (argc, argv, settings);
+
+        std::ofstream outputFile;
+        if ( !settings.outputFileName.empty () )
+        {
+            outputFile.open (settings.outputFileName.c_str ());
+            if ( !outputFile )
+            {
+                throw std::runtime_error ("Couldn't open the output file " +
+                                          settings.outputFileName);
+            }
+        }
+        std::ostream &output = outputFile.is_open () ? outputFile : std::cout;
+        if ( settings.tournament )
+        {
+            playTournament (settings, output);
+            return EXIT_SUCCESS;
+        }
+        output << "left_level,right_level,seed,winner,left_score,right_score,"
+               << "duration_ms,left_max_chain,right_max_chain" << std::endl;
+
+        // Every level pair plays the same seeds, so all pairs get the
+        // same amoebas and the results can be compared.
+        std::vector<Job> jobs;
+        for ( std::vector<LevelPair>::const_iterator levels =
+                settings.levels.begin () ;
+              levels != settings.levels.end () ; ++levels )
+        {
+            for ( uint32_t match = 0 ; match < settings.matches ; ++match )
+            {
+                Job job;
+                job.levels = *levels;
+                job.seed = settings.firstSeed + match;
+                jobs.push_back (job);
+            }
+        }
+
+        StatsMatrix stats = { };
+        ThreadPool pool (settings.threads);
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now ();
+        for ( size_t first = 0 ; first < jobs.size () ; first += k_BatchSize )
+        {
+            size_t last = std::min (first + k_BatchSize, jobs.size ());
+            for ( size_t current = first ; current < last ; ++current )
+            {
+                pool.schedule (std::bind (playMatch, &jobs[current],
+                                          settings.stepTime));
+            }
+            pool.wait ();
+            for ( size_t current = first ; current < last ; ++current )
+            {
+                writeResult (output, jobs[current]);
+                addResult (stats, jobs[current]);
+            }
+        }
+        output.flush ();
+        if ( !settings.matrixFileName.empty () )
+        {
+            writeMatrix (settings.matrixFileName, stats);
+        }
+
+        double seconds = std::chrono::duration<double> (
+                std::chrono::steady_clock::now () - start).count ();
+        std::cerr << jobs.size () << " matches in " << std::fixed
+                  << std::setprecision (2) << seconds << " s using "
+                  << pool.getNumberOfThreads () << " threads ("
+                  << std::setprecision (0)
+                  << (0.0 < seconds ? jobs.size () / seconds : 0.0)
+                  << " matches/s)" << std::endl;
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "amoebax-sim: " << e.what () << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+///
+/// \brief Adds a match's result to the levels' stats.
+///
+/// The stats don't care at which side each level played, so a match
+/// between two levels counts for both.
+///
+/// \param stats The stats to add the result to.
+/// \param job The played match.
+///
+void
+addResult (StatsMatrix &stats, const Job &job)
+{
+    uint8_t left = job.levels.first;
+    uint8_t right = job.levels.second;
+    const MatchSimulator::Result &result = job.result;
+
+    ++stats[left][right].matches;
+    ++stats[right][left].matches;
+    if ( !result.finished )
+    {
+        ++stats[left][right].draws;
+        ++stats[right][left].draws;
+    }
+    else if ( IPlayer::LeftSide == result.winner )
+    {
+        ++stats[left][right].wins;
+    }
+    else
+    {
+        ++stats[right][left].wins;
+    }
+}
+
+///
+/// \brief Parses a non negative integer from the command line.
+///
+/// \param text The text to parse.
+/// \param option The option the number is for, used for the error message.
+/// \return The parsed number.
+///
+uint32_t
+parseNumber (const std::string &text, const std::string &option)
+{
+    std::istringstream stream (text);
+    uint32_t number = 0;
+    if ( text.empty () || '-' == text[0] || !(stream >> number) ||
+         !stream.eof () )
+    {
+        throw std::runtime_error ("Invalid number for " + option + ": " + text);
+    }
+    return number;
+}
+
+///
+/// \brief Parses the list of levels pairs to play.
+///
+/// \param text Either "all" or a comma separated list of
+///             LEFT:RIGHT levels pairs.
+/// \return The list of levels pairs.
+///
+std::vector<LevelPair>
+parseLevels (const std::string &text)
+{
+    std::vector<LevelPair> levels;
+    if ( "all" == text )
+    {
+        for ( uint8_t left = 0 ; left < AIPlayerFactory::k_MaxPlayerLevel ;
+              ++left )
+        {
+            for ( uint8_t right = 0 ; right < AIPlayerFactory::k_MaxPlayerLevel ;
+                  ++right )
+            {
+                levels.push_back (LevelPair (left, right));
+            }
+        }
+        return levels;
+    }
+
+    std::istringstream stream (text);
+    std::string pair;
+    while ( std::getline (stream, pair, ',') )
+    {
+        std::string::size_type colon = pair.find (':');
+        if ( std::string::npos == colon )
+        {
+            throw std::runtime_error ("Invalid levels pair: " + pair);
+        }
+        uint32_t left = parseNumber (pair.substr (0, colon), "--levels");
+        uint32_t right = parseNumber (pair.substr (colon + 1), "--levels");
+        if ( left >= AIPlayerFactory::k_MaxPlayerLevel ||
+             right >= AIPlayerFactory::k_MaxPlayerLevel )
+        {
+            throw std::runtime_error ("Level out of range: " + pair);
+        }
+        levels.push_back (LevelPair (left, right));
+    }
+    if ( levels.empty () )
+    {
+        throw std::runtime_error ("No levels to play.");
+    }
+    return levels;
+}
+
+///
+/// \brief Parses the command line for options.
+///
+/// \param argc The number of arguments from the command line.
+/// \param argv The array of command line parameters.
+/// \param settings The settings to fill from the command line.
+///
+void
+parseCommandLine (int argc, char **argv, Settings &settings)
+{
+    settings.levels = parseLevels ("all");
+    settings.entrants = Bracket::k_MinEntrants;
+    settings.firstSeed = 1;
+    settings.matches = 100;
+    settings.stepTime = MatchSimulator::k_DefaultStepTime;
+    settings.threads = 0;
+    settings.tournament = false;
+    settings.tournamentFormat = Bracket::SingleElimination;
+
+    bool hasLevels = false;
+    bool hasMatches = false;
+    uint32_t lastSeed = 0;
+    bool hasLastSeed = false;
+    for ( int currentArgument = 1 ; currentArgument < argc ; ++currentArgument )
+    {
+        std::string argument (argv[currentArgument]);
+
+        // Help.
+        if ( argument == "-h" || argument == "--help" )
+        {
+            showUsage ();
+            exit (EXIT_SUCCESS);
+        }
+
+        // All other options have a value.
+        if ( currentArgument + 1 >= argc )
+        {
+            showUsage ();
+            throw std::runtime_error ("Missing value for " + argument);
+        }
+        std::string value (argv[++currentArgument]);
+
+        // Tournament's players.
+        if ( argument == "--entrants" )
+        {
+            settings.entrants = parseNumber (value, argument);
+            if ( settings.entrants < Bracket::k_MinEntrants ||
+                 settings.entrants > Bracket::k_MaxEntrants )
+            {
+                throw std::runtime_error ("Invalid number of entrants: " +
+                                          value);
+            }
+        }
+
+        // Levels.
+        else if ( argument == "-l" || argument == "--levels" )
+        {
+            settings.levels = parseLevels (value);
+            hasLevels = true;
+        }
+
+        // Matches per levels pair.
+        else if ( argument == "-m" || argument == "--matches" )
+        {
+            settings.matches = parseNumber (value, argument);
+            hasMatches = true;
+        }
+
+        // Win rates table.
+        else if ( argument == "--matrix" )
+        {
+            settings.matrixFileName = value;
+        }
+
+        // Output file.
+        else if ( argument == "-o" || argument == "--output" )
+        {
+            settings.outputFileName = value;
+        }
+
+        // Seeds range.
+        else if ( argument == "-s" || argument == "--seeds" )
+        {
+            std::string::size_type dash = value.find ('-');
+            settings.firstSeed = parseNumber (value.substr (0, dash), argument);
+            hasLastSeed = std::string::npos != dash;
+            if ( hasLastSeed )
+            {
+                lastSeed = parseNumber (value.substr (dash + 1), argument);
+                if ( lastSeed < settings.firstSeed )
+                {
+                    throw std::runtime_error ("Invalid seeds range: " + value);
+                }
+            }
+        }
+
+        // Time step.
+        else if ( argument == "--step" )
+        {
+            settings.stepTime = parseNumber (value, argument);
+            if ( 0 == settings.stepTime )
+            {
+                throw std::runtime_error ("The step must be greater than 0.");
+            }
+        }
+
+        // Threads.
+        else if ( argument == "-t" || argument == "--threads" )
+        {
+            settings.threads = parseNumber (value, argument);
+        }
+
+        // Tournament.
+        else if ( argument == "--tournament" )
+        {
+            settings.tournament = true;
+            if ( "single" == value )
+            {
+                settings.tournamentFormat = Bracket::SingleElimination;
+            }
+            else if ( "double" == value )
+            {
+                settings.tournamentFormat = Bracket::DoubleElimination;
+            }
+            else if ( "swiss" == value )
+            {
+                settings.tournamentFormat = Bracket::Swiss;
+            }
+            else
+            {
+                throw std::runtime_error ("Unknown tournament format: " +
+                                          value);
+            }
+        }
+
+        // Unknown parameter.
+        else
+        {
+            std::cerr << "Unknown option: " << argument << std::endl;
+            showUsage ();
+            throw std::runtime_error ("Unknown command line option.");
+        }
+    }
+
+    // The win rates table doesn't need a level against itself.
+    if ( !hasLevels && !settings.matrixFileName.empty () )
+    {
+        settings.levels.clear ();
+        for ( uint8_t left = 0 ; left < AIPlayerFactory::k_MaxPlayerLevel ;
+              ++left )
+        {
+            for ( uint8_t right = 0 ; right < AIPlayerFactory::k_MaxPlayerLevel ;
+                  ++right )
+            {
+                if ( left != right )
+                {
+                    settings.levels.push_back (LevelPair (left, right));
+                }
+            }
+        }
+    }
+
+    // A seeds range without --matches plays the whole range, and
+    // with it only the first seeds of the range.
+    if ( hasLastSeed )
+    {
+        uint32_t seeds = lastSeed - settings.firstSeed + 1;
+        settings.matches = hasMatches ? std::min (settings.matches, seeds) :
+                                        seeds;
+    }
+}
+
+///
+/// \brief Plays a job's match.
+///
+/// \param job The job to play the match of. Its result is set once
+///            the match is over.
+/// \param stepTime The time to pass to each match update, in ms.
+///
+void
+playMatch (Job *job, uint32_t stepTime)
+{
+    job->result = MatchSimulator::play (job->levels.first,
+                                        job->levels.second, job->seed,
+                                        0, 0, stepTime);
+}
+
+///
+/// \brief Plays a whole tournament between computer players.
+///
+/// The entrants' levels go from the lowest to the highest and then
+/// start over, so every level has about the same number of players.
+/// Once the tournament is over, writes the standings as CSV.
+///
+/// \param settings The simulator's settings.
+/// \param output The stream to write the standings to.
+///
+void
+playTournament (const Settings &settings, std::ostream &output)
+{
+    std::vector<Bracket::Entrant> entrants;
+    for ( uint32_t index = 0 ; index < settings.entrants ; ++index )
+    {
+        Bracket::Entrant entrant = Bracket::Entrant ();
+        entrant.computerPlayerLevel = static_cast<uint8_t>(
+                index % AIPlayerFactory::k_MaxPlayerLevel);
+        entrant.isComputerPlayer = true;
+        std::ostringstream name;
+        name << AIPlayerFactory::getPlayerName (entrant.computerPlayerLevel)
+             << " #" << index + 1;
+        entrant.name = name.str ();
+        entrants.push_back (entrant);
+    }
+
+    Bracket bracket (settings.tournamentFormat, entrants);
+    ThreadPool pool (settings.threads);
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now ();
+    bracket.playComputerMatches (pool, settings.firstSeed);
+    double seconds = std::chrono::duration<double> (
+            std::chrono::steady_clock::now () - start).count ();
+
+    output << "rank,name,level,wins,losses,byes,score" << std::endl;
+    std::vector<uint16_t> standings (bracket.getStandings ());
+    uint32_t matches = 0;
+    for ( size_t rank = 0 ; rank < standings.size () ; ++rank )
+    {
+        const Bracket::Entrant &entrant =
+            bracket.getEntrants ()[standings[rank]];
+        output << rank + 1 << ',' << entrant.name << ','
+               << static_cast<int>(entrant.computerPlayerLevel) << ','
+               << entrant.wins << ',' << entrant.losses << ','
+               << entrant.byes << ',' << entrant.score << '\n';
+        matches += entrant.losses;
+    }
+    output.flush ();
+
+    std::cerr << matches << " matches in " << bracket.getRoundNumber () - 1
+              << " rounds in " << std::fixed << std::setprecision (2)
+              << seconds << " s using " << pool.getNumberOfThreads ()
+              << " threads" << std::endl;
+}
+
+///
+/// \brief Shows the simulator's usage information.
+///
+void
+showUsage (void)
+{
+    using namespace std;
+    const int optionWidth = 32;
+
+    cout << "Usage: amoebax-sim [OPTION]" << endl;
+    cout << endl;
+    cout << "Plays computer against computer matches without a screen ";
+    cout << "and writes the" << endl;
+    cout << "results as CSV." << endl;
+    cout << endl;
+
+    cout << left << setw (optionWidth) << "      --entrants N";
+    cout << right << "players of the tournament (default "
+         << Bracket::k_MinEntrants << ")" << endl;
+
+    cout << left << setw (optionWidth) << "  -h, --help";
+    cout << right << "display this help message and exit" << endl;
+
+    cout << left << setw (optionWidth) << "  -l, --levels L:R[,L:R...]|all";
+    cout << right << "levels pairs to play (default all)" << endl;
+
+    cout << left << setw (optionWidth) << "  -m, --matches N";
+    cout << right << "matches per levels pair (default 100)" << endl;
+
+    cout << left << setw (optionWidth) << "      --matrix FILE";
+    cout << right << "write the win rates table header to FILE" << endl;
+
+    cout << left << setw (optionWidth) << "  -o, --output FILE";
+    cout << right << "write the CSV to FILE (default stdout)" << endl;
+
+    cout << left << setw (optionWidth) << "  -s, --seeds FIRST[-LAST]";
+    cout << right << "seeds of each pair's matches (default 1)" << endl;
+
+    cout << left << setw (optionWidth) << "      --step MS";
+    cout << right << "simulated ms per update (default "
+         << MatchSimulator::k_DefaultStepTime << ")" << endl;
+
+    cout << left << setw (optionWidth) << "  -t, --threads N";
+    cout << right << "worker threads (default one per core)" << endl;
+
+    cout << left << setw (optionWidth) << "      --tournament FORMAT";
+    cout << right << "play a single, double or swiss tournament" << endl;
+
+    cout << endl;
+    cout << "Report bugs to <" << PACKAGE_BUGREPORT << ">" << endl;
+}
+
+///
+/// \brief Writes the win rates table as a C++ header.
+///
+/// For each two levels writes the probability that the first wins,
+/// counting draws as half a win, and the 95% Wilson score interval
+/// of that probability. All values are in 1/1000.
+///
+/// \param fileName The header file to write.
+/// \param stats The levels' stats to compute the win rates from.
+///
+void
+writeMatrix (const std::string &fileName, const StatsMatrix &stats)
+{
+    const uint8_t levels = AIPlayerFactory::k_MaxPlayerLevel;
+    const double z = 1.96;
+    uint16_t winRate[levels][levels];
+    uint16_t lowerBound[levels][levels];
+    uint16_t upperBound[levels][levels];
+    uint32_t minMatches = 0;
+    for ( uint8_t level = 0 ; level < levels ; ++level )
+    {
+        for ( uint8_t opponent = 0 ; opponent < levels ; ++opponent )
+        {
+            const LevelStats &current = stats[level][opponent];
+            double rate = 0.5;
+            double low = 0.5;
+            double high = 0.5;
+            if ( level != opponent )
+            {
+                if ( 0 == current.matches )
+                {
+                    throw std::runtime_error ("Missing matches to compute "
+                                              "the win rates table.");
+                }
+                double n = current.matches;
+                rate = (current.wins + current.draws / 2.0) / n;
+                double centre = (rate + z * z / (2.0 * n)) / (1.0 + z * z / n);
+                double margin = z * std::sqrt (rate * (1.0 - rate) / n +
+                                               z * z / (4.0 * n * n)) /
+                                (1.0 + z * z / n);
+                low = std::max (0.0, centre - margin);
+                high = std::min (1.0, centre + margin);
+                if ( 0 == minMatches || current.matches < minMatches )
+                {
+                    minMatches = current.matches;
+                }
+            }
+            winRate[level][opponent] =
+                static_cast<uint16_t>(std::floor (rate * 1000.0 + 0.5));
+            lowerBound[level][opponent] =
+                static_cast<uint16_t>(std::floor (low * 1000.0 + 0.5));
+            upperBound[level][opponent] =
+                static_cast<uint16_t>(std::floor (high * 1000.0 + 0.5));
+        }
+    }
+
+    std::ofstream header (fileName.c_str ());
+    if ( !header )
+    {
+        throw std::runtime_error ("Couldn't open the matrix file " + fileName);
+    }
+    header << "//\n"
+           << "// Cross-platform free Puyo-Puyo clone.\n"
+           << "// Copyright (C) 2006, 2007 Emma's Software\n"
+           << "//\n"
+           << "// This program is free software; you can redistribute it and/or modify\n"
+           << "// it under the terms of the GNU General Public License as published by\n"
+           << "// the Free Software Foundation; either version 2 of the License, or\n"
+           << "// (at your option) any later version.\n"
+           << "//\n"
+           << "// This program is distributed in the hope that it will be useful,\n"
+           << "// but WITHOUT ANY WARRANTY; without even the implied warranty of\n"
+           << "// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\n"
+           << "// GNU General Public License for more details.\n"
+           << "//\n"
+           << "// You should have received a copy of the GNU General Public License\n"
+           << "// along with this program; if not, write to the Free Software\n"
+           << "// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.\n"
+           << "//\n"
+           << "// Generated by amoebax-sim --matrix. Don't edit by hand, rebuild it\n"
+           << "// with the win_rates target after changing any AI player.\n"
+           << "//\n"
+           << "#if !defined (AMOEBAX_WIN_RATES_H)\n"
+           << "#define AMOEBAX_WIN_RATES_H\n"
+           << "\n"
+           << "#include <stdint.h>\n"
+           << "\n"
+           << "namespace Amoebax\n"
+           << "{\n"
+           << "    /// The least number of matches played between two levels.\n"
+           << "    static const uint32_t k_WinRateMatches = " << minMatches
+           << ";\n";
+
+    const char *names[] = { "k_WinRate", "k_WinRateLowerBound",
+                            "k_WinRateUpperBound" };
+    const char *comments[] = {
+        "The probability, in 1/1000, that the left level wins.",
+        "The lower bound of k_WinRate's 95% confidence interval.",
+        "The upper bound of k_WinRate's 95% confidence interval." };
+    const uint16_t (*tables[])[levels] = { winRate, lowerBound, upperBound };
+    for ( size_t table = 0 ; table < 3 ; ++table )
+    {
+        header << "\n"
+               << "    /// " << comments[table] << "\n"
+               << "    static const uint16_t " << names[table]
+               << "[" << static_cast<int>(levels) << "]["
+               << static_cast<int>(levels) << "] =\n"
+               << "    {\n";
+        for ( uint8_t level = 0 ; level < levels ; ++level )
+        {
+            header << "        {";
+            for ( uint8_t opponent = 0 ; opponent < levels ; ++opponent )
+            {
+                header << std::setw (4) << tables[table][level][opponent]
+                       << (opponent + 1 < levels ? "," : " ");
+            }
+            header << "}" << (level + 1 < levels ? "," : "") << "\n";
+        }
+        header << "    };\n";
+    }
+    header << "}\n"
+           << "\n"
+           << "#endif // !AMOEBAX_WIN_RATES_H\n";
+}
+
+///
+/// \brief Writes a job's result as a CSV line.
+///
+/// \param output The stream to write the line to.
+/// \param job The job whose result to write.
+///
+void
+writeResult (std::ostream &output, const Job &job)
+{
+    const MatchSimulator::Result &result = job.result;
+    const char *winner = "none";
+    if ( result.finished )
+    {
+        winner = IPlayer::LeftSide == result.winner ? "left" : "right";
+    }
+    output << static_cast<int>(job.levels.first) << ','
+           << static_cast<int>(job.levels.second) << ','
+           << job.seed << ',' << winner << ','
+           << result.leftScore << ',' << result.rightScore << ','
+           << result.duration << ','
+           << static_cast<int>(result.leftMaxChain) << ','
+           << static_cast<int>(result.rightMaxChain) << '\n';
+}
@@ -1,5 +1,5 @@
 
-target_sources(amoebax PRIVATE
+target_sources(amoebax_core PRIVATE
 	unix/UnixOptions.cxx unix/UnixOptions.h)
 set(DATADIR "${CMAKE_INSTALL_FULL_DATADIR}/amoebax" CACHE PATH "Path to gamedata")
-target_compile_definitions(amoebax PRIVATE DATADIR="${DATADIR}")
+target_compile_definitions(amoebax_core PRIVATE DATADIR="${DATADIR}")
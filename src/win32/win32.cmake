@@ -1,8 +1,11 @@
 
-target_sources(amoebax PRIVATE
+target_sources(amoebax_core PRIVATE
 	win32/Win32Options.cxx win32/Win32Options.h)
-target_compile_definitions(amoebax PRIVATE WIN32_LEAN_AND_MEAN IS_WIN32_HOST)
+target_compile_definitions(amoebax_core PUBLIC WIN32_LEAN_AND_MEAN IS_WIN32_HOST)
 target_link_libraries(amoebax PRIVATE SDL2::SDL2main)
+if(SIMULATOR)
+	target_link_libraries(amoebax-sim PRIVATE SDL2::SDL2main)
+endif()
 
 set_target_properties(amoebax PROPERTIES WIN32_EXECUTABLE TRUE)
 